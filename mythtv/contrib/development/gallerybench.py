@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# Measures the throughput of the backend's gallery scanner and thumbnail
+# generator over a synthetic photo tree.
+#
+# The tree is built from copies of one or more sample images, so use a
+# few real camera JPEGs with EXIF data to get realistic numbers:
+#
+#   gallerybench.py --create 20000 --dirs 200 --sample a.jpg --sample b.jpg \
+#                   /srv/photos/bench
+#
+# The directory must be in (or below) a directory of the Photographs
+# storage group.  Then run the benchmark against the master backend:
+#
+#   gallerybench.py --host mybackend /srv/photos/bench
+#   gallerybench.py --thumbs 1-20000 /srv/photos/bench
+#
+# --thumbs queues thumbnails for a range of gallery_files ids after the
+# scan and waits until they are in the thumbnail directory, which only
+# works when run on the backend itself (see --thumbdir).  The thread count
+# is the GalleryWorkerThreads setting, the backend also logs its own
+# throughput figures.
+
+import argparse
+import os
+import re
+import shutil
+import sys
+import time
+import urllib.request
+
+
+def create_tree(root, count, dirs, samples):
+    """Copies the samples into count files spread over dirs directories,
+    two levels deep like a typical year/event layout."""
+    for n in range(count):
+        d = n % dirs
+        path = os.path.join(root, 'y%02d' % (d % 10), 'event%04d' % d)
+        if not os.path.isdir(path):
+            os.makedirs(path)
+        sample = samples[n % len(samples)]
+        ext = os.path.splitext(sample)[1].lower() or '.jpg'
+        dst = os.path.join(path, 'img%06d%s' % (n, ext))
+        if not os.path.exists(dst):
+            shutil.copyfile(sample, dst)
+    print('Created %d files in %d directories below %s' % (count, dirs, root))
+
+
+class Backend(object):
+
+    def __init__(self, host, port):
+        self.base = 'http://%s:%d/Image/' % (host, port)
+
+    def call(self, method, post=False, **params):
+        query = '&'.join('%s=%s' % kv for kv in params.items())
+        url = self.base + method + ('?' + query if query else '')
+        data = b'' if post else None
+        with urllib.request.urlopen(url, data, timeout=30) as f:
+            return f.read().decode('utf-8', 'replace')
+
+    def sync_status(self):
+        xml = self.call('GetSyncStatus')
+
+        def value(tag):
+            m = re.search(r'<%s>([^<]*)</%s>' % (tag, tag), xml)
+            return m.group(1) if m else ''
+
+        return (value('Running') == 'true',
+                int(value('Current') or 0), int(value('Total') or 0))
+
+
+def count_files(path):
+    total = 0
+    for _, _, files in os.walk(path):
+        total += len(files)
+    return total
+
+
+def bench_scan(backend, poll):
+    running, _, _ = backend.sync_status()
+    if running:
+        sys.exit('A synchronization is already running')
+
+    start = time.time()
+    backend.call('StartSync', post=True)
+
+    total = 0
+    while True:
+        time.sleep(poll)
+        running, current, t = backend.sync_status()
+        total = max(total, t)
+        if not running:
+            break
+        sys.stderr.write('\r%d/%d' % (current, total))
+    elapsed = time.time() - start
+
+    sys.stderr.write('\n')
+    print('Scan: %d entries in %.1f s, %.1f entries/s' %
+          (total, elapsed, total / elapsed if elapsed else 0))
+
+
+def bench_thumbs(backend, ids, thumbdir, poll, timeout):
+    first, last = [int(x) for x in ids.split('-')]
+    before = count_files(thumbdir)
+
+    start = time.time()
+    queued = 0
+    for i in range(first, last + 1):
+        if 'true' in backend.call('CreateThumbnail', post=True, Id=i):
+            queued += 1
+    backend.call('StartThumbnailGeneration', post=True)
+
+    made = 0
+    last_change = time.time()
+    while made < queued and time.time() - last_change < timeout:
+        time.sleep(poll)
+        now = count_files(thumbdir) - before
+        if now != made:
+            made = now
+            last_change = time.time()
+        sys.stderr.write('\r%d/%d' % (made, queued))
+    elapsed = time.time() - start
+
+    sys.stderr.write('\n')
+    print('Thumbnails: %d of %d in %.1f s, %.1f/s' %
+          (made, queued, elapsed, made / elapsed if elapsed else 0))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark the gallery scanner and thumbnail generator.')
+    parser.add_argument('root', help='benchmark directory')
+    parser.add_argument('--host', default='localhost')
+    parser.add_argument('--port', type=int, default=6544)
+    parser.add_argument('--create', type=int, metavar='FILES',
+                        help='create a tree of this many files and exit')
+    parser.add_argument('--dirs', type=int, default=100,
+                        help='directories in the created tree')
+    parser.add_argument('--sample', action='append', default=[],
+                        help='image the created files are copies of')
+    parser.add_argument('--thumbs', metavar='FIRST-LAST',
+                        help='also time thumbnails for these file ids')
+    parser.add_argument('--thumbdir',
+                        default=os.path.expanduser('~/.mythtv/tmp/MythImage'),
+                        help='the backend\'s thumbnail directory')
+    parser.add_argument('--poll', type=float, default=0.5,
+                        help='status poll interval (s)')
+    parser.add_argument('--timeout', type=float, default=60,
+                        help='give up when no thumbnail appears for this '
+                             'many seconds')
+    args = parser.parse_args()
+
+    if args.create:
+        if not args.sample:
+            sys.exit('--create needs at least one --sample image')
+        create_tree(args.root, args.create, max(args.dirs, 1), args.sample)
+        return
+
+    print('%d files below %s' % (count_files(args.root), args.root))
+
+    backend = Backend(args.host, args.port)
+    bench_scan(backend, args.poll)
+
+    if args.thumbs:
+        bench_thumbs(backend, args.thumbs, args.thumbdir,
+                     args.poll, args.timeout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+#
+# Replays a directory of HLS fixtures over HTTP with injected latency, so
+# HLSRingBuffer's segment fetching and variant switching can be exercised
+# without a real IPTV source.
+#
+# A fixture is a directory holding a master playlist, the media playlists
+# it references and their segments, e.g. made with:
+#
+#   ffmpeg -i in.ts -map 0 -c copy -f hls -hls_time 4 -hls_list_size 0 \
+#          -hls_segment_filename 'hi_%05d.ts' hi.m3u8
+#
+# (repeat with -b:v for lower variants and write a master.m3u8 by hand).
+#
+# Then play http://localhost:8089/master.m3u8 in mythfrontend/mythavtest:
+#
+#   hlsreplay.py --latency 300 --jitter 200 --rate 4000 fixtures/channel1
+#   hlsreplay.py --live 6 fixtures/channel1     # sliding window live stream
+#
+# The rate limit is shared by all connections, like a real access link,
+# and --rate-after switches to a second rate part way through to provoke
+# a variant switch.
+
+import argparse
+import os
+import random
+import re
+import sys
+import threading
+import time
+
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class TokenBucket(object):
+    """Limits the combined throughput of all connections."""
+
+    def __init__(self, kbps):
+        self.lock = threading.Lock()
+        self.set_rate(kbps)
+
+    def set_rate(self, kbps):
+        with self.lock:
+            self.rate = kbps * 1000 / 8.0 if kbps else 0
+            self.tokens = self.rate
+            self.last = time.time()
+
+    def take(self, nbytes):
+        while True:
+            with self.lock:
+                if not self.rate:
+                    return
+                now = time.time()
+                self.tokens = min(self.rate,
+                                  self.tokens + (now - self.last) * self.rate)
+                self.last = now
+                if self.tokens >= nbytes:
+                    self.tokens -= nbytes
+                    return
+                wait = (nbytes - self.tokens) / self.rate
+            time.sleep(wait)
+
+
+class Fixture(object):
+    """Media playlists of a fixture, optionally replayed as live streams."""
+
+    def __init__(self, root, live_window):
+        self.root = os.path.abspath(root)
+        self.live_window = live_window
+        self.start = time.time()
+
+    def path(self, url):
+        rel = url.split('?', 1)[0].lstrip('/')
+        full = os.path.abspath(os.path.join(self.root, rel))
+        if not full.startswith(self.root + os.sep):
+            return None
+        return full
+
+    def playlist(self, full):
+        with open(full, 'r') as f:
+            text = f.read()
+        if not self.live_window or '#EXTINF' not in text:
+            return text.encode('utf-8')
+        return self.slide(text).encode('utf-8')
+
+    def slide(self, text):
+        """Turns a VOD media playlist into a live one, moving the window of
+        segments forward in real time and looping at the end."""
+        header = []
+        segments = []
+        pending = []
+        for line in text.splitlines():
+            if line.startswith('#EXT-X-ENDLIST') or \
+               line.startswith('#EXT-X-PLAYLIST-TYPE') or \
+               line.startswith('#EXT-X-MEDIA-SEQUENCE'):
+                continue
+            if line.startswith('#EXTINF') or \
+               (segments or pending) and line.startswith('#'):
+                pending.append(line)
+            elif line.startswith('#') or not line.strip():
+                header.append(line)
+            else:
+                pending.append(line)
+                segments.append(pending)
+                pending = []
+        if not segments:
+            return text
+
+        def duration(seg):
+            for l in seg:
+                m = re.match(r'#EXTINF:([0-9.]+)', l)
+                if m:
+                    return float(m.group(1))
+            return 10.0
+
+        total = sum(duration(s) for s in segments)
+        elapsed = time.time() - self.start
+        loops, into = divmod(elapsed, total)
+        first = 0
+        while first < len(segments) - 1 and into >= duration(segments[first]):
+            into -= duration(segments[first])
+            first += 1
+        sequence = int(loops) * len(segments) + first
+
+        out = header + ['#EXT-X-MEDIA-SEQUENCE:%d' % sequence]
+        for n in range(self.live_window):
+            seg = segments[(first + n) % len(segments)]
+            if n and (first + n) % len(segments) == 0:
+                out.append('#EXT-X-DISCONTINUITY')
+            out.extend(seg)
+        return '\n'.join(out) + '\n'
+
+
+def make_handler(args, fixture, bucket):
+
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = 'HTTP/1.1'
+
+        def log_message(self, fmt, *a):
+            if args.verbose:
+                sys.stderr.write('%.3f %s\n' % (time.time(), fmt % a))
+
+        def do_GET(self):
+            full = fixture.path(self.path)
+            if full is None or not os.path.isfile(full):
+                self.send_error(404)
+                return
+
+            if args.fail and random.random() < args.fail:
+                self.send_error(503)
+                return
+
+            delay = args.latency + random.uniform(0, args.jitter)
+            time.sleep(delay / 1000.0)
+
+            if full.endswith('.m3u8'):
+                body = fixture.playlist(full)
+                ctype = 'application/vnd.apple.mpegurl'
+            else:
+                with open(full, 'rb') as f:
+                    body = f.read()
+                ctype = 'video/MP2T'
+
+            self.send_response(200)
+            self.send_header('Content-Type', ctype)
+            self.send_header('Content-Length', str(len(body)))
+            self.end_headers()
+
+            for pos in range(0, len(body), args.chunk):
+                chunk = body[pos:pos + args.chunk]
+                bucket.take(len(chunk))
+                try:
+                    self.wfile.write(chunk)
+                except (BrokenPipeError, ConnectionResetError):
+                    return
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Serve HLS fixtures with injected latency.')
+    parser.add_argument('root', help='fixture directory')
+    parser.add_argument('--port', type=int, default=8089)
+    parser.add_argument('--latency', type=int, default=0,
+                        help='delay before each response (ms)')
+    parser.add_argument('--jitter', type=int, default=0,
+                        help='random extra delay of up to this many ms')
+    parser.add_argument('--rate', type=int, default=0,
+                        help='total bandwidth limit (kbit/s, 0 = none)')
+    parser.add_argument('--rate-after', nargs=2, type=int,
+                        metavar=('SECONDS', 'KBPS'),
+                        help='change the bandwidth limit after SECONDS')
+    parser.add_argument('--fail', type=float, default=0.0,
+                        help='fraction of requests answered with 503')
+    parser.add_argument('--live', type=int, default=0, metavar='SEGMENTS',
+                        help='replay media playlists as live streams with '
+                             'a window of this many segments')
+    parser.add_argument('--chunk', type=int, default=16384,
+                        help=argparse.SUPPRESS)
+    parser.add_argument('--verbose', action='store_true')
+    args = parser.parse_args()
+
+    fixture = Fixture(args.root, args.live)
+    bucket = TokenBucket(args.rate)
+
+    if args.rate_after:
+        secs, kbps = args.rate_after
+        timer = threading.Timer(secs, bucket.set_rate, [kbps])
+        timer.daemon = True
+        timer.start()
+
+    server = ThreadingHTTPServer(('', args.port),
+                                 make_handler(args, fixture, bucket))
+    server.daemon_threads = True
+    print('Serving %s on port %d' % (fixture.root, args.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+#
+# Measures how long mythfilldatabase takes to import a large XMLTV file,
+# and how much memory it needs for it.
+#
+# Generate a file with as many channels and days as your real feeds have,
+# or more, the listings are made up but have credits, ratings, categories
+# and episode numbers like typical grabber output:
+#
+#   xmltvbench.py --create 300 --days 14 /tmp/bench.xmltv
+#
+# The channels are named bench1.xmltv ... benchN.xmltv, add them to a
+# video source once with:
+#
+#   xmltvbench.py --channels 300 --sourceid 5 --create-channels
+#
+# (this needs the mysql command line client and reads the database
+# settings from ~/.mythtv/config.xml).  Then time the import:
+#
+#   xmltvbench.py --sourceid 5 /tmp/bench.xmltv
+#
+# Run it twice, the second run is the usual daily case where nearly all
+# programs are unchanged.  --shift moves all programs by some minutes so
+# the next run has to replace them all instead.
+
+import argparse
+import os
+import random
+import re
+import resource
+import subprocess
+import sys
+import time
+from datetime import datetime, timedelta
+from xml.sax.saxutils import escape, quoteattr
+
+WORDS = ('news weather sport night live show world late morning family '
+         'story house garden kitchen island city road secret great war '
+         'history science nature planet ocean music star quiz game life '
+         'time police doctor school murder mystery party road trip').split()
+CATEGORIES = ['News', 'Sports', 'Movie', 'Series', 'Documentary', 'Kids',
+              'Comedy', 'Drama', 'Talk', 'Music']
+ROLES = ['actor', 'director', 'writer', 'presenter', 'guest']
+
+
+def words(rnd, lo, hi):
+    return ' '.join(rnd.choice(WORDS) for _ in range(rnd.randint(lo, hi)))
+
+
+def xmltv_time(dt):
+    return dt.strftime('%Y%m%d%H%M%S +0000')
+
+
+def create_file(path, channels, days, shift, seed):
+    rnd = random.Random(seed)
+    start = datetime.utcnow().replace(hour=0, minute=0, second=0,
+                                      microsecond=0)
+    start += timedelta(minutes=shift)
+    end = start + timedelta(days=days)
+    people = ['%s %s' % (words(rnd, 1, 1).title(), words(rnd, 1, 1).title())
+              for _ in range(5000)]
+    count = 0
+
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+        f.write('<!DOCTYPE tv SYSTEM "xmltv.dtd">\n')
+        f.write('<tv generator-info-name="xmltvbench">\n')
+
+        for c in range(1, channels + 1):
+            f.write('  <channel id="bench%d.xmltv">\n' % c)
+            f.write('    <display-name>Bench %d</display-name>\n' % c)
+            f.write('    <display-name>BENCH%d</display-name>\n' % c)
+            f.write('    <display-name>%d</display-name>\n' % c)
+            f.write('  </channel>\n')
+
+        for c in range(1, channels + 1):
+            t = start
+            while t < end:
+                length = timedelta(minutes=rnd.choice([5, 15, 30, 30, 60,
+                                                       60, 90, 120]))
+                f.write('  <programme start="%s" stop="%s" '
+                        'channel="bench%d.xmltv">\n' %
+                        (xmltv_time(t), xmltv_time(t + length), c))
+                f.write('    <title lang="en">%s</title>\n' %
+                        escape(words(rnd, 1, 4).title()))
+                if rnd.random() < 0.6:
+                    f.write('    <sub-title lang="en">%s</sub-title>\n' %
+                            escape(words(rnd, 2, 6).capitalize()))
+                f.write('    <desc lang="en">%s.</desc>\n' %
+                        escape(words(rnd, 10, 60).capitalize()))
+                if rnd.random() < 0.5:
+                    f.write('    <credits>\n')
+                    for _ in range(rnd.randint(1, 8)):
+                        role = rnd.choice(ROLES)
+                        f.write('      <%s>%s</%s>\n' %
+                                (role, escape(rnd.choice(people)), role))
+                    f.write('    </credits>\n')
+                f.write('    <category lang="en">%s</category>\n' %
+                        rnd.choice(CATEGORIES))
+                if rnd.random() < 0.4:
+                    f.write('    <episode-num system="xmltv_ns">'
+                            '%d.%d.</episode-num>\n' %
+                            (rnd.randint(0, 20), rnd.randint(0, 25)))
+                if rnd.random() < 0.3:
+                    f.write('    <previously-shown />\n')
+                if rnd.random() < 0.2:
+                    f.write('    <rating system=%s><value>%s</value>'
+                            '</rating>\n' %
+                            (quoteattr('VCHIP'),
+                             rnd.choice(['TV-G', 'TV-PG', 'TV-14'])))
+                f.write('  </programme>\n')
+                t += length
+                count += 1
+
+        f.write('</tv>\n')
+
+    size = os.path.getsize(path)
+    print('Wrote %d programs on %d channels, %.1f MB, to %s' %
+          (count, channels, size / 1048576.0, path))
+
+
+def db_settings():
+    path = os.path.expanduser('~/.mythtv/config.xml')
+    with open(path) as f:
+        text = f.read()
+
+    def value(tag):
+        m = re.search(r'<%s>([^<]*)</%s>' % (tag, tag), text)
+        return m.group(1) if m else ''
+
+    return (value('Host'), value('UserName'), value('Password'),
+            value('DatabaseName'))
+
+
+def create_channels(channels, sourceid):
+    host, user, password, name = db_settings()
+    sql = []
+    for c in range(1, channels + 1):
+        chanid = 90000 + c
+        sql.append("REPLACE INTO channel (chanid, channum, callsign, name, "
+                   "xmltvid, sourceid) VALUES (%d, '9%04d', 'BENCH%d', "
+                   "'Bench %d', 'bench%d.xmltv', %d);" %
+                   (chanid, c, c, c, c, sourceid))
+    subprocess.run(['mysql', '-h', host, '-u', user, '-p' + password, name],
+                   input='\n'.join(sql).encode('utf-8'), check=True)
+    print('Created channels %d to %d on source %d' %
+          (90001, 90000 + channels, sourceid))
+
+
+def run_import(path, sourceid, binary, extra):
+    cmd = [binary, '--file', '--sourceid', str(sourceid),
+           '--xmlfile', path] + extra
+    print(' '.join(cmd))
+
+    start = time.time()
+    result = subprocess.run(cmd, stdout=subprocess.DEVNULL)
+    elapsed = time.time() - start
+    usage = resource.getrusage(resource.RUSAGE_CHILDREN)
+
+    if result.returncode != 0:
+        sys.exit('mythfilldatabase failed with exit code %d' %
+                 result.returncode)
+
+    print('Import: %.1f s, %.1f s CPU, %.0f MB peak memory' %
+          (elapsed, usage.ru_utime + usage.ru_stime, usage.ru_maxrss / 1024.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Benchmark importing a large XMLTV file.')
+    parser.add_argument('file', nargs='?', help='XMLTV file')
+    parser.add_argument('--create', type=int, metavar='CHANNELS',
+                        help='generate the file with this many channels')
+    parser.add_argument('--days', type=int, default=14,
+                        help='days of listings in the generated file')
+    parser.add_argument('--shift', type=int, default=0, metavar='MINUTES',
+                        help='move all generated programs by this much')
+    parser.add_argument('--seed', type=int, default=1,
+                        help='random seed of the generated listings')
+    parser.add_argument('--channels', type=int, default=300,
+                        help='channels added by --create-channels')
+    parser.add_argument('--create-channels', action='store_true',
+                        help='add the benchmark channels to --sourceid')
+    parser.add_argument('--sourceid', type=int)
+    parser.add_argument('--binary', default='mythfilldatabase')
+    parser.add_argument('--extra', action='append', default=[],
+                        help='extra mythfilldatabase argument')
+    args = parser.parse_args()
+
+    if args.create:
+        if not args.file:
+            sys.exit('--create needs a file name')
+        create_file(args.file, args.create, args.days, args.shift, args.seed)
+        return
+
+    if not args.sourceid:
+        sys.exit('--sourceid is required')
+
+    if args.create_channels:
+        create_channels(args.channels, args.sourceid)
+        return
+
+    if not args.file:
+        sys.exit('No XMLTV file given')
+
+    run_import(args.file, args.sourceid, args.binary, args.extra)
+
+
+if __name__ == '__main__':
+    main()
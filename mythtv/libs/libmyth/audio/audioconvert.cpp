@@ -38,37 +38,111 @@ extern "C" {
 
 #define ISALIGN(x) (((unsigned long)x & 0xf) == 0)
 
+#if HAVE_XMM_CLOBBERS
+#define SIMD_CLOBBERS "memory", "%xmm0", "%xmm1", "%xmm2", "%xmm3", \
+                     "%xmm4", "%xmm5", "%xmm6", "%xmm7"
+#else
+#define SIMD_CLOBBERS "memory"
+#endif
+
 #if ARCH_X86
-static int has_sse2 = -1;
+static int simd_cpu = -1;
+static int simd_max = AudioConvert::kSIMDAVX2;
 
-// Check cpuid for SSE2 support on x86 / x86_64
-static inline bool sse_check()
+static inline void cpuid(int leaf, int &a, int &b, int &c, int &d)
 {
-    if (has_sse2 != -1)
-        return (bool)has_sse2;
-    __asm__(
+    __asm__ volatile (
             // -fPIC - we may not clobber ebx/rbx
 #if ARCH_X86_64
-            "push       %%rbx               \n\t"
-#else
-            "push       %%ebx               \n\t"
-#endif
-            "mov        $1, %%eax           \n\t"
+            "xchg       %%rbx, %q1          \n\t"
             "cpuid                          \n\t"
-            "and        $0x4000000, %%edx   \n\t"
-            "shr        $26, %%edx          \n\t"
-#if ARCH_X86_64
-            "pop        %%rbx               \n\t"
+            "xchg       %%rbx, %q1          \n\t"
 #else
-            "pop        %%ebx               \n\t"
+            "xchg       %%ebx, %1           \n\t"
+            "cpuid                          \n\t"
+            "xchg       %%ebx, %1           \n\t"
 #endif
-            :"=d"(has_sse2)
-            ::"%eax","%ecx"
+            :"=a"(a), "=&r"(b), "=c"(c), "=d"(d)
+            :"0"(leaf), "2"(0)
             );
-    return (bool)has_sse2;
+}
+
+// Check cpuid for SSE2 and AVX2 support on x86 / x86_64
+static int cpu_simd_level(void)
+{
+    int a, b, c, d;
+
+    cpuid(0, a, b, c, d);
+    int max_leaf = a;
+
+    cpuid(1, a, b, c, d);
+    if (!(d & (1 << 26)))
+        return AudioConvert::kSIMDNone;
+
+    int level = AudioConvert::kSIMDSSE2;
+#if HAVE_AVX2_INLINE
+    // The OS must also save the upper halves of the ymm registers (OSXSAVE,
+    // then XCR0 bits 1 and 2)
+    if (max_leaf >= 7 && (c & (1 << 27)) && (c & (1 << 28)))
+    {
+        int xcr0, xcr0_hi;
+        __asm__ volatile (".byte 0x0f, 0x01, 0xd0" // xgetbv
+                          :"=a"(xcr0), "=d"(xcr0_hi)
+                          :"c"(0)
+                          );
+        cpuid(7, a, b, c, d);
+        if ((xcr0 & 6) == 6 && (b & (1 << 5)))
+            level = AudioConvert::kSIMDAVX2;
+    }
+#else
+    (void)max_leaf;
+#endif
+    return level;
 }
 #endif //ARCH_x86
 
+/**
+ * Returns the best SIMD instruction set both this build and the CPU support,
+ * capped by SetMaxSIMDLevel()
+ */
+AudioConvert::SIMDLevel AudioConvert::GetSIMDLevel(void)
+{
+#if ARCH_X86
+    if (simd_cpu < 0)
+        simd_cpu = cpu_simd_level();
+    return (SIMDLevel)(simd_cpu < simd_max ? simd_cpu : simd_max);
+#else
+    return kSIMDNone;
+#endif
+}
+
+/**
+ * Restrict the conversion routines to 'level', so tests and benchmarks can
+ * compare each implementation with the plain C one
+ */
+void AudioConvert::SetMaxSIMDLevel(SIMDLevel level)
+{
+#if ARCH_X86
+    simd_max = level;
+#else
+    (void)level;
+#endif
+}
+
+#if ARCH_X86
+static inline bool sse_check()
+{
+    return AudioConvert::GetSIMDLevel() >= AudioConvert::kSIMDSSE2;
+}
+#endif //ARCH_x86
+
+#if HAVE_AVX2_INLINE
+static inline bool avx2_check()
+{
+    return AudioConvert::GetSIMDLevel() >= AudioConvert::kSIMDAVX2;
+}
+#endif //HAVE_AVX2_INLINE
+
 #if !HAVE_LRINTF
 static av_always_inline av_const long int lrintf(float x)
 {
@@ -84,7 +158,8 @@ static inline float clipcheck(float f)
 }
 
 /*
- The SSE code processes 16 bytes at a time and leaves any remainder for the C
+ The AVX2 code processes 32 samples at a time, the SSE code 16 of what is
+ left after that and any remainder is left for the C
  */
 
 static int toFloat8(float* out, const uchar* in, int len)
@@ -92,11 +167,53 @@ static int toFloat8(float* out, const uchar* in, int len)
     int i = 0;
     float f = 1.0f / ((1<<7));
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %4, %%ymm7                 \n\t"
+                          "vmovd        %3, %%xmm6                 \n\t"
+                          "vpbroadcastd %%xmm6, %%ymm6             \n\t"
+                          "1:                                      \n\t"
+                          "vpmovzxbd    (%1), %%ymm1               \n\t"
+                          "vpmovzxbd    8(%1), %%ymm2              \n\t"
+                          "vpmovzxbd    16(%1), %%ymm3             \n\t"
+                          "vpmovzxbd    24(%1), %%ymm4             \n\t"
+                          "vpsubd       %%ymm6, %%ymm1, %%ymm1     \n\t"
+                          "vpsubd       %%ymm6, %%ymm2, %%ymm2     \n\t"
+                          "vpsubd       %%ymm6, %%ymm3, %%ymm3     \n\t"
+                          "vpsubd       %%ymm6, %%ymm4, %%ymm4     \n\t"
+                          "vcvtdq2ps    %%ymm1, %%ymm1             \n\t"
+                          "vcvtdq2ps    %%ymm2, %%ymm2             \n\t"
+                          "vcvtdq2ps    %%ymm3, %%ymm3             \n\t"
+                          "vcvtdq2ps    %%ymm4, %%ymm4             \n\t"
+                          "vmulps       %%ymm7, %%ymm1, %%ymm1     \n\t"
+                          "vmulps       %%ymm7, %%ymm2, %%ymm2     \n\t"
+                          "vmulps       %%ymm7, %%ymm3, %%ymm3     \n\t"
+                          "vmulps       %%ymm7, %%ymm4, %%ymm4     \n\t"
+                          "vmovups      %%ymm1, (%0)               \n\t"
+                          "vmovups      %%ymm2, 32(%0)             \n\t"
+                          "vmovups      %%ymm3, 64(%0)             \n\t"
+                          "vmovups      %%ymm4, 96(%0)             \n\t"
+                          "add          $32,  %1                   \n\t"
+                          "add          $128, %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"r"(0x80), "m"(f)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
-        int loops = len >> 4;
-        i = loops << 4;
+        int loops = (len - i) >> 4;
+        i += loops << 4;
         int a = 0x80808080;
 
         __asm__ volatile (
@@ -165,11 +282,51 @@ static int fromFloat8(uchar* out, const float* in, int len)
     int i = 0;
     float f = (1<<7);
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        // the packs work within each 128 bits half, put the dwords back
+        // into order afterwards
+        static const int dword_order[8] = { 0, 4, 1, 5, 2, 6, 3, 7 };
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %4, %%ymm7                 \n\t"
+                          "vmovd        %3, %%xmm0                 \n\t"
+                          "vpbroadcastd %%xmm0, %%ymm0             \n\t"
+                          "vmovdqu      (%5), %%ymm5               \n\t"
+                          "1:                                      \n\t"
+                          "vmulps       (%1), %%ymm7, %%ymm1       \n\t"
+                          "vmulps       32(%1), %%ymm7, %%ymm2     \n\t"
+                          "vmulps       64(%1), %%ymm7, %%ymm3     \n\t"
+                          "vmulps       96(%1), %%ymm7, %%ymm4     \n\t"
+                          "vcvtps2dq    %%ymm1, %%ymm1             \n\t"
+                          "vcvtps2dq    %%ymm2, %%ymm2             \n\t"
+                          "vcvtps2dq    %%ymm3, %%ymm3             \n\t"
+                          "vcvtps2dq    %%ymm4, %%ymm4             \n\t"
+                          "vpackssdw    %%ymm2, %%ymm1, %%ymm1     \n\t"
+                          "vpackssdw    %%ymm4, %%ymm3, %%ymm3     \n\t"
+                          "vpacksswb    %%ymm3, %%ymm1, %%ymm1     \n\t"
+                          "vpermd       %%ymm1, %%ymm5, %%ymm1     \n\t"
+                          "vpaddb       %%ymm0, %%ymm1, %%ymm1     \n\t"
+                          "vmovdqu      %%ymm1, (%0)               \n\t"
+                          "add          $128, %1                   \n\t"
+                          "add          $32,  %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"r"(0x80808080), "m"(f), "r"(dword_order)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
-        int loops = len >> 4;
-        i = loops << 4;
+        int loops = (len - i) >> 4;
+        i += loops << 4;
         int a = 0x80808080;
 
         __asm__ volatile (
@@ -216,11 +373,47 @@ static int toFloat16(float* out, const short* in, int len)
     int i = 0;
     float f = 1.0f / ((1<<15));
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %3, %%ymm7                 \n\t"
+                          "1:                                      \n\t"
+                          "vpmovsxwd    (%1), %%ymm1               \n\t"
+                          "vpmovsxwd    16(%1), %%ymm2             \n\t"
+                          "vpmovsxwd    32(%1), %%ymm3             \n\t"
+                          "vpmovsxwd    48(%1), %%ymm4             \n\t"
+                          "vcvtdq2ps    %%ymm1, %%ymm1             \n\t"
+                          "vcvtdq2ps    %%ymm2, %%ymm2             \n\t"
+                          "vcvtdq2ps    %%ymm3, %%ymm3             \n\t"
+                          "vcvtdq2ps    %%ymm4, %%ymm4             \n\t"
+                          "vmulps       %%ymm7, %%ymm1, %%ymm1     \n\t"
+                          "vmulps       %%ymm7, %%ymm2, %%ymm2     \n\t"
+                          "vmulps       %%ymm7, %%ymm3, %%ymm3     \n\t"
+                          "vmulps       %%ymm7, %%ymm4, %%ymm4     \n\t"
+                          "vmovups      %%ymm1, (%0)               \n\t"
+                          "vmovups      %%ymm2, 32(%0)             \n\t"
+                          "vmovups      %%ymm3, 64(%0)             \n\t"
+                          "vmovups      %%ymm4, 96(%0)             \n\t"
+                          "add          $64,  %1                   \n\t"
+                          "add          $128, %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"m"(f)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
-        int loops = len >> 4;
-        i = loops << 4;
+        int loops = (len - i) >> 4;
+        i += loops << 4;
 
         __asm__ volatile (
                           "movd       %3, %%xmm7          \n\t"
@@ -276,11 +469,45 @@ static int fromFloat16(short* out, const float* in, int len)
     int i = 0;
     float f = (1<<15);
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %3, %%ymm7                 \n\t"
+                          "1:                                      \n\t"
+                          "vmulps       (%1), %%ymm7, %%ymm1       \n\t"
+                          "vmulps       32(%1), %%ymm7, %%ymm2     \n\t"
+                          "vmulps       64(%1), %%ymm7, %%ymm3     \n\t"
+                          "vmulps       96(%1), %%ymm7, %%ymm4     \n\t"
+                          "vcvtps2dq    %%ymm1, %%ymm1             \n\t"
+                          "vcvtps2dq    %%ymm2, %%ymm2             \n\t"
+                          "vcvtps2dq    %%ymm3, %%ymm3             \n\t"
+                          "vcvtps2dq    %%ymm4, %%ymm4             \n\t"
+                          "vpackssdw    %%ymm2, %%ymm1, %%ymm1     \n\t"
+                          "vpackssdw    %%ymm4, %%ymm3, %%ymm3     \n\t"
+                          "vpermq       $0xd8, %%ymm1, %%ymm1      \n\t"
+                          "vpermq       $0xd8, %%ymm3, %%ymm3      \n\t"
+                          "vmovdqu      %%ymm1, (%0)               \n\t"
+                          "vmovdqu      %%ymm3, 32(%0)             \n\t"
+                          "add          $128, %1                   \n\t"
+                          "add          $64,  %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"m"(f)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
-        int loops = len >> 4;
-        i = loops << 4;
+        int loops = (len - i) >> 4;
+        i += loops << 4;
 
         __asm__ volatile (
                           "movd       %3, %%xmm7          \n\t"
@@ -327,11 +554,52 @@ static int toFloat32(AudioFormat format, float* out, const int* in, int len)
     if (format == FORMAT_S24LSB)
         shift = 0;
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %3, %%ymm7                 \n\t"
+                          "vmovd        %4, %%xmm6                 \n\t"
+                          "1:                                      \n\t"
+                          "vmovdqu      (%1), %%ymm1               \n\t"
+                          "vmovdqu      32(%1), %%ymm2             \n\t"
+                          "vmovdqu      64(%1), %%ymm3             \n\t"
+                          "vmovdqu      96(%1), %%ymm4             \n\t"
+                          "vpsrad       %%xmm6, %%ymm1, %%ymm1     \n\t"
+                          "vpsrad       %%xmm6, %%ymm2, %%ymm2     \n\t"
+                          "vpsrad       %%xmm6, %%ymm3, %%ymm3     \n\t"
+                          "vpsrad       %%xmm6, %%ymm4, %%ymm4     \n\t"
+                          "vcvtdq2ps    %%ymm1, %%ymm1             \n\t"
+                          "vcvtdq2ps    %%ymm2, %%ymm2             \n\t"
+                          "vcvtdq2ps    %%ymm3, %%ymm3             \n\t"
+                          "vcvtdq2ps    %%ymm4, %%ymm4             \n\t"
+                          "vmulps       %%ymm7, %%ymm1, %%ymm1     \n\t"
+                          "vmulps       %%ymm7, %%ymm2, %%ymm2     \n\t"
+                          "vmulps       %%ymm7, %%ymm3, %%ymm3     \n\t"
+                          "vmulps       %%ymm7, %%ymm4, %%ymm4     \n\t"
+                          "vmovups      %%ymm1, (%0)               \n\t"
+                          "vmovups      %%ymm2, 32(%0)             \n\t"
+                          "vmovups      %%ymm3, 64(%0)             \n\t"
+                          "vmovups      %%ymm4, 96(%0)             \n\t"
+                          "add          $128, %1                   \n\t"
+                          "add          $128, %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"m"(f), "r"(shift)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
-        int loops = len >> 4;
-        i = loops << 4;
+        int loops = (len - i) >> 4;
+        i += loops << 4;
 
         __asm__ volatile (
                           "movd       %3, %%xmm7          \n\t"
@@ -383,12 +651,64 @@ static int fromFloat32(AudioFormat format, int* out, const float* in, int len)
     if (format == FORMAT_S24LSB)
         shift = 0;
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        float o = 0.99999995, mo = -1;
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %3, %%ymm7                 \n\t"
+                          "vbroadcastss %4, %%ymm5                 \n\t"
+                          "vbroadcastss %5, %%ymm6                 \n\t"
+                          "vmovd        %6, %%xmm0                 \n\t"
+                          "1:                                      \n\t"
+                          "vmovups      (%1), %%ymm1               \n\t"
+                          "vminps       %%ymm5, %%ymm1, %%ymm1     \n\t"
+                          "vmaxps       %%ymm6, %%ymm1, %%ymm1     \n\t"
+                          "vmulps       %%ymm7, %%ymm1, %%ymm1     \n\t"
+                          "vcvtps2dq    %%ymm1, %%ymm1             \n\t"
+                          "vpslld       %%xmm0, %%ymm1, %%ymm1     \n\t"
+                          "vmovdqu      %%ymm1, (%0)               \n\t"
+                          "vmovups      32(%1), %%ymm2             \n\t"
+                          "vminps       %%ymm5, %%ymm2, %%ymm2     \n\t"
+                          "vmaxps       %%ymm6, %%ymm2, %%ymm2     \n\t"
+                          "vmulps       %%ymm7, %%ymm2, %%ymm2     \n\t"
+                          "vcvtps2dq    %%ymm2, %%ymm2             \n\t"
+                          "vpslld       %%xmm0, %%ymm2, %%ymm2     \n\t"
+                          "vmovdqu      %%ymm2, 32(%0)             \n\t"
+                          "vmovups      64(%1), %%ymm3             \n\t"
+                          "vminps       %%ymm5, %%ymm3, %%ymm3     \n\t"
+                          "vmaxps       %%ymm6, %%ymm3, %%ymm3     \n\t"
+                          "vmulps       %%ymm7, %%ymm3, %%ymm3     \n\t"
+                          "vcvtps2dq    %%ymm3, %%ymm3             \n\t"
+                          "vpslld       %%xmm0, %%ymm3, %%ymm3     \n\t"
+                          "vmovdqu      %%ymm3, 64(%0)             \n\t"
+                          "vmovups      96(%1), %%ymm4             \n\t"
+                          "vminps       %%ymm5, %%ymm4, %%ymm4     \n\t"
+                          "vmaxps       %%ymm6, %%ymm4, %%ymm4     \n\t"
+                          "vmulps       %%ymm7, %%ymm4, %%ymm4     \n\t"
+                          "vcvtps2dq    %%ymm4, %%ymm4             \n\t"
+                          "vpslld       %%xmm0, %%ymm4, %%ymm4     \n\t"
+                          "vmovdqu      %%ymm4, 96(%0)             \n\t"
+                          "add          $128, %1                   \n\t"
+                          "add          $128, %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"m"(f), "m"(o), "m"(mo), "r"(shift)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
         float o = 0.99999995, mo = -1;
-        int loops = len >> 4;
-        i = loops << 4;
+        int loops = (len - i) >> 4;
+        i += loops << 4;
 
         __asm__ volatile (
                           "movd       %3, %%xmm7          \n\t"
@@ -463,12 +783,50 @@ static int fromFloatFLT(float* out, const float* in, int len)
 {
     int i = 0;
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && len >= 32)
+    {
+        float o = 1, mo = -1;
+        int loops = len >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+                          "vbroadcastss %3, %%ymm6                 \n\t"
+                          "vbroadcastss %4, %%ymm7                 \n\t"
+                          "1:                                      \n\t"
+                          "vmovups      (%1), %%ymm1               \n\t"
+                          "vminps       %%ymm6, %%ymm1, %%ymm1     \n\t"
+                          "vmaxps       %%ymm7, %%ymm1, %%ymm1     \n\t"
+                          "vmovups      %%ymm1, (%0)               \n\t"
+                          "vmovups      32(%1), %%ymm2             \n\t"
+                          "vminps       %%ymm6, %%ymm2, %%ymm2     \n\t"
+                          "vmaxps       %%ymm7, %%ymm2, %%ymm2     \n\t"
+                          "vmovups      %%ymm2, 32(%0)             \n\t"
+                          "vmovups      64(%1), %%ymm3             \n\t"
+                          "vminps       %%ymm6, %%ymm3, %%ymm3     \n\t"
+                          "vmaxps       %%ymm7, %%ymm3, %%ymm3     \n\t"
+                          "vmovups      %%ymm3, 64(%0)             \n\t"
+                          "vmovups      96(%1), %%ymm4             \n\t"
+                          "vminps       %%ymm6, %%ymm4, %%ymm4     \n\t"
+                          "vmaxps       %%ymm7, %%ymm4, %%ymm4     \n\t"
+                          "vmovups      %%ymm4, 96(%0)             \n\t"
+                          "add          $128, %1                   \n\t"
+                          "add          $128, %0                   \n\t"
+                          "sub          $1, %%ecx                  \n\t"
+                          "jnz          1b                         \n\t"
+                          "vzeroupper                              \n\t"
+                          :"+r"(out), "+r"(in), "+c"(loops)
+                          :"m"(o), "m"(mo)
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && len >= 16)
+    if (sse_check() && len - i >= 16)
     {
-        int loops = len >> 4;
+        int loops = (len - i) >> 4;
         float o = 1, mo = -1;
-        i = loops << 4;
+        i += loops << 4;
 
         __asm__ volatile (
                           "movss      %3, %%xmm6          \n\t"
@@ -731,6 +1089,93 @@ void AudioConvert::MonoToStereo(void* dst, const void* src, int samples)
     }
 }
 
+/*
+ The SSE code splits 16 bytes of stereo frames at a time and leaves any
+ remainder for the C. Returns the number of frames done.
+ */
+static int DeinterleaveStereo(int size, void* left, void* right,
+                              const void* in, int frames)
+{
+    int i = 0;
+
+#if ARCH_X86
+    if (sse_check() && size == 4 && frames >= 4)
+    {
+        int loops = frames >> 2;
+        i = loops << 2;
+
+        __asm__ volatile (
+                          "1:                             \n\t"
+                          "movups     (%2), %%xmm1        \n\t"
+                          "movups     16(%2), %%xmm2      \n\t"
+                          "movaps     %%xmm1, %%xmm3      \n\t"
+                          "shufps     $0x88, %%xmm2, %%xmm1 \n\t"
+                          "shufps     $0xdd, %%xmm2, %%xmm3 \n\t"
+                          "movups     %%xmm1, (%0)        \n\t"
+                          "movups     %%xmm3, (%1)        \n\t"
+                          "add        $16,    %0          \n\t"
+                          "add        $16,    %1          \n\t"
+                          "add        $32,    %2          \n\t"
+                          "sub        $1, %%ecx           \n\t"
+                          "jnz        1b                  \n\t"
+                          :"+r"(left), "+r"(right), "+r"(in), "+c"(loops)
+                          :
+                          :SIMD_CLOBBERS
+                          );
+    }
+    else if (sse_check() && size == 2 && frames >= 8)
+    {
+        int loops = frames >> 3;
+        i = loops << 3;
+
+        __asm__ volatile (
+                          "1:                             \n\t"
+                          "movdqu     (%2), %%xmm1        \n\t"
+                          "movdqu     16(%2), %%xmm2      \n\t"
+                          "movdqa     %%xmm1, %%xmm3      \n\t"
+                          "movdqa     %%xmm2, %%xmm4      \n\t"
+                          "pslld      $16,    %%xmm1      \n\t"
+                          "pslld      $16,    %%xmm2      \n\t"
+                          "psrad      $16,    %%xmm3      \n\t"
+                          "psrad      $16,    %%xmm4      \n\t"
+                          "psrad      $16,    %%xmm1      \n\t"
+                          "psrad      $16,    %%xmm2      \n\t"
+                          "packssdw   %%xmm4, %%xmm3      \n\t"
+                          "packssdw   %%xmm2, %%xmm1      \n\t"
+                          "movdqu     %%xmm1, (%0)        \n\t"
+                          "movdqu     %%xmm3, (%1)        \n\t"
+                          "add        $16,    %0          \n\t"
+                          "add        $16,    %1          \n\t"
+                          "add        $32,    %2          \n\t"
+                          "sub        $1, %%ecx           \n\t"
+                          "jnz        1b                  \n\t"
+                          :"+r"(left), "+r"(right), "+r"(in), "+c"(loops)
+                          :
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //ARCH_x86
+    return i;
+}
+
+/*
+ With the number of channels known at compile time the compiler unrolls the
+ loop over the channels
+ */
+template <class AudioDataType, int channels>
+void _DeinterleaveFrames(AudioDataType** outp, const AudioDataType* in,
+                         int start, int frames)
+{
+    in += start * channels;
+    for (int i = start; i < frames; i++)
+    {
+        for (int j = 0; j < channels; j++)
+        {
+            outp[j][i] = *(in++);
+        }
+    }
+}
+
 template <class AudioDataType>
 void _DeinterleaveSample(AudioDataType* out, const AudioDataType* in, int channels, int frames)
 {
@@ -741,6 +1186,23 @@ void _DeinterleaveSample(AudioDataType* out, const AudioDataType* in, int channe
         outp[i] = out + (i * frames);
     }
 
+    switch (channels)
+    {
+        case 2:
+        {
+            int done = DeinterleaveStereo(sizeof(AudioDataType),
+                                          outp[0], outp[1], in, frames);
+            _DeinterleaveFrames<AudioDataType, 2>(outp, in, done, frames);
+            return;
+        }
+        case 6:
+            _DeinterleaveFrames<AudioDataType, 6>(outp, in, 0, frames);
+            return;
+        case 8:
+            _DeinterleaveFrames<AudioDataType, 8>(outp, in, 0, frames);
+            return;
+    }
+
     for (int i = 0; i < frames; i++)
     {
         for (int j = 0; j < channels; j++)
@@ -773,6 +1235,82 @@ void AudioConvert::DeinterleaveSamples(AudioFormat format, int channels,
     }
 }
 
+/*
+ The SSE code merges 16 bytes of each channel at a time and leaves any
+ remainder for the C. Returns the number of frames done.
+ */
+static int InterleaveStereo(int size, void* out, const void* left,
+                            const void* right, int frames)
+{
+    int i = 0;
+
+#if ARCH_X86
+    if (sse_check() && size == 4 && frames >= 4)
+    {
+        int loops = frames >> 2;
+        i = loops << 2;
+
+        __asm__ volatile (
+                          "1:                             \n\t"
+                          "movups     (%1), %%xmm1        \n\t"
+                          "movups     (%2), %%xmm2        \n\t"
+                          "movaps     %%xmm1, %%xmm3      \n\t"
+                          "unpcklps   %%xmm2, %%xmm1      \n\t"
+                          "unpckhps   %%xmm2, %%xmm3      \n\t"
+                          "movups     %%xmm1, (%0)        \n\t"
+                          "movups     %%xmm3, 16(%0)      \n\t"
+                          "add        $32,    %0          \n\t"
+                          "add        $16,    %1          \n\t"
+                          "add        $16,    %2          \n\t"
+                          "sub        $1, %%ecx           \n\t"
+                          "jnz        1b                  \n\t"
+                          :"+r"(out), "+r"(left), "+r"(right), "+c"(loops)
+                          :
+                          :SIMD_CLOBBERS
+                          );
+    }
+    else if (sse_check() && size == 2 && frames >= 8)
+    {
+        int loops = frames >> 3;
+        i = loops << 3;
+
+        __asm__ volatile (
+                          "1:                             \n\t"
+                          "movdqu     (%1), %%xmm1        \n\t"
+                          "movdqu     (%2), %%xmm2        \n\t"
+                          "movdqa     %%xmm1, %%xmm3      \n\t"
+                          "punpcklwd  %%xmm2, %%xmm1      \n\t"
+                          "punpckhwd  %%xmm2, %%xmm3      \n\t"
+                          "movdqu     %%xmm1, (%0)        \n\t"
+                          "movdqu     %%xmm3, 16(%0)      \n\t"
+                          "add        $32,    %0          \n\t"
+                          "add        $16,    %1          \n\t"
+                          "add        $16,    %2          \n\t"
+                          "sub        $1, %%ecx           \n\t"
+                          "jnz        1b                  \n\t"
+                          :"+r"(out), "+r"(left), "+r"(right), "+c"(loops)
+                          :
+                          :SIMD_CLOBBERS
+                          );
+    }
+#endif //ARCH_x86
+    return i;
+}
+
+template <class AudioDataType, int channels>
+void _InterleaveFrames(AudioDataType* out, const AudioDataType* const* inp,
+                       int start, int frames)
+{
+    out += start * channels;
+    for (int i = start; i < frames; i++)
+    {
+        for (int j = 0; j < channels; j++)
+        {
+            *(out++) = inp[j][i];
+        }
+    }
+}
+
 template <class AudioDataType>
 void _InterleaveSample(AudioDataType* out, const AudioDataType* in, int channels, int frames,
                        const AudioDataType*  const* inp = NULL)
@@ -802,6 +1340,23 @@ void _InterleaveSample(AudioDataType* out, const AudioDataType* in, int channels
         }
     }
 
+    switch (channels)
+    {
+        case 2:
+        {
+            int done = InterleaveStereo(sizeof(AudioDataType), out,
+                                        my_inp[0], my_inp[1], frames);
+            _InterleaveFrames<AudioDataType, 2>(out, my_inp, done, frames);
+            return;
+        }
+        case 6:
+            _InterleaveFrames<AudioDataType, 6>(out, my_inp, 0, frames);
+            return;
+        case 8:
+            _InterleaveFrames<AudioDataType, 8>(out, my_inp, 0, frames);
+            return;
+    }
+
     for (int i = 0; i < frames; i++)
     {
         for (int j = 0; j < channels; j++)
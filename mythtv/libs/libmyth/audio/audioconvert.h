@@ -63,6 +63,18 @@ public:
                            uint8_t* output, const uint8_t* input,
                            int data_size);
 
+    // SIMD instruction sets the static utilities can use
+    enum SIMDLevel
+    {
+        kSIMDNone = 0,
+        kSIMDSSE2,
+        kSIMDAVX2
+    };
+    // Best instruction set supported by both the build and the CPU
+    static SIMDLevel GetSIMDLevel(void);
+    // Don't use anything better than 'level', for testing and benchmarking
+    static void SetMaxSIMDLevel(SIMDLevel level);
+
     // static utilities
     static int  toFloat(AudioFormat format, void* out, const void* in, int bytes);
     static int  fromFloat(AudioFormat format, void* out, const void* in, int bytes);
@@ -23,7 +23,6 @@
 #define LOC QString("AOBase: ")
 
 #define WPOS audiobuffer + org_waud
-#define RPOS audiobuffer + raud
 #define ABUF audiobuffer
 #define STST soundtouch::SAMPLETYPE
 #define AOALIGN(x) (((long)&x + 15) & ~0xf);
@@ -339,7 +338,8 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             pSoundStretch = NULL;
             VBGENERAL(QString("Cancelling time stretch"));
             bytes_per_frame = m_previousbpf;
-            waud = raud = 0;
+            SetWritePos(0);
+            SetReadPos(0);
             reset_active.Ref();
         }
         else
@@ -367,7 +367,8 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             m_previousbpf = bytes_per_frame;
             bytes_per_frame = source_channels *
                               AudioOutputSettings::SampleSize(FORMAT_FLT);
-            waud = raud = 0;
+            SetWritePos(0);
+            SetReadPos(0);
             reset_active.Ref();
         }
     }
@@ -611,9 +612,9 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
     KillAudio();
 
     QMutexLocker lock(&audio_buflock);
-    QMutexLocker lockav(&avsync_lock);
 
-    waud = raud = 0;
+    SetWritePos(0);
+    SetReadPos(0);
     reset_active.Clear();
     actually_paused = processing = m_forcedprocessing = false;
 
@@ -791,7 +792,9 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
         .arg(main_device).arg(channels).arg(source_channels).arg(samplerate)
         .arg(output_settings->FormatToString(output_format)).arg(reenc));
 
-    audbuf_timecode = audiotime = frames_buffered = 0;
+    audbuf_timecode.Store(0);
+    ResetAudiotime();
+    frames_buffered = 0;
     current_seconds = source_bitrate = -1;
     effdsp = samplerate * 100;
 
@@ -825,7 +828,9 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
     {
         surround_mode = gCoreContext->GetNumSetting("AudioUpmixType", QUALITY_HIGH);
         upmixer = new FreeSurround(samplerate, source == AUDIOOUTPUT_VIDEO,
-                                   (FreeSurround::SurroundMode)surround_mode);
+                                   (FreeSurround::SurroundMode)surround_mode,
+                                   gCoreContext->GetNumSetting(
+                                       "AudioUpmixParallel", false));
         VBAUDIO(QString("Create %1 quality upmixer done")
                 .arg(quality_string(surround_mode)));
     }
@@ -936,17 +941,22 @@ void AudioOutputBase::PauseUntilBuffered()
 void AudioOutputBase::Reset()
 {
     QMutexLocker lock(&audio_buflock);
-    QMutexLocker lockav(&avsync_lock);
 
-    audbuf_timecode = audiotime = frames_buffered = 0;
+    audbuf_timecode.Store(0);
+    ResetAudiotime();
+    frames_buffered = 0;
     if (encoder)
     {
-        waud = raud = 0;    // empty ring buffer
+        SetWritePos(0);     // empty ring buffer
+        SetReadPos(0);
         memset(audiobuffer, 0, kAudioRingBufferSize);
     }
     else
     {
-        waud = raud;        // empty ring buffer
+        // empty ring buffer; skip the reader ahead rather than moving the
+        // writer back, the output thread may still be writing the bytes
+        // behind raud to the device
+        SetReadPos(WritePos());
     }
     reset_active.Ref();
     current_seconds = -1;
@@ -971,7 +981,10 @@ void AudioOutputBase::Reset()
  */
 void AudioOutputBase::SetTimecode(int64_t timecode)
 {
-    audbuf_timecode = audiotime = timecode;
+    QMutexLocker lock(&audio_buflock);
+
+    audbuf_timecode.Store(timecode);
+    ResetAudiotime(timecode);
     frames_buffered = (timecode * source_samplerate) / 1000;
 }
 
@@ -992,10 +1005,13 @@ void AudioOutputBase::SetEffDsp(int dsprate)
  */
 inline int AudioOutputBase::audiolen()
 {
-    if (waud >= raud)
-        return waud - raud;
+    uint rpos = ReadPos();
+    uint wpos = WritePos();
+
+    if (wpos >= rpos)
+        return wpos - rpos;
     else
-        return kAudioRingBufferSize - (raud - waud);
+        return kAudioRingBufferSize - (rpos - wpos);
 }
 
 /**
@@ -1026,14 +1042,22 @@ int AudioOutputBase::audioready()
 
 /**
  * Calculate the timecode of the samples that are about to become audible
+ *
+ * This takes no locks, it is called for every frame by the A/V sync code
+ * and must not wait for AddData() or the output thread.
  */
 int64_t AudioOutputBase::GetAudiotime(void)
 {
-    if (audbuf_timecode == 0 || !m_configure_succeeded)
+    /* Read the last value before the timecode, a reset in between makes
+       sure we don't store what we computed from the stale timecode */
+    AudiotimeStamp last = audiotime.Load();
+    int64_t timecode = audbuf_timecode.Load();
+
+    if (timecode == 0 || !m_configure_succeeded)
         return 0;
 
     int obpf = output_bytes_per_frame;
-    int64_t oldaudiotime;
+    int64_t newaudiotime;
 
     /* We want to calculate 'audiotime', which is the timestamp of the audio
        Which is leaving the sound card at this instant.
@@ -1043,39 +1067,38 @@ int64_t AudioOutputBase::GetAudiotime(void)
        'effdsp' is frames/sec
 
        'audbuf_timecode' is the timecode of the audio that has just been
-       written into the buffer.
+       written into the buffer. AddData() moves waud before it stores
+       audbuf_timecode, so the buffer contents read below are never older
+       than that timecode.
 
        'totalbuffer' is the total # of bytes in our audio buffer, and the
        sound card's buffer. */
 
-
-    QMutexLocker lockav(&avsync_lock);
-
     int soundcard_buffer = GetBufferedOnSoundcard(); // bytes
 
     /* audioready tells us how many bytes are in audiobuffer
        scaled appropriately if output format != internal format */
     int main_buffer = audioready();
 
-    oldaudiotime = audiotime;
-
     /* timecode is the stretch adjusted version
        of major post-stretched buffer contents
        processing latencies are catered for in AddData/SetAudiotime
        to eliminate race */
-    audiotime = audbuf_timecode - (effdsp && obpf ? (
+    newaudiotime = timecode - (effdsp && obpf ? (
         ((int64_t)(main_buffer + soundcard_buffer) * eff_stretchfactor) /
         (effdsp * obpf)) : 0);
 
     /* audiotime should never go backwards, but we might get a negative
        value if GetBufferedOnSoundcard() isn't updated by the driver very
        quickly (e.g. ALSA) */
-    if (audiotime < oldaudiotime)
-        audiotime = oldaudiotime;
+    if (newaudiotime < last.time)
+        newaudiotime = last.time;
+    else if (newaudiotime > last.time)
+        audiotime.TestAndStore(last, AudiotimeStamp(newaudiotime, last.resets));
 
     VBAUDIOTS(QString("GetAudiotime audt=%1 atc=%2 mb=%3 sb=%4 tb=%5 "
                       "sr=%6 obpf=%7 bpf=%8 sf=%9 %10 %11")
-              .arg(audiotime).arg(audbuf_timecode)
+              .arg(newaudiotime).arg(timecode)
               .arg(main_buffer)
               .arg(soundcard_buffer)
               .arg(main_buffer+soundcard_buffer)
@@ -1085,7 +1108,16 @@ int64_t AudioOutputBase::GetAudiotime(void)
                    (effdsp * obpf))
               );
 
-    return audiotime;
+    return newaudiotime;
+}
+
+/**
+ * Forget the last audiotime, e.g. after a seek, and start over from 'value'
+ */
+void AudioOutputBase::ResetAudiotime(int64_t value)
+{
+    AudiotimeStamp last = audiotime.Load();
+    audiotime.Store(AudiotimeStamp(value, last.resets + 1));
 }
 
 /**
@@ -1097,7 +1129,8 @@ void AudioOutputBase::SetAudiotime(int frames, int64_t timecode)
 {
     int64_t processframes_stretched   = 0;
     int64_t processframes_unstretched = 0;
-    int64_t old_audbuf_timecode       = audbuf_timecode;
+    int64_t old_audbuf_timecode       = audbuf_timecode.Load();
+    int64_t new_audbuf_timecode;
 
     if (!m_configure_succeeded)
         return;
@@ -1116,7 +1149,7 @@ void AudioOutputBase::SetAudiotime(int frames, int64_t timecode)
         processframes_stretched -= encoder->Buffered();
     }
 
-    audbuf_timecode =
+    new_audbuf_timecode =
         timecode + (effdsp ? ((frames + processframes_unstretched) * 100000 +
                     (processframes_stretched * eff_stretchfactor)
                    ) / effdsp : 0);
@@ -1124,11 +1157,12 @@ void AudioOutputBase::SetAudiotime(int frames, int64_t timecode)
     // check for timecode wrap and reset audiotime if detected
     // timecode will always be monotonic asc if not seeked and reset
     // happens if seek or pause happens
-    if (audbuf_timecode < old_audbuf_timecode)
-        audiotime = 0;
+    audbuf_timecode.Store(new_audbuf_timecode);
+    if (new_audbuf_timecode < old_audbuf_timecode)
+        ResetAudiotime();
 
     VBAUDIOTS(QString("SetAudiotime atc=%1 tc=%2 f=%3 pfu=%4 pfs=%5")
-              .arg(audbuf_timecode)
+              .arg(new_audbuf_timecode)
               .arg(timecode)
               .arg(frames)
               .arg(processframes_unstretched)
@@ -1145,7 +1179,7 @@ void AudioOutputBase::SetAudiotime(int frames, int64_t timecode)
  */
 int64_t AudioOutputBase::GetAudioBufferedTime(void)
 {
-    int64_t ret = audbuf_timecode - GetAudiotime();
+    int64_t ret = audbuf_timecode.Load() - GetAudiotime();
     // Pulse can give us values that make this -ve
     if (ret < 0)
         return 0;
@@ -1341,7 +1375,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
     // Don't write new samples if we're resetting the buffer or reconfiguring
     QMutexLocker lock(&audio_buflock);
 
-    uint org_waud = waud;
+    uint org_waud = WritePos();
     int  afree    = audiofree();
     int  used     = kAudioRingBufferSize - afree;
 
@@ -1438,9 +1472,17 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
     int frames_final = 0;
     int maxframes = (kAudioSRCInputSize / source_channels) & ~0xf;
     int offset = 0;
+    // Samples only need converting to float when nothing else rewrites them
+    bool direct = processing && !needs_downmix &&
+                  !(need_resampler && src_ctx) && !needs_upmix;
 
     while(frames_remaining > 0)
     {
+        // Nothing written in this pass is visible to the output thread
+        // until waud is moved at the end of it
+        uint chunk_waud = org_waud;
+        bool copied     = false;
+
         buffer = (char *)in_buffer + offset;
         frames = frames_remaining;
         len = frames * source_bytes_per_frame;
@@ -1453,8 +1495,16 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
                 len = frames * source_bytes_per_frame;
                 offset += len;
             }
-            // Convert to floats
-            len = AudioOutputUtil::toFloat(format, src_in, buffer, len);
+            // Convert to floats, straight into the ring buffer if the
+            // converted samples don't wrap around its end
+            if (direct && kAudioRingBufferSize - org_waud >= (uint)(frames * bpf))
+            {
+                len = AudioOutputUtil::toFloat(format, WPOS, buffer, len);
+                org_waud = (org_waud + len) % kAudioRingBufferSize;
+                copied = true;
+            }
+            else
+                len = AudioOutputUtil::toFloat(format, src_in, buffer, len);
         }
 
         frames_remaining -= frames;
@@ -1487,7 +1537,8 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
            represent */
 
         // Copy samples into audiobuffer, with upmix if necessary
-        if ((len = CopyWithUpmix((char *)buffer, frames, org_waud)) <= 0)
+        if (!copied &&
+            (len = CopyWithUpmix((char *)buffer, frames, org_waud)) <= 0)
         {
             continue;
         }
@@ -1495,7 +1546,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
         frames = len / bpf;
         frames_final += frames;
 
-        bdiff = kAudioRingBufferSize - waud;
+        bdiff = kAudioRingBufferSize - chunk_waud;
         if ((len % bpf) != 0 && bdiff < len)
         {
             VBERROR(QString("AddData: Corruption likely: len = %1 (bpf = %2)")
@@ -1512,7 +1563,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
         if (pSoundStretch)
         {
             // does not change the timecode, only the number of samples
-            org_waud     = waud;
+            org_waud     = chunk_waud;
             int bdFrames = bdiff / bpf;
 
             if (bdiff < len)
@@ -1544,7 +1595,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
 
         if (internal_vol && SWVolume())
         {
-            org_waud    = waud;
+            org_waud    = chunk_waud;
             int num     = len;
 
             if (bdiff <= num)
@@ -1562,7 +1613,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
 
         if (encoder)
         {
-            org_waud            = waud;
+            org_waud            = chunk_waud;
             int to_get          = 0;
 
             if (bdiff < len)
@@ -1589,7 +1640,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
             org_waud = (org_waud + to_get) % kAudioRingBufferSize;
         }
 
-        waud = org_waud;
+        SetWritePos(org_waud);
     }
 
     SetAudiotime(frames_final, timecode);
@@ -1660,7 +1711,7 @@ void AudioOutputBase::OutputAudioLoop(void)
             }
 
             actually_paused = true;
-            audiotime = 0; // mark 'audiotime' as invalid.
+            ResetAudiotime(); // mark 'audiotime' as invalid.
 
             WriteAudio(zeros, zero_fragment_size);
             continue;
@@ -1699,14 +1750,19 @@ void AudioOutputBase::OutputAudioLoop(void)
         // delay setting raud until after phys buffer is filled
         // so GetAudiotime will be accurate without locking
         reset_active.TestAndDeref();
-        volatile uint next_raud = raud;
-        if (GetAudioData(fragment, fragment_size, true, &next_raud))
+        uint next_raud = ReadPos();
+        // Hand the device the ring buffer itself when we can, the samples
+        // stay ours until raud moves past them
+        uchar *data = PeekAudioData(fragment_size, next_raud);
+        if (!data && GetAudioData(fragment, fragment_size, true, &next_raud))
+            data = fragment;
+        if (data)
         {
             if (!reset_active.TestAndDeref())
             {
-                WriteAudio(fragment, fragment_size);
+                WriteAudio(data, fragment_size);
                 if (!reset_active.TestAndDeref())
-                    raud = next_raud;
+                    SetReadPos(next_raud);
             }
         }
 #ifdef AUDIOTSTESTING
@@ -1729,9 +1785,12 @@ void AudioOutputBase::OutputAudioLoop(void)
  * If 'full_buffer' is true we copy either 'size' bytes (if available) or
  * nothing. Otherwise, we'll copy less than 'size' bytes if that's all that's
  * available. Returns the number of bytes copied.
+ *
+ * If 'local_raud' is given it is advanced instead of the read position,
+ * and the caller publishes it once the device has the samples.
  */
 int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
-                                  volatile uint *local_raud)
+                                  uint *local_raud)
 {
 
 #define LRPOS audiobuffer + *local_raud
@@ -1740,9 +1799,10 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
     int avail_size   = audioready();
     int frag_size    = size;
     int written_size = size;
+    uint read_pos    = ReadPos();
 
     if (local_raud == NULL)
-        local_raud = &raud;
+        local_raud = &read_pos;
 
     if (!full_buffer && (size > avail_size))
     {
@@ -1754,7 +1814,7 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
     if (!avail_size || (frag_size > avail_size))
         return 0;
 
-    int bdiff = kAudioRingBufferSize - raud;
+    int bdiff = kAudioRingBufferSize - *local_raud;
 
     int obytes = output_settings->SampleSize(output_format);
 
@@ -1794,18 +1854,51 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
 
     *local_raud += frag_size;
 
-    // Mute individual channels through mono->stereo duplication
+    if (local_raud == &read_pos)
+        SetReadPos(read_pos);
+
+    MuteChannels(buffer, written_size);
+
+    return written_size;
+}
+
+/**
+ * Return the next 'size' bytes of the audiobuffer in place, if they are
+ * contiguous and already in the output format, and advance 'local_raud'
+ * past them. Returns NULL if the caller has to use GetAudioData() instead.
+ */
+uchar *AudioOutputBase::PeekAudioData(int size, uint &local_raud)
+{
+    if (processing && !enc && output_format != FORMAT_FLT)
+        return NULL;
+
+    if (size <= 0 || kAudioRingBufferSize - local_raud < (uint)size ||
+        audioready() < size)
+        return NULL;
+
+    uchar *data = audiobuffer + local_raud;
+    local_raud = (local_raud + size) % kAudioRingBufferSize;
+
+    MuteChannels(data, size);
+
+    return data;
+}
+
+/**
+ * Mute individual channels through mono->stereo duplication
+ */
+void AudioOutputBase::MuteChannels(uchar *buffer, int size)
+{
     MuteState mute_state = GetMuteState();
     if (!enc && !passthru &&
-        written_size && configured_channels > 1 &&
+        size && configured_channels > 1 &&
         (mute_state == kMuteLeft || mute_state == kMuteRight))
     {
+        int obytes = output_settings->SampleSize(output_format);
         AudioOutputUtil::MuteChannel(obytes << 3, configured_channels,
                                      mute_state == kMuteLeft ? 0 : 1,
-                                     buffer, written_size);
+                                     buffer, size);
     }
-
-    return written_size;
 }
 
 /**
@@ -12,6 +12,7 @@ using namespace std;
 #include <QString>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QAtomicInt>
 
 // MythTV headers
 #include "audiooutput.h"
@@ -39,13 +40,94 @@ struct AVCodecContext;
 class AsyncLooseLock
 {
 public:
-    AsyncLooseLock() { head = tail = 0; }
-    void Clear() { head = tail = 0; }
-    void Ref() { head++; }
-    bool TestAndDeref() { bool r; if ((r=(head != tail))) tail++; return r; }
+    AsyncLooseLock() : head(0), tail(0) { }
+    void Clear() { head.fetchAndStoreOrdered(0); tail.fetchAndStoreOrdered(0); }
+    void Ref() { head.fetchAndAddOrdered(1); }
+    bool TestAndDeref()
+    {
+        bool r = head.fetchAndAddAcquire(0) != tail.fetchAndAddAcquire(0);
+        if (r)
+            tail.fetchAndAddOrdered(1);
+        return r;
+    }
 private:
-    int head;
-    int tail;
+    QAtomicInt head;
+    QAtomicInt tail;
+};
+
+/**
+ *  A value that is read without taking a lock.
+ *
+ *  Store() makes the sequence number odd while it writes the value and even
+ *  again when done, Load() copies the value until it saw the same even
+ *  sequence number before and after the copy. Concurrent stores wait for
+ *  each other by spinning, which only ever lasts for a few assignments;
+ *  nobody sleeps on it.
+ */
+template <typename T>
+class SeqLockedValue
+{
+  public:
+    SeqLockedValue(const T &value = T()) : m_seq(0), m_value(value) { }
+
+    T Load(void) const
+    {
+        while (true)
+        {
+            int seq = m_seq.fetchAndAddAcquire(0);
+            if (seq & 1)
+                continue;
+            T value = m_value;
+            if (m_seq.fetchAndAddOrdered(0) == seq)
+                return value;
+        }
+    }
+
+    void Store(const T &value)
+    {
+        int seq = BeginStore();
+        m_value = value;
+        m_seq.fetchAndStoreRelease(seq + 2);
+    }
+
+    /// Stores 'value' only if the current value still equals 'expected'
+    bool TestAndStore(const T &expected, const T &value)
+    {
+        int seq = BeginStore();
+        bool ok = (m_value == expected);
+        if (ok)
+            m_value = value;
+        m_seq.fetchAndStoreRelease(seq + 2);
+        return ok;
+    }
+
+  private:
+    int BeginStore(void)
+    {
+        while (true)
+        {
+            int seq = m_seq.fetchAndAddAcquire(0);
+            if (!(seq & 1) && m_seq.testAndSetAcquire(seq, seq + 1))
+                return seq;
+        }
+    }
+
+    mutable QAtomicInt m_seq;
+    T m_value;
+};
+
+/**
+ *  The last audiotime handed out, and how often it has been reset since,
+ *  so that a GetAudiotime() racing with a reset can't store a stale value.
+ */
+struct AudiotimeStamp
+{
+    AudiotimeStamp(int64_t t = 0, uint r = 0) : time(t), resets(r) { }
+    bool operator==(const AudiotimeStamp &o) const
+        { return time == o.time && resets == o.resets; }
+
+    int64_t time;
+    uint    resets;
 };
 
 // Forward declaration of SPDIF encoder
@@ -149,7 +231,8 @@ class AudioOutputBase : public AudioOutput, public MThread
     virtual void StopOutputThread(void);
 
     int GetAudioData(uchar *buffer, int buf_size, bool fill_buffer,
-                     volatile uint *local_raud = NULL);
+                     uint *local_raud = NULL);
+    uchar *PeekAudioData(int size, uint &local_raud);
 
     void OutputAudioLoop(void);
 
@@ -161,10 +244,18 @@ class AudioOutputBase : public AudioOutput, public MThread
     int audiofree();       // number of free bytes in audio buffer
     int audioready();      // number of bytes ready to be written
 
+    // Positions in the audiobuffer. Only the output thread (or the pull
+    // callback) moves raud forward and only the writer moves waud forward,
+    // each publishes its position after it is done with the bytes it covers
+    uint ReadPos(void)  { return (uint)raud.fetchAndAddAcquire(0); }
+    uint WritePos(void) { return (uint)waud.fetchAndAddAcquire(0); }
+    void SetReadPos(uint pos)  { raud.fetchAndStoreRelease((int)pos); }
+    void SetWritePos(uint pos) { waud.fetchAndStoreRelease((int)pos); }
+
     void SetStretchFactorLocked(float factor);
 
     // For audiooutputca
-    int GetBaseAudBufTimeCode() const { return audbuf_timecode; }
+    int GetBaseAudBufTimeCode() const { return audbuf_timecode.Load(); }
 
   protected:
     // Basic details about the audio stream
@@ -211,7 +302,9 @@ class AudioOutputBase : public AudioOutput, public MThread
                           int &samplerate_tmp, int &channels_tmp);
     AudioOutputSettings* OutputSettings(bool digital = true);
     int CopyWithUpmix(char *buffer, int frames, uint &org_waud);
+    void MuteChannels(uchar *buffer, int size);
     void SetAudiotime(int frames, int64_t timecode);
+    void ResetAudiotime(int64_t value = 0);
     AudioOutputSettings *output_settingsraw;
     AudioOutputSettings *output_settings;
     AudioOutputSettings *output_settingsdigitalraw;
@@ -241,29 +334,25 @@ class AudioOutputBase : public AudioOutput, public MThread
 
     /**
      *  Writes to the audiobuffer, reconfigures and audiobuffer resets can only
-     *  take place while holding this lock
+     *  take place while holding this lock. The output thread never takes it.
      */
     QMutex audio_buflock;
 
     /**
-     *  must hold avsync_lock to read or write 'audiotime' and
-     *  'audiotime_updated'
-     */
-    QMutex avsync_lock;
-
-    /**
-     * timecode of audio leaving the soundcard (same units as timecodes)
+     * timecode of audio leaving the soundcard (same units as timecodes),
+     * the last value GetAudiotime() returned
      */
-    int64_t audiotime;
+    SeqLockedValue<AudiotimeStamp> audiotime;
 
     /**
      * Audio circular buffer
      */
-    volatile uint raud, waud;     // read and write positions
+    QAtomicInt raud, waud;     // read and write positions
     /**
-     * timecode of audio most recently placed into buffer
+     * timecode of audio most recently placed into buffer, stored after
+     * waud has been moved past that audio
      */
-    int64_t audbuf_timecode;
+    SeqLockedValue<int64_t> audbuf_timecode;
     AsyncLooseLock reset_active;
 
     QMutex killAudioLock;
@@ -12,6 +12,7 @@
 #include <cerrno>
 #include <cstring>
 #include <iostream>
+#include <algorithm>
 
 #include "config.h"
 
@@ -26,7 +27,10 @@ using namespace std;
 AudioOutputNULL::AudioOutputNULL(const AudioSettings &settings) :
     AudioOutputBase(settings),
     pcm_output_buffer_mutex(QMutex::NonRecursive),
-    current_buffer_size(0)
+    current_buffer_size(0),
+    m_realtime(settings.GetMainDevice().toLower() == "null:realtime"),
+    m_realtime_lock(QMutex::NonRecursive),
+    m_realtime_written(0)
 {
     memset(pcm_output_buffer, 0, sizeof(char) * NULLAUDIO_OUTPUT_BUFFER_SIZE);
     InitSettings(settings);
@@ -41,11 +45,27 @@ AudioOutputNULL::~AudioOutputNULL()
 
 bool AudioOutputNULL::OpenDevice()
 {
-    LOG(VB_GENERAL, LOG_INFO, "Opening NULL audio device, will fail.");
-
     fragment_size = NULLAUDIO_OUTPUT_BUFFER_SIZE / 2;
     soundcard_buffer_size = NULLAUDIO_OUTPUT_BUFFER_SIZE;
 
+    if (m_realtime)
+    {
+        LOG(VB_GENERAL, LOG_INFO, "Opening NULL audio device, realtime.");
+
+        // About 10ms per fragment, like most real cards
+        fragment_size = (samplerate / 100) * output_bytes_per_frame;
+        if (fragment_size <= 0)
+            fragment_size = NULLAUDIO_OUTPUT_BUFFER_SIZE / 2;
+        soundcard_buffer_size = fragment_size * 4;
+
+        QMutexLocker locker(&m_realtime_lock);
+        m_realtime_clock.invalidate();
+        m_realtime_written = 0;
+        return true;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, "Opening NULL audio device, will fail.");
+
     return false;
 }
 
@@ -83,6 +103,25 @@ AudioOutputSettings* AudioOutputNULL::GetOutputSettings(bool /*digital*/)
 
 void AudioOutputNULL::WriteAudio(unsigned char* aubuf, int size)
 {
+    if (m_realtime)
+    {
+        // Block like a real card would until there is room for the fragment
+        int buffered;
+        while ((buffered = RealtimeBuffered()) + size > soundcard_buffer_size)
+        {
+            int bytes_per_ms = (samplerate * output_bytes_per_frame) / 1000;
+            int wait = bytes_per_ms > 0 ?
+                (buffered + size - soundcard_buffer_size) / bytes_per_ms : 1;
+            usleep(max(wait, 1) * 1000);
+        }
+
+        QMutexLocker locker(&m_realtime_lock);
+        if (!m_realtime_clock.isValid())
+            m_realtime_clock.start();
+        m_realtime_written += size;
+        return;
+    }
+
     if (buffer_output_data_for_use)
     {
         if (size + current_buffer_size > NULLAUDIO_OUTPUT_BUFFER_SIZE)
@@ -118,6 +157,12 @@ int AudioOutputNULL::readOutputData(unsigned char *read_buffer, int max_length)
 
 void AudioOutputNULL::Reset()
 {
+    if (m_realtime)
+    {
+        QMutexLocker locker(&m_realtime_lock);
+        m_realtime_clock.invalidate();
+        m_realtime_written = 0;
+    }
     if (buffer_output_data_for_use)
     {
         pcm_output_buffer_mutex.lock();
@@ -127,8 +172,36 @@ void AudioOutputNULL::Reset()
     AudioOutputBase::Reset();
 }
 
+/**
+ * Bytes written to the imaginary sound card that it hasn't played yet
+ */
+int AudioOutputNULL::RealtimeBuffered(void) const
+{
+    QMutexLocker locker(&m_realtime_lock);
+
+    if (!m_realtime_clock.isValid())
+        return 0;
+
+    int64_t played = m_realtime_clock.nsecsElapsed() / 1000 *
+        samplerate * output_bytes_per_frame / 1000000;
+    played -= played % max(output_bytes_per_frame, 1);
+
+    if (played >= m_realtime_written)
+    {
+        // Underrun, the card starts over with the next write
+        m_realtime_clock.invalidate();
+        m_realtime_written = 0;
+        return 0;
+    }
+
+    return (int)(m_realtime_written - played);
+}
+
 int AudioOutputNULL::GetBufferedOnSoundcard(void) const
 {
+    if (m_realtime)
+        return RealtimeBuffered();
+
     if (buffer_output_data_for_use)
     {
         return current_buffer_size;
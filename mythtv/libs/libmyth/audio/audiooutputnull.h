@@ -1,6 +1,8 @@
 #ifndef AUDIOOUTPUTNULL
 #define AUDIOOUTPUTNULL
 
+#include <QElapsedTimer>
+
 #include "audiooutputbase.h"
 
 #define NULLAUDIO_OUTPUT_BUFFER_SIZE 32768
@@ -16,6 +18,11 @@
     it will maintain a small buffer and will not let anymore audio data be
     decoded until something pulls the data off (via readOutputData()). 
 
+    Opened as "NULL:realtime" it instead plays the audio into an imaginary
+    sound card, consuming it at the sample rate and reporting what that
+    card would have buffered. This makes the output thread and the A/V sync
+    timing behave like they do with real hardware, for benchmarks and tests.
+
 */
 
 class AudioOutputNULL : public AudioOutputBase
@@ -43,9 +50,17 @@ class AudioOutputNULL : public AudioOutputBase
     virtual AudioOutputSettings* GetOutputSettings(bool digital);
 
   private:
+    int  RealtimeBuffered(void) const;
+
     QMutex        pcm_output_buffer_mutex;
     unsigned char pcm_output_buffer[NULLAUDIO_OUTPUT_BUFFER_SIZE];
     int           current_buffer_size;
+
+    // "NULL:realtime" sound card emulation
+    bool            m_realtime;
+    mutable QMutex  m_realtime_lock;
+    mutable QElapsedTimer m_realtime_clock;   // started by the first write
+    mutable int64_t m_realtime_written;       // bytes written since then
 };
 
 #endif
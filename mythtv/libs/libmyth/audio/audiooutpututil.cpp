@@ -17,37 +17,27 @@ extern "C" {
 
 #define ISALIGN(x) (((unsigned long)x & 0xf) == 0)
 
-#if ARCH_X86
-static int has_sse2 = -1;
+#if HAVE_XMM_CLOBBERS
+#define SIMD_CLOBBERS "memory", "%xmm0", "%xmm1", "%xmm2", "%xmm3", \
+                      "%xmm4", "%xmm5", "%xmm6", "%xmm7"
+#else
+#define SIMD_CLOBBERS "memory"
+#endif
 
-// Check cpuid for SSE2 support on x86 / x86_64
+#if ARCH_X86
 static inline bool sse_check()
 {
-    if (has_sse2 != -1)
-        return (bool)has_sse2;
-    __asm__(
-        // -fPIC - we may not clobber ebx/rbx
-#if ARCH_X86_64
-        "push       %%rbx               \n\t"
-#else
-        "push       %%ebx               \n\t"
-#endif
-        "mov        $1, %%eax           \n\t"
-        "cpuid                          \n\t"
-        "and        $0x4000000, %%edx   \n\t"
-        "shr        $26, %%edx          \n\t"
-#if ARCH_X86_64
-        "pop        %%rbx               \n\t"
-#else
-        "pop        %%ebx               \n\t"
-#endif
-        :"=d"(has_sse2)
-        ::"%eax","%ecx"
-    );
-    return (bool)has_sse2;
+    return AudioConvert::GetSIMDLevel() >= AudioConvert::kSIMDSSE2;
 }
 #endif //ARCH_x86
 
+#if HAVE_AVX2_INLINE
+static inline bool avx2_check()
+{
+    return AudioConvert::GetSIMDLevel() >= AudioConvert::kSIMDAVX2;
+}
+#endif //HAVE_AVX2_INLINE
+
 /**
  * Returns true if platform has an FPU.
  * for the time being, this test is limited to testing if SSE2 is supported
@@ -119,11 +109,38 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
     if (g == 1.0f)
         return;
 
+#if HAVE_AVX2_INLINE
+    if (avx2_check() && samples >= 32)
+    {
+        int loops = samples >> 5;
+        i = loops << 5;
+
+        __asm__ volatile (
+            "vbroadcastss %2, %%ymm0        \n\t"
+            "1:                             \n\t"
+            "vmulps     (%0), %%ymm0, %%ymm1    \n\t"
+            "vmulps     32(%0), %%ymm0, %%ymm2  \n\t"
+            "vmulps     64(%0), %%ymm0, %%ymm3  \n\t"
+            "vmulps     96(%0), %%ymm0, %%ymm4  \n\t"
+            "vmovups    %%ymm1, (%0)        \n\t"
+            "vmovups    %%ymm2, 32(%0)      \n\t"
+            "vmovups    %%ymm3, 64(%0)      \n\t"
+            "vmovups    %%ymm4, 96(%0)      \n\t"
+            "add        $128,   %0          \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            "vzeroupper                     \n\t"
+            :"+r"(fptr), "+c"(loops)
+            :"m"(g)
+            :SIMD_CLOBBERS
+        );
+    }
+#endif //HAVE_AVX2_INLINE
 #if ARCH_X86
-    if (sse_check() && samples >= 16)
+    if (sse_check() && samples - i >= 16)
     {
-        int loops = samples >> 4;
-        i = loops << 4;
+        int loops = (samples - i) >> 4;
+        i += loops << 4;
 
         __asm__ volatile (
             "movss      %2, %%xmm0          \n\t"
@@ -154,13 +171,76 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
         *fptr++ *= g;
 }
 
+/*
+ With two channels a frame of 16 or 32 bits samples is a single dword or
+ word pair, so the SSE code copies one channel over the other with a shuffle:
+ 'order' picks the odd (right) or even (left) samples. Processes 16 bytes at
+ a time and returns the number of frames done.
+ */
+template <int order>
+static int MuteStereo(int size, void *buffer, int frames)
+{
+    int i = 0;
+
+#if ARCH_X86
+    if (sse_check() && size == 4 && frames >= 2)
+    {
+        int loops = frames >> 1;
+        i = loops << 1;
+
+        __asm__ volatile (
+            "1:                             \n\t"
+            "movdqu     (%0), %%xmm1        \n\t"
+            "pshufd     %2, %%xmm1, %%xmm1  \n\t"
+            "movdqu     %%xmm1, (%0)        \n\t"
+            "add        $16,    %0          \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            :"+r"(buffer), "+c"(loops)
+            :"i"(order)
+            :SIMD_CLOBBERS
+        );
+    }
+    else if (sse_check() && size == 2 && frames >= 4)
+    {
+        int loops = frames >> 2;
+        i = loops << 2;
+
+        __asm__ volatile (
+            "1:                             \n\t"
+            "movdqu     (%0), %%xmm1        \n\t"
+            "pshuflw    %2, %%xmm1, %%xmm1  \n\t"
+            "pshufhw    %2, %%xmm1, %%xmm1  \n\t"
+            "movdqu     %%xmm1, (%0)        \n\t"
+            "add        $16,    %0          \n\t"
+            "sub        $1, %%ecx           \n\t"
+            "jnz        1b                  \n\t"
+            :"+r"(buffer), "+c"(loops)
+            :"i"(order)
+            :SIMD_CLOBBERS
+        );
+    }
+#endif //ARCH_X86
+    return i;
+}
+
 template <class AudioDataType>
 void _MuteChannel(AudioDataType *buffer, int channels, int ch, int frames)
 {
-    AudioDataType *s1 = buffer + ch;
-    AudioDataType *s2 = buffer - ch + 1;
+    int i = 0;
+
+    if (channels == 2)
+    {
+        if (ch == 0)
+            i = MuteStereo<0xf5>(sizeof(AudioDataType), buffer, frames);
+        else
+            i = MuteStereo<0xa0>(sizeof(AudioDataType), buffer, frames);
+    }
+
+    AudioDataType *s1 = buffer + i * channels + ch;
+    AudioDataType *s2 = buffer + i * channels - ch + 1;
 
-    for (int i = 0; i < frames; i++)
+    for (; i < frames; i++)
     {
         *s1 = *s2;
         s1 += channels;
@@ -15,6 +15,7 @@ using namespace std;
 // Qt headers
 #include <QRegExp>
 #include <QMap>
+#include <QHash>
 #include <QUrl>
 #include <QFile>
 #include <QFileInfo>
@@ -676,6 +677,18 @@ ProgramInfo::ProgramInfo(
     if (originalAirDate.isValid() && originalAirDate < QDate(1940, 1, 1))
         originalAirDate = QDate();
 
+    ApplySchedule(schedList);
+}
+
+/** \fn ProgramInfo::ApplySchedule(const ProgramList&)
+ *  \brief Takes the recording rule and status of the matching program in
+ *         the scheduler's list, if there is one.
+ *
+ *  This is what the listings constructor does with its schedList, it allows
+ *  listings loaded without a schedule to be brought up to date later.
+ */
+void ProgramInfo::ApplySchedule(const ProgramList &schedList)
+{
     ProgramList::const_iterator it = schedList.begin();
     for (; it != schedList.end(); ++it)
     {
@@ -2334,6 +2347,11 @@ QString ProgramInfo::GetPlaybackURL(
     bool checklocal = !gCoreContext->GetNumSetting("AlwaysStreamFiles", 0) ||
                       forceCheckLocal;
 
+    // The live end of LiveTV may only be in the recording backend's RAM,
+    // then the file is only complete when it is streamed from the backend.
+    if (checklocal && !forceCheckLocal && IsLiveTVRAMBuffered())
+        checklocal = false;
+
     if (IsVideo())
     {
         QString fullpath = GetPathname();
@@ -2416,6 +2434,41 @@ QString ProgramInfo::GetPlaybackURL(
     return tmpURL;
 }
 
+/// How long IsLiveTVRAMBuffered() trusts what it read from the settings
+static const int kRAMBufferSettingSecs = 60;
+
+/** \brief Returns true if this is a LiveTV recording whose live end may
+ *         still be held in the recording backend's RAM.
+ *
+ *  The file on disk is then not complete, it has to be read through the
+ *  backend (a myth:// URL) to see all of it.  The backend's
+ *  "LiveTVRAMBufferSize" setting is remembered per host for a minute,
+ *  GetPlaybackURL() is called far too often to query it each time.
+ */
+bool ProgramInfo::IsLiveTVRAMBuffered(void) const
+{
+    if (recgroup != "LiveTV" || hostname.isEmpty())
+        return false;
+
+    static QMutex                    lock;
+    static QHash<QString, bool>      buffered;
+    static QHash<QString, QDateTime> checked;
+
+    QDateTime now = MythDate::current();
+
+    QMutexLocker locker(&lock);
+
+    QHash<QString, QDateTime>::const_iterator it = checked.find(hostname);
+    if (it == checked.end() || (*it).secsTo(now) >= kRAMBufferSettingSecs)
+    {
+        buffered[hostname] = gCoreContext->GetNumSettingOnHost(
+            "LiveTVRAMBufferSize", hostname, 0) > 0;
+        checked[hostname] = now;
+    }
+
+    return buffered[hostname];
+}
+
 /** \fn ProgramInfo::SaveFilesize(uint64_t)
  *  \brief Sets recording file size in database, and sets "filesize" field.
  */
@@ -3268,12 +3321,11 @@ void ProgramInfo::SaveMarkupMap(
         return;
     }
 
+    frm_dir_map_t rows;
     frm_dir_map_t::const_iterator it;
     for (it = marks.begin(); it != marks.end(); ++it)
     {
         uint64_t frame = it.key();
-        int mark_type;
-        QString querystr;
 
         if ((min_frame >= 0) && (frame < (uint64_t)min_frame))
             continue;
@@ -3281,24 +3333,57 @@ void ProgramInfo::SaveMarkupMap(
         if ((max_frame >= 0) && (frame > (uint64_t)max_frame))
             continue;
 
-        mark_type = (type != MARK_ALL) ? type : *it;
+        rows.insert(frame, (type != MARK_ALL) ? type : *it);
+    }
+
+    // Insert the marks in batches rather than one statement per mark
+    static const int kMaxRowsPerInsert = 500;
+
+    int done = 0;
+    it = rows.begin();
+    while (it != rows.end())
+    {
+        int count = min(rows.size() - done, kMaxRowsPerInsert);
+        QStringList values;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (IsVideo())
+                values << QString("( :PATH%1 , :MARK%1 , :TYPE%1 )").arg(i);
+            else // if (IsRecording())
+                values << QString("( :CHANID%1 , :STARTTIME%1 ,"
+                                  "  :MARK%1 , :TYPE%1 )").arg(i);
+        }
 
         if (IsVideo())
         {
             query.prepare("INSERT INTO filemarkup (filename, mark, type)"
-                          " VALUES ( :PATH , :MARK , :TYPE );");
-            query.bindValue(":PATH", videoPath);
+                          " VALUES " + values.join(",") + ";");
         }
         else // if (IsRecording())
         {
             query.prepare("INSERT INTO recordedmarkup"
                           " (chanid, starttime, mark, type)"
-                          " VALUES ( :CHANID , :STARTTIME , :MARK , :TYPE );");
-            query.bindValue(":CHANID", chanid);
-            query.bindValue(":STARTTIME", recstartts);
+                          " VALUES " + values.join(",") + ";");
+        }
+
+        for (int i = 0; i < count; ++i, ++it)
+        {
+            QString n = QString::number(i);
+
+            if (IsVideo())
+            {
+                query.bindValue(":PATH" + n, videoPath);
+            }
+            else // if (IsRecording())
+            {
+                query.bindValue(":CHANID"    + n, chanid);
+                query.bindValue(":STARTTIME" + n, recstartts);
+            }
+            query.bindValue(":MARK" + n, (quint64)it.key());
+            query.bindValue(":TYPE" + n, *it);
         }
-        query.bindValue(":MARK", (quint64)frame);
-        query.bindValue(":TYPE", mark_type);
+        done += count;
 
         if (!query.exec())
             MythDB::DBError("SaveMarkupMap inserting", query);
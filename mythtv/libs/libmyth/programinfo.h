@@ -529,8 +529,11 @@ class MPUBLIC ProgramInfo
     }
     void SetRecordingStatus(RecStatusType status) { recstatus = status; }
     void SetRecordingRuleType(RecordingType type) { rectype   = type;   }
+    void ApplySchedule(const ProgramList &schedList);
     void SetPositionMapDBReplacement(PMapDBReplacement *pmap)
         { positionMapDBReplacement = pmap; }
+    bool HasPositionMapDBReplacement(void) const
+        { return positionMapDBReplacement; }
 
     // Slow DB gets
     QString     QueryBasename(void) const;
@@ -590,6 +593,7 @@ class MPUBLIC ProgramInfo
     QString DiscoverRecordingDirectory(void) const;
     QString GetPlaybackURL(bool checkMaster = false,
                            bool forceCheckLocal = false) const;
+    bool IsLiveTVRAMBuffered(void) const;
     ProgramInfoType DiscoverProgramInfoType(void) const;
 
     // Edit flagging map
@@ -19,6 +19,7 @@
  */
 
 #include <QtTest/QtTest>
+#include <QVector>
 
 #include "mythcorecontext.h"
 #include "audioconvert.h"
@@ -35,6 +36,12 @@
 
 #define ISIZEOF(type) ((int)sizeof(type))
 
+Q_DECLARE_METATYPE(AudioFormat)
+Q_DECLARE_METATYPE(AudioConvert::SIMDLevel)
+
+// Not a multiple of any vector size, so every tail loop gets used too
+#define SIMDFRAMES (2048 + 13)
+
 class TestAudioConvert: public QObject
 {
     Q_OBJECT
@@ -46,6 +53,12 @@ class TestAudioConvert: public QObject
         gCoreContext = new MythCoreContext("bin_version", NULL);
     }
 
+    // undo any SetMaxSIMDLevel() of the test
+    void cleanup(void)
+    {
+        AudioConvert::SetMaxSIMDLevel(AudioConvert::kSIMDAVX2);
+    }
+
     void Identical_data(void)
     {
         QTest::addColumn<int>("SAMPLES");
@@ -597,4 +610,126 @@ class TestAudioConvert: public QObject
         av_free(arrays2);
         av_free(arrayf1);
     }
+    static void addInterleaveRows(AudioConvert::SIMDLevel level,
+                                  const char *levelname)
+    {
+        static const AudioFormat formats[] = { FORMAT_U8, FORMAT_S16,
+                                               FORMAT_FLT };
+        static const char *names[] = { "8", "16", "32" };
+        static const int channels[] = { 1, 2, 6, 8 };
+
+        for (uint f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+        {
+            for (uint c = 0; c < sizeof(channels) / sizeof(channels[0]); c++)
+            {
+                QTest::newRow(QString("%1 bits %2ch %3")
+                              .arg(names[f]).arg(channels[c]).arg(levelname)
+                              .toLatin1().constData())
+                    << formats[f] << channels[c] << level;
+            }
+        }
+    }
+
+    void InterleaveExact_data(void)
+    {
+        QTest::addColumn<AudioFormat>("format");
+        QTest::addColumn<int>("channels");
+        QTest::addColumn<AudioConvert::SIMDLevel>("level");
+        addInterleaveRows(AudioConvert::kSIMDNone, "C");
+        addInterleaveRows(AudioConvert::kSIMDSSE2, "SSE2");
+    }
+
+    // All the specialised interleave paths must move the samples exactly
+    // where the obvious per sample loop puts them
+    void InterleaveExact(void)
+    {
+        QFETCH(AudioFormat, format);
+        QFETCH(int, channels);
+        QFETCH(AudioConvert::SIMDLevel, level);
+
+        if (AudioConvert::GetSIMDLevel() < level)
+            MSKIP("Not supported by this CPU or build");
+
+        int size  = AudioOutputSettings::SampleSize(format);
+        int bytes = SIMDFRAMES * channels * size;
+
+        QByteArray interleaved(bytes, 0), planar(bytes, 0);
+        for (int i = 0; i < bytes; i++)
+            interleaved[i] = (char)(i * 7 + (i >> 8));
+        for (int ch = 0; ch < channels; ch++)
+        {
+            for (int i = 0; i < SIMDFRAMES; i++)
+            {
+                memcpy(planar.data() + (ch * SIMDFRAMES + i) * size,
+                       interleaved.constData() + (i * channels + ch) * size,
+                       size);
+            }
+        }
+
+        QVector<const uint8_t *> planes(channels);
+        for (int ch = 0; ch < channels; ch++)
+            planes[ch] = (const uint8_t *)planar.constData() +
+                ch * SIMDFRAMES * size;
+
+        AudioConvert::SetMaxSIMDLevel(level);
+
+        QByteArray out(bytes, 0);
+        AudioConvert::DeinterleaveSamples(format, channels,
+                                          (uint8_t *)out.data(),
+                                          (const uint8_t *)interleaved.constData(),
+                                          bytes);
+        QVERIFY(out == planar);
+
+        out.fill(0);
+        AudioConvert::InterleaveSamples(format, channels,
+                                        (uint8_t *)out.data(),
+                                        (const uint8_t *)planar.constData(),
+                                        bytes);
+        QVERIFY(out == interleaved);
+
+        out.fill(0);
+        AudioConvert::InterleaveSamples(format, channels,
+                                        (uint8_t *)out.data(),
+                                        planes.constData(), bytes);
+        QVERIFY(out == interleaved);
+    }
+
+    void InterleaveSpeed_data(void)
+    {
+        QTest::addColumn<int>("channels");
+        QTest::addColumn<AudioConvert::SIMDLevel>("level");
+        QTest::newRow("stereo C")    << 2 << AudioConvert::kSIMDNone;
+        QTest::newRow("stereo SSE2") << 2 << AudioConvert::kSIMDSSE2;
+        QTest::newRow("5.1")         << 6 << AudioConvert::kSIMDNone;
+        QTest::newRow("7.1")         << 8 << AudioConvert::kSIMDNone;
+    }
+
+    // What the decoder pays to interleave a planar float frame
+    void InterleaveSpeed(void)
+    {
+        QFETCH(int, channels);
+        QFETCH(AudioConvert::SIMDLevel, level);
+
+        if (AudioConvert::GetSIMDLevel() < level)
+            MSKIP("Not supported by this CPU or build");
+
+        int bytes = SIMDFRAMES * channels * ISIZEOF(float);
+        QByteArray in(bytes, 1), out(bytes, 0);
+
+        AudioConvert::SetMaxSIMDLevel(level);
+        QBENCHMARK
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                AudioConvert::InterleaveSamples(FORMAT_FLT, channels,
+                                                (uint8_t *)out.data(),
+                                                (const uint8_t *)in.constData(),
+                                                bytes);
+                AudioConvert::DeinterleaveSamples(FORMAT_FLT, channels,
+                                                  (uint8_t *)in.data(),
+                                                  (const uint8_t *)out.constData(),
+                                                  bytes);
+            }
+        }
+    }
 };
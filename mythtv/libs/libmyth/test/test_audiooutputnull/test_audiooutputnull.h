@@ -0,0 +1,227 @@
+/*
+ *  Class TestAudioOutputNULL
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <cmath>
+#include <unistd.h>
+
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "mythcorecontext.h"
+#include "mythdb.h"
+#include "mthread.h"
+#include "audiooutput.h"
+
+#define RATE        48000
+#define CHANNELS    2
+#define CHUNK       960     // 20ms, what a typical decoder hands us
+#define SECONDS     3
+
+/*
+ * Calls GetAudiotime() every millisecond like the A/V sync code would,
+ * recording how far the audio clock is from the wall clock each time.
+ */
+class AudiotimeSampler : public MThread
+{
+  public:
+    explicit AudiotimeSampler(AudioOutput *audio) :
+        MThread("AudiotimeSampler"), backwards(0),
+        m_audio(audio), m_stop(0) { }
+
+    void Stop(void) { m_stop.fetchAndStoreRelease(1); wait(); }
+
+    QVector<double>  offsets;     // audiotime - wall clock, ms
+    int              backwards;   // times audiotime went backwards
+
+  protected:
+    virtual void run(void)
+    {
+        RunProlog();
+
+        QElapsedTimer clock;
+        int64_t last = 0;
+        backwards = 0;
+        clock.start();
+        while (!m_stop.fetchAndAddAcquire(0))
+        {
+            int64_t audiotime = m_audio->GetAudiotime();
+            if (audiotime < last)
+                backwards++;
+            if (audiotime > 0)
+            {
+                offsets.push_back(audiotime -
+                                  clock.nsecsElapsed() / 1000000.0);
+                last = audiotime;
+            }
+            usleep(1000);
+        }
+
+        RunEpilog();
+    }
+
+  private:
+    AudioOutput *m_audio;
+    QAtomicInt   m_stop;
+};
+
+class TestAudioOutputNULL: public QObject
+{
+    Q_OBJECT
+
+    AudioOutput *m_audio;
+
+    static void fillChunk(short *buf, long &t)
+    {
+        for (int i = 0; i < CHUNK; i++, t++)
+        {
+            short s = (short)(8000 * sin(2 * M_PI * 440 * t / RATE));
+            buf[i * CHANNELS]     = s;
+            buf[i * CHANNELS + 1] = s;
+        }
+    }
+
+    // Feeds SECONDS of audio the way the decoder thread does, retrying
+    // whenever the ring buffer is full, and returns the slowest AddFrames()
+    double feed(void)
+    {
+        short   buf[CHUNK * CHANNELS];
+        long    t        = 0;
+        int64_t timecode = 0;
+        double  slowest  = 0;
+
+        for (int chunk = 0; chunk < SECONDS * RATE / CHUNK; chunk++)
+        {
+            fillChunk(buf, t);
+            while (true)
+            {
+                QElapsedTimer timer;
+                timer.start();
+                bool added = m_audio->AddFrames(buf, CHUNK, timecode);
+                double ms = timer.nsecsElapsed() / 1000000.0;
+                if (ms > slowest)
+                    slowest = ms;
+                if (added)
+                    break;
+                usleep(5000);
+            }
+            timecode += CHUNK * 1000 / RATE;
+        }
+        return slowest;
+    }
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void)
+    {
+        gCoreContext = new MythCoreContext("bin_version", NULL);
+        GetMythDB()->IgnoreDatabase(true);
+    }
+
+    void init(void)
+    {
+        m_audio = AudioOutput::OpenAudio(
+            "NULL:realtime", "NULL", FORMAT_S16, CHANNELS, 0, RATE,
+            AUDIOOUTPUT_VIDEO, false, false);
+        QVERIFY(m_audio);
+        QVERIFY2(m_audio->GetError().isEmpty(),
+                 m_audio->GetError().toLocal8Bit().constData());
+    }
+
+    void cleanup(void)
+    {
+        delete m_audio;
+        m_audio = NULL;
+    }
+
+    // The audio clock must never go backwards while the decoder adds
+    // audio, and must run at the rate of the wall clock. How far single
+    // samples stray from it and how long AddFrames takes depend on the
+    // load of the machine, so they are only reported, and the allowed
+    // drift grows with the jitter seen.
+    void AudiotimeJitter(void)
+    {
+        AudiotimeSampler sampler(m_audio);
+        sampler.start();
+        double slowest = feed();
+        m_audio->Drain();
+        sampler.Stop();
+
+        QVector<double> &offsets = sampler.offsets;
+        QVERIFY(offsets.size() > 100);
+
+        // Skip the first half second, the device is still filling up
+        int first = offsets.size() / (SECONDS * 2);
+        double mean = 0, var = 0;
+        for (int i = first; i < offsets.size(); i++)
+            mean += offsets[i];
+        mean /= offsets.size() - first;
+        for (int i = first; i < offsets.size(); i++)
+            var += (offsets[i] - mean) * (offsets[i] - mean);
+        double jitter = sqrt(var / (offsets.size() - first));
+
+        // Drift is the change of the mean offset from the first to the
+        // last third, measured against the jitter within each third
+        int    third = (offsets.size() - first) / 3;
+        double early = 0, late = 0, spread = 0;
+        for (int i = 0; i < third; i++)
+        {
+            early += offsets[first + i];
+            late  += offsets[offsets.size() - third + i];
+        }
+        early /= third;
+        late  /= third;
+        for (int i = 0; i < third; i++)
+        {
+            double e = offsets[first + i] - early;
+            double l = offsets[offsets.size() - third + i] - late;
+            spread += e * e + l * l;
+        }
+        spread = sqrt(spread / (2 * third));
+        double drift   = late - early;
+        double allowed = 100 + 4 * spread;
+
+        qDebug() << "audiotime jitter" << jitter << "ms, drift" << drift
+                 << "ms, slowest AddFrames" << slowest << "ms";
+
+        QCOMPARE(sampler.backwards, 0);
+        QVERIFY2(fabs(drift) < allowed,
+                 QString("audiotime drifted %1 ms from the wall clock, "
+                         "allowed %2 ms").arg(drift).arg(allowed)
+                     .toLocal8Bit().constData());
+    }
+
+    // What the A/V sync code pays for each GetAudiotime() while the
+    // output thread is busy consuming audio
+    void AudiotimeBenchmark(void)
+    {
+        short buf[CHUNK * CHANNELS];
+        long  t = 0;
+        int64_t timecode = 0;
+        for (int i = 0; i < 10; i++, timecode += CHUNK * 1000 / RATE)
+        {
+            fillChunk(buf, t);
+            QVERIFY(m_audio->AddFrames(buf, CHUNK, timecode));
+        }
+
+        QBENCHMARK
+        {
+            m_audio->GetAudiotime();
+        }
+    }
+};
@@ -22,6 +22,7 @@
 
 #include "mythcorecontext.h"
 #include "audiooutpututil.h"
+#include "audioconvert.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #define MSKIP(MSG) QSKIP(MSG, SkipSingle)
@@ -35,6 +36,12 @@
 
 #define ISIZEOF(type) ((int)sizeof(type))
 
+Q_DECLARE_METATYPE(AudioFormat)
+Q_DECLARE_METATYPE(AudioConvert::SIMDLevel)
+
+// Not a multiple of any vector size, so every tail loop gets used too
+#define SIMDSAMPLES (4096 + 27)
+
 class TestAudioUtils: public QObject
 {
     Q_OBJECT
@@ -46,6 +53,12 @@ class TestAudioUtils: public QObject
         gCoreContext = new MythCoreContext("bin_version", NULL);
     }
 
+    // undo any SetMaxSIMDLevel() of the test
+    void cleanup(void)
+    {
+        AudioConvert::SetMaxSIMDLevel(AudioConvert::kSIMDAVX2);
+    }
+
     void S16ToFloatSSE_data(void)
     {
         QTest::addColumn<int>("SAMPLES");
@@ -922,4 +935,264 @@ class TestAudioUtils: public QObject
         av_free(arrayf2);
         av_free(arrayf3);
     }
+    // Deterministic noise, values anywhere in an int
+    static uint32_t noise(uint32_t &seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return seed;
+    }
+
+    // Fills 'buf' with 'samples' samples of 'format', floats in -range..range
+    static void fillNoise(AudioFormat format, void *buf, int samples,
+                          float range, uint32_t seed)
+    {
+        for (int i = 0; i < samples; i++)
+        {
+            uint32_t n = noise(seed);
+            switch (format)
+            {
+                case FORMAT_U8:
+                    ((uchar *)buf)[i] = n >> 24;
+                    break;
+                case FORMAT_S16:
+                    ((short *)buf)[i] = n >> 16;
+                    break;
+                case FORMAT_S24LSB:
+                    ((int32_t *)buf)[i] = (int32_t)n >> 8;
+                    break;
+                case FORMAT_S24:
+                    ((int32_t *)buf)[i] = n & ~0xff;
+                    break;
+                case FORMAT_FLT:
+                    // keep in range samples strictly inside -1..1
+                    ((float *)buf)[i] =
+                        ((int32_t)n / 2147483648.0f) * range * 0.999f;
+                    break;
+                default:
+                    ((int32_t *)buf)[i] = n;
+                    break;
+            }
+        }
+    }
+
+    static void addSIMDRows(const char *name)
+    {
+        QTest::newRow(QString("%1 SSE2").arg(name).toLatin1().constData())
+            << AudioConvert::kSIMDSSE2;
+        QTest::newRow(QString("%1 AVX2").arg(name).toLatin1().constData())
+            << AudioConvert::kSIMDAVX2;
+    }
+
+    static void addFormatRows(AudioConvert::SIMDLevel level,
+                              const char *levelname)
+    {
+        static const AudioFormat formats[] =
+            { FORMAT_U8, FORMAT_S16, FORMAT_S24LSB, FORMAT_S24, FORMAT_S32,
+              FORMAT_FLT };
+        static const char *names[] =
+            { "U8", "S16", "S24LSB", "S24", "S32", "FLT" };
+
+        for (uint i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+        {
+            QTest::newRow(QString("%1 %2").arg(names[i]).arg(levelname)
+                          .toLatin1().constData())
+                << formats[i] << level;
+        }
+    }
+
+    // Converts with the given SIMD level, at an unaligned offset
+    static void convert(AudioConvert::SIMDLevel level, AudioFormat format,
+                        const void *ints, const float *floats,
+                        float *outfloats, void *outints)
+    {
+        int size = AudioOutputSettings::SampleSize(format);
+
+        AudioConvert::SetMaxSIMDLevel(level);
+        if (format != FORMAT_FLT)
+            AudioOutputUtil::toFloat(format, outfloats + 1,
+                                     (const char *)ints + size,
+                                     SIMDSAMPLES * size);
+        AudioOutputUtil::fromFloat(format, (char *)outints + size, floats + 1,
+                                   SIMDSAMPLES * ISIZEOF(float));
+        AudioConvert::SetMaxSIMDLevel(AudioConvert::kSIMDAVX2);
+    }
+
+    void SIMDConversionExact_data(void)
+    {
+        QTest::addColumn<AudioFormat>("format");
+        QTest::addColumn<AudioConvert::SIMDLevel>("level");
+        addFormatRows(AudioConvert::kSIMDSSE2, "SSE2");
+        addFormatRows(AudioConvert::kSIMDAVX2, "AVX2");
+    }
+
+    // The vector code must give the same bits as the C code for all in
+    // range samples, and AVX2 the same as SSE2 also for out of range ones
+    void SIMDConversionExact(void)
+    {
+        QFETCH(AudioFormat, format);
+        QFETCH(AudioConvert::SIMDLevel, level);
+
+        if (AudioConvert::GetSIMDLevel() < level)
+            MSKIP("Not supported by this CPU or build");
+
+        int bytes = (SIMDSAMPLES + 1) * ISIZEOF(float);
+        QByteArray ints(bytes, 0), floats(bytes, 0), loud(bytes, 0);
+        fillNoise(format, ints.data(), SIMDSAMPLES + 1, 1.0f, 1);
+        fillNoise(FORMAT_FLT, floats.data(), SIMDSAMPLES + 1, 1.0f, 2);
+        fillNoise(FORMAT_FLT, loud.data(), SIMDSAMPLES + 1, 1.5f, 3);
+
+        QByteArray reff(bytes, 0), refi(bytes, 0), simdf(bytes, 0),
+                   simdi(bytes, 0);
+
+        convert(AudioConvert::kSIMDNone, format, ints.constData(),
+                (const float *)floats.constData(), (float *)reff.data(),
+                refi.data());
+        convert(level, format, ints.constData(),
+                (const float *)floats.constData(), (float *)simdf.data(),
+                simdi.data());
+        QVERIFY(reff == simdf);
+        QVERIFY(refi == simdi);
+
+        if (level == AudioConvert::kSIMDSSE2)
+            return;
+
+        convert(AudioConvert::kSIMDSSE2, format, ints.constData(),
+                (const float *)loud.constData(), (float *)reff.data(),
+                refi.data());
+        convert(level, format, ints.constData(),
+                (const float *)loud.constData(), (float *)simdf.data(),
+                simdi.data());
+        QVERIFY(refi == simdi);
+    }
+
+    void SIMDConversionSpeed_data(void)
+    {
+        QTest::addColumn<AudioFormat>("format");
+        QTest::addColumn<AudioConvert::SIMDLevel>("level");
+        addFormatRows(AudioConvert::kSIMDNone, "C");
+        addFormatRows(AudioConvert::kSIMDSSE2, "SSE2");
+        addFormatRows(AudioConvert::kSIMDAVX2, "AVX2");
+    }
+
+    void SIMDConversionSpeed(void)
+    {
+        QFETCH(AudioFormat, format);
+        QFETCH(AudioConvert::SIMDLevel, level);
+
+        if (AudioConvert::GetSIMDLevel() < level)
+            MSKIP("Not supported by this CPU or build");
+
+        int bytes = (SIMDSAMPLES + 1) * ISIZEOF(float);
+        QByteArray ints(bytes, 0), floats(bytes, 0);
+        fillNoise(format, ints.data(), SIMDSAMPLES + 1, 1.0f, 1);
+
+        QBENCHMARK
+        {
+            for (int i = 0; i < 32; i++)
+            {
+                convert(level, format, ints.constData(),
+                        (const float *)floats.constData(),
+                        (float *)floats.data(), ints.data());
+            }
+        }
+    }
+
+    void AdjustVolumeExact_data(void)
+    {
+        QTest::addColumn<AudioConvert::SIMDLevel>("level");
+        addSIMDRows("volume");
+    }
+
+    void AdjustVolumeExact(void)
+    {
+        QFETCH(AudioConvert::SIMDLevel, level);
+
+        if (AudioConvert::GetSIMDLevel() < level)
+            MSKIP("Not supported by this CPU or build");
+
+        int bytes = (SIMDSAMPLES + 1) * ISIZEOF(float);
+        QByteArray floats(bytes, 0);
+        fillNoise(FORMAT_FLT, floats.data(), SIMDSAMPLES + 1, 1.5f, 4);
+        QByteArray ref(floats), simd(floats);
+
+        AudioConvert::SetMaxSIMDLevel(AudioConvert::kSIMDNone);
+        AudioOutputUtil::AdjustVolume(ref.data() + ISIZEOF(float),
+                                      SIMDSAMPLES * ISIZEOF(float), 73,
+                                      false, true);
+        AudioConvert::SetMaxSIMDLevel(level);
+        AudioOutputUtil::AdjustVolume(simd.data() + ISIZEOF(float),
+                                      SIMDSAMPLES * ISIZEOF(float), 73,
+                                      false, true);
+        QVERIFY(ref == simd);
+        QVERIFY(ref != floats);
+    }
+
+    void AdjustVolumeSpeed_data(void)
+    {
+        QTest::addColumn<AudioConvert::SIMDLevel>("level");
+        QTest::newRow("volume C") << AudioConvert::kSIMDNone;
+        addSIMDRows("volume");
+    }
+
+    void AdjustVolumeSpeed(void)
+    {
+        QFETCH(AudioConvert::SIMDLevel, level);
+
+        if (AudioConvert::GetSIMDLevel() < level)
+            MSKIP("Not supported by this CPU or build");
+
+        QByteArray floats(SIMDSAMPLES * ISIZEOF(float), 0);
+        fillNoise(FORMAT_FLT, floats.data(), SIMDSAMPLES, 1.0f, 5);
+
+        AudioConvert::SetMaxSIMDLevel(level);
+        QBENCHMARK
+        {
+            for (int i = 0; i < 32; i++)
+                AudioOutputUtil::AdjustVolume(floats.data(), floats.size(),
+                                              100 - (i & 1), false, false);
+        }
+    }
+
+    void MuteChannelExact_data(void)
+    {
+        QTest::addColumn<int>("bits");
+        QTest::addColumn<int>("channels");
+        QTest::newRow("8 bits stereo")    << 8  << 2;
+        QTest::newRow("16 bits stereo")   << 16 << 2;
+        QTest::newRow("32 bits stereo")   << 32 << 2;
+        QTest::newRow("16 bits 5.1")      << 16 << 6;
+        QTest::newRow("32 bits 7.1")      << 32 << 8;
+    }
+
+    // Every SIMD level must mute exactly like copying the other channel
+    void MuteChannelExact(void)
+    {
+        QFETCH(int, bits);
+        QFETCH(int, channels);
+
+        int size   = bits >> 3;
+        int frames = SIMDSAMPLES / channels;
+        int bytes  = frames * channels * size;
+        QByteArray samples(bytes + size, 0);
+        fillNoise(FORMAT_U8, samples.data(), samples.size(), 1.0f, 6);
+
+        for (int ch = 0; ch < 2; ch++)
+        {
+            QByteArray ref(samples);
+            char *r = ref.data() + size;
+            for (int i = 0; i < frames; i++)
+                memcpy(r + (i * channels + ch) * size,
+                       r + (i * channels + 1 - ch) * size, size);
+
+            for (int level = AudioConvert::kSIMDNone;
+                 level <= AudioConvert::GetSIMDLevel(); level++)
+            {
+                QByteArray muted(samples);
+                AudioConvert::SetMaxSIMDLevel((AudioConvert::SIMDLevel)level);
+                AudioOutputUtil::MuteChannel(bits, channels, ch,
+                                             muted.data() + size, bytes);
+                QVERIFY(muted == ref);
+            }
+        }
+    }
 };
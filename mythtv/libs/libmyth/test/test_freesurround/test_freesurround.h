@@ -0,0 +1,212 @@
+/*
+ *  Class TestFreeSurround
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <cmath>
+
+#include <QtTest/QtTest>
+
+#include "el_processor.h"
+
+#define BLOCKSIZE   8192
+#define HALFBLOCK   (BLOCKSIZE/2)
+#define RATE        48000
+#define BLOCKS      12
+#define WARMUP      4
+
+// Output of the decoder before its per-bin decoding was vectorised, for
+// the test signal below: the RMS of each channel (L, C, R, LS, RS, LFE)
+// over the blocks after WARMUP, and the samples 123, 1123, 2123 and 3123
+// of the last block.
+struct GoldenOutput
+{
+    const char *name;
+    bool        linear;
+    unsigned    phasemode;
+    float       rms[6];
+    float       samples[6][4];
+};
+
+static const GoldenOutput golden[] =
+{
+    { "linear steering", true, 0,
+      { 0.3472959, 0.1662178, 0.1717031, 0.1384381, 0.1384381, 0.1003051 },
+      { { -0.1971080, -0.3405042, -0.1382009,  0.2595969 },
+        { -0.0499430, -0.0814274, -0.0275471,  0.0975447 },
+        {  0.0033197,  0.0146101,  0.0164525,  0.0592156 },
+        { -0.1192640, -0.1942046, -0.0749796,  0.1193153 },
+        {  0.1191753,  0.1941022,  0.0749223, -0.1191663 },
+        {  0.0971855, -0.0322275, -0.0423136,  0.1057213 } } },
+    { "simple steering", false, 0,
+      { 0.3382311, 0.1663020, 0.1739638, 0.1453179, 0.1453178, 0.1003051 },
+      { { -0.1839034, -0.3177395, -0.1286454,  0.2464279 },
+        { -0.0499675, -0.0814684, -0.0275645,  0.0975923 },
+        { -0.0058758, -0.0009696,  0.0100674,  0.0684356 },
+        { -0.1251159, -0.2037395, -0.0786521,  0.1251327 },
+        {  0.1251078,  0.2037525,  0.0786435, -0.1251296 },
+        {  0.0971855, -0.0322275, -0.0423136,  0.1057213 } } },
+    { "linear steering, PowerDVD phase", true, 1,
+      { 0.3472959, 0.1662178, 0.1717031, 0.1384381, 0.1384381, 0.1003051 },
+      { { -0.1971080, -0.3405042, -0.1382009,  0.2595969 },
+        { -0.0499430, -0.0814274, -0.0275471,  0.0975447 },
+        {  0.0033197,  0.0146101,  0.0164525,  0.0592156 },
+        { -0.1192640, -0.1942046, -0.0749796,  0.1193153 },
+        { -0.1191753, -0.1941022, -0.0749223,  0.1191663 },
+        {  0.0971855, -0.0322275, -0.0423136,  0.1057213 } } },
+};
+
+class TestFreeSurround: public QObject
+{
+    Q_OBJECT
+
+    // a 440Hz tone panned left, a 1kHz tone out of phase (surround),
+    // a 250Hz tone in the centre and a 20Hz tone for the LFE
+    static void fillBlock(fsurround_decoder &decoder, long &t)
+    {
+        float **in = decoder.getInputBuffers();
+        for (int i = 0; i < HALFBLOCK; i++, t++)
+        {
+            double s = 2 * M_PI * t / RATE;
+            double panned = 0.5 * sin(440 * s);
+            double surround = 0.3 * sin(1000 * s);
+            double center = 0.25 * sin(250 * s);
+            double lfe = 0.2 * sin(20 * s);
+            in[0][i] = panned + surround + center + lfe;
+            in[1][i] = 0.4 * panned - surround + center + lfe;
+        }
+    }
+
+  private slots:
+    void Decode_data(void)
+    {
+        QTest::addColumn<int>("index");
+        for (uint i = 0; i < sizeof(golden) / sizeof(golden[0]); i++)
+            QTest::newRow(golden[i].name) << (int)i;
+    }
+
+    // compare the decoder's output with the golden output; the fast
+    // trigonometry is allowed small errors, changed steering is not
+    void Decode(void)
+    {
+        QFETCH(int, index);
+        const GoldenOutput &g = golden[index];
+
+        fsurround_decoder decoder(BLOCKSIZE);
+        decoder.sample_rate(RATE);
+        decoder.steering_mode(g.linear);
+        decoder.phase_mode(g.phasemode);
+
+        long t = 0;
+        double sum[6] = { 0, 0, 0, 0, 0, 0 };
+        float **out = NULL;
+        for (int b = 0; b < BLOCKS; b++)
+        {
+            fillBlock(decoder, t);
+            decoder.decode(0.65, 0.0);
+            out = decoder.getOutputBuffers();
+            if (b < WARMUP)
+                continue;
+            for (int c = 0; c < 6; c++)
+                for (int i = 0; i < HALFBLOCK; i++)
+                    sum[c] += out[c][i] * out[c][i];
+        }
+
+        for (int c = 0; c < 6; c++)
+        {
+            double rms = sqrt(sum[c] / ((BLOCKS - WARMUP) * HALFBLOCK));
+            QVERIFY2(fabs(rms - g.rms[c]) < 1e-4,
+                     qPrintable(QString("channel %1 rms %2, expected %3")
+                                .arg(c).arg(rms).arg(g.rms[c])));
+            for (int k = 0; k < 4; k++)
+            {
+                float sample = out[c][k * 1000 + 123];
+                QVERIFY2(fabs(sample - g.samples[c][k]) < 1e-3,
+                         qPrintable(QString("channel %1 sample %2 is %3, "
+                                            "expected %4")
+                                    .arg(c).arg(k * 1000 + 123)
+                                    .arg(sample).arg(g.samples[c][k])));
+            }
+        }
+    }
+
+    // silence must stay silent, no NaNs from the amplitude ratios
+    void DecodeSilence(void)
+    {
+        fsurround_decoder decoder(BLOCKSIZE);
+        for (int b = 0; b < 3; b++)
+        {
+            float **in = decoder.getInputBuffers();
+            memset(in[0], 0, HALFBLOCK * sizeof(float));
+            memset(in[1], 0, HALFBLOCK * sizeof(float));
+            decoder.decode(0.65, 0.0);
+        }
+        float **out = decoder.getOutputBuffers();
+        for (int c = 0; c < 6; c++)
+            for (int i = 0; i < HALFBLOCK; i++)
+                QCOMPARE(out[c][i], 0.0f);
+    }
+
+    // the block-parallel mode runs the same transforms, only on other
+    // threads, so its output is the same to the bit
+    void DecodeParallel(void)
+    {
+        fsurround_decoder serial(BLOCKSIZE), parallel(BLOCKSIZE);
+        parallel.parallel_mode(true);
+
+        long ts = 0, tp = 0;
+        for (int b = 0; b < 4; b++)
+        {
+            fillBlock(serial, ts);
+            fillBlock(parallel, tp);
+            serial.decode(0.65, 0.0);
+            parallel.decode(0.65, 0.0);
+            float **outs = serial.getOutputBuffers();
+            float **outp = parallel.getOutputBuffers();
+            for (int c = 0; c < 6; c++)
+                QVERIFY(memcmp(outs[c], outp[c],
+                               HALFBLOCK * sizeof(float)) == 0);
+        }
+    }
+
+    void DecodeBenchmark_data(void)
+    {
+        QTest::addColumn<bool>("linear");
+        QTest::addColumn<bool>("parallel");
+        QTest::newRow("linear steering") << true << false;
+        QTest::newRow("simple steering") << false << false;
+        QTest::newRow("linear steering, block-parallel") << true << true;
+    }
+
+    // one block is 4096 frames, about 85ms of audio at 48kHz
+    void DecodeBenchmark(void)
+    {
+        QFETCH(bool, linear);
+        QFETCH(bool, parallel);
+
+        fsurround_decoder decoder(BLOCKSIZE);
+        decoder.sample_rate(RATE);
+        decoder.steering_mode(linear);
+        decoder.parallel_mode(parallel);
+
+        long t = 0;
+        fillBlock(decoder, t);
+        QBENCHMARK
+        {
+            decoder.decode(0.65, 0.0);
+        }
+    }
+};
@@ -5,12 +5,14 @@
 #include <QList>
 #include <QQueue>
 #include <QHash>
+#include <QThreadStorage>
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QStringList>
 #include <QMap>
 #include <QRegExp>
 #include <QVariantMap>
+#include <QDataStream>
 #include <iostream>
 
 using namespace std;
@@ -74,8 +76,10 @@ extern "C" {
 #endif
 
 static QMutex                  logQueueMutex;
-static QQueue<LoggingItem *>   logQueue;
-static QRegExp                 logRegExp = QRegExp("[%]{1,2}");
+static LoggingQueue            logQueue(LOGQUEUE_SIZE);
+static LoggingQueue            logFreeItems(LOGQUEUE_SIZE);
+static QAtomicInt              logQueueSleeping;
+static QAtomicInt              logDroppedCount;
 
 static LoggerThread           *logThread = NULL;
 static QMutex                  logThreadMutex;
@@ -83,6 +87,8 @@ static QHash<uint64_t, char *> logThreadHash;
 
 static QMutex                   logThreadTidMutex;
 static QHash<uint64_t, int64_t> logThreadTidHash;
+// Each thread's entry in logThreadTidHash, so LOG() needn't lock to find it
+static QThreadStorage<int64_t>  logThreadTid;
 
 static bool                    logThreadFinished = false;
 static bool                    debugRegistration = false;
@@ -152,7 +158,7 @@ LoggingItem::LoggingItem() :
         m_pid(-1), m_tid(-1), m_threadId(-1), m_usec(0), m_line(0),
         m_type(kMessage), m_level((LogLevel_t)LOG_INFO), m_facility(0), m_epoch(0),
         m_file(NULL), m_function(NULL), m_threadName(NULL), m_appName(NULL),
-        m_table(NULL), m_logFile(NULL)
+        m_table(NULL), m_logFile(NULL), m_pooled(false)
 {
     m_message[0]='\0';
     m_message[LOGLINE_MAX]='\0';
@@ -160,12 +166,61 @@ LoggingItem::LoggingItem() :
 
 LoggingItem::LoggingItem(const char *_file, const char *_function,
                          int _line, LogLevel_t _level, LoggingType _type) :
-        ReferenceCounter("LoggingItem", false), m_pid(-1),
-        m_threadId((uint64_t)(QThread::currentThreadId())),
-        m_line(_line), m_type(_type), m_level(_level), m_facility(0),
-        m_file(strdup(_file)), m_function(strdup(_function)),
-        m_threadName(NULL), m_appName(NULL), m_table(NULL), m_logFile(NULL)
+        ReferenceCounter("LoggingItem", false),
+        m_threadName(NULL), m_appName(NULL), m_table(NULL), m_logFile(NULL),
+        m_pooled(true)
+{
+    init(_file, _function, _line, _level, _type);
+}
+
+LoggingItem::~LoggingItem()
+{
+    if (!m_pooled)
+    {
+        if (m_file)
+            free((void *)m_file);
+
+        if (m_function)
+            free((void *)m_function);
+    }
+
+    freeStrings();
+}
+
+/// \brief Copy a LOG() caller's __FILE__ or __FUNCTION__ into a pooled
+///        item.  The caller's string may live in a plugin that is unloaded
+///        while the item is still queued.  A name that is too long keeps
+///        its end, which for a file is the part that identifies it.
+static const char *copySourceName(char *dst, const char *src)
 {
+    if (!src)
+        return NULL;
+
+    size_t len = strlen(src);
+    if (len > LOGSOURCE_MAX)
+    {
+        src += len - LOGSOURCE_MAX;
+        len  = LOGSOURCE_MAX;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+    return dst;
+}
+
+/// \brief (Re)initialize an item for a new LOG() call.  This runs in the
+///        logging thread's caller, so it must not allocate.
+void LoggingItem::init(const char *_file, const char *_function,
+                       int _line, LogLevel_t _level, LoggingType _type)
+{
+    m_pid      = -1;
+    m_threadId = (uint64_t)(QThread::currentThreadId());
+    m_line     = _line;
+    m_type     = _type;
+    m_level    = _level;
+    m_facility = 0;
+    m_file     = copySourceName(m_fileBuf, _file);
+    m_function = copySourceName(m_functionBuf, _function);
+
     loggingGetTimeStamp(&m_epoch, &m_usec);
 
     m_message[0]='\0';
@@ -173,36 +228,233 @@ LoggingItem::LoggingItem(const char *_file, const char *_function,
     setThreadTid();
 }
 
-LoggingItem::~LoggingItem()
+/// \brief Free the strings filled in by the logging thread
+void LoggingItem::freeStrings(void)
 {
-    if (m_file)
-        free((void *)m_file);
+    free(m_threadName);
+    free((void *)m_appName);
+    free((void *)m_table);
+    free((void *)m_logFile);
+
+    m_threadName = NULL;
+    m_appName    = NULL;
+    m_table      = NULL;
+    m_logFile    = NULL;
+}
 
-    if (m_function)
-        free((void *)m_function);
+/// \brief Decrement the reference count.  Items created by LOG() go back to
+///        the free pool when the last reference is dropped so the next LOG()
+///        call can reuse them without allocating.
+int LoggingItem::DecrRef(void)
+{
+    if (!m_pooled)
+        return ReferenceCounter::DecrRef();
 
-    if (m_threadName)
-        free(m_threadName);
+    int val = m_referenceCount.fetchAndAddRelaxed(-1) - 1;
 
-    if (m_appName)
-        free((void *)m_appName);
+    if (val == 0)
+    {
+        freeStrings();
+        m_referenceCount.fetchAndStoreOrdered(1);
 
-    if (m_table)
-        free((void *)m_table);
+        if (!logFreeItems.push(this))
+            delete this;
+    }
 
-    if (m_logFile)
-        free((void *)m_logFile);
+    return val;
 }
 
-QByteArray LoggingItem::toByteArray(void)
+/// \brief Fill the free pool so that LOG() doesn't allocate at startup
+/// \param count   number of LoggingItems to add to the pool
+void LoggingItem::preallocate(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        LoggingItem *item = new LoggingItem;
+        item->m_pooled = true;
+
+        if (!logFreeItems.push(item))
+        {
+            delete item;
+            break;
+        }
+    }
+}
+
+/// \brief Delete all LoggingItems in the free pool
+void LoggingItem::freePool(void)
+{
+    LoggingItem *item;
+
+    while ((item = logFreeItems.pop()) != NULL)
+        delete item;
+}
+
+LoggingQueue::LoggingQueue(uint size) :
+        m_cells(new Cell[size]), m_mask(size - 1), m_head(0), m_tail(0)
+{
+    for (uint i = 0; i < size; i++)
+    {
+        m_cells[i].seq.fetchAndStoreRelaxed(i);
+        m_cells[i].item = NULL;
+    }
+}
+
+LoggingQueue::~LoggingQueue()
+{
+    delete [] m_cells;
+}
+
+/// \brief Add an item to the tail of the queue.  Each cell carries a
+///        sequence number telling whether it is free for the current lap,
+///        so producers only ever race on the tail index.
+/// \return false if the queue is full
+bool LoggingQueue::push(LoggingItem *item)
 {
-    QVariantMap variant = QJson::QObjectHelper::qobject2qvariant(this);
-    QJson::Serializer serializer;
-    QByteArray json = serializer.serialize(variant);
+    uint  pos = (uint)m_tail.fetchAndAddRelaxed(0);
+    Cell *cell;
 
-    //cout << json.constData() << endl;
+    for (;;)
+    {
+        cell = &m_cells[pos & m_mask];
+        int dif = (int)((uint)cell->seq.fetchAndAddAcquire(0) - pos);
+
+        if (dif == 0)
+        {
+            if (m_tail.testAndSetRelaxed((int)pos, (int)(pos + 1)))
+                break;
+        }
+        else if (dif < 0)
+            return false;
+
+        pos = (uint)m_tail.fetchAndAddRelaxed(0);
+    }
+
+    cell->item = item;
+    cell->seq.fetchAndStoreRelease((int)(pos + 1));
+
+    return true;
+}
+
+/// \brief Remove the item at the head of the queue
+/// \return the item, or NULL if the queue is empty
+LoggingItem *LoggingQueue::pop(void)
+{
+    uint  pos = (uint)m_head.fetchAndAddRelaxed(0);
+    Cell *cell;
+
+    for (;;)
+    {
+        cell = &m_cells[pos & m_mask];
+        int dif = (int)((uint)cell->seq.fetchAndAddAcquire(0) - (pos + 1));
+
+        if (dif == 0)
+        {
+            if (m_head.testAndSetRelaxed((int)pos, (int)(pos + 1)))
+                break;
+        }
+        else if (dif < 0)
+            return NULL;
+
+        pos = (uint)m_head.fetchAndAddRelaxed(0);
+    }
+
+    LoggingItem *item = cell->item;
+    cell->seq.fetchAndStoreRelease((int)(pos + m_mask + 1));
+
+    return item;
+}
+
+bool LoggingQueue::isEmpty(void)
+{
+    uint  pos  = (uint)m_head.fetchAndAddRelaxed(0);
+    Cell *cell = &m_cells[pos & m_mask];
+
+    return (int)((uint)cell->seq.fetchAndAddAcquire(0) - (pos + 1)) < 0;
+}
+
+/// \brief Hand an item to the logging thread.  This never takes a lock
+///        unless the logging thread is asleep and needs waking up.
+/// \param item    The item to queue.  Ownership passes to the queue.
+/// \param wait    Retry for up to a second when the queue is full rather
+///                than dropping the item (used for thread registration)
+/// \return true if the item was queued
+static bool logEnqueue(LoggingItem *item, bool wait)
+{
+    int tries = 0;
+
+    while (!logQueue.push(item))
+    {
+        if (!wait || !logThread || logThreadFinished || ++tries > 1000)
+        {
+            logDroppedCount.fetchAndAddOrdered(1);
+            item->DecrRef();
+            return false;
+        }
+        usleep(1000);
+    }
+
+    if (logQueueSleeping.fetchAndAddOrdered(0) && logThread)
+        logThread->wake();
+
+    return true;
+}
+
+/// \brief Append a length-prefixed C-string to a serialized LoggingItem
+static void writeString(QDataStream &stream, const char *str)
+{
+    quint32 len = str ? strlen(str) : 0;
+    stream << len;
+    if (len)
+        stream.writeRawData(str, len);
+}
+
+/// \brief Read a length-prefixed C-string from a serialized LoggingItem.
+/// \return malloc()ed copy of the string, so it can be free()d like the
+///         strdup()ed values, or NULL if the buffer is short.
+static char *readString(QDataStream &stream, uint maxLen = 0)
+{
+    quint32 len = 0;
+    stream >> len;
+    if (stream.status() != QDataStream::Ok ||
+        len > (quint32)(stream.device()->bytesAvailable()))
+        return NULL;
+
+    char *str = (char *)malloc(len + 1);
+    if (!str)
+        return NULL;
+
+    stream.readRawData(str, len);
+    str[(maxLen && len > maxLen) ? maxLen : len] = '\0';
+    return str;
+}
 
-    return json;
+/// \brief Serialize the item for sending to mythlogserver.  The fixed fields
+///        are written in network byte order followed by the strings, each
+///        prefixed by its length.  The leading magic byte lets the receiver
+///        tell this apart from the older JSON encoding.
+QByteArray LoggingItem::toByteArray(void)
+{
+    QByteArray buf;
+    buf.reserve(128 + strlen(m_message));
+
+    QDataStream stream(&buf, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    stream << (quint8)LOGITEM_MAGIC << (quint8)LOGITEM_VERSION
+           << (qint32)m_pid << (qint64)m_tid << (quint64)m_threadId
+           << (quint32)m_usec << (qint32)m_line << (qint32)m_type
+           << (qint32)m_level << (qint32)m_facility << (qint64)m_epoch;
+
+    writeString(stream, m_file);
+    writeString(stream, m_function);
+    writeString(stream, m_threadName);
+    writeString(stream, m_appName);
+    writeString(stream, m_table);
+    writeString(stream, m_logFile);
+    writeString(stream, m_message);
+
+    return buf;
 }
 
 /// \brief Get the name of the thread that produced the LoggingItem
@@ -232,12 +484,21 @@ int64_t LoggingItem::getThreadTid(void)
 
 /// \brief Set the thread ID of the thread that produced the LoggingItem.  This
 ///        code is actually run in the thread in question as part of the call
-///        to LOG()
+///        to LOG().  The ID is kept in thread local storage, so only the first
+///        message of a thread, and its registration, take logThreadTidMutex.
 /// \notes In different platforms, the actual value returned here will vary.
 ///        The intention is to get a thread ID that will map well to what is
 ///        shown in gdb.
 void LoggingItem::setThreadTid(void)
 {
+    // Registration puts the ID back in logThreadTidHash for the logger
+    // thread, after an earlier deregistration removed it
+    if (!(m_type & kRegistering) && logThreadTid.hasLocalData())
+    {
+        m_tid = logThreadTid.localData();
+        return;
+    }
+
     QMutexLocker locker(&logThreadTidMutex);
 
     m_tid = logThreadTidHash.value(m_threadId, -1);
@@ -257,6 +518,7 @@ void LoggingItem::setThreadTid(void)
 #endif
         logThreadTidHash[m_threadId] = m_tid;
     }
+    logThreadTid.setLocalData(m_tid);
 }
 
 /// \brief LoggerThread constructor.  Enables debugging of thread registration
@@ -272,7 +534,8 @@ LoggerThread::LoggerThread(QString filename, bool progress, bool quiet,
     m_quiet(quiet), m_appname(QCoreApplication::applicationName()),
     m_tablename(table), m_facility(facility), m_pid(getpid()), m_epoch(0),
     m_zmqContext(NULL), m_zmqSocket(NULL), m_initialTimer(NULL),
-    m_heartbeatTimer(NULL), m_noserver(noserver)
+    m_heartbeatTimer(NULL), m_noserver(noserver),
+    m_droppedPending(0), m_droppedTotal(0)
 {
     char *debug = getenv("VERBOSE_THREADS");
     if (debug != NULL)
@@ -401,23 +664,35 @@ void LoggerThread::run(void)
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(NULL, QEvent::DeferredDelete);
 
-        qLock.relock();
-        if (logQueue.isEmpty())
+        // Producers never wait on us, so work through the queue in batches
+        // and only return to the event loop between batches.
+        LoggingItem *item;
+        int count = 0;
+
+        while (count < LOGQUEUE_BATCH && (item = logQueue.pop()) != NULL)
         {
-            m_waitEmpty->wakeAll();
-            m_waitNotEmpty->wait(qLock.mutex(), 100);
-            continue;
+            fillItem(item);
+            handleItem(item);
+            logConsole(item);
+            item->DecrRef();
+            count++;
         }
 
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
-
-        fillItem(item);
-        handleItem(item);
-        logConsole(item);
-        item->DecrRef();
+        sendBatch();
+        reportDropped();
 
         qLock.relock();
+        if (count == 0)
+        {
+            m_waitEmpty->wakeAll();
+
+            // Producers check this flag after queueing an item and only
+            // then take logQueueMutex to wake us.
+            logQueueSleeping.fetchAndStoreOrdered(1);
+            if (logQueue.isEmpty() && !m_aborted)
+                m_waitNotEmpty->wait(qLock.mutex(), 100);
+            logQueueSleeping.fetchAndStoreOrdered(0);
+        }
     }
 
     qLock.unlock();
@@ -557,6 +832,35 @@ void LoggerThread::messageReceived(const QList<QByteArray> &msg)
 }
 
 
+/// \brief  Wake the logging thread if it is waiting for new items
+void LoggerThread::wake(void)
+{
+    QMutexLocker qLock(&logQueueMutex);
+    m_waitNotEmpty->wakeAll();
+}
+
+/// \brief  Report messages that were dropped because the logging queue was
+///         full.  Reports are rate limited to one per second.
+void LoggerThread::reportDropped(void)
+{
+    m_droppedPending += logDroppedCount.fetchAndStoreOrdered(0);
+
+    if (!m_droppedPending)
+        return;
+
+    if (m_droppedTimer.isValid() && m_droppedTimer.elapsed() < 1000)
+        return;
+
+    m_droppedTotal += m_droppedPending;
+
+    LOG(VB_GENERAL, LOG_WARNING,
+        QString("Logging queue full, dropped %1 messages (%2 total)")
+            .arg(m_droppedPending).arg(m_droppedTotal));
+
+    m_droppedPending = 0;
+    m_droppedTimer.start();
+}
+
 /// \brief  Handles each LoggingItem, generally by handing it off to 
 ///         mythlogserver via ZeroMQ.  There is a special case for
 ///         thread registration and deregistration which are also included in
@@ -624,22 +928,40 @@ void LoggerThread::handleItem(LoggingItem *item)
 
     if (item->m_message[0] != '\0')
     {
+        // Collected here and sent to mythlogserver by sendBatch()
 #ifndef NOLOGSERVER
-        // Send it to mythlogserver
         if (!logThreadFinished && m_zmqSocket)
-            m_zmqSocket->sendMessage(item->toByteArray());
+            m_batch.append(item->toByteArray());
 #else
         if (logServerThread)
-        {
-            QList<QByteArray> list;
-            list.append(QByteArray());
-            list.append(item->toByteArray());
-            logServerThread->receivedMessage(list);
-        }
+            m_batch.append(item->toByteArray());
 #endif
     }
 }
 
+/// \brief Send the items collected by handleItem() to mythlogserver as a
+///        single multipart ZeroMQ message, one item per part, rather than
+///        paying for a message per LOG() call.
+void LoggerThread::sendBatch(void)
+{
+    if (m_batch.isEmpty())
+        return;
+
+#ifndef NOLOGSERVER
+    if (!logThreadFinished && m_zmqSocket)
+        m_zmqSocket->sendMessage(m_batch);
+#else
+    if (logServerThread)
+    {
+        // The first part is normally the client id added by ZeroMQ
+        m_batch.prepend(QByteArray());
+        logServerThread->receivedMessage(m_batch);
+    }
+#endif
+
+    m_batch.clear();
+}
+
 /// \brief Process a log message, writing to the console
 /// \param item LoggingItem containing the log message to process
 bool LoggerThread::logConsole(LoggingItem *item)
@@ -746,14 +1068,22 @@ LoggingItem *LoggingItem::create(const char *_file,
                                  int _line, LogLevel_t _level,
                                  LoggingType _type)
 {
-    LoggingItem *item = new LoggingItem(_file, _function, _line, _level, _type);
+    LoggingItem *item = logFreeItems.pop();
+
+    if (item)
+        item->init(_file, _function, _line, _level, _type);
+    else
+        item = new LoggingItem(_file, _function, _line, _level, _type);
 
     return item;
 }
 
 LoggingItem *LoggingItem::create(QByteArray &buf)
 {
-    // Deserialize buffer
+    if (!buf.isEmpty() && (quint8)buf.at(0) == LOGITEM_MAGIC)
+        return createFromBinary(buf);
+
+    // Older clients send the item as JSON
     QJson::Parser parser;
     QVariant variant = parser.parse(buf);
 
@@ -763,9 +1093,62 @@ LoggingItem *LoggingItem::create(QByteArray &buf)
     return item;
 }
 
+/// \brief Deserialize an item written by toByteArray()
+/// \return New LoggingItem, or NULL if the buffer is truncated or was
+///         written by an unknown version
+LoggingItem *LoggingItem::createFromBinary(const QByteArray &buf)
+{
+    QDataStream stream(buf);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint8  magic, version;
+    qint32  pid, line, type, level, facility;
+    qint64  tid, epoch;
+    quint64 threadId;
+    quint32 usec;
+
+    stream >> magic >> version;
+    if (magic != LOGITEM_MAGIC || version != LOGITEM_VERSION)
+        return NULL;
+
+    stream >> pid >> tid >> threadId >> usec >> line >> type >> level
+           >> facility >> epoch;
+
+    LoggingItem *item = new LoggingItem;
+    item->m_pid        = pid;
+    item->m_tid        = tid;
+    item->m_threadId   = threadId;
+    item->m_usec       = usec;
+    item->m_line       = line;
+    item->m_type       = (LoggingType)type;
+    item->m_level      = (LogLevel_t)level;
+    item->m_facility   = facility;
+    item->m_epoch      = epoch;
+    item->m_file       = readString(stream);
+    item->m_function   = readString(stream);
+    item->m_threadName = readString(stream);
+    item->m_appName    = readString(stream);
+    item->m_table      = readString(stream);
+    item->m_logFile    = readString(stream);
+
+    char *message = readString(stream, LOGLINE_MAX);
+    if (!message || stream.status() != QDataStream::Ok)
+    {
+        free(message);
+        item->DecrRef();
+        return NULL;
+    }
+    strcpy(item->m_message, message);
+    free(message);
+
+    return item;
+}
+
 
 /// \brief  Format and send a log message into the queue.  This is called from
-///         the LOG() macro.  The intention is minimal blocking of the caller.
+///         the LOG() macro.  The intention is minimal blocking of the caller:
+///         the item comes from a free pool, is queued without taking a lock,
+///         and is dropped (and counted) if the logging thread falls behind.
 /// \param  mask    Verbosity mask of the message (VB_*)
 /// \param  level   Log level of this message (LOG_* - matching syslog levels)
 /// \param  file    Filename of source code logging the message
@@ -789,45 +1172,66 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
     if (!item)
         return;
 
-    char *formatcopy = NULL;
-    if( fromQString && strchr(format, '%') )
+    if (fromQString)
     {
-        QString string(format);
-        format = strdup(string.replace(logRegExp, "%%").toLocal8Bit()
-                              .constData());
-        formatcopy = (char *)format;
+        // The message is already formatted.  Copy it straight in rather
+        // than escaping it for vsnprintf(), collapsing "%%" to "%" just as
+        // the printf pass used to.
+        char       *dst = item->m_message;
+        char       *end = item->m_message + LOGLINE_MAX - 1;
+        const char *src = format;
+
+        while (*src && dst < end)
+        {
+            if (src[0] == '%' && src[1] == '%')
+                src++;
+            *dst++ = *src++;
+        }
+        *dst = '\0';
+    }
+    else
+    {
+        va_start(arguments, format);
+        vsnprintf(item->m_message, LOGLINE_MAX, format, arguments);
+        va_end(arguments);
     }
-
-    va_start(arguments, format);
-    vsnprintf(item->m_message, LOGLINE_MAX, format, arguments);
-    va_end(arguments);
-
-    if (formatcopy)
-        free(formatcopy);
-
-    QMutexLocker qLock(&logQueueMutex);
 
 #if defined( _MSC_VER ) && defined( _DEBUG )
 	OutputDebugStringA( item->m_message );
 	OutputDebugStringA( "\n" );
 #endif
 
-    logQueue.enqueue(item);
-
     if (logThread && logThreadFinished && !logThread->isRunning())
     {
-        while (!logQueue.isEmpty())
+        // The logging thread is gone, so handle everything still queued
+        // (and this item) synchronously.
+        QMutexLocker qLock(&logQueueMutex);
+
+        if (!logQueue.push(item))
+        {
+            logThread->handleItem(item);
+            logThread->logConsole(item);
+            item->DecrRef();
+        }
+
+        while ((item = logQueue.pop()) != NULL)
         {
-            item = logQueue.dequeue();
             qLock.unlock();
             logThread->handleItem(item);
             logThread->logConsole(item);
             item->DecrRef();
             qLock.relock();
         }
+        logThread->sendBatch();
+        return;
     }
-    else if (logThread && !logThreadFinished && (type & kFlush))
+
+    if (!logEnqueue(item, false))
+        return;
+
+    if (logThread && !logThreadFinished && (type & kFlush))
     {
+        QMutexLocker qLock(&logQueueMutex);
         logThread->flush();
     }
 }
@@ -942,6 +1346,8 @@ void logStart(QString logfile, int progress, int quiet, int facility,
 
     QString table = dblog ? QString("logging") : QString("");
 
+    LoggingItem::preallocate(LOGPOOL_PREALLOC);
+
     if (!logThread)
         logThread = new LoggerThread(logfile, progress, quiet, table, facility, noserver);
 
@@ -958,6 +1364,8 @@ void logStop(void)
         delete logThread;
         logThread = NULL;
     }
+
+    LoggingItem::freePool();
 }
 
 /// \brief  Register the current thread with the given name.  This is triggered
@@ -969,15 +1377,13 @@ void loggingRegisterThread(const QString &name)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
                                             __LINE__, (LogLevel_t)LOG_DEBUG,
                                             kRegistering);
     if (item)
     {
         item->setThreadName((char *)name.toLocal8Bit().constData());
-        logQueue.enqueue(item);
+        logEnqueue(item, true);
     }
 }
 
@@ -988,13 +1394,11 @@ void loggingDeregisterThread(void)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
                                             (LogLevel_t)LOG_DEBUG,
                                             kDeregistering);
     if (item)
-        logQueue.enqueue(item);
+        logEnqueue(item, true);
 }
 
 
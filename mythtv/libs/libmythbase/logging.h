@@ -3,11 +3,15 @@
 
 #include <QMutexLocker>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QQueue>
 #include <QTime>
 #include <QPointer>
+#include <QByteArray>
+#include <QList>
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -30,6 +34,14 @@ namespace nzmqt {
 }
 
 #define LOGLINE_MAX (2048-120)
+#define LOGSOURCE_MAX 255       ///< Longest file or function name kept
+
+#define LOGQUEUE_SIZE    4096   ///< Slots in the logging queue, power of 2
+#define LOGQUEUE_BATCH   64     ///< Items handled per logger thread wakeup
+#define LOGPOOL_PREALLOC 256    ///< LoggingItems allocated by logStart()
+
+#define LOGITEM_MAGIC    0xB1   ///< First byte of a binary LoggingItem
+#define LOGITEM_VERSION  1      ///< Binary LoggingItem layout version
 
 class QString;
 class MSqlQuery;
@@ -88,8 +100,12 @@ class LoggingItem: public QObject, public ReferenceCounter
     static LoggingItem *create(const char *, const char *, int, LogLevel_t,
                                LoggingType);
     static LoggingItem *create(QByteArray &buf);
+    static void preallocate(int count);
+    static void freePool(void);
     QByteArray toByteArray(void);
 
+    virtual int DecrRef(void);
+
     int                 pid() const         { return m_pid; };
     qlonglong           tid() const         { return m_tid; };
     qulonglong          threadId() const    { return m_threadId; };
@@ -121,13 +137,25 @@ class LoggingItem: public QObject, public ReferenceCounter
     void setFunction(const QString &val)
             { m_function = strdup(val.toLocal8Bit().constData()); };
     void setThreadName(const QString &val)
-            { m_threadName = strdup(val.toLocal8Bit().constData()); };
+    {
+        free(m_threadName);
+        m_threadName = strdup(val.toLocal8Bit().constData());
+    };
     void setAppName(const QString &val)
-            { m_appName = strdup(val.toLocal8Bit().constData()); };
+    {
+        free((void *)m_appName);
+        m_appName = strdup(val.toLocal8Bit().constData());
+    };
     void setTable(const QString &val)
-            { m_table = strdup(val.toLocal8Bit().constData()); };
+    {
+        free((void *)m_table);
+        m_table = strdup(val.toLocal8Bit().constData());
+    };
     void setLogFile(const QString &val)
-            { m_logFile = strdup(val.toLocal8Bit().constData()); };
+    {
+        free((void *)m_logFile);
+        m_logFile = strdup(val.toLocal8Bit().constData());
+    };
     void setMessage(const QString &val)        
     {
         strncpy(m_message, val.toLocal8Bit().constData(), LOGLINE_MAX);
@@ -159,12 +187,49 @@ class LoggingItem: public QObject, public ReferenceCounter
     const char         *m_table;
     const char         *m_logFile;
     char                m_message[LOGLINE_MAX+1];
+    char                m_fileBuf[LOGSOURCE_MAX+1];
+    char                m_functionBuf[LOGSOURCE_MAX+1];
+    bool                m_pooled;   ///< Created by LOG(): m_file and
+                                    ///  m_function point at copies of the
+                                    ///  caller's __FILE__ and __FUNCTION__
+                                    ///  in m_fileBuf and m_functionBuf, and
+                                    ///  the item is recycled, not deleted
 
   private:
     LoggingItem();
     LoggingItem(const char *_file, const char *_function,
                 int _line, LogLevel_t _level, LoggingType _type);
     ~LoggingItem();
+    void init(const char *_file, const char *_function,
+              int _line, LogLevel_t _level, LoggingType _type);
+    void freeStrings(void);
+    static LoggingItem *createFromBinary(const QByteArray &buf);
+};
+
+/// \brief Bounded lock-free queue of LoggingItem pointers.  Any number of
+///        threads may push and pop concurrently.  A full queue refuses new
+///        items rather than blocking the caller.
+class LoggingQueue
+{
+  public:
+    explicit LoggingQueue(uint size);
+    ~LoggingQueue();
+
+    bool push(LoggingItem *item);
+    LoggingItem *pop(void);
+    bool isEmpty(void);
+
+  private:
+    struct Cell
+    {
+        QAtomicInt   seq;
+        LoggingItem *item;
+    };
+
+    Cell       *m_cells;
+    uint        m_mask;
+    QAtomicInt  m_head;     ///< Next position to pop
+    QAtomicInt  m_tail;     ///< Next position to push
 };
 
 /// \brief The logging thread that consumes the logging queue and dispatches
@@ -182,7 +247,9 @@ class LoggerThread : public QObject, public MThread
     void run(void);
     void stop(void);
     bool flush(int timeoutMS = 200000);
+    void wake(void);
     void handleItem(LoggingItem *item);
+    void sendBatch(void);
     void fillItem(LoggingItem *item);
   private:
     QWaitCondition *m_waitNotEmpty; ///< Condition variable for waiting
@@ -215,8 +282,16 @@ class LoggerThread : public QObject, public MThread
 
     bool m_noserver;
 
+    QList<QByteArray> m_batch;  ///< Encoded items waiting to be sent to
+                                ///  mythlogserver as one multipart message
+
+    int       m_droppedPending; ///< Dropped messages not yet reported
+    qlonglong m_droppedTotal;   ///< Dropped messages since startup
+    QTime     m_droppedTimer;   ///< Time since the last drop report
+
   protected:
     bool logConsole(LoggingItem *item);
+    void reportDropped(void);
     void launchLogServer(void);
     void pingLogServer(void);
 
@@ -11,6 +11,7 @@
 #include <QMap>
 #include <QRegExp>
 #include <QSocketNotifier>
+#include <QTimer>
 #include <iostream>
 
 using namespace std;
@@ -18,6 +19,7 @@ using namespace std;
 #include "mythlogging.h"
 #include "logging.h"
 #include "loggingserver.h"
+#include "logstore.h"
 #include "mythdb.h"
 #include "mythcorecontext.h"
 #include "mythsignalingtimer.h"
@@ -416,6 +418,7 @@ bool SyslogLogger::setupZMQSocket(void)
 #endif
 
 const int DatabaseLogger::kMinDisabledTime = 1000;
+const int DatabaseLogger::kMaxBatchRows = 100;
 
 /// \brief DatabaseLogger constructor
 /// \param table C-string of the database table to log to
@@ -423,12 +426,12 @@ DatabaseLogger::DatabaseLogger(const char *table) :
     LoggerBase(table), m_opened(false), m_loggingTableExists(false),
     m_zmqSock(NULL)
 {
+    // The VALUES rows are added by prepare()
     m_query = QString(
         "INSERT INTO %1 "
         "    (host, application, pid, tid, thread, filename, "
         "     line, function, msgtime, level, message) "
-        "VALUES (:HOST, :APP, :PID, :TID, :THREAD, :FILENAME, "
-        "        :LINE, :FUNCTION, :MSGTIME, :LEVEL, :MESSAGE)")
+        "VALUES ")
         .arg(m_handle);
 
     LOG(VB_GENERAL, LOG_INFO, QString("Added database logging to table %1")
@@ -562,27 +565,36 @@ bool DatabaseLogger::setupZMQSocket(void)
 /// \brief Actually insert a log message from the queue into the database
 /// \param query    The database insert query to use
 /// \param item     LoggingItem containing the log message to insert
-bool DatabaseLogger::logqmsg(MSqlQuery &query, LoggingItem *item)
+bool DatabaseLogger::logqmsg(MSqlQuery &query,
+                             const QList<LoggingItem *> &items)
 {
     char        timestamp[TIMESTAMP_MAX];
+    QString     host = gCoreContext->GetHostName();
 
-    time_t epoch = item->epoch();
-    struct tm tm;
-    localtime_r(&epoch, &tm);
-
-    strftime(timestamp, TIMESTAMP_MAX-8, "%Y-%m-%d %H:%M:%S",
-             (const struct tm *)&tm);
-
-    query.bindValue(":TID",         item->tid());
-    query.bindValue(":THREAD",      item->threadName());
-    query.bindValue(":FILENAME",    item->file());
-    query.bindValue(":LINE",        item->line());
-    query.bindValue(":FUNCTION",    item->function());
-    query.bindValue(":MSGTIME",     timestamp);
-    query.bindValue(":LEVEL",       item->level());
-    query.bindValue(":MESSAGE",     item->message());
-    query.bindValue(":APP",         item->appName());
-    query.bindValue(":PID",         item->pid());
+    for (int i = 0; i < items.size(); i++)
+    {
+        LoggingItem *item = items.at(i);
+        QString row = QString::number(i);
+
+        time_t epoch = item->epoch();
+        struct tm tm;
+        localtime_r(&epoch, &tm);
+
+        strftime(timestamp, TIMESTAMP_MAX-8, "%Y-%m-%d %H:%M:%S",
+                 (const struct tm *)&tm);
+
+        query.bindValue(":HOST"     + row, host);
+        query.bindValue(":TID"      + row, item->tid());
+        query.bindValue(":THREAD"   + row, item->threadName());
+        query.bindValue(":FILENAME" + row, item->file());
+        query.bindValue(":LINE"     + row, item->line());
+        query.bindValue(":FUNCTION" + row, item->function());
+        query.bindValue(":MSGTIME"  + row, timestamp);
+        query.bindValue(":LEVEL"    + row, item->level());
+        query.bindValue(":MESSAGE"  + row, item->message());
+        query.bindValue(":APP"      + row, item->appName());
+        query.bindValue(":PID"      + row, item->pid());
+    }
 
     if (!query.exec())
     {
@@ -603,12 +615,22 @@ bool DatabaseLogger::logqmsg(MSqlQuery &query, LoggingItem *item)
     return true;
 }
 
-/// \brief Prepare the database query for use, and bind constant values to it.
+/// \brief Prepare the database query for use.  Each row of the INSERT gets
+///        its own set of placeholders, suffixed with the row number.
 /// \param query    The database query to prepare
-void DatabaseLogger::prepare(MSqlQuery &query)
+/// \param rows     Number of log messages the query will insert
+void DatabaseLogger::prepare(MSqlQuery &query, int rows)
 {
-    query.prepare(m_query);
-    query.bindValue(":HOST", gCoreContext->GetHostName());
+    QStringList values;
+
+    for (int i = 0; i < rows; i++)
+    {
+        values << QString("(:HOST%1, :APP%1, :PID%1, :TID%1, :THREAD%1, "
+                          " :FILENAME%1, :LINE%1, :FUNCTION%1, :MSGTIME%1, "
+                          " :LEVEL%1, :MESSAGE%1)").arg(i);
+    }
+
+    query.prepare(m_query + values.join(", "));
 }
 
 /// \brief Check if the database is ready for use
@@ -659,6 +681,116 @@ bool DatabaseLogger::tableExists(const QString &table)
 }
 
 
+/// \brief LogStoreLogger constructor
+/// \param path Directory of the log store
+LogStoreLogger::LogStoreLogger(const char *path) :
+    LoggerBase(path), m_store(new LogStore(QString::fromLocal8Bit(path))),
+    m_flushTimer(new QTimer(this)), m_zmqSock(NULL)
+{
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flushTimerExpired()));
+    m_flushTimer->start(LogStore::kFlushSecs * 1000);
+
+    LOG(VB_GENERAL, LOG_INFO, QString("Added logging to the log store in %1")
+        .arg(path));
+}
+
+/// \brief LogStoreLogger deconstructor, writes out the last block
+LogStoreLogger::~LogStoreLogger()
+{
+    LOG(VB_GENERAL, LOG_INFO, QString("Removed logging to the log store in %1")
+        .arg(m_handle));
+
+    m_flushTimer->stop();
+    delete m_store;
+    m_store = NULL;
+
+#ifndef NOLOGSERVER
+    m_zmqSock->unsubscribeFrom(QByteArray(""));
+    m_zmqSock->setLinger(0);
+    m_zmqSock->disconnect(this);
+    m_zmqSock->close();
+    m_zmqSock->deleteLater();
+#endif
+}
+
+LogStoreLogger *LogStoreLogger::create(QString path, QMutex *mutex)
+{
+    QByteArray ba = path.toLocal8Bit();
+    LogStoreLogger *logger =
+        dynamic_cast<LogStoreLogger *>(loggerMap.value(path, NULL));
+
+    if (logger)
+        return logger;
+
+    // Need to add a new LogStoreLogger
+    mutex->unlock();
+    // inserts into loggerMap
+    logger = new LogStoreLogger(ba.constData());
+    mutex->lock();
+
+    if (!logger->setupZMQSocket())
+    {
+        delete logger;
+        return NULL;
+    }
+
+    ClientList *clients = new ClientList;
+    logRevClientMap.insert(logger, clients);
+    return logger;
+}
+
+/// \brief Write out the buffered messages on a SIGHUP, the next block
+///        reopens the segment
+void LogStoreLogger::reopen(void)
+{
+    m_store->Reopen();
+}
+
+/// \brief Process a log message, adding it to the block being collected
+/// \param item LoggingItem containing the log message to process
+bool LogStoreLogger::logmsg(LoggingItem *item)
+{
+    if (item->rawMessage()[0] == '\0')
+        return false;
+
+    m_store->Append(item);
+    if (m_store->NeedsFlush())
+        m_store->Flush();
+    return true;
+}
+
+/// \brief Write out a block that has waited long enough for more messages
+void LogStoreLogger::flushTimerExpired(void)
+{
+    if (m_store->NeedsFlush())
+        m_store->Flush();
+}
+
+bool LogStoreLogger::setupZMQSocket(void)
+{
+#ifndef NOLOGSERVER
+    try
+    {
+        nzmqt::ZMQContext *ctx = logForwardThread->getZMQContext();
+        m_zmqSock = ctx->createSocket(nzmqt::ZMQSocket::TYP_SUB, this);
+        connect(m_zmqSock, SIGNAL(messageReceived(const QList<QByteArray>&)),
+                this, SLOT(receivedMessage(const QList<QByteArray>&)),
+                Qt::QueuedConnection);
+        m_zmqSock->subscribeTo(QByteArray(""));
+        m_zmqSock->connectTo("inproc://loggers");
+    }
+    catch (nzmqt::ZMQException &e)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Exception during socket setup: %1")
+            .arg(e.what()));
+        m_zmqSock = NULL;
+        return false;
+    }
+#endif
+    return true;
+}
+
+
 /// \brief DBLoggerThread constructor
 /// \param logger DatabaseLogger instance that this thread belongs to
 DBLoggerThread::DBLoggerThread(DatabaseLogger *logger) :
@@ -707,7 +839,8 @@ void DBLoggerThread::run(void)
         // shutdown occurs correctly as otherwise the connection appears still
         // in use, and we get a qWarning on shutdown.
         MSqlQuery *query = new MSqlQuery(MSqlQuery::InitCon());
-        m_logger->prepare(*query);
+        int preparedRows = 0;
+        QList<LoggingItem *> batch;
 
         QMutexLocker qLock(&m_queueMutex);
         while (!m_aborted || !m_queue->isEmpty())
@@ -718,28 +851,47 @@ void DBLoggerThread::run(void)
                 continue;
             }
 
-            LoggingItem *item = m_queue->dequeue();
-            if (!item)
+            // Write everything that has queued up (to a limit) with a single
+            // INSERT rather than making a round trip per message.
+            while (!m_queue->isEmpty() &&
+                   batch.size() < DatabaseLogger::kMaxBatchRows)
+            {
+                LoggingItem *item = m_queue->dequeue();
+                if (!item)
+                    continue;
+
+                if (item->rawMessage()[0] == '\0')
+                    item->DecrRef();
+                else
+                    batch.append(item);
+            }
+
+            if (batch.isEmpty())
                 continue;
 
-            if (item->message()[0] != '\0')
+            qLock.unlock();
+            if (preparedRows != batch.size())
             {
-                qLock.unlock();
-                bool logged = m_logger->logqmsg(*query, item);
-                qLock.relock();
+                m_logger->prepare(*query, batch.size());
+                preparedRows = batch.size();
+            }
+            bool logged = m_logger->logqmsg(*query, batch);
+            qLock.relock();
 
-                if (!logged)
-                {
-                    m_queue->prepend(item);
-                    m_wait->wait(qLock.mutex(), 100);
-                    delete query;
-                    query = new MSqlQuery(MSqlQuery::InitCon());
-                    m_logger->prepare(*query);
-                    continue;
-                }
+            if (!logged)
+            {
+                // Requeue in the original order and retry on a new query
+                while (!batch.isEmpty())
+                    m_queue->prepend(batch.takeLast());
+                m_wait->wait(qLock.mutex(), 100);
+                delete query;
+                query = new MSqlQuery(MSqlQuery::InitCon());
+                preparedRows = 0;
+                continue;
             }
 
-            item->DecrRef();
+            while (!batch.isEmpty())
+                batch.takeFirst()->DecrRef();
         }
 
         delete query;
@@ -1056,10 +1208,16 @@ void FileLogger::receivedMessage(const QList<QByteArray> &msg)
     }
 #endif
 
-    QByteArray json     = msg.at(1);
-    LoggingItem *item   = LoggingItem::create(json);
-    logmsg(item);
-    item->DecrRef();
+    // Each remaining part is one LoggingItem
+    for (int i = 1; i < msg.size(); i++)
+    {
+        QByteArray buf      = msg.at(i);
+        LoggingItem *item   = LoggingItem::create(buf);
+        if (!item)
+            continue;
+        logmsg(item);
+        item->DecrRef();
+    }
 }
 
 #ifndef _WIN32
@@ -1079,10 +1237,16 @@ void SyslogLogger::receivedMessage(const QList<QByteArray> &msg)
     }
 #endif
 
-    QByteArray json     = msg.at(1);
-    LoggingItem *item   = LoggingItem::create(json);
-    logmsg(item);
-    item->DecrRef();
+    // Each remaining part is one LoggingItem
+    for (int i = 1; i < msg.size(); i++)
+    {
+        QByteArray buf      = msg.at(i);
+        LoggingItem *item   = LoggingItem::create(buf);
+        if (!item)
+            continue;
+        logmsg(item);
+        item->DecrRef();
+    }
 }
 
 #else
@@ -1112,13 +1276,47 @@ void DatabaseLogger::receivedMessage(const QList<QByteArray> &msg)
     }
 #endif
 
-    QByteArray json     = msg.at(1);
-    LoggingItem *item   = LoggingItem::create(json);
-    logmsg(item);
-    item->DecrRef();
+    // Each remaining part is one LoggingItem
+    for (int i = 1; i < msg.size(); i++)
+    {
+        QByteArray buf      = msg.at(i);
+        LoggingItem *item   = LoggingItem::create(buf);
+        if (!item)
+            continue;
+        logmsg(item);
+        item->DecrRef();
+    }
 }
 
 
+void LogStoreLogger::receivedMessage(const QList<QByteArray> &msg)
+{
+#ifndef NOLOGSERVER
+    // Filter on the clientId
+    QByteArray clientBa = msg.first();
+    QString clientId = QString(clientBa.toHex());
+
+    {
+        QMutexLocker locker(&logRevClientMapMutex);
+
+        ClientList *clients = logRevClientMap.value(this, NULL);
+        if (!clients || !clients->contains(clientId))
+            return;
+    }
+#endif
+
+    // Each remaining part is one LoggingItem
+    for (int i = 1; i < msg.size(); i++)
+    {
+        QByteArray buf      = msg.at(i);
+        LoggingItem *item   = LoggingItem::create(buf);
+        if (!item)
+            continue;
+        logmsg(item);
+        item->DecrRef();
+    }
+}
+
 /// \brief LogForwardThread constructor.
 LogForwardThread::LogForwardThread() :
     MThread("LogForward"), m_aborted(false), m_zmqContext(NULL),
@@ -1334,6 +1532,7 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
     QByteArray clientBa = msg->first();
     QString clientId = QString(clientBa.toHex());
 
+    // The remaining sections are LoggingItems, all from the same client
     QByteArray json     = msg->at(1);
 
     if (json.size() == 0)
@@ -1366,6 +1565,13 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
     else
     {
         LoggingItem *item = LoggingItem::create(json);
+        if (!item)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Unreadable log message from client %1")
+                .arg(clientId));
+            return;
+        }
 
         logClientCount.ref();
         LOG(VB_GENERAL, LOG_INFO, QString("New Client: %1 (#%2)")
@@ -1436,6 +1642,22 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
                 loggers->insert(0, logger);
         }
 
+        // LogStoreLogger for every client logging to a file or the
+        // database, it is what Myth/GetLogs searches on this host
+        if (!logfile.isEmpty() || !table.isEmpty())
+        {
+            logger = LogStoreLogger::create(LogStore::DefaultPath(),
+                                            lock2.mutex());
+
+            ClientList *clients = logRevClientMap.value(logger);
+
+            if (clients)
+                clients->insert(0, clientId);
+
+            if (logger && loggers)
+                loggers->insert(0, logger);
+        }
+
         logItem = new LoggerListItem;
         loggingGetTimeStamp(&logItem->epoch, NULL);
         logItem->list = loggers;
@@ -1449,15 +1671,20 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
 #else
     if (logItem && logItem->list && !logItem->list->isEmpty())
     {
-        LoggerList::iterator it = logItem->list->begin();
-        LoggingItem *item = LoggingItem::create(json);
-        if (!item)
-            return;
-        for (; it != logItem->list->end(); ++it)
+        for (int i = 1; i < msg->size(); i++)
         {
-            (*it)->logmsg(item);
+            QByteArray buf = msg->at(i);
+            LoggingItem *item = LoggingItem::create(buf);
+            if (!item)
+                continue;
+
+            LoggerList::iterator it = logItem->list->begin();
+            for (; it != logItem->list->end(); ++it)
+            {
+                (*it)->logmsg(item);
+            }
+            item->DecrRef();
         }
-        item->DecrRef();
     }
 #endif
 }
@@ -120,14 +120,14 @@ class DatabaseLogger : public LoggerBase
   protected:
     bool setupZMQSocket(void);
   protected:
-    bool logqmsg(MSqlQuery &query, LoggingItem *item);
-    void prepare(MSqlQuery &query);
+    bool logqmsg(MSqlQuery &query, const QList<LoggingItem *> &items);
+    void prepare(MSqlQuery &query, int rows = 1);
   private:
     bool isDatabaseReady(void);
     bool tableExists(const QString &table);
 
     DBLoggerThread *m_thread;   ///< The database queue handling thread
-    QString m_query;            ///< The database query to insert log messages
+    QString m_query;            ///< Start of the query to insert log messages
     bool m_opened;              ///< The database is opened
     bool m_loggingTableExists;  ///< The desired logging table exists
     bool m_disabled;            ///< DB logging is temporarily disabled
@@ -135,11 +135,38 @@ class DatabaseLogger : public LoggerBase
     QTime m_errorLoggingTime;   ///< Time when DB error logging was last done
     static const int kMinDisabledTime; ///< Minimum time to disable DB logging
                                        ///  (in ms)
+    static const int kMaxBatchRows;    ///< Most log messages written by one
+                                       ///  INSERT
     nzmqt::ZMQSocket *m_zmqSock;  ///< ZeroMQ feeding socket
   protected slots:
     void receivedMessage(const QList<QByteArray>&);
 };
 
+class LogStore;
+class QTimer;
+
+/// \brief Log store logger - appends to the local compressed LogStore
+class LogStoreLogger : public LoggerBase
+{
+    Q_OBJECT
+
+  public:
+    LogStoreLogger(const char *path);
+    ~LogStoreLogger();
+    bool logmsg(LoggingItem *item);
+    void reopen(void);
+    static LogStoreLogger *create(QString path, QMutex *mutex);
+  protected:
+    bool setupZMQSocket(void);
+  private:
+    LogStore *m_store;            ///< The store written to
+    QTimer *m_flushTimer;         ///< Writes out blocks when logging is quiet
+    nzmqt::ZMQSocket *m_zmqSock;  ///< ZeroMQ feeding socket
+  protected slots:
+    void receivedMessage(const QList<QByteArray>&);
+    void flushTimerExpired(void);
+};
+
 typedef QList<QByteArray> LogMessage;
 typedef QList<LogMessage *> LogMessageList;
 
@@ -153,6 +180,7 @@ class LogServerThread : public QObject, public MThread
     friend class FileLogger;
     friend class SyslogLogger;
     friend class DatabaseLogger;
+    friend class LogStoreLogger;
 
   public:
     LogServerThread();
@@ -0,0 +1,772 @@
+#include <QtAlgorithms>
+#include <QDataStream>
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <QDir>
+
+#include <time.h>
+
+#include "logstore.h"
+#include "logging.h"
+#include "mythdirs.h"
+#include "mythlogging.h"
+#include "mythcorecontext.h"
+
+#define LOC QString("LogStore(%1): ").arg(m_path)
+
+const int LogStore::kBlockRows  = 1024;
+const int LogStore::kFlushSecs  = 2;
+const int LogStore::kMaxAgeDays = 14;
+
+static const quint32 kBlockMagic   = 0x4d4c5342; // "MLSB"
+static const quint8  kBlockVersion = 1;
+/// Magic, version, rows, first and last time, level mask and payload size
+static const qint64  kHeaderSize   = 4 + 1 + 4 + 8 + 8 + 4 + 4;
+
+/// The columns of a block, in the order they are stored
+enum LogStoreColumn
+{
+    kColTime = 0,       ///< Seconds after the block's first row and usec
+    kColLevel,
+    kColApplication,    ///< Dictionary
+    kColPid,
+    kColTid,
+    kColThread,         ///< Dictionary
+    kColFile,           ///< Dictionary
+    kColLine,
+    kColFunction,       ///< Dictionary
+    kColMessage,
+    kColCount
+};
+
+/// Bit of a level in a block's level mask, LOG_ANY gets the top one
+static inline quint32 levelBit(int level)
+{
+    return (level >= 0 && level < 31) ? (1U << level) : (1U << 31);
+}
+
+static inline void setupStream(QDataStream &ds)
+{
+    ds.setVersion(QDataStream::Qt_4_6);
+    ds.setByteOrder(QDataStream::LittleEndian);
+}
+
+static QByteArray compressColumn(const QByteArray &raw)
+{
+    return qCompress(raw, 6);
+}
+
+/// \brief Serialize a string column as a dictionary of the distinct values
+///        followed by the index of each row's value in it.
+static QByteArray dictColumn(const QStringList &values)
+{
+    QByteArray raw;
+    QDataStream ds(&raw, QIODevice::WriteOnly);
+    setupStream(ds);
+
+    QHash<QString, int> index;
+    QVector<quint16> rows(values.size());
+    QList<QByteArray> dict;
+
+    for (int i = 0; i < values.size(); i++)
+    {
+        QHash<QString, int>::const_iterator it = index.find(values[i]);
+        if (it == index.end())
+        {
+            it = index.insert(values[i], dict.size());
+            dict.append(values[i].toUtf8());
+        }
+        rows[i] = *it;
+    }
+
+    ds << (quint32)dict.size();
+    for (int i = 0; i < dict.size(); i++)
+        ds << dict[i];
+    for (int i = 0; i < rows.size(); i++)
+        ds << rows[i];
+
+    return compressColumn(raw);
+}
+
+/// \brief Read back a column written by dictColumn()
+static bool readDictColumn(const QByteArray &column, uint rows,
+                           QStringList &dict, QVector<quint16> &index)
+{
+    QByteArray raw = qUncompress(column);
+    QDataStream ds(raw);
+    setupStream(ds);
+
+    quint32 count;
+    ds >> count;
+    if (ds.status() != QDataStream::Ok || count > rows)
+        return false;
+
+    dict.clear();
+    for (uint i = 0; i < count; i++)
+    {
+        QByteArray value;
+        ds >> value;
+        dict.append(QString::fromUtf8(value.constData(), value.size()));
+    }
+
+    index.resize(rows);
+    for (uint i = 0; i < rows; i++)
+    {
+        ds >> index[i];
+        if (index[i] >= count)
+            return false;
+    }
+
+    return ds.status() == QDataStream::Ok;
+}
+
+/// \brief Read just the dictionary of a column written by dictColumn()
+static void readDictionary(const QByteArray &column, QStringList &dict)
+{
+    QByteArray raw = qUncompress(column);
+    QDataStream ds(raw);
+    setupStream(ds);
+
+    quint32 count;
+    ds >> count;
+    for (uint i = 0; i < count && ds.status() == QDataStream::Ok; i++)
+    {
+        QByteArray value;
+        ds >> value;
+        dict.append(QString::fromUtf8(value.constData(), value.size()));
+    }
+}
+
+static bool logStoreRowLessThan(const LogStoreRow &a, const LogStoreRow &b)
+{
+    return a.epoch < b.epoch || (a.epoch == b.epoch && a.usec < b.usec);
+}
+
+/// \brief LogStore constructor
+/// \param path       Directory of the store, created if missing
+/// \param maxAgeDays Days of logs to keep, older segments are removed
+LogStore::LogStore(const QString &path, int maxAgeDays) :
+    m_path(path), m_maxAgeDays(maxAgeDays), m_firstBuffered(0)
+{
+    QDir dir;
+    if (!dir.mkpath(m_path))
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to create the directory");
+}
+
+/// \brief LogStore destructor, writes out what is still buffered
+LogStore::~LogStore()
+{
+    Flush();
+    m_file.close();
+}
+
+/// \brief The store mythlogserver writes for the local host.  This is the
+///        LogStorePath setting, as the backend reading the store may run as
+///        another user, with another configuration directory.
+QString LogStore::DefaultPath(void)
+{
+    QString path;
+    if (gCoreContext)
+        path = gCoreContext->GetSetting("LogStorePath");
+    if (path.isEmpty())
+        path = GetConfDir() + "/logstore";
+    return path;
+}
+
+/// \brief Save the path of this host's store in the LogStorePath setting,
+///        unless it is already set, so the other programs find it.  This is
+///        called by mythlogserver before it writes the store.
+void LogStore::PublishPath(void)
+{
+    if (gCoreContext && gCoreContext->GetSetting("LogStorePath").isEmpty())
+        gCoreContext->SaveSetting("LogStorePath", DefaultPath());
+}
+
+/// \brief Add a log message to the block being collected.  The block is
+///        only written by Flush(), once NeedsFlush() says so.
+void LogStore::Append(const LoggingItem *item)
+{
+    if (m_epoch.isEmpty())
+        m_firstBuffered = time(NULL);
+
+    m_epoch.append(item->epoch());
+    m_usec.append(item->usec());
+    m_level.append(item->level());
+    m_application.append(QString::fromUtf8(item->rawAppName()));
+    m_pid.append(item->pid());
+    m_tid.append(item->tid());
+    m_thread.append(QString::fromUtf8(item->rawThreadName()));
+    m_fileName.append(QString::fromUtf8(item->rawFile()));
+    m_line.append(item->line());
+    m_function.append(QString::fromUtf8(item->rawFunction()));
+    m_message.append(QString::fromUtf8(item->rawMessage()));
+}
+
+/// \brief Whether the block being collected is full, or its oldest
+///        message has waited long enough
+bool LogStore::NeedsFlush(void) const
+{
+    if (m_epoch.isEmpty())
+        return false;
+
+    return m_epoch.size() >= kBlockRows ||
+           time(NULL) - m_firstBuffered >= kFlushSecs;
+}
+
+/// \brief Write the collected messages as one block to the segment of the
+///        day of the first of them.
+void LogStore::Flush(void)
+{
+    if (m_epoch.isEmpty())
+        return;
+
+    QDate day = QDateTime::fromTime_t(m_epoch.first()).date();
+    if ((day != m_day || !m_file.isOpen()) && !OpenSegment(day))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Dropping %1 log messages").arg(m_epoch.size()));
+    }
+    else
+    {
+        qlonglong first = m_epoch.first();
+        qlonglong last  = first;
+        quint32 levels  = 0;
+
+        QByteArray columns[kColCount];
+        {
+            QByteArray times, level, pid, tid, line, message;
+            QDataStream dsTime(&times, QIODevice::WriteOnly);
+            QDataStream dsLevel(&level, QIODevice::WriteOnly);
+            QDataStream dsPid(&pid, QIODevice::WriteOnly);
+            QDataStream dsTid(&tid, QIODevice::WriteOnly);
+            QDataStream dsLine(&line, QIODevice::WriteOnly);
+            QDataStream dsMessage(&message, QIODevice::WriteOnly);
+            setupStream(dsTime);
+            setupStream(dsLevel);
+            setupStream(dsPid);
+            setupStream(dsTid);
+            setupStream(dsLine);
+            setupStream(dsMessage);
+
+            for (int i = 0; i < m_epoch.size(); i++)
+            {
+                // Messages from several clients may be a little out of order
+                first  = qMin(first, m_epoch[i]);
+                last   = qMax(last, m_epoch[i]);
+                levels |= levelBit(m_level[i]);
+            }
+
+            for (int i = 0; i < m_epoch.size(); i++)
+            {
+                dsTime    << (quint32)(m_epoch[i] - first)
+                          << (quint32)m_usec[i];
+                dsLevel   << (qint8)m_level[i];
+                dsPid     << (qint32)m_pid[i];
+                dsTid     << (qint64)m_tid[i];
+                dsLine    << (qint32)m_line[i];
+                dsMessage << m_message[i].toUtf8();
+            }
+
+            columns[kColTime]        = compressColumn(times);
+            columns[kColLevel]       = compressColumn(level);
+            columns[kColApplication] = dictColumn(m_application);
+            columns[kColPid]         = compressColumn(pid);
+            columns[kColTid]         = compressColumn(tid);
+            columns[kColThread]      = dictColumn(m_thread);
+            columns[kColFile]        = dictColumn(m_fileName);
+            columns[kColLine]        = compressColumn(line);
+            columns[kColFunction]    = dictColumn(m_function);
+            columns[kColMessage]     = compressColumn(message);
+        }
+
+        QByteArray payload;
+        QDataStream dsPayload(&payload, QIODevice::WriteOnly);
+        setupStream(dsPayload);
+        for (int i = 0; i < kColCount; i++)
+            dsPayload << columns[i];
+
+        QByteArray block;
+        QDataStream ds(&block, QIODevice::WriteOnly);
+        setupStream(ds);
+        ds << kBlockMagic << kBlockVersion << (quint32)m_epoch.size()
+           << (qint64)first << (qint64)last << levels
+           << (quint32)payload.size();
+        block.append(payload);
+
+        // One write, so readers never see part of a block
+        if (m_file.write(block) != block.size() || !m_file.flush())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Write failed " + ENO);
+            m_file.close();
+        }
+    }
+
+    m_epoch.clear();
+    m_usec.clear();
+    m_level.clear();
+    m_application.clear();
+    m_pid.clear();
+    m_tid.clear();
+    m_thread.clear();
+    m_fileName.clear();
+    m_line.clear();
+    m_function.clear();
+    m_message.clear();
+}
+
+/// \brief Write out what is buffered and reopen the segment after a SIGHUP
+void LogStore::Reopen(void)
+{
+    Flush();
+    m_file.close();
+}
+
+/// \brief Open the segment of the given day for appending.  A block left
+///        incomplete by a crash is cut off first, otherwise it would hide
+///        everything written after it.
+bool LogStore::OpenSegment(const QDate &day)
+{
+    m_file.close();
+    m_file.setFileName(QString("%1/%2.mls").arg(m_path)
+                       .arg(day.toString("yyyyMMdd")));
+    m_day = day;
+
+    if (!m_file.open(QIODevice::ReadWrite))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to open %1").arg(m_file.fileName()));
+        return false;
+    }
+
+    QDataStream ds(&m_file);
+    setupStream(ds);
+
+    qint64 end = 0;
+    qint64 size = m_file.size();
+    while (end + kHeaderSize <= size)
+    {
+        quint32 magic, rows, levels, length;
+        quint8 version;
+        qint64 first, last;
+
+        m_file.seek(end);
+        ds >> magic >> version >> rows >> first >> last >> levels >> length;
+        if (magic != kBlockMagic || end + kHeaderSize + length > size)
+            break;
+        end += kHeaderSize + length;
+    }
+
+    if (end != size)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Dropping %1 bytes of an incomplete block from %2")
+            .arg(size - end).arg(m_file.fileName()));
+        m_file.resize(end);
+    }
+    m_file.seek(end);
+
+    Prune();
+    return true;
+}
+
+/// \brief Remove the segments older than the configured age
+void LogStore::Prune(void)
+{
+    QDate oldest = QDate::currentDate().addDays(-m_maxAgeDays);
+    QDir dir(m_path);
+    QStringList segments = dir.entryList(QStringList("*.mls"), QDir::Files);
+
+    for (int i = 0; i < segments.size(); i++)
+    {
+        QDate day = QDate::fromString(segments[i].left(8), "yyyyMMdd");
+        if (day.isValid() && day < oldest && !dir.remove(segments[i]))
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Unable to remove %1").arg(segments[i]));
+        }
+    }
+}
+
+/// \brief Find the log messages of a store matching a filter.
+///
+/// Blocks outside the time range, or holding only less important levels,
+/// are skipped by their header.  In the others the columns are checked
+/// one filter at a time, and a column is only decompressed while some
+/// rows of the block still match.
+///
+/// The segments and their blocks are read newest first.  Once the filter's
+/// limit is reached, the time of the oldest message kept becomes the start
+/// of the time range, so older blocks and segments are skipped as well.
+/// \param path         Directory of the store
+/// \param filter       Which messages to return
+/// \param rows         Receives the matching messages, oldest first
+/// \return false if the store does not exist
+bool LogStore::Query(const QString &path, const LogStoreFilter &filter,
+                     QList<LogStoreRow> &rows)
+{
+    QDir dir(path);
+    if (!dir.exists())
+        return false;
+
+    qlonglong from = filter.from.isValid() ? filter.from.toTime_t() : 0;
+    qlonglong to   = filter.to.isValid() ? filter.to.toTime_t() : -1;
+
+    quint32 levelMask = 0xffffffff;
+    if (filter.level >= 0)
+    {
+        levelMask = levelBit(LOG_ANY);
+        for (int level = 0; level <= filter.level; level++)
+            levelMask |= levelBit(level);
+    }
+
+    // A segment holds the blocks that started on its day, none of them
+    // lasts into the day after the next
+    QDate fromDay = filter.from.isValid() ?
+        QDateTime::fromTime_t(from).date().addDays(-1) : QDate();
+    QDate toDay = filter.to.isValid() ?
+        QDateTime::fromTime_t(to).date() : QDate();
+
+    QStringList segments = dir.entryList(QStringList("*.mls"), QDir::Files,
+                                         QDir::Name);
+    QList<LogStoreRow> found;
+
+    for (int s = segments.size() - 1; s >= 0; s--)
+    {
+        QDate day = QDate::fromString(segments[s].left(8), "yyyyMMdd");
+        if (fromDay.isValid() && day < fromDay)
+            break;
+        if (toDay.isValid() && day > toDay)
+            continue;
+
+        QFile file(dir.filePath(segments[s]));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        QDataStream ds(&file);
+        setupStream(ds);
+
+        // The size when we started, the writer may be appending
+        qint64 size = file.size();
+        qint64 pos  = 0;
+        quint32 magic, count, levels, length;
+        quint8 version;
+        qint64 first, last;
+
+        // Find the blocks first, so they can be read newest first
+        QList<qint64> blocks;
+        while (pos + kHeaderSize <= size)
+        {
+            file.seek(pos);
+            ds >> magic >> version >> count >> first >> last >> levels
+               >> length;
+            if (magic != kBlockMagic || pos + kHeaderSize + length > size)
+                break;
+            blocks.prepend(pos);
+            pos += kHeaderSize + length;
+        }
+
+        for (int b = 0; b < blocks.size(); b++)
+        {
+            file.seek(blocks[b]);
+            ds >> magic >> version >> count >> first >> last >> levels
+               >> length;
+
+            if (version != kBlockVersion || !(levels & levelMask) ||
+                last < from || (to >= 0 && first > to))
+                continue;
+
+            QByteArray columns[kColCount];
+            for (int i = 0; i < kColCount; i++)
+                ds >> columns[i];
+            if (ds.status() != QDataStream::Ok)
+                break;
+
+            // Narrow down the matching rows a column at a time
+            QVector<bool> match(count, true);
+            uint left = count;
+
+            QVector<quint32> secs(count), usecs(count);
+            {
+                QByteArray raw = qUncompress(columns[kColTime]);
+                QDataStream cs(raw);
+                setupStream(cs);
+                for (uint i = 0; i < count; i++)
+                {
+                    cs >> secs[i] >> usecs[i];
+                    qlonglong epoch = first + secs[i];
+                    if (epoch < from || (to >= 0 && epoch > to))
+                    {
+                        match[i] = false;
+                        left--;
+                    }
+                }
+            }
+
+            QVector<qint8> level(count);
+            if (left)
+            {
+                QByteArray raw = qUncompress(columns[kColLevel]);
+                QDataStream cs(raw);
+                setupStream(cs);
+                for (uint i = 0; i < count; i++)
+                {
+                    cs >> level[i];
+                    if (match[i] && filter.level >= 0 &&
+                        level[i] > filter.level)
+                    {
+                        match[i] = false;
+                        left--;
+                    }
+                }
+            }
+
+            QStringList appDict, threadDict, fileDict, funcDict;
+            QVector<quint16> app, thread, fileIdx, func;
+            if (left && !readDictColumn(columns[kColApplication], count,
+                                        appDict, app))
+                left = 0;
+            for (uint i = 0; left && i < count; i++)
+            {
+                if (match[i] && !filter.application.isEmpty() &&
+                    appDict[app[i]] != filter.application)
+                {
+                    match[i] = false;
+                    left--;
+                }
+            }
+
+            QVector<qint32> pid(count);
+            if (left)
+            {
+                QByteArray raw = qUncompress(columns[kColPid]);
+                QDataStream cs(raw);
+                setupStream(cs);
+                for (uint i = 0; i < count; i++)
+                {
+                    cs >> pid[i];
+                    if (match[i] && filter.pid && pid[i] != filter.pid)
+                    {
+                        match[i] = false;
+                        left--;
+                    }
+                }
+            }
+
+            QVector<qint64> tid(count);
+            if (left)
+            {
+                QByteArray raw = qUncompress(columns[kColTid]);
+                QDataStream cs(raw);
+                setupStream(cs);
+                for (uint i = 0; i < count; i++)
+                {
+                    cs >> tid[i];
+                    if (match[i] && filter.tid && tid[i] != filter.tid)
+                    {
+                        match[i] = false;
+                        left--;
+                    }
+                }
+            }
+
+            if (left && !readDictColumn(columns[kColThread], count,
+                                        threadDict, thread))
+                left = 0;
+            for (uint i = 0; left && i < count; i++)
+            {
+                if (match[i] && !filter.thread.isEmpty() &&
+                    threadDict[thread[i]] != filter.thread)
+                {
+                    match[i] = false;
+                    left--;
+                }
+            }
+
+            if (left && !readDictColumn(columns[kColFile], count,
+                                        fileDict, fileIdx))
+                left = 0;
+            for (uint i = 0; left && i < count; i++)
+            {
+                if (match[i] && !filter.file.isEmpty() &&
+                    fileDict[fileIdx[i]] != filter.file)
+                {
+                    match[i] = false;
+                    left--;
+                }
+            }
+
+            QVector<qint32> line(count);
+            if (left)
+            {
+                QByteArray raw = qUncompress(columns[kColLine]);
+                QDataStream cs(raw);
+                setupStream(cs);
+                for (uint i = 0; i < count; i++)
+                {
+                    cs >> line[i];
+                    if (match[i] && filter.line && line[i] != filter.line)
+                    {
+                        match[i] = false;
+                        left--;
+                    }
+                }
+            }
+
+            if (left && !readDictColumn(columns[kColFunction], count,
+                                        funcDict, func))
+                left = 0;
+            for (uint i = 0; left && i < count; i++)
+            {
+                if (match[i] && !filter.function.isEmpty() &&
+                    funcDict[func[i]] != filter.function)
+                {
+                    match[i] = false;
+                    left--;
+                }
+            }
+
+            if (!left)
+                continue;
+
+            QByteArray raw = qUncompress(columns[kColMessage]);
+            QDataStream cs(raw);
+            setupStream(cs);
+            for (uint i = 0; i < count; i++)
+            {
+                QByteArray utf8;
+                cs >> utf8;
+                if (!match[i])
+                    continue;
+
+                QString message = QString::fromUtf8(utf8.constData(),
+                                                    utf8.size());
+                if (!filter.contains.isEmpty() &&
+                    !message.contains(filter.contains, Qt::CaseInsensitive))
+                    continue;
+
+                LogStoreRow row;
+                row.epoch       = first + secs[i];
+                row.usec        = usecs[i];
+                row.level       = level[i];
+                row.application = appDict[app[i]];
+                row.pid         = pid[i];
+                row.tid         = tid[i];
+                row.thread      = threadDict[thread[i]];
+                row.file        = fileDict[fileIdx[i]];
+                row.line        = line[i];
+                row.function    = funcDict[func[i]];
+                row.message     = message;
+                found.append(row);
+            }
+
+            if (filter.limit > 0 && found.size() >= filter.limit)
+            {
+                // Keep the newest rows, nothing older can replace them
+                qStableSort(found.begin(), found.end(), logStoreRowLessThan);
+                found = found.mid(found.size() - filter.limit);
+                from    = found.first().epoch;
+                fromDay = QDateTime::fromTime_t(from).date().addDays(-1);
+            }
+        }
+    }
+
+    // Blocks are in order, the rows within one need not be
+    qStableSort(found.begin(), found.end(), logStoreRowLessThan);
+    if (filter.limit > 0 && found.size() > filter.limit)
+        found = found.mid(found.size() - filter.limit);
+    rows += found;
+
+    return true;
+}
+
+/// \brief When the oldest message of a store was logged
+/// \param path Directory of the store
+/// \return seconds since 1970-01-01 00:00 UTC, -1 if the store is empty
+qlonglong LogStore::Oldest(const QString &path)
+{
+    QDir dir(path);
+    QStringList segments = dir.entryList(QStringList("*.mls"), QDir::Files,
+                                         QDir::Name);
+
+    for (int s = 0; s < segments.size(); s++)
+    {
+        QFile file(dir.filePath(segments[s]));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        QDataStream ds(&file);
+        setupStream(ds);
+
+        // A block's first time is that of its oldest row
+        quint32 magic, count, levels, length;
+        quint8 version;
+        qint64 first, last;
+        ds >> magic >> version >> count >> first >> last >> levels >> length;
+        if (ds.status() == QDataStream::Ok && magic == kBlockMagic &&
+            version == kBlockVersion)
+            return first;
+    }
+
+    return -1;
+}
+
+/// \brief List the applications that have messages in a store.  Only the
+///        application dictionary of each block is decompressed.
+/// \param path Directory of the store
+QStringList LogStore::Applications(const QString &path)
+{
+    QStringList applications;
+    QDir dir(path);
+    QStringList segments = dir.entryList(QStringList("*.mls"), QDir::Files);
+
+    for (int s = 0; s < segments.size(); s++)
+    {
+        QFile file(dir.filePath(segments[s]));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        QDataStream ds(&file);
+        setupStream(ds);
+
+        qint64 size = file.size();
+        qint64 pos  = 0;
+        while (pos + kHeaderSize <= size)
+        {
+            quint32 magic, count, levels, length;
+            quint8 version;
+            qint64 first, last;
+
+            file.seek(pos);
+            ds >> magic >> version >> count >> first >> last >> levels
+               >> length;
+            if (magic != kBlockMagic || pos + kHeaderSize + length > size)
+                break;
+            pos += kHeaderSize + length;
+
+            if (version != kBlockVersion)
+                continue;
+
+            QByteArray columns[kColApplication + 1];
+            for (int i = 0; i <= kColApplication; i++)
+                ds >> columns[i];
+            if (ds.status() != QDataStream::Ok)
+                break;
+
+            QStringList apps;
+            readDictionary(columns[kColApplication], apps);
+            for (int i = 0; i < apps.size(); i++)
+            {
+                if (!applications.contains(apps[i]))
+                    applications.append(apps[i]);
+            }
+        }
+    }
+
+    applications.sort();
+    return applications;
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
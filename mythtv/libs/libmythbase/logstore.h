@@ -0,0 +1,123 @@
+// -*- Mode: c++ -*-
+#ifndef LOGSTORE_H_
+#define LOGSTORE_H_
+
+#include <QStringList>
+#include <QDateTime>
+#include <QString>
+#include <QList>
+#include <QFile>
+
+#include <stdint.h>
+
+#include "mythbaseexp.h"
+
+class LoggingItem;
+
+/// \brief One log message read back from a LogStore
+struct MBASE_PUBLIC LogStoreRow
+{
+    LogStoreRow() : epoch(0), usec(0), level(0), pid(0), tid(0), line(0) {}
+
+    qlonglong epoch;        ///< Seconds since 1970-01-01 00:00 UTC
+    uint      usec;         ///< Microseconds into the second
+    int       level;        ///< LogLevel_t of the message
+    QString   application;
+    int       pid;
+    qlonglong tid;
+    QString   thread;
+    QString   file;
+    int       line;
+    QString   function;
+    QString   message;
+};
+
+/// \brief What LogStore::Query() returns, every field left at its default
+///        matches any message.
+struct MBASE_PUBLIC LogStoreFilter
+{
+    LogStoreFilter() : pid(0), tid(0), line(0), level(-1), limit(0) {}
+
+    QString   application;
+    int       pid;
+    qlonglong tid;
+    QString   thread;
+    QString   file;
+    int       line;
+    QString   function;
+    QDateTime from;
+    QDateTime to;
+    int       level;        ///< Least important level to return, -1 for all
+    QString   contains;     ///< Case insensitive substring of the message
+    int       limit;        ///< Most messages to return, the newest, 0 for all
+};
+
+/// \brief Append only, compressed, columnar store of log messages.
+///
+/// The store is a directory of segment files, one per local day, named
+/// after it (YYYYMMDD.mls).  A segment is a sequence of blocks of up to
+/// kBlockRows messages.  Each block starts with a small header holding
+/// its row count, first and last time stamp and the levels it contains,
+/// so a query skips blocks outside its time range or above its level
+/// without reading them.  The columns follow, each compressed on its own,
+/// the repetitive ones (application, thread, file and function) as a
+/// dictionary plus an index per row.  Only the columns a filter needs are
+/// decompressed before a block is known to have a match.
+///
+/// A block is written in one piece, so a reader sees either all or none
+/// of it and may run while the store is being written.  A block cut short
+/// by a crash is dropped when the segment is next opened for writing.
+class MBASE_PUBLIC LogStore
+{
+  public:
+    LogStore(const QString &path, int maxAgeDays = kMaxAgeDays);
+    ~LogStore();
+
+    void Append(const LoggingItem *item);
+    void Flush(void);
+    bool NeedsFlush(void) const;
+    void Reopen(void);
+
+    QString GetPath(void) const { return m_path; }
+
+    static bool Query(const QString &path, const LogStoreFilter &filter,
+                      QList<LogStoreRow> &rows);
+    static QStringList Applications(const QString &path);
+    static qlonglong Oldest(const QString &path);
+
+    static QString DefaultPath(void);
+    static void PublishPath(void);
+
+    static const int kBlockRows;    ///< Most messages in one block
+    static const int kFlushSecs;    ///< Longest a message waits unwritten
+    static const int kMaxAgeDays;   ///< Segments older than this are removed
+
+  private:
+    bool OpenSegment(const QDate &day);
+    void Prune(void);
+
+    QString   m_path;               ///< Directory holding the segments
+    int       m_maxAgeDays;
+    QFile     m_file;               ///< Segment being appended to
+    QDate     m_day;                ///< Day of m_file
+    qlonglong m_firstBuffered;      ///< When the oldest unwritten row came
+
+    // Columns of the block being collected, see Flush()
+    QList<qlonglong> m_epoch;
+    QList<uint>      m_usec;
+    QList<int>       m_level;
+    QStringList      m_application;
+    QList<int>       m_pid;
+    QList<qlonglong> m_tid;
+    QStringList      m_thread;
+    QStringList      m_fileName;
+    QList<int>       m_line;
+    QStringList      m_function;
+    QStringList      m_message;
+};
+
+#endif
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -1,4 +1,10 @@
 #include <unistd.h>
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
 
 // ANSI C
 #include <cstdlib>
@@ -10,6 +16,9 @@
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
+#include <QSqlResult>
+#include <QElapsedTimer>
+#include <QFileInfo>
 
 // MythTV
 #include "compat.h"
@@ -29,6 +38,23 @@
 
 static const uint kPurgeTimeout = 60 * 60;
 
+// Prepared statements kept per connection
+static const int kStatementCacheSize = 32;
+
+// Distinct call sites to keep execution statistics for
+static const int kMaxQueryStats = 1000;
+
+// Address MSqlQuery::exec() returns to, which identifies the call site
+#if defined(__GNUC__)
+#define QUERY_CALLER() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_ReturnAddress)
+#define QUERY_CALLER() _ReturnAddress()
+#else
+#define QUERY_CALLER() NULL
+#endif
+
 bool TestDatabase(QString dbHostName,
                   QString dbUserName,
                   QString dbPassword,
@@ -70,6 +96,7 @@ bool TestDatabase(QString dbHostName,
 
 MSqlDatabase::MSqlDatabase(const QString &name)
 {
+    m_stmtClock = 0;
     m_name = name;
     m_name.detach();
     m_db = QSqlDatabase::addDatabase("QMYSQL", m_name);
@@ -85,6 +112,8 @@ MSqlDatabase::MSqlDatabase(const QString &name)
 
 MSqlDatabase::~MSqlDatabase()
 {
+    ClearStatementCache();
+
     if (m_db.isOpen())
     {
         m_db.close();
@@ -232,6 +261,7 @@ bool MSqlDatabase::KickDatabase(void)
 
 bool MSqlDatabase::Reconnect()
 {
+    ClearStatementCache();
     m_db.close();
     m_db.open();
 
@@ -253,6 +283,96 @@ void MSqlDatabase::InitSessionVars()
     m_db.exec("SET @@session.sql_mode=''");
 }
 
+/** \brief Hand out a statement this connection has already prepared.
+ *
+ *  QSqlQuery copies share their QSqlResult, so the caller ends up with the
+ *  same server side statement and doesn't have to send the SQL text again.
+ *  \return false if the statement isn't cached or is in use elsewhere.
+ */
+bool MSqlDatabase::BorrowStatement(const QString &sql, QSqlQuery &query)
+{
+    if (!m_db.isOpen())
+    {
+        ClearStatementCache();
+        return false;
+    }
+
+    CachedStatement *stmt = m_stmtCache.value(sql, NULL);
+    if (!stmt || stmt->inUse)
+        return false;
+
+    bool forwardOnly = query.isForwardOnly();
+    query = stmt->query;
+    query.setForwardOnly(forwardOnly);
+
+    // Don't let the previous user's values leak into this execution
+    MSqlBindings bindings = query.boundValues();
+    MSqlBindings::const_iterator it = bindings.begin();
+    for (; it != bindings.end(); ++it)
+        query.bindValue(it.key(), QVariant());
+
+    stmt->inUse = true;
+    stmt->lastUsed = ++m_stmtClock;
+
+    return true;
+}
+
+/** \brief Keep a newly prepared statement for reuse.  The least recently
+ *         used idle statement is dropped when the cache is full.
+ *  \return true if the statement was cached and is now marked in use.
+ */
+bool MSqlDatabase::CacheStatement(const QString &sql, const QSqlQuery &query)
+{
+    if (m_stmtCache.contains(sql))
+        return false;
+
+    if (m_stmtCache.size() >= kStatementCacheSize)
+    {
+        QHash<QString, CachedStatement*>::iterator oldest = m_stmtCache.end();
+        QHash<QString, CachedStatement*>::iterator it = m_stmtCache.begin();
+        for (; it != m_stmtCache.end(); ++it)
+        {
+            if (!(*it)->inUse && (oldest == m_stmtCache.end() ||
+                                  (*it)->lastUsed < (*oldest)->lastUsed))
+                oldest = it;
+        }
+
+        if (oldest == m_stmtCache.end())
+            return false;
+
+        delete *oldest;
+        m_stmtCache.erase(oldest);
+    }
+
+    m_stmtCache.insert(sql, new CachedStatement(query, ++m_stmtClock));
+
+    return true;
+}
+
+/// \brief Return a borrowed statement to the cache
+void MSqlDatabase::ReleaseStatement(const QString &sql,
+                                    const QSqlResult *result)
+{
+    CachedStatement *stmt = m_stmtCache.value(sql, NULL);
+
+    // The cache may have been flushed by a reconnect since it was borrowed
+    if (!stmt || stmt->query.result() != result)
+        return;
+
+    stmt->query.finish();
+    stmt->inUse = false;
+}
+
+/// \brief Drop all cached statements.  Must be done before the connection is
+///        closed, as the statements can't outlive it.
+void MSqlDatabase::ClearStatementCache(void)
+{
+    QHash<QString, CachedStatement*>::iterator it = m_stmtCache.begin();
+    for (; it != m_stmtCache.end(); ++it)
+        delete *it;
+    m_stmtCache.clear();
+}
+
 // -----------------------------------------------------------------------
 
 
@@ -261,6 +381,8 @@ MDBManager::MDBManager()
 {
     m_nextConnID = 0;
     m_connCount = 0;
+    m_stmtCacheHits = 0;
+    m_stmtCacheMisses = 0;
 
     m_schedCon = NULL;
     m_DDCon = NULL;
@@ -465,6 +587,7 @@ void MDBManager::CloseDatabases()
     {
         LOG(VB_DATABASE, LOG_INFO,
             "Closing DB connection named '" + (*it)->m_name + "'");
+        (*it)->ClearStatementCache();
         (*it)->m_db.close();
         delete (*it);
         m_connCount--;
@@ -477,6 +600,7 @@ void MDBManager::CloseDatabases()
         MSqlDatabase *db = slist.takeFirst();
         LOG(VB_DATABASE, LOG_INFO,
             "Closing DB connection named '" + db->m_name + "'");
+        db->ClearStatementCache();
         db->m_db.close();
         delete db;
 
@@ -488,6 +612,138 @@ void MDBManager::CloseDatabases()
     m_lock.unlock();
 }
 
+/// \brief Number of pooled connections, in use or idle, over all threads
+int MDBManager::GetConnectionCount(void)
+{
+    QMutexLocker locker(&m_lock);
+    return m_connCount;
+}
+
+/// \brief Number of pooled connections not currently in use
+int MDBManager::GetIdleConnectionCount(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    int idle = 0;
+    QHash<QThread*, DBList>::const_iterator it = m_pool.begin();
+    for (; it != m_pool.end(); ++it)
+        idle += (*it).size();
+
+    return idle;
+}
+
+/// \brief Readable name for a code address, "function+offset (library)"
+///        when the symbol is exported, "library+offset" otherwise.
+///
+/// Most symbols are hidden, so the second form is the common one; feed the
+/// offset to "addr2line -f -C -e <library>" to get the file and line.
+static QString describe_caller(const void *caller)
+{
+#ifndef _WIN32
+    Dl_info info;
+    if (dladdr(caller, &info) && info.dli_fname)
+    {
+        QString lib = QFileInfo(info.dli_fname).fileName();
+        quintptr offset = (quintptr)caller - (quintptr)info.dli_fbase;
+
+        if (!info.dli_sname || !info.dli_saddr)
+            return QString("%1+0x%2").arg(lib).arg(offset, 0, 16);
+
+        QString name = info.dli_sname;
+#ifdef __GNUC__
+        int status = 0;
+        char *demangled =
+            abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+        if (demangled)
+        {
+            if (status == 0)
+                name = demangled;
+            free(demangled);
+        }
+#endif
+        quintptr symoffset = (quintptr)caller - (quintptr)info.dli_saddr;
+        return QString("%1+0x%2 (%3)")
+            .arg(name).arg(symoffset, 0, 16).arg(lib);
+    }
+#endif
+    return QString("0x%1").arg((quintptr)caller, 0, 16);
+}
+
+/// \brief Add one execution of a query to the statistics
+///
+/// Executions are grouped by the code that called MSqlQuery::exec(), so the
+/// same statement run from two places is reported twice, and a statement
+/// built with different literal values each time is reported once.  When
+/// the caller can't be determined the SQL text is used instead.
+void MDBManager::RecordQuery(const void *caller, const QString &sql,
+                             quint64 usecs, bool ok)
+{
+    QMutexLocker locker(&m_statsLock);
+
+    QString key = caller ?
+        QString::number((quintptr)caller, 16) : QString("sql:") + sql;
+
+    QHash<QString, MSqlQueryStats>::iterator it = m_queryStats.find(key);
+    if (it == m_queryStats.end())
+    {
+        if (m_queryStats.size() < kMaxQueryStats)
+        {
+            it = m_queryStats.insert(key, MSqlQueryStats());
+            (*it).caller = caller ? describe_caller(caller) : QString();
+            (*it).sql = sql;
+        }
+        else
+        {
+            it = m_queryStats.find("(other)");
+            if (it == m_queryStats.end())
+            {
+                it = m_queryStats.insert("(other)", MSqlQueryStats());
+                (*it).caller = "(other)";
+            }
+        }
+    }
+
+    MSqlQueryStats &stats = *it;
+
+    stats.count++;
+    if (!ok)
+        stats.failed++;
+    stats.totalUSecs += usecs;
+    stats.maxUSecs = qMax(stats.maxUSecs, usecs);
+
+    int bucket = 0;
+    while (bucket < MSqlQueryStats::kHistogramBuckets - 1 &&
+           usecs >= MSqlQueryStats::HistogramLimit(bucket))
+        bucket++;
+    stats.histogram[bucket]++;
+}
+
+/// \brief Count a prepare() that did or did not hit the statement cache
+void MDBManager::RecordPrepare(bool cached)
+{
+    QMutexLocker locker(&m_statsLock);
+
+    if (cached)
+        m_stmtCacheHits++;
+    else
+        m_stmtCacheMisses++;
+}
+
+/// \brief Execution statistics for every call site that has run a query
+QList<MSqlQueryStats> MDBManager::GetQueryStats(void)
+{
+    QMutexLocker locker(&m_statsLock);
+    return m_queryStats.values();
+}
+
+/// \brief Prepared statement cache hits and misses over all connections
+void MDBManager::GetStatementCacheStats(uint &hits, uint &misses)
+{
+    QMutexLocker locker(&m_statsLock);
+    hits = m_stmtCacheHits;
+    misses = m_stmtCacheMisses;
+}
+
 
 // -----------------------------------------------------------------------
 
@@ -505,6 +761,7 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
     m_isConnected = false;
     m_db = qi.db;
     m_returnConnection = qi.returnConnection;
+    m_cachedStatement = false;
 
     m_isConnected = m_db && m_db->isOpen();
 
@@ -515,6 +772,8 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
 
 MSqlQuery::~MSqlQuery()
 {
+    ReleaseStatement();
+
     if (m_returnConnection)
     {
         MDBManager *dbmanager = GetMythDB()->GetDBManager();
@@ -626,6 +885,9 @@ bool MSqlQuery::exec()
         return false;
     }
 
+    QElapsedTimer timer;
+    timer.start();
+
     bool result = QSqlQuery::exec();
 
     // if the query failed with "MySQL server has gone away"
@@ -663,6 +925,11 @@ bool MSqlQuery::exec()
         }
     }
 
+    MDBManager *dbmanager = GetMythDB()->GetDBManager();
+    if (dbmanager)
+        dbmanager->RecordQuery(QUERY_CALLER(), m_last_prepared_query,
+                               timer.nsecsElapsed() / 1000, result);
+
     if (VERBOSE_LEVEL_CHECK(VB_DATABASE, LOG_DEBUG))
     {
         QString str = lastQuery();
@@ -709,6 +976,12 @@ bool MSqlQuery::exec(const QString &query)
         return false;
     }
 
+    // This replaces the prepared statement, if any
+    ReleaseStatement();
+
+    QElapsedTimer timer;
+    timer.start();
+
     bool result = QSqlQuery::exec(query);
 
     // if the query failed with "MySQL server has gone away"
@@ -717,6 +990,11 @@ bool MSqlQuery::exec(const QString &query)
     if (!result && QSqlQuery::lastError().number() == 2006 && Reconnect())
         result = QSqlQuery::exec(query);
 
+    MDBManager *dbmanager = GetMythDB()->GetDBManager();
+    if (dbmanager)
+        dbmanager->RecordQuery(QUERY_CALLER(), query,
+                               timer.nsecsElapsed() / 1000, result);
+
     LOG(VB_DATABASE, LOG_DEBUG,
             QString("MSqlQuery::exec(%1) %2%3")
                     .arg(m_db->MSqlDatabase::GetConnectionName()).arg(query)
@@ -795,6 +1073,8 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    ReleaseStatement();
+
     m_last_prepared_query = query;
 
 #ifdef DEBUG_QT4_PORT
@@ -823,6 +1103,17 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    MDBManager *dbmanager = GetMythDB()->GetDBManager();
+
+    // Reuse the statement if this connection has already prepared it
+    if (m_db->BorrowStatement(query, *this))
+    {
+        m_cachedStatement = true;
+        if (dbmanager)
+            dbmanager->RecordPrepare(true);
+        return true;
+    }
+
     bool ok = QSqlQuery::prepare(query);
 
     // if the prepare failed with "MySQL server has gone away"
@@ -831,6 +1122,13 @@ bool MSqlQuery::prepare(const QString& query)
     if (!ok && QSqlQuery::lastError().number() == 2006 && Reconnect())
         ok = true;
 
+    if (ok)
+    {
+        m_cachedStatement = m_db->CacheStatement(query, *this);
+        if (dbmanager)
+            dbmanager->RecordPrepare(false);
+    }
+
     if (!ok && !(GetMythDB()->SuppressDBMessages()))
     {
         LOG(VB_GENERAL, LOG_ERR,
@@ -888,6 +1186,9 @@ QVariant MSqlQuery::lastInsertId()
 
 bool MSqlQuery::Reconnect(void)
 {
+    // Reconnecting flushes the connection's statement cache
+    m_cachedStatement = false;
+
     if (!m_db->Reconnect())
         return false;
     if (!m_last_prepared_query.isEmpty())
@@ -900,6 +1201,15 @@ bool MSqlQuery::Reconnect(void)
     return true;
 }
 
+/// \brief Hand a statement borrowed from the connection's cache back to it
+void MSqlQuery::ReleaseStatement(void)
+{
+    if (m_cachedStatement && m_db)
+        m_db->ReleaseStatement(m_last_prepared_query, QSqlQuery::result());
+
+    m_cachedStatement = false;
+}
+
 void MSqlAddMoreBindings(MSqlBindings &output, MSqlBindings &addfrom)
 {
     MSqlBindings::Iterator it;
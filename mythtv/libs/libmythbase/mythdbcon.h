@@ -10,6 +10,7 @@
 #include <QDateTime>
 #include <QMutex>
 #include <QList>
+#include <QHash>
 
 #include "mythbaseexp.h"
 #include "mythdbparams.h"
@@ -42,11 +43,54 @@ class MSqlDatabase
     bool Reconnect(void);
     void InitSessionVars(void);
 
+    bool BorrowStatement(const QString &sql, QSqlQuery &query);
+    bool CacheStatement(const QString &sql, const QSqlQuery &query);
+    void ReleaseStatement(const QString &sql, const QSqlResult *result);
+    void ClearStatementCache(void);
+
+    /// \brief A statement that has been prepared on this connection.
+    ///        Only one MSqlQuery may use it at a time.
+    struct CachedStatement
+    {
+        CachedStatement(const QSqlQuery &q, uint used) :
+            query(q), inUse(true), lastUsed(used) { }
+        QSqlQuery query;
+        bool      inUse;
+        uint      lastUsed;
+    };
+
   private:
     QString m_name;
     QSqlDatabase m_db;
     QDateTime m_lastDBKick;
     DatabaseParams m_dbparms;
+    QHash<QString, CachedStatement*> m_stmtCache; // keyed by SQL text
+    uint m_stmtClock;
+};
+
+/// \brief Execution statistics for the queries run from one call site, see
+///        MDBManager::GetQueryStats()
+struct MBASE_PUBLIC MSqlQueryStats
+{
+    /// Number of latency histogram buckets.  Bucket i counts executions
+    /// that took less than HistogramLimit(i) microseconds, the last bucket
+    /// counts everything slower.
+    static const int kHistogramBuckets = 8;
+    static quint64 HistogramLimit(int bucket) { return 250ULL << (2 * bucket); }
+
+    MSqlQueryStats() : count(0), failed(0), totalUSecs(0), maxUSecs(0)
+    {
+        for (int i = 0; i < kHistogramBuckets; i++)
+            histogram[i] = 0;
+    }
+
+    QString caller; ///< Code that called MSqlQuery::exec()
+    QString sql;    ///< First statement run from there
+    uint    count;
+    uint    failed;
+    quint64 totalUSecs;
+    quint64 maxUSecs;
+    uint    histogram[kHistogramBuckets];
 };
 
 /// \brief DB connection pool, used by MSqlQuery. Do not use directly.
@@ -60,10 +104,19 @@ class MBASE_PUBLIC MDBManager
     void CloseDatabases(void);
     void PurgeIdleConnections(bool leaveOne = false);
 
+    int GetConnectionCount(void);
+    int GetIdleConnectionCount(void);
+    QList<MSqlQueryStats> GetQueryStats(void);
+    void GetStatementCacheStats(uint &hits, uint &misses);
+
   protected:
     MSqlDatabase *popConnection(bool reuse);
     void pushConnection(MSqlDatabase *db);
 
+    void RecordQuery(const void *caller, const QString &sql,
+                     quint64 usecs, bool ok);
+    void RecordPrepare(bool cached);
+
     MSqlDatabase *getSchedCon(void);
     MSqlDatabase *getDDCon(void);
 
@@ -84,6 +137,12 @@ class MBASE_PUBLIC MDBManager
     MSqlDatabase *m_schedCon;
     MSqlDatabase *m_DDCon;
     QHash<QThread*, DBList> m_static_pool;
+
+    QMutex m_statsLock;
+    // keyed by call site, protected by m_statsLock
+    QHash<QString, MSqlQueryStats> m_queryStats;
+    uint m_stmtCacheHits;   // protected by m_statsLock
+    uint m_stmtCacheMisses; // protected by m_statsLock
 };
 
 /// \brief MSqlDatabase Info, used by MSqlQuery. Do not use directly.
@@ -218,11 +277,13 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
 
     bool seekDebug(const char *type, bool result,
                    int where, bool relative) const;
+    void ReleaseStatement(void);
 
     MSqlDatabase *m_db;
     bool m_isConnected;
     bool m_returnConnection;
     QString m_last_prepared_query; // holds a copy of the last prepared query
+    bool m_cachedStatement; // query is shared with m_db's statement cache
 #ifdef DEBUG_QT4_PORT
     QRegExp m_testbindings;
 #endif
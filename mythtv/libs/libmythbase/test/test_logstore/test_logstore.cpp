@@ -0,0 +1,3 @@
+#include "test_logstore.h"
+
+QTEST_APPLESS_MAIN(TestLogStore)
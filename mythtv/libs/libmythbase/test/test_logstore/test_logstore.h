@@ -0,0 +1,290 @@
+/*
+ *  Class TestLogStore
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <unistd.h> // for getpid()
+
+#include <QtTest/QtTest>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+
+#include "mythlogging.h"
+#include "logging.h"
+#include "logstore.h"
+
+class TestLogStore: public QObject
+{
+    Q_OBJECT
+
+    QString m_path;
+    QDateTime m_start;
+
+    void removeStore(void)
+    {
+        QDir dir(m_path);
+        QStringList files = dir.entryList(QDir::Files);
+        for (int i = 0; i < files.size(); i++)
+            dir.remove(files[i]);
+        QDir().rmdir(m_path);
+    }
+
+    static void append(LogStore &store, const QDateTime &when,
+                       LogLevel_t level, const char *app, int line,
+                       const QString &message)
+    {
+        LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
+                                                line, level, kMessage);
+        item->setEpoch(when.toTime_t());
+        item->setUsec(line);
+        item->setPid(1234);
+        item->setTid(5678);
+        item->setAppName(app);
+        item->setThreadName("CoreContext");
+        item->setMessage(message);
+        store.Append(item);
+        item->DecrRef();
+    }
+
+    // Two days of one message a minute from mythbackend, one in ten of them
+    // an error, and a message an hour from mythfrontend
+    void fill(LogStore &store)
+    {
+        for (int i = 0; i < 2 * 24 * 60; i++)
+        {
+            QDateTime when = m_start.addSecs(60 * i);
+            append(store, when, (i % 10) ? LOG_INFO : LOG_ERR,
+                   "mythbackend", i, QString("Message %1").arg(i));
+            if (i % 60 == 0)
+                append(store, when, LOG_NOTICE, "mythfrontend", i,
+                       QString("Hourly %1").arg(i / 60));
+            if (store.NeedsFlush())
+                store.Flush();
+        }
+        store.Flush();
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        m_path = QString("%1/test_logstore-%2")
+            .arg(QDir::tempPath()).arg(getpid());
+        // Yesterday, so the store doesn't prune it
+        m_start = QDateTime(QDate::currentDate().addDays(-1), QTime(0, 0));
+    }
+
+    void init(void)
+    {
+        removeStore();
+    }
+
+    void cleanupTestCase(void)
+    {
+        removeStore();
+    }
+
+    void MissingStore(void)
+    {
+        QList<LogStoreRow> rows;
+        QVERIFY(!LogStore::Query(m_path, LogStoreFilter(), rows));
+        QVERIFY(rows.isEmpty());
+    }
+
+    void WritesCompressedBlocks(void)
+    {
+        {
+            LogStore store(m_path);
+            fill(store);
+        }
+
+        QDir dir(m_path);
+        QStringList segments = dir.entryList(QStringList("*.mls"));
+        QCOMPARE(segments.size(), 2);
+
+        qint64 size = 0;
+        for (int i = 0; i < segments.size(); i++)
+            size += QFileInfo(dir.filePath(segments[i])).size();
+        // The same messages as text log lines would take some 400KB
+        QVERIFY(size < 100 * 1024);
+    }
+
+    void ReadsBackEverything(void)
+    {
+        {
+            LogStore store(m_path);
+            fill(store);
+        }
+
+        QList<LogStoreRow> rows;
+        QVERIFY(LogStore::Query(m_path, LogStoreFilter(), rows));
+        QCOMPARE(rows.size(), 2 * 24 * 60 + 2 * 24);
+
+        const LogStoreRow &row = rows.first();
+        QCOMPARE(row.epoch, (qlonglong)m_start.toTime_t());
+        QCOMPARE(row.application, QString("mythbackend"));
+        QCOMPARE(row.level, (int)LOG_ERR);
+        QCOMPARE(row.pid, 1234);
+        QCOMPARE(row.tid, (qlonglong)5678);
+        QCOMPARE(row.thread, QString("CoreContext"));
+        QCOMPARE(row.file, QString(__FILE__));
+        QCOMPARE(row.function, QString("append"));
+        QCOMPARE(row.message, QString("Message 0"));
+
+        for (int i = 1; i < rows.size(); i++)
+            QVERIFY(rows[i - 1].epoch <= rows[i].epoch);
+    }
+
+    void FiltersRows(void)
+    {
+        {
+            LogStore store(m_path);
+            fill(store);
+        }
+
+        LogStoreFilter filter;
+        filter.application = "mythfrontend";
+        QList<LogStoreRow> rows;
+        LogStore::Query(m_path, filter, rows);
+        QCOMPARE(rows.size(), 2 * 24);
+
+        filter = LogStoreFilter();
+        filter.level = LOG_ERR;
+        rows.clear();
+        LogStore::Query(m_path, filter, rows);
+        QCOMPARE(rows.size(), 2 * 24 * 6);
+
+        filter = LogStoreFilter();
+        filter.from = m_start.addSecs(3600);
+        filter.to   = m_start.addSecs(2 * 3600 - 1);
+        filter.application = "mythbackend";
+        rows.clear();
+        LogStore::Query(m_path, filter, rows);
+        QCOMPARE(rows.size(), 60);
+        QCOMPARE(rows.first().line, 60);
+
+        filter = LogStoreFilter();
+        filter.contains = "hourly 4";
+        rows.clear();
+        LogStore::Query(m_path, filter, rows);
+        // Hourly 4 and Hourly 40 to 47
+        QCOMPARE(rows.size(), 9);
+
+        filter = LogStoreFilter();
+        filter.line = 61;
+        filter.function = "append";
+        rows.clear();
+        LogStore::Query(m_path, filter, rows);
+        QCOMPARE(rows.size(), 1);
+        QCOMPARE(rows.first().message, QString("Message 61"));
+    }
+
+    void LimitsRows(void)
+    {
+        {
+            LogStore store(m_path);
+            fill(store);
+        }
+
+        LogStoreFilter filter;
+        filter.application = "mythbackend";
+        filter.limit = 100;
+        QList<LogStoreRow> rows;
+        QVERIFY(LogStore::Query(m_path, filter, rows));
+        // The newest ones, oldest first
+        QCOMPARE(rows.size(), 100);
+        QCOMPARE(rows.first().line, 2 * 24 * 60 - 100);
+        QCOMPARE(rows.last().line, 2 * 24 * 60 - 1);
+
+        // Reaching back into the first day's segment
+        filter.limit = 24 * 60 + 10;
+        rows.clear();
+        LogStore::Query(m_path, filter, rows);
+        QCOMPARE(rows.size(), 24 * 60 + 10);
+        QCOMPARE(rows.first().line, 24 * 60 - 10);
+        for (int i = 1; i < rows.size(); i++)
+            QCOMPARE(rows[i].line, rows[i - 1].line + 1);
+    }
+
+    void FindsOldest(void)
+    {
+        QCOMPARE(LogStore::Oldest(m_path), (qlonglong)-1);
+
+        {
+            LogStore store(m_path);
+            fill(store);
+        }
+
+        QCOMPARE(LogStore::Oldest(m_path), (qlonglong)m_start.toTime_t());
+    }
+
+    void ListsApplications(void)
+    {
+        {
+            LogStore store(m_path);
+            fill(store);
+        }
+
+        QStringList apps = LogStore::Applications(m_path);
+        QCOMPARE(apps, QStringList() << "mythbackend" << "mythfrontend");
+    }
+
+    void DropsIncompleteBlock(void)
+    {
+        {
+            LogStore store(m_path);
+            append(store, m_start, LOG_INFO, "mythbackend", 1, "Before");
+            store.Flush();
+        }
+
+        // A block cut short by a crash
+        QFile file(QDir(m_path).filePath(
+                       m_start.date().toString("yyyyMMdd") + ".mls"));
+        QVERIFY(file.open(QIODevice::Append));
+        file.write(QByteArray("MLSB\x01\x10", 6));
+        file.close();
+
+        {
+            LogStore store(m_path);
+            append(store, m_start.addSecs(1), LOG_INFO, "mythbackend", 2,
+                   "After");
+            store.Flush();
+        }
+
+        QList<LogStoreRow> rows;
+        LogStore::Query(m_path, LogStoreFilter(), rows);
+        QCOMPARE(rows.size(), 2);
+        QCOMPARE(rows[0].message, QString("Before"));
+        QCOMPARE(rows[1].message, QString("After"));
+    }
+
+    void PrunesOldSegments(void)
+    {
+        {
+            LogStore store(m_path, 14);
+            append(store, m_start.addDays(-20), LOG_INFO, "mythbackend", 1,
+                   "Old");
+            store.Flush();
+            append(store, m_start, LOG_INFO, "mythbackend", 2, "New");
+            store.Flush();
+        }
+
+        QList<LogStoreRow> rows;
+        LogStore::Query(m_path, LogStoreFilter(), rows);
+        QCOMPARE(rows.size(), 1);
+        QCOMPARE(rows.first().message, QString("New"));
+    }
+};
@@ -0,0 +1,3 @@
+#include "test_querystats.h"
+
+QTEST_APPLESS_MAIN(TestQueryStats)
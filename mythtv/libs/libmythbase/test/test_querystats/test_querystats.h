@@ -0,0 +1,143 @@
+/*
+ *  Class TestQueryStats
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "mythdbcon.h"
+
+// Stands in for the code addresses MSqlQuery::exec() passes as the caller
+static char call_sites[1100];
+
+// Gives the test access to MDBManager::RecordQuery() without a database
+class QueryStatsManager : public MDBManager
+{
+  public:
+    void Record(int site, const QString &sql,
+                quint64 usecs = 100, bool ok = true)
+    {
+        RecordQuery(site < 0 ? NULL : &call_sites[site], sql, usecs, ok);
+    }
+
+    MSqlQueryStats Find(const QString &sql)
+    {
+        QList<MSqlQueryStats> stats = GetQueryStats();
+        for (int i = 0; i < stats.size(); i++)
+        {
+            if (stats[i].sql == sql)
+                return stats[i];
+        }
+        return MSqlQueryStats();
+    }
+};
+
+class TestQueryStats: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void SameStatementFromTwoCallers(void)
+    {
+        QueryStatsManager manager;
+        QString sql("SELECT title FROM program WHERE chanid = :CHANID");
+
+        manager.Record(0, sql);
+        manager.Record(1, sql);
+        manager.Record(1, sql);
+
+        QList<MSqlQueryStats> stats = manager.GetQueryStats();
+        QCOMPARE(stats.size(), 2);
+        QCOMPARE(stats[0].sql, sql);
+        QCOMPARE(stats[1].sql, sql);
+        QVERIFY(stats[0].caller != stats[1].caller);
+        QCOMPARE(stats[0].count + stats[1].count, 3U);
+    }
+
+    void LiteralsFromOneCaller(void)
+    {
+        QueryStatsManager manager;
+
+        for (int i = 0; i < 50; i++)
+            manager.Record(0, QString("DELETE FROM recordedseek "
+                                      "WHERE chanid = %1").arg(1000 + i));
+
+        QList<MSqlQueryStats> stats = manager.GetQueryStats();
+        QCOMPARE(stats.size(), 1);
+        QCOMPARE(stats[0].count, 50U);
+        QCOMPARE(stats[0].sql,
+                 QString("DELETE FROM recordedseek WHERE chanid = 1000"));
+        QVERIFY(!stats[0].caller.isEmpty());
+    }
+
+    void UnknownCallerUsesStatement(void)
+    {
+        QueryStatsManager manager;
+
+        manager.Record(-1, "SELECT 1");
+        manager.Record(-1, "SELECT 2");
+        manager.Record(-1, "SELECT 1");
+
+        QCOMPARE(manager.GetQueryStats().size(), 2);
+        QCOMPARE(manager.Find("SELECT 1").count, 2U);
+        QCOMPARE(manager.Find("SELECT 2").count, 1U);
+        QVERIFY(manager.Find("SELECT 1").caller.isEmpty());
+    }
+
+    void CountsTimesAndFailures(void)
+    {
+        QueryStatsManager manager;
+        QString sql("UPDATE record SET last_record = NOW()");
+
+        manager.Record(0, sql, 100, true);
+        manager.Record(0, sql, 2000, false);
+        manager.Record(0, sql, 10 * 1000 * 1000, true);
+
+        MSqlQueryStats stats = manager.Find(sql);
+        QCOMPARE(stats.count, 3U);
+        QCOMPARE(stats.failed, 1U);
+        QCOMPARE(stats.totalUSecs, (quint64)(10 * 1000 * 1000 + 2100));
+        QCOMPARE(stats.maxUSecs, (quint64)(10 * 1000 * 1000));
+
+        // < 250us, < 4ms and the catch-all bucket
+        QCOMPARE(stats.histogram[0], 1U);
+        QCOMPARE(stats.histogram[2], 1U);
+        QCOMPARE(stats.histogram[MSqlQueryStats::kHistogramBuckets - 1], 1U);
+    }
+
+    void FoldsExtraCallers(void)
+    {
+        QueryStatsManager manager;
+
+        for (int i = 0; i < 1100; i++)
+            manager.Record(i, QString("SELECT %1").arg(i));
+        manager.Record(0, "SELECT 0");
+
+        QList<MSqlQueryStats> stats = manager.GetQueryStats();
+        QCOMPARE(stats.size(), 1001);
+
+        // Callers seen before the limit keep their own entry
+        QCOMPARE(manager.Find("SELECT 0").count, 2U);
+
+        MSqlQueryStats other;
+        for (int i = 0; i < stats.size(); i++)
+        {
+            if (stats[i].caller == "(other)")
+                other = stats[i];
+        }
+        QCOMPARE(other.count, 100U);
+    }
+};
@@ -0,0 +1,3 @@
+#include "test_threadedfilewriter.h"
+
+QTEST_APPLESS_MAIN(TestThreadedFileWriter)
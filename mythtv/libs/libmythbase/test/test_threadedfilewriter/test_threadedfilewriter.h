@@ -0,0 +1,219 @@
+/*
+ *  Class TestThreadedFileWriter
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <unistd.h> // for getpid()
+
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QDir>
+
+#include "threadedfilewriter.h"
+#include "mythtimer.h"
+
+class TestThreadedFileWriter: public QObject
+{
+    Q_OBJECT
+
+    QString m_filename;
+
+    /// The byte the test writes at file position \p pos
+    static char byteAt(long long pos)
+    {
+        return (char)((pos * 7) % 251);
+    }
+
+    static QByteArray bytes(long long pos, uint count)
+    {
+        QByteArray data(count, 0);
+        for (uint i = 0; i < count; i++)
+            data[i] = byteAt(pos + i);
+        return data;
+    }
+
+    static ThreadedFileWriter::TFWBuffer *buffer(long long pos, uint count)
+    {
+        ThreadedFileWriter::TFWBuffer *buf = new ThreadedFileWriter::TFWBuffer;
+        QByteArray data = bytes(pos, count);
+        buf->data.assign(data.constData(), data.constData() + count);
+        buf->lastUsed = QDateTime::currentDateTime();
+        return buf;
+    }
+
+    static QByteArray readTimeshift(const QString &fname, long long pos,
+                                    uint count)
+    {
+        QByteArray data(count, 0);
+        int ret = ThreadedFileWriter::ReadTimeshift(
+            fname, pos, data.data(), count);
+        return data.left(max(ret, 0));
+    }
+
+    /// Reads like RingBuffer does, from RAM if it isn't on disk yet
+    static QByteArray readBack(const QString &fname, long long size)
+    {
+        QByteArray data;
+        QFile file(fname);
+        if (!file.open(QIODevice::ReadOnly))
+            return data;
+
+        while (data.size() < size)
+        {
+            QByteArray ram = readTimeshift(fname, data.size(), 64 * 1024);
+            if (!ram.isEmpty())
+            {
+                data += ram;
+                continue;
+            }
+
+            // Not in RAM anymore, so it has to be on disk
+            if (!file.seek(data.size()))
+                break;
+            QByteArray disk = file.read(
+                min(size - data.size(), (long long)64 * 1024));
+            if (disk.isEmpty())
+                break;
+            data += disk;
+        }
+
+        return data;
+    }
+
+    /// Lets the destructor finish without a disk thread to drain the buffers
+    static void release(ThreadedFileWriter &tfw)
+    {
+        if (tfw.diskBuffer)
+            tfw.emptyBuffers.push_back(tfw.diskBuffer);
+        tfw.diskBuffer = NULL;
+        tfw.emptyBuffers += tfw.writeBuffers;
+        tfw.writeBuffers.clear();
+        tfw.totalBufferUse = 0;
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        m_filename = QString("%1/test_threadedfilewriter-%2.ts")
+            .arg(QDir::tempPath()).arg(getpid());
+    }
+
+    void cleanup(void)
+    {
+        QFile::remove(m_filename);
+    }
+
+    // DiskLoop() has taken the first buffer off writeBuffers and is
+    // writing it, so diskPos doesn't include it yet.
+    void ReadsBufferBeingWritten(void)
+    {
+        ThreadedFileWriter tfw(m_filename, O_WRONLY | O_CREAT, 0644);
+        tfw.SetTimeshift(1024 * 1024);
+
+        tfw.diskPos = 1000;
+        tfw.diskBuffer = buffer(1000, 100);
+        tfw.writeBuffers.push_back(buffer(1100, 50));
+        tfw.writeBuffers.push_back(buffer(1150, 150));
+        tfw.totalBufferUse = 200;
+
+        QCOMPARE(ThreadedFileWriter::GetTimeshiftSize(m_filename), 1300LL);
+
+        // Already on disk, and past the end
+        QCOMPARE(readTimeshift(m_filename, 999, 100).size(), 0);
+        QCOMPARE(readTimeshift(m_filename, 1300, 100).size(), 0);
+
+        QCOMPARE(readTimeshift(m_filename, 1000, 300), bytes(1000, 300));
+        QCOMPARE(readTimeshift(m_filename, 1050, 100), bytes(1050, 100));
+        QCOMPARE(readTimeshift(m_filename, 1099, 2), bytes(1099, 2));
+        QCOMPARE(readTimeshift(m_filename, 1290, 50), bytes(1290, 10));
+
+        // The write finished
+        tfw.diskPos += tfw.diskBuffer->data.size();
+        tfw.emptyBuffers.push_back(tfw.diskBuffer);
+        tfw.diskBuffer = NULL;
+
+        QCOMPARE(ThreadedFileWriter::GetTimeshiftSize(m_filename), 1300LL);
+        QCOMPARE(readTimeshift(m_filename, 1050, 100).size(), 0);
+        QCOMPARE(readTimeshift(m_filename, 1100, 300), bytes(1100, 200));
+
+        release(tfw);
+    }
+
+    void NotTimeshifted(void)
+    {
+        char data[16];
+        QVERIFY(!ThreadedFileWriter::IsTimeshifted(m_filename));
+        QCOMPARE(ThreadedFileWriter::ReadTimeshift(m_filename, 0, data, 16), 0);
+        QCOMPARE(ThreadedFileWriter::GetTimeshiftSize(m_filename), -1LL);
+    }
+
+    void HeldInRAM(void)
+    {
+        ThreadedFileWriter tfw(m_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        QVERIFY(tfw.Open());
+        tfw.SetTimeshift(1024 * 1024);
+
+        QByteArray data = bytes(0, 100 * 1024);
+        tfw.Write(data.constData(), data.size());
+
+        // Past the point where it would be written without a timeshift
+        usleep(500 * 1000);
+        QCOMPARE(QFileInfo(m_filename).size(), 0LL);
+        QCOMPARE(ThreadedFileWriter::GetTimeshiftSize(m_filename),
+                 (long long)data.size());
+        QCOMPARE(readTimeshift(m_filename, 0, data.size()), data);
+
+        // Writes are only delayed, closing the file writes everything
+        tfw.SetTimeshift(0);
+        tfw.Flush();
+        QCOMPARE(readTimeshift(m_filename, 0, data.size()).size(), 0);
+        QCOMPARE(readBack(m_filename, data.size()), data);
+    }
+
+    // Everything stays readable while the part that no longer fits in
+    // the window is written, and ends up on disk in the end.
+    void SpillsToDisk(void)
+    {
+        ThreadedFileWriter tfw(m_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        QVERIFY(tfw.Open());
+        tfw.SetTimeshift(256 * 1024);
+
+        long long size = 3 * 1024 * 1024;
+        QByteArray data = bytes(0, size);
+        for (long long pos = 0; pos < size; pos += 188 * 7)
+        {
+            uint count = min(size - pos, 188LL * 7);
+            tfw.Write(data.constData() + pos, count);
+        }
+
+        MythTimer timer;
+        timer.start();
+        while (QFileInfo(m_filename).size() < size - 256 * 1024 &&
+               timer.elapsed() < 10000)
+        {
+            QCOMPARE(readBack(m_filename, size), data);
+            usleep(10 * 1000);
+        }
+
+        QVERIFY(QFileInfo(m_filename).size() >= size - 256 * 1024);
+        QVERIFY(QFileInfo(m_filename).size() < size);
+        QCOMPARE(readBack(m_filename, size), data);
+
+        tfw.Flush();
+        QCOMPARE(QFileInfo(m_filename).size(), size);
+        QCOMPARE(readBack(m_filename, size), data);
+    }
+};
@@ -3,6 +3,9 @@
 #include <cstdlib>
 #include <cerrno>
 
+// C++ headers
+#include <algorithm>
+
 // Unix C headers
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -13,6 +16,7 @@
 
 // Qt headers
 #include <QString>
+#include <QDir>
 
 // MythTV headers
 #include "threadedfilewriter.h"
@@ -44,6 +48,17 @@ const uint ThreadedFileWriter::kMaxBufferSize   = 8 * 1024 * 1024;
 const uint ThreadedFileWriter::kMinWriteSize    = 64 * 1024;
 const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
 
+QMutex                              ThreadedFileWriter::s_timeshiftLock;
+QHash<QString, ThreadedFileWriter*> ThreadedFileWriter::s_timeshifts;
+QMutex                              ThreadedFileWriter::s_statsLock;
+TimeshiftStats                      ThreadedFileWriter::s_stats;
+
+/// The recorder and FileTransfer may not spell the path the same way
+static QString timeshift_key(const QString &filename)
+{
+    return QDir::cleanPath(filename);
+}
+
 /** \class ThreadedFileWriter
  *  \brief This class supports the writing of recordings to disk.
  *
@@ -53,6 +68,14 @@ const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
  *   using another thread. The goal here so to block as little as
  *   possible when the classes using this class want to add data
  *   to the stream.
+ *
+ *   With SetTimeshift() the writes are held in RAM for as long as they
+ *   fit in a window, and are only written to disk when they leave it or
+ *   when the file is flushed or closed.  Readers in the same process use
+ *   ReadTimeshift() for the part that isn't on disk yet, which lets the
+ *   backend serve the live end of a LiveTV recording without the disk.
+ *   Every byte is still written; the timeshift only delays the writes
+ *   and batches them into larger ones.
  */
 
 /** \fn ThreadedFileWriter::ThreadedFileWriter(const QString&,int,mode_t)
@@ -66,7 +89,12 @@ ThreadedFileWriter::ThreadedFileWriter(const QString &fname,
     // state
     flush(false),                        in_dtor(false),
     ignore_writes(false),                tfw_min_write_size(kMinWriteSize),
-    totalBufferUse(0),
+    totalBufferUse(0),                   diskPos(0),
+    // timeshift
+    timeshifted(false),                  timeshiftSize(0),
+    timeshiftSecs(0),                    timeshiftFull(false),
+    timeshiftRAM(0),
+    diskBuffer(NULL),
     // threads
     writeThread(NULL),                   syncThread(NULL),
     m_warned(false),                     m_blocking(false)
@@ -84,7 +112,10 @@ bool ThreadedFileWriter::ReOpen(QString newFilename)
 {
     Flush();
 
+    s_timeshiftLock.lock();
     buflock.lock();
+    if (s_timeshifts.value(timeshift_key(filename)) == this)
+        s_timeshifts.remove(timeshift_key(filename));
 
     if (fd >= 0)
     {
@@ -97,7 +128,15 @@ bool ThreadedFileWriter::ReOpen(QString newFilename)
 
     buflock.unlock();
 
-    return Open();
+    bool ok = Open();
+
+    buflock.lock();
+    if (ok && timeshifted)
+        s_timeshifts[timeshift_key(filename)] = this;
+    buflock.unlock();
+    s_timeshiftLock.unlock();
+
+    return ok;
 }
 
 /** \fn ThreadedFileWriter::Open(void)
@@ -116,6 +155,8 @@ bool ThreadedFileWriter::Open(void)
         fd = open(fname.constData(), flags, mode);
     }
 
+    diskPos = (fd >= 0) ? max(lseek(fd, 0, SEEK_CUR), (off_t)0) : 0;
+
     if (fd < 0)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
@@ -152,6 +193,15 @@ ThreadedFileWriter::~ThreadedFileWriter()
 {
     Flush();
 
+    {
+        QMutexLocker locker(&s_timeshiftLock);
+        QMutexLocker buflocker(&buflock);
+        if (s_timeshifts.value(timeshift_key(filename)) == this)
+            s_timeshifts.remove(timeshift_key(filename));
+        timeshifted = false;
+        UpdateTimeshiftRAM();
+    }
+
     {  /* tell child threads to exit */
         QMutexLocker locker(&buflock);
         in_dtor = true;
@@ -215,7 +265,9 @@ uint ThreadedFileWriter::Write(const void *data, uint count)
     {
         uint towrite = (left > kMaxBlockSize) ? kMaxBlockSize : left;
 
-        if ((totalBufferUse + towrite) > (kMaxBufferSize * (m_blocking ? 1 : 8)))
+        uint64_t max_use = (uint64_t) kMaxBufferSize * (m_blocking ? 1 : 8) +
+            timeshiftSize;
+        if ((totalBufferUse + towrite) > max_use)
         {
             if (!m_blocking)
             {
@@ -288,6 +340,8 @@ uint ThreadedFileWriter::Write(const void *data, uint count)
         left    -= towrite;
     }
 
+    UpdateTimeshiftRAM();
+
     LOG(VB_FILE, LOG_DEBUG, LOC + QString("Write(*, %1) total %2 cnt %3")
             .arg(count,4).arg(totalBufferUse).arg(writeBuffers.size()));
 
@@ -320,7 +374,11 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
         }
     }
     flush = false;
-    return lseek(fd, pos, whence);
+
+    long long ret = lseek(fd, pos, whence);
+    if (ret >= 0)
+        diskPos = ret;
+    return ret;
 }
 
 /** \fn ThreadedFileWriter::Flush(void)
@@ -452,6 +510,13 @@ void ThreadedFileWriter::DiskLoop(void)
             continue;
         }
 
+        if (HoldInTimeshift())
+        {
+            bufferHasData.wait(locker.mutex(), 1000);
+            TrimEmptyBuffers();
+            continue;
+        }
+
         int mwte = minWriteTimer.elapsed();
         if (!flush && (mwte < 250) && (totalBufferUse < kMinWriteSize))
         {
@@ -470,6 +535,14 @@ void ThreadedFileWriter::DiskLoop(void)
         TFWBuffer *buf = writeBuffers.front();
         writeBuffers.pop_front();
         totalBufferUse -= buf->data.size();
+        // Keep it readable for ReadTimeshift() until it is on disk
+        diskBuffer = buf;
+        UpdateTimeshiftRAM();
+        if (timeshiftFull && !flush)
+        {
+            QMutexLocker slocker(&s_statsLock);
+            s_stats.spilledBytes += buf->data.size();
+        }
         bufferWasFreed.wakeAll();
         minWriteTimer.start();
 
@@ -528,6 +601,9 @@ void ThreadedFileWriter::DiskLoop(void)
 
         //////////////////////////////////////////
 
+        diskPos += sz;
+        diskBuffer = NULL;
+
         buf->lastUsed = MythDate::current();
         emptyBuffers.push_back(buf);
 
@@ -605,3 +681,178 @@ bool ThreadedFileWriter::SetBlocking(bool block)
     m_blocking = block;
     return old;
 }
+
+/** \brief Holds up to \p max_bytes, or \p max_secs worth, of the most
+ *         recent writes in RAM instead of writing them to disk.
+ *
+ *  Data that leaves the window is written ("spilled") to disk as usual,
+ *  as is everything that is left when the file is flushed or closed.
+ *  Passing 0 for \p max_bytes writes everything to disk again, e.g.
+ *  when the recording is going to be kept.  The file stays readable with
+ *  ReadTimeshift() until it is closed.
+ */
+void ThreadedFileWriter::SetTimeshift(uint64_t max_bytes, uint max_secs)
+{
+    QMutexLocker locker(&s_timeshiftLock);
+    QMutexLocker buflocker(&buflock);
+
+    timeshiftSize = max_bytes;
+    timeshiftSecs = max_secs;
+    timeshiftFull = false;
+
+    if (max_bytes && !timeshifted)
+    {
+        timeshifted = true;
+        s_timeshifts[timeshift_key(filename)] = this;
+    }
+
+    UpdateTimeshiftRAM();
+    bufferHasData.wakeAll();
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Timeshift of %1 kB, %2 seconds")
+        .arg(max_bytes / 1024).arg(max_secs));
+}
+
+/// \brief Returns true if the file is being written with a timeshift
+bool ThreadedFileWriter::IsTimeshifted(const QString &fname)
+{
+    QMutexLocker locker(&s_timeshiftLock);
+    return s_timeshifts.contains(timeshift_key(fname));
+}
+
+/** \brief Copies data of a file being written with a timeshift that
+ *         hasn't been written to disk yet.
+ *
+ *  \return number of bytes copied, 0 if \p pos is already on disk, is
+ *          at the end of the file or the file isn't timeshifted.
+ */
+int ThreadedFileWriter::ReadTimeshift(const QString &fname, long long pos,
+                                      void *data, uint count)
+{
+    QMutexLocker locker(&s_timeshiftLock);
+
+    ThreadedFileWriter *tfw = s_timeshifts.value(timeshift_key(fname));
+    if (!tfw)
+        return 0;
+
+    int copied;
+    {
+        QMutexLocker buflocker(&tfw->buflock);
+        copied = tfw->CopyFromBuffers(pos, (char*) data, count);
+    }
+
+    if (copied > 0)
+    {
+        QMutexLocker slocker(&s_statsLock);
+        s_stats.ramReadBytes += copied;
+    }
+
+    return copied;
+}
+
+/** \brief Returns the size of a file being written with a timeshift,
+ *         including the part that is only in RAM, or -1 if the file isn't
+ *         timeshifted.
+ */
+long long ThreadedFileWriter::GetTimeshiftSize(const QString &fname)
+{
+    QMutexLocker locker(&s_timeshiftLock);
+
+    ThreadedFileWriter *tfw = s_timeshifts.value(timeshift_key(fname));
+    if (!tfw)
+        return -1;
+
+    QMutexLocker buflocker(&tfw->buflock);
+    long long size = tfw->diskPos + tfw->totalBufferUse;
+    if (tfw->diskBuffer)
+        size += tfw->diskBuffer->data.size();
+    return size;
+}
+
+TimeshiftStats ThreadedFileWriter::GetTimeshiftStats(void)
+{
+    QMutexLocker locker(&s_timeshiftLock);
+    QMutexLocker slocker(&s_statsLock);
+    TimeshiftStats stats = s_stats;
+    stats.buffers = s_timeshifts.size();
+    return stats;
+}
+
+/** \brief Returns true if DiskLoop() should leave the buffers in RAM,
+ *         buflock must be held.
+ */
+bool ThreadedFileWriter::HoldInTimeshift(void)
+{
+    if (!timeshiftSize || flush || writeBuffers.empty())
+        return false;
+
+    bool expired = timeshiftSecs &&
+        (writeBuffers.front()->lastUsed.secsTo(MythDate::current()) >
+         (int) timeshiftSecs);
+
+    if (totalBufferUse <= timeshiftSize && !expired)
+    {
+        // Half empty again, e.g. after a Flush(), the next time the
+        // window fills up is a new spill.
+        if (totalBufferUse < timeshiftSize / 2)
+            timeshiftFull = false;
+        return true;
+    }
+
+    if (!timeshiftFull)
+    {
+        timeshiftFull = true;
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Timeshift window full (%1 kB), writing to disk")
+                .arg(totalBufferUse / 1024));
+        QMutexLocker slocker(&s_statsLock);
+        s_stats.spills++;
+    }
+
+    return false;
+}
+
+/// \brief Updates the RAM use in the stats, buflock must be held.
+void ThreadedFileWriter::UpdateTimeshiftRAM(void)
+{
+    uint64_t ram = timeshifted ? totalBufferUse : 0;
+    if (ram == timeshiftRAM)
+        return;
+
+    QMutexLocker slocker(&s_statsLock);
+    s_stats.ramBytes = s_stats.ramBytes + ram - timeshiftRAM;
+    s_stats.peakRAMBytes = max(s_stats.peakRAMBytes, s_stats.ramBytes);
+    timeshiftRAM = ram;
+}
+
+/// \brief Copies buffered data starting at \p pos, buflock must be held.
+int ThreadedFileWriter::CopyFromBuffers(long long pos, char *data,
+                                        uint count) const
+{
+    if (pos < diskPos)
+        return 0;
+
+    QList<TFWBuffer*> buffers = writeBuffers;
+    if (diskBuffer)
+        buffers.push_front(diskBuffer);
+
+    uint copied = 0;
+    long long start = diskPos;
+    QList<TFWBuffer*>::const_iterator it = buffers.begin();
+    for (; it != buffers.end() && copied < count; ++it)
+    {
+        const vector<char> &buf = (*it)->data;
+        long long end = start + buf.size();
+        if (pos < end)
+        {
+            uint offset = pos - start;
+            uint size   = min((uint)(buf.size() - offset), count - copied);
+            memcpy(data + copied, &buf[offset], size);
+            copied += size;
+            pos    += size;
+        }
+        start = end;
+    }
+
+    return copied;
+}
@@ -9,6 +9,7 @@ using namespace std;
 #include <QDateTime>
 #include <QString>
 #include <QMutex>
+#include <QHash>
 
 #include <fcntl.h>
 #include <stdint.h>
@@ -18,6 +19,22 @@ using namespace std;
 
 class ThreadedFileWriter;
 
+/// \brief Totals of all timeshift buffers in this process, see
+///        ThreadedFileWriter::GetTimeshiftStats()
+struct MBASE_PUBLIC TimeshiftStats
+{
+    TimeshiftStats() :
+        buffers(0), ramBytes(0), peakRAMBytes(0), spills(0),
+        spilledBytes(0), ramReadBytes(0) {}
+
+    uint     buffers;       ///< Files currently buffered in RAM
+    uint64_t ramBytes;      ///< Bytes currently held in RAM
+    uint64_t peakRAMBytes;  ///< Most bytes ever held in RAM at once
+    uint     spills;        ///< Times a buffer grew past its RAM window
+    uint64_t spilledBytes;  ///< Bytes written to disk after the window
+    uint64_t ramReadBytes;  ///< Bytes served from RAM by ReadTimeshift()
+};
+
 class TFWWriteThread : public MThread
 {
   public:
@@ -42,6 +59,7 @@ class MBASE_PUBLIC ThreadedFileWriter
 {
     friend class TFWWriteThread;
     friend class TFWSyncThread;
+    friend class TestThreadedFileWriter;
   public:
     ThreadedFileWriter(const QString &fname, int flags, mode_t mode);
     ~ThreadedFileWriter();
@@ -58,10 +76,21 @@ class MBASE_PUBLIC ThreadedFileWriter
     void Flush(void);
     bool SetBlocking(bool block = true);
 
+    void SetTimeshift(uint64_t max_bytes, uint max_secs = 0);
+
+    static bool IsTimeshifted(const QString &fname);
+    static int  ReadTimeshift(const QString &fname, long long pos,
+                              void *data, uint count);
+    static long long GetTimeshiftSize(const QString &fname);
+    static TimeshiftStats GetTimeshiftStats(void);
+
   protected:
     void DiskLoop(void);
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
+    bool HoldInTimeshift(void);
+    void UpdateTimeshiftRAM(void);
+    int  CopyFromBuffers(long long pos, char *data, uint count) const;
 
   private:
     // file info
@@ -76,6 +105,15 @@ class MBASE_PUBLIC ThreadedFileWriter
     bool            ignore_writes;      // protected by buflock
     uint            tfw_min_write_size; // protected by buflock
     uint            totalBufferUse;     // protected by buflock
+    /// File position of the first byte that is still buffered
+    long long       diskPos;            // protected by buflock
+
+    // timeshift, writes are held back in RAM until they leave the window
+    bool            timeshifted;        // protected by buflock
+    uint64_t        timeshiftSize;      // protected by buflock
+    uint            timeshiftSecs;      // protected by buflock
+    bool            timeshiftFull;      // protected by buflock
+    uint64_t        timeshiftRAM;       // protected by buflock
 
     // buffers
     class TFWBuffer
@@ -87,6 +125,8 @@ class MBASE_PUBLIC ThreadedFileWriter
     mutable QMutex    buflock;
     QList<TFWBuffer*> writeBuffers;     // protected by buflock
     QList<TFWBuffer*> emptyBuffers;     // protected by buflock
+    /// Buffer being written by DiskLoop(), it follows diskPos
+    TFWBuffer        *diskBuffer;       // protected by buflock
 
     // threads
     TFWWriteThread *writeThread;
@@ -107,6 +147,13 @@ class MBASE_PUBLIC ThreadedFileWriter
 
     bool m_warned;
     bool m_blocking;
+
+    // Writers with a timeshift, by file name.  s_timeshiftLock is taken
+    // before buflock, s_statsLock is taken last.
+    static QMutex                              s_timeshiftLock;
+    static QHash<QString, ThreadedFileWriter*> s_timeshifts;
+    static QMutex                              s_statsLock;
+    static TimeshiftStats                      s_stats;
 };
 
 #endif
@@ -17,11 +17,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
 #include "el_processor.h"
+#include "mythconfig.h"
 #include <cstdlib>
 #include <cstring>
 #include <complex>
 #include <cmath>
 #include <vector>
+#include <QRunnable>
+#include <QSemaphore>
+#include "mthreadpool.h"
+#if HAVE_SSE2 && defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE_LANES 1
+#endif
 #ifdef USE_FFTW3
 #include "fftw3.h"
 #else
@@ -43,6 +51,137 @@ static const float PI = 3.141592654;
 static const float epsilon = 0.000001;
 static const float center_level = 0.5*sqrt(0.5);
 
+// --- lanes for the per-bin decoding ---
+// The per-bin math of block_decode() is written once, as templates over a
+// "lane" type: float for the plain path and v4f (four bins in one SSE
+// register) where the compiler targets SSE2. Comparisons yield a mask (a
+// bool, or all bits set per lane) which vselect() uses instead of branches.
+
+static inline float vselect(bool m, float a, float b) { return m ? a : b; }
+static inline float vmin(float a, float b) { return a<b?a:b; }
+static inline float vmax(float a, float b) { return a>b?a:b; }
+static inline float vabs(float a) { return std::fabs(a); }
+static inline float vsqrt(float a) { return std::sqrt(a); }
+static inline float vtrunc(float a) { return (float)(int)a; }
+static inline void vload(const float *p, float &a) { a = *p; }
+static inline void vstore(float *p, float a) { *p = a; }
+// (re,im) pairs <-> separate real and imaginary lanes
+static inline void vload_complex(const float *p, float &re, float &im) { re = p[0]; im = p[1]; }
+static inline void vstore_complex(float *p, float re, float im) { p[0] = re; p[1] = im; }
+
+#ifdef USE_SSE_LANES
+class v4f {
+public:
+    v4f() { }
+    v4f(__m128 x): v(x) { }
+    v4f(float x): v(_mm_set1_ps(x)) { }
+    __m128 v;
+};
+
+static inline v4f operator+(const v4f &a, const v4f &b) { return _mm_add_ps(a.v,b.v); }
+static inline v4f operator-(const v4f &a, const v4f &b) { return _mm_sub_ps(a.v,b.v); }
+static inline v4f operator*(const v4f &a, const v4f &b) { return _mm_mul_ps(a.v,b.v); }
+static inline v4f operator/(const v4f &a, const v4f &b) { return _mm_div_ps(a.v,b.v); }
+static inline v4f operator-(const v4f &a) { return _mm_xor_ps(a.v,_mm_set1_ps(-0.0f)); }
+static inline v4f operator<(const v4f &a, const v4f &b) { return _mm_cmplt_ps(a.v,b.v); }
+static inline v4f operator>(const v4f &a, const v4f &b) { return _mm_cmpgt_ps(a.v,b.v); }
+
+static inline v4f vselect(const v4f &m, const v4f &a, const v4f &b) {
+    return _mm_or_ps(_mm_and_ps(m.v,a.v),_mm_andnot_ps(m.v,b.v));
+}
+static inline v4f vmin(const v4f &a, const v4f &b) { return _mm_min_ps(a.v,b.v); }
+static inline v4f vmax(const v4f &a, const v4f &b) { return _mm_max_ps(a.v,b.v); }
+static inline v4f vabs(const v4f &a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f),a.v); }
+static inline v4f vsqrt(const v4f &a) { return _mm_sqrt_ps(a.v); }
+static inline v4f vtrunc(const v4f &a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v)); }
+static inline void vload(const float *p, v4f &a) { a = _mm_loadu_ps(p); }
+static inline void vstore(float *p, const v4f &a) { _mm_storeu_ps(p,a.v); }
+static inline void vload_complex(const float *p, v4f &re, v4f &im) {
+    __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p+4);
+    re = _mm_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0));
+    im = _mm_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1));
+}
+static inline void vstore_complex(float *p, const v4f &re, const v4f &im) {
+    _mm_storeu_ps(p,_mm_unpacklo_ps(re.v,im.v));
+    _mm_storeu_ps(p+4,_mm_unpackhi_ps(re.v,im.v));
+}
+#endif
+
+// the abs() this decoder has always called on floats is the integer one
+// from <cstdlib>, the steering depends on its truncation
+template <class V> static inline V int_abs(const V &x) { return vtrunc(vabs(x)); }
+
+// --- fast approximations ---
+// Minimax polynomials; over the ranges the decoder uses (|x| <= 1.1) the
+// errors are below 1e-7, except fast_atan2() which is within 5e-7.
+
+// sin(x) - x
+template <class V> static inline V sin_m_x(const V &x) {
+    V x2 = x*x;
+    return x*x2*(V(-0.16666666664850255f) + x2*(V(0.008333333161644148f) +
+           x2*(V(-0.00019841213021250402f) + x2*(V(2.7548765292916194e-06f) +
+           x2*V(-2.445167925369901e-08f)))));
+}
+
+// 1 - cos(x)
+template <class V> static inline V one_m_cos(const V &x) {
+    V x2 = x*x;
+    return x2*(V(0.49999999986532667f) + x2*(V(-0.04166666510719735f) +
+           x2*(V(0.001388882989895914f) + x2*(V(-2.4791816746784903e-05f) +
+           x2*V(2.682019249201957e-07f)))));
+}
+
+// tan(x) - x
+template <class V> static inline V tan_m_x(const V &x) {
+    V omc = one_m_cos(x);
+    return (sin_m_x(x) + x*omc) / (V(1.0f) - omc);
+}
+
+// asin(x), |x| <= 1
+template <class V> static inline V fast_asin(const V &x) {
+    V a = vabs(x);
+    V p = V(1.57079626f) + a*(V(-0.214597060f) + a*(V(0.0889598178f) +
+          a*(V(-0.0500848688f) + a*(V(0.0306826362f) + a*(V(-0.0168304377f) +
+          a*(V(0.00651085800f) + a*V(-0.00122369340f)))))));
+    V r = V(PI/2) - vsqrt(V(1.0f) - a)*p;
+    return vselect(x < V(0.0f), -r, r);
+}
+
+// asin(x) - x, |x| <= 1
+template <class V> static inline V asin_m_x(const V &x) {
+    V x2 = x*x;
+    V small = x*x2*(V(0.16666653151343164f) + x2*(V(0.07500814905492338f) +
+              x2*(V(0.04446748648203363f) + x2*(V(0.03216604651751644f) +
+              x2*(V(0.013229817857112885f) + x2*V(0.03905940294612038f))))));
+    return vselect(vabs(x) < V(0.5f), small, fast_asin(x) - x);
+}
+
+// atan2(y,x) for y >= 0
+template <class V> static inline V fast_atan2(const V &y, const V &x) {
+    V ax = vabs(x);
+    V mx = vmax(ax,y), mn = vmin(ax,y);
+    V z = vselect(mx > V(0.0f), mn/mx, V(0.0f));
+    V z2 = z*z;
+    V r = z*(V(0.99999562f) + z2*(V(-0.33316f) + z2*(V(0.19796871f) +
+          z2*(V(-0.13195822f) + z2*(V(0.07899836f) + z2*(V(-0.03310397f) +
+          z2*V(0.00665786f)))))));
+    r = vselect(y > ax, V(PI/2) - r, r);
+    return vselect(x < V(0.0f), V(PI) - r, r);
+}
+
+class decoder_impl;
+
+// one of the transforms of block_decode(), for the block-parallel mode
+class decoder_job : public QRunnable {
+public:
+    decoder_job(decoder_impl *d, unsigned i): decoder(d), index(i), inverse(false) { setAutoDelete(false); }
+    void run(void);
+
+    decoder_impl *decoder;
+    unsigned index;                    // the input (0=left, 1=right) or the output channel
+    bool inverse;                      // transform the output channel rather than the input
+};
+
 // private implementation of the surround decoder
 class decoder_impl {
 public:
@@ -53,26 +192,33 @@ public:
         // create FFTW buffers
         lt = (float*)fftwf_malloc(sizeof(float)*N);
         rt = (float*)fftwf_malloc(sizeof(float)*N);
-        dst = (float*)fftwf_malloc(sizeof(float)*N);
         dftL = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
         dftR = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
-        src = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
+        for (unsigned c=0;c<6;c++) {
+            dst[c] = (float*)fftwf_malloc(sizeof(float)*N);
+            src[c] = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*N);
+        }
         loadL = fftwf_plan_dft_r2c_1d(N, lt, dftL,FFTW_MEASURE);
         loadR = fftwf_plan_dft_r2c_1d(N, rt, dftR,FFTW_MEASURE);
-        store = fftwf_plan_dft_c2r_1d(N, src, dst,FFTW_MEASURE);    
+        // one plan for all channels, apply_filter() gives it their arrays
+        store = fftwf_plan_dft_c2r_1d(N, src[0], dst[0],FFTW_MEASURE);
 #else
         // create lavc fft buffers
         lt = (float*)av_malloc(sizeof(FFTSample)*N);
         rt = (float*)av_malloc(sizeof(FFTSample)*N);
         dftL = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*N*2);
         dftR = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*N*2);
-        src = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*N*2);
         fftContextForward = (FFTContext*)av_malloc(sizeof(FFTContext));
         memset(fftContextForward, 0, sizeof(FFTContext));
-        fftContextReverse = (FFTContext*)av_malloc(sizeof(FFTContext));
-        memset(fftContextReverse, 0, sizeof(FFTContext));
         ff_fft_init(fftContextForward, 13, 0);
-        ff_fft_init(fftContextReverse, 13, 1);
+        // av_fft_permute() goes through the context's tmp_buf, so each
+        // channel needs a context of its own
+        for (unsigned c=0;c<6;c++) {
+            src[c] = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*N*2);
+            fftContextReverse[c] = (FFTContext*)av_malloc(sizeof(FFTContext));
+            memset(fftContextReverse[c], 0, sizeof(FFTContext));
+            ff_fft_init(fftContextReverse[c], 13, 1);
+        }
 #endif
         // resize our own buffers
         frontR.resize(N);
@@ -81,14 +227,16 @@ public:
         surR.resize(N);
         surL.resize(N);
         trueavg.resize(N);
-        xfs.resize(N);
-        yfs.resize(N);
         inbuf[0].resize(N);
         inbuf[1].resize(N);
         for (unsigned c=0;c<6;c++) {
             outbuf[c].resize(N);
             filter[c].resize(N);
+            jobs[c] = new decoder_job(this,c);
         }
+        signal[0] = &frontL; signal[1] = &avg; signal[2] = &frontR;
+        signal[3] = &surL; signal[4] = &surR; signal[5] = &trueavg;
+        pool = NULL;
         sample_rate(48000);
         // generate the window function (square root of hann, b/c it is applied before and after the transform)
         wnd.resize(N);
@@ -106,27 +254,34 @@ public:
 
     // destructor
     ~decoder_impl() {
+        delete pool;
+        for (unsigned c=0;c<6;c++)
+            delete jobs[c];
 #ifdef USE_FFTW3
         // clean up the FFTW stuff
         fftwf_destroy_plan(store);
         fftwf_destroy_plan(loadR);
         fftwf_destroy_plan(loadL);
-        fftwf_free(src); 
+        for (unsigned c=0;c<6;c++) {
+            fftwf_free(src[c]);
+            fftwf_free(dst[c]);
+        }
         fftwf_free(dftR);
         fftwf_free(dftL);
-        fftwf_free(dst);
         fftwf_free(rt);
         fftwf_free(lt);
 #else
         ff_fft_end(fftContextForward);
-        ff_fft_end(fftContextReverse);
-        av_free(src); 
+        for (unsigned c=0;c<6;c++) {
+            ff_fft_end(fftContextReverse[c]);
+            av_free(fftContextReverse[c]);
+            av_free(src[c]);
+        }
         av_free(dftR);
         av_free(dftL);
         av_free(rt);
         av_free(lt);
         av_free(fftContextForward); 
-        av_free(fftContextReverse); 
 #endif
     }
 
@@ -204,6 +359,9 @@ public:
         const float modes[4][2] = {{0,0},{0,PI},{PI,0},{-PI/2,PI/2}};
         phase_offsetL = modes[mode][0];
         phase_offsetR = modes[mode][1];
+        // the rear signals are the front ones rotated by these
+        phase_cosL = cos(phase_offsetL); phase_sinL = sin(phase_offsetL);
+        phase_cosR = cos(phase_offsetR); phase_sinR = sin(phase_offsetR);
     }
 
     // what steering mode should be chosen
@@ -215,16 +373,20 @@ public:
         rear_separation = rear;
     }
 
+    // run the transforms of a block on pool threads
+    void parallel_mode(bool mode) {
+        if (mode && !pool) {
+            pool = new MThreadPool("FreeSurround");
+            pool->setMaxThreadCount(5);
+        } else if (!mode && pool) {
+            delete pool;
+            pool = NULL;
+        }
+    }
+
 private:
-    // polar <-> cartesian coodinates conversion
-    static inline float amplitude(const float cf[2]) { return sqrt(cf[0]*cf[0] + cf[1]*cf[1]); }
-    static inline float phase(const float cf[2]) { return atan2(cf[1],cf[0]); }
-    static inline cfloat polar(float a, float p) { return cfloat(a*cos(p),a*sin(p)); }
-    static inline float sqr(float x) { return x*x; }
-    // the dreaded min/max
-    static inline float min(float a, float b) { return a<b?a:b; }
-    static inline float max(float a, float b) { return a>b?a:b; }
-    static inline float clamp(float x) { return max(-1,min(1,x)); }
+    template <class V> static inline V clamp(const V &x) { return vmax(V(-1.0f),vmin(V(1.0f),x)); }
+    static inline float *bin(std::vector<cfloat> &v, unsigned f) { return reinterpret_cast<float*>(&v[f]); }
 
     // handle the output buffering for overlapped calls of block_decode
     void add_output(float *input1[2], float *input2[2], float center_width, float dimension, float adaption_rate, bool result=false) {
@@ -256,176 +418,187 @@ private:
             }
         }
 
-#ifdef USE_FFTW3
         // ... and tranform it into the frequency domain
-        fftwf_execute(loadL);
-        fftwf_execute(loadR);
-#else
-        ff_fft_permuteRC(fftContextForward, lt, (FFTComplex*)&dftL[0]);
-        av_fft_calc(fftContextForward, (FFTComplex*)&dftL[0]);
-
-        ff_fft_permuteRC(fftContextForward, rt, (FFTComplex*)&dftR[0]);
-        av_fft_calc(fftContextForward, (FFTComplex*)&dftR[0]);
-#endif
+        run_jobs(false,2);
 
         // 2. compare amplitude and phase of each DFT bin and produce the X/Y coordinates in the sound field
         //    but dont do DC or N/2 component
-        for (unsigned f=0;f<halfN;f++) {           
-            // get left/right amplitudes/phases
-            float ampL = amplitude(dftL[f]), ampR = amplitude(dftR[f]);
-            float phaseL = phase(dftL[f]), phaseR = phase(dftR[f]);
-//          if (ampL+ampR < epsilon)
-//              continue;       
-
-            // calculate the amplitude/phase difference
-            float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-            float phaseDiff = phaseL - phaseR;
-            if (phaseDiff < -PI) phaseDiff += 2*PI;
-            if (phaseDiff > PI) phaseDiff -= 2*PI;
-            phaseDiff = abs(phaseDiff);
-
-            if (linear_steering) {
-                // --- this is the fancy new linear mode ---
-
-                // get sound field x/y position
-                yfs[f] = get_yfs(ampDiff,phaseDiff);
-                xfs[f] = get_xfs(ampDiff,yfs[f]);
-
-                // add dimension control
-                yfs[f] = clamp(yfs[f] - dimension);
-
-                // add crossfeed control
-                xfs[f] = clamp(xfs[f] * (front_separation*(1+yfs[f])/2 + rear_separation*(1-yfs[f])/2));
-
-                // 3. generate frequency filters for each output channel
-                float left = (1-xfs[f])/2, right = (1+xfs[f])/2;
-                float front = (1+yfs[f])/2, back = (1-yfs[f])/2;
-                float volume[5] = {
-                    front * (left * center_width + max(0,-xfs[f]) * (1-center_width)),  // left
-                    front * center_level*((1-abs(xfs[f])) * (1-center_width)),          // center
-                    front * (right * center_width + max(0, xfs[f]) * (1-center_width)), // right
-                    back * surround_level * left,                                       // left surround
-                    back * surround_level * right                                       // right surround
-                };
-
-                // adapt the prior filter
-                for (unsigned c=0;c<5;c++)
-                    filter[c][f] = (1-adaption_rate)*filter[c][f] + adaption_rate*volume[c];
-
-            } else {
-                // --- this is the old & simple steering mode ---
-
-                // calculate the amplitude/phase difference
-                float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-                float phaseDiff = phaseL - phaseR;
-                if (phaseDiff < -PI) phaseDiff += 2*PI;
-                if (phaseDiff > PI) phaseDiff -= 2*PI;
-                phaseDiff = abs(phaseDiff);
-
-                // determine sound field x-position
-                xfs[f] = ampDiff;
-
-                // determine preliminary sound field y-position from phase difference
-                yfs[f] = 1 - (phaseDiff/PI)*2;
-
-                if (abs(xfs[f]) > surround_balance) {
-                    // blend linearly between the surrounds and the fronts if the balance exceeds the surround encoding balance
-                    // this is necessary because the sound field is trapezoidal and will be stretched behind the listener
-                    float frontness = (abs(xfs[f]) - surround_balance)/(1-surround_balance);
-                    yfs[f]  = (1-frontness) * yfs[f] + frontness * 1; 
-                }
-
-                // add dimension control
-                yfs[f] = clamp(yfs[f] - dimension);
-
-                // add crossfeed control
-                xfs[f] = clamp(xfs[f] * (front_separation*(1+yfs[f])/2 + rear_separation*(1-yfs[f])/2));
-
-                // 3. generate frequency filters for each output channel, according to the signal position
-                // the sum of all channel volumes must be 1.0
-                float left = (1-xfs[f])/2, right = (1+xfs[f])/2;
-                float front = (1+yfs[f])/2, back = (1-yfs[f])/2;
-                float volume[5] = {
-                    front * (left * center_width + max(0,-xfs[f]) * (1-center_width)),      // left
-                    front * center_level*((1-abs(xfs[f])) * (1-center_width)),              // center
-                    front * (right * center_width + max(0, xfs[f]) * (1-center_width)),     // right
-                    back * surround_level*max(0,min(1,((1-(xfs[f]/surround_balance))/2))),  // left surround
-                    back * surround_level*max(0,min(1,((1+(xfs[f]/surround_balance))/2)))   // right surround
-                };
-
-                // adapt the prior filter
-                for (unsigned c=0;c<5;c++)
-                    filter[c][f] = (1-adaption_rate)*filter[c][f] + adaption_rate*volume[c];
-            }
-
-            // ... and build the signal which we want to position
-            frontL[f] = polar(ampL+ampR,phaseL);
-            frontR[f] = polar(ampL+ampR,phaseR);
-            avg[f] = frontL[f] + frontR[f];
-            surL[f] = polar(ampL+ampR,phaseL+phase_offsetL);
-            surR[f] = polar(ampL+ampR,phaseR+phase_offsetR);
-            trueavg[f] = cfloat(dftL[f][0] + dftR[f][0], dftL[f][1] + dftR[f][1]);
-        }
+        //    the bins are independent, so with SSE this is done for four of them at a time
+        unsigned f = 0;
+#ifdef USE_SSE_LANES
+        for (;f+4<=halfN;f+=4)
+            decode_bins<v4f>(f,center_width,dimension,adaption_rate);
+#endif
+        for (;f<halfN;f++)
+            decode_bins<float>(f,center_width,dimension,adaption_rate);
 
         // 4. distribute the unfiltered reference signals over the channels
-        apply_filter(&frontL[0],&filter[0][0],&output[0][0]);   // front left
-        apply_filter(&avg[0], &filter[1][0],&output[1][0]);     // front center
-        apply_filter(&frontR[0],&filter[2][0],&output[2][0]);   // front right
-        apply_filter(&surL[0],&filter[3][0],&output[3][0]);     // surround left
-        apply_filter(&surR[0],&filter[4][0],&output[4][0]);     // surround right
-        apply_filter(&trueavg[0],&filter[5][0],&output[5][0]);  // lfe
+        //    (front left, center, front right, surround left, surround right, lfe)
+        for (unsigned c=0;c<6;c++)
+            target[c] = output[c];
+        run_jobs(true,6);
     }
 
-#define FASTER_CALC
-    // map from amplitude difference and phase difference to yfs
-    inline double get_yfs(double ampDiff, double phaseDiff) {
-        double x = 1-(((1-sqr(ampDiff))*phaseDiff)/PI*2);
-#ifdef FASTER_CALC
-        double tanX = tan(x);
-        return 0.16468622925824683 + 0.5009268347818189*x - 0.06462757726992101*x*x
-            + 0.09170680403453149*x*x*x + 0.2617754892323973*tanX - 0.04180413533856156*sqr(tanX);
+    // run the forward (inputs) or inverse (channels) transforms of a block;
+    // in block-parallel mode the pool takes all but the first of them
+    void run_jobs(bool inverse, unsigned count) {
+        unsigned started = 0;
+        for (unsigned i=1;i<count;i++) {
+            jobs[i]->inverse = inverse;
+            if (pool && pool->tryStart(jobs[i],"FreeSurround"))
+                started++;
+            else
+                run_job(inverse,i);
+        }
+        run_job(inverse,0);
+        done.acquire(started);
+    }
+
+    // the jobs only share data they read
+    void run_job(bool inverse, unsigned i) {
+        if (inverse) {
+            apply_filter(&(*signal[i])[0],&filter[i][0],target[i],i);
+            return;
+        }
+#ifdef USE_FFTW3
+        fftwf_execute(i ? loadR : loadL);
 #else
-        return 0.16468622925824683 + 0.5009268347818189*x - 0.06462757726992101*x*x
-            + 0.09170680403453149*x*x*x + 0.2617754892323973*tan(x) - 0.04180413533856156*sqr(tan(x));
+        // ff_fft_permuteRC() and av_fft_calc() leave the context alone
+        FFTSample *in = i ? rt : lt;
+        FFTComplexArray *dft = i ? dftR : dftL;
+        ff_fft_permuteRC(fftContextForward, in, (FFTComplex*)&dft[0]);
+        av_fft_calc(fftContextForward, (FFTComplex*)&dft[0]);
 #endif
     }
 
+    // steps 2. and 3. of block_decode for the bins f.. of one lane
+    template <class V> inline void decode_bins(unsigned f, float center_width, float dimension, float adaption_rate) {
+        V Lr, Li, Rr, Ri;
+        vload_complex(&dftL[f][0],Lr,Li);
+        vload_complex(&dftR[f][0],Rr,Ri);
+
+        // get left/right amplitudes, the phase difference comes from
+        // the cross and dot products rather than from two atan2()s
+        V ampL = vsqrt(Lr*Lr + Li*Li), ampR = vsqrt(Rr*Rr + Ri*Ri);
+        V ampSum = ampL + ampR;
+
+        // calculate the amplitude/phase difference
+        V ampDiff = clamp(vselect(ampSum < V(epsilon), V(0.0f), (ampR-ampL) / ampSum));
+        V phaseDiff = int_abs(fast_atan2(vabs(Li*Rr - Lr*Ri), Lr*Rr + Li*Ri));
+
+        V xfs, yfs;
+        if (linear_steering) {
+            // --- this is the fancy new linear mode ---
+
+            // get sound field x/y position
+            yfs = get_yfs(ampDiff,phaseDiff);
+            xfs = get_xfs(ampDiff,yfs);
+        } else {
+            // --- this is the old & simple steering mode ---
+
+            // determine sound field x-position
+            xfs = ampDiff;
+
+            // determine preliminary sound field y-position from phase difference
+            yfs = V(1.0f) - (phaseDiff/V(PI))*V(2.0f);
+
+            // blend linearly between the surrounds and the fronts if the balance exceeds the surround encoding balance
+            // this is necessary because the sound field is trapezoidal and will be stretched behind the listener
+            V frontness = (int_abs(xfs) - V(surround_balance))/V(1-surround_balance);
+            yfs = vselect(int_abs(xfs) > V(surround_balance), (V(1.0f)-frontness) * yfs + frontness, yfs);
+        }
+
+        // add dimension control
+        yfs = clamp(yfs - V(dimension));
+
+        // add crossfeed control
+        xfs = clamp(xfs * (V(front_separation)*(V(1.0f)+yfs)/V(2.0f) + V(rear_separation)*(V(1.0f)-yfs)/V(2.0f)));
+
+        // 3. generate frequency filters for each output channel, according to the signal position
+        // the sum of all channel volumes must be 1.0
+        V left = (V(1.0f)-xfs)/V(2.0f), right = (V(1.0f)+xfs)/V(2.0f);
+        V front = (V(1.0f)+yfs)/V(2.0f), back = (V(1.0f)-yfs)/V(2.0f);
+        V width = V(center_width), spread = V(1-center_width);
+        V volume[5];
+        volume[0] = front * (left * width + vmax(V(0.0f),-xfs) * spread);               // left
+        volume[1] = front * V(center_level)*((V(1.0f)-int_abs(xfs)) * spread);         // center
+        volume[2] = front * (right * width + vmax(V(0.0f), xfs) * spread);             // right
+        if (linear_steering) {
+            volume[3] = back * V(surround_level) * left;                                // left surround
+            volume[4] = back * V(surround_level) * right;                               // right surround
+        } else {
+            V balance = xfs/V(surround_balance);
+            volume[3] = back * V(surround_level)*vmax(V(0.0f),vmin(V(1.0f),((V(1.0f)-balance)/V(2.0f))));
+            volume[4] = back * V(surround_level)*vmax(V(0.0f),vmin(V(1.0f),((V(1.0f)+balance)/V(2.0f))));
+        }
+
+        // adapt the prior filter
+        for (unsigned c=0;c<5;c++) {
+            V prior;
+            vload(&filter[c][f],prior);
+            vstore(&filter[c][f],V(1-adaption_rate)*prior + V(adaption_rate)*volume[c]);
+        }
+
+        // ... and build the signal which we want to position; that is
+        // the left/right bins scaled to the amplitude ampL+ampR, with the
+        // rear ones rotated by the phase offsets
+        V scaleL = vselect(ampL > V(0.0f), ampSum/ampL, V(0.0f));
+        V scaleR = vselect(ampR > V(0.0f), ampSum/ampR, V(0.0f));
+        V fLr = vselect(ampL > V(0.0f), Lr*scaleL, ampSum), fLi = Li*scaleL;
+        V fRr = vselect(ampR > V(0.0f), Rr*scaleR, ampSum), fRi = Ri*scaleR;
+        vstore_complex(bin(frontL,f),fLr,fLi);
+        vstore_complex(bin(frontR,f),fRr,fRi);
+        vstore_complex(bin(avg,f),fLr+fRr,fLi+fRi);
+        vstore_complex(bin(surL,f),fLr*V(phase_cosL) - fLi*V(phase_sinL),fLr*V(phase_sinL) + fLi*V(phase_cosL));
+        vstore_complex(bin(surR,f),fRr*V(phase_cosR) - fRi*V(phase_sinR),fRr*V(phase_sinR) + fRi*V(phase_cosR));
+        vstore_complex(bin(trueavg,f),Lr+Rr,Li+Ri);
+    }
+
+    // map from amplitude difference and phase difference to yfs
+    template <class V> static inline V get_yfs(const V &ampDiff, const V &phaseDiff) {
+        V x = V(1.0f)-(((V(1.0f)-ampDiff*ampDiff)*phaseDiff)*V(2/PI));
+        V tanX = x + tan_m_x(x);
+        return V(0.16468622925824683f) + x*(V(0.5009268347818189f) + x*(V(-0.06462757726992101f) + x*V(0.09170680403453149f)))
+            + tanX*(V(0.2617754892323973f) - V(0.04180413533856156f)*tanX);
+    }
+
     // map from amplitude difference and yfs to xfs
-    inline double get_xfs(double ampDiff, double yfs) {
-        double x=ampDiff,y=yfs;
-#ifdef FASTER_CALC
-        double tanX = tan(x);
-        double tanY = tan(y);
-        double asinX = asin(x);
-        double sinX = sin(x);
-        double sinY = sin(y);
-        double x3 = x*x*x;
-        double y2 = y*y;
-        double y3 = y*y2;
-        return 2.464833559224702*x - 423.52131153259404*x*y + 
-            67.8557858606918*x3*y + 788.2429425544392*x*y2 - 
-            79.97650354902909*x3*y2 - 513.8966153850349*x*y3 + 
-            35.68117670186306*x3*y3 + 13867.406173420834*y*asinX - 
-            2075.8237075786396*y2*asinX - 908.2722068360281*y3*asinX - 
-            12934.654772878019*asinX*sinY - 13216.736529661162*y*tanX + 
-            1288.6463247741938*y2*tanX + 1384.372969378453*y3*tanX + 
-            12699.231471126128*sinY*tanX + 95.37131275594336*sinX*tanY - 
-            91.21223198407546*tanX*tanY;
-#else
-        return 2.464833559224702*x - 423.52131153259404*x*y + 
-            67.8557858606918*x*x*x*y + 788.2429425544392*x*y*y - 
-            79.97650354902909*x*x*x*y*y - 513.8966153850349*x*y*y*y + 
-            35.68117670186306*x*x*x*y*y*y + 13867.406173420834*y*asin(x) - 
-            2075.8237075786396*y*y*asin(x) - 908.2722068360281*y*y*y*asin(x) - 
-            12934.654772878019*asin(x)*sin(y) - 13216.736529661162*y*tan(x) + 
-            1288.6463247741938*y*y*tan(x) + 1384.372969378453*y*y*y*tan(x) + 
-            12699.231471126128*sin(y)*tan(x) + 95.37131275594336*sin(x)*tan(y) - 
-            91.21223198407546*tan(x)*tan(y);
-#endif
+    //  the fit is
+    //    k1*x + k2*x*y + k3*x^3*y + k4*x*y^2 + k5*x^3*y^2 + k6*x*y^3 + k7*x^3*y^3
+    //    + (k8*y + k9*y^2 + k10*y^3 + k11*sin(y))*asin(x)
+    //    + (k12*y + k13*y^2 + k14*y^3 + k15*sin(y))*tan(x)
+    //    + k16*sin(x)*tan(y) + k17*tan(x)*tan(y)
+    //  whose large coefficients mostly cancel; it is evaluated around
+    //  asin(x)-x, tan(x)-x, sin(x)-x and sin(y)-y so that the cancelling
+    //  happens in the constants rather than in single precision, which
+    //  keeps the result within 1e-3 of the double precision fit
+    template <class V> static inline V get_xfs(const V &x, const V &y) {
+        static const double k1=2.464833559224702, k2=-423.52131153259404, k3=67.8557858606918,
+            k4=788.2429425544392, k5=-79.97650354902909, k6=-513.8966153850349, k7=35.68117670186306,
+            k8=13867.406173420834, k9=-2075.8237075786396, k10=-908.2722068360281, k11=-12934.654772878019,
+            k12=-13216.736529661162, k13=1288.6463247741938, k14=1384.372969378453, k15=12699.231471126128,
+            k16=95.37131275594336, k17=-91.21223198407546;
+        V y2 = y*y, y3 = y2*y, x3 = x*x*x;
+        V sy = sin_m_x(y), tanY = y + tan_m_x(y);
+        V as = asin_m_x(x), t = tan_m_x(x), sx = sin_m_x(x);
+        V P = V(float(k8+k11))*y + V(float(k9))*y2 + V(float(k10))*y3 + V(float(k11))*sy;
+        V Q = V(float(k12+k15))*y + V(float(k13))*y2 + V(float(k14))*y3 + V(float(k15))*sy;
+        V lin = V(float(k1)) + V(float(k2+k8+k11+k12+k15))*y + V(float(k4+k9+k13))*y2 +
+            V(float(k6+k10+k14))*y3 + V(float(k11+k15))*sy + V(float(k16+k17))*tanY;
+        return x*lin + x3*(V(float(k3))*y + V(float(k5))*y2 + V(float(k7))*y3) +
+            as*P + t*Q + tanY*(V(float(k16))*sx + V(float(k17))*t);
     }
 
-    // filter the complex source signal and add it to target
-    void apply_filter(cfloat *signal, float *flt, float *target) {
+    // filter the complex source signal and add it to target, using the
+    // transform buffers of channel c
+    void apply_filter(cfloat *signal, float *flt, float *target, unsigned c) {
+#ifdef USE_FFTW3
+        fftwf_complex *src = this->src[c];
+        float *dst = this->dst[c];
+#else
+        FFTComplexArray *src = this->src[c];
+        FFTContext *fftContextReverse = this->fftContextReverse[c];
+#endif
         // filter the signal
         unsigned f;
         for (f=0;f<=halfN;f++) {
@@ -434,7 +607,7 @@ private:
         }
 #ifdef USE_FFTW3
         // transform into time domain
-        fftwf_execute(store);
+        fftwf_execute_dft_c2r(store, src, dst);
 
         float* pT1   = &target[current_buf*halfN];
         float* pWnd1 = &wnd[0];
@@ -522,18 +695,17 @@ private:
     unsigned int halfN;                // half block size precalculated
 #ifdef USE_FFTW3
     // FFTW data structures
-    float *lt,*rt,*dst;                // left total, right total (source arrays), destination array
-    fftwf_complex *dftL,*dftR,*src;    // intermediate arrays (FFTs of lt & rt, processing source)
+    float *lt,*rt,*dst[6];             // left total, right total (source arrays), destination arrays
+    fftwf_complex *dftL,*dftR,*src[6]; // intermediate arrays (FFTs of lt & rt, processing sources)
     fftwf_plan loadL,loadR,store;      // plans for loading the data into the intermediate format and back
 #else
-    FFTContext *fftContextForward, *fftContextReverse; 
-    FFTSample *lt,*rt;                 // left total, right total (source arrays), destination array
-    FFTComplexArray *dftL,*dftR,*src;  // intermediate arrays (FFTs of lt & rt, processing source)
+    FFTContext *fftContextForward, *fftContextReverse[6];
+    FFTSample *lt,*rt;                 // left total, right total (source arrays)
+    FFTComplexArray *dftL,*dftR,*src[6]; // intermediate arrays (FFTs of lt & rt, processing sources)
 #endif
     // buffers
     std::vector<cfloat> frontL,frontR,avg,surL,surR; // the signal (phase-corrected) in the frequency domain
     std::vector<cfloat> trueavg;       // for lfe generation
-    std::vector<float> xfs,yfs;        // the feature space positions for each frequency bin
     std::vector<float> wnd;            // the window function, precalculated
     std::vector<float> filter[6];      // a frequency filter for each output channel
     std::vector<float> inbuf[2];       // the sliding input buffers
@@ -543,6 +715,8 @@ private:
     float surround_balance;            // the xfs balance that follows from the coeffs
     float surround_level;              // gain for the surround channels (follows from the coeffs
     float phase_offsetL, phase_offsetR;// phase shifts to be applied to the rear channels
+    float phase_cosL, phase_sinL;      // ... as rotations
+    float phase_cosR, phase_sinR;
     float front_separation;            // front stereo separation
     float rear_separation;             // rear stereo separation
     bool linear_steering;              // whether the steering should be linear or not
@@ -550,10 +724,22 @@ private:
     int current_buf;                   // specifies which buffer is 2nd half of input sliding buffer
     float * inbufs[2];                 // for passing back to driver
     float * outbufs[6];                // for passing back to driver
+    // block-parallel mode
+    std::vector<cfloat> *signal[6];    // the reference signal of each channel
+    float *target[6];                  // the output of each channel for this block
+    decoder_job *jobs[6];              // the transforms of a block
+    MThreadPool *pool;                 // the threads that run them, NULL when serial
+    QSemaphore done;                   // released by each job the pool ran
 
     friend class fsurround_decoder;
+    friend class decoder_job;
 };
 
+void decoder_job::run(void) {
+    decoder->run_job(inverse,index);
+    decoder->done.release();
+}
+
 
 // implementation of the shell class
 
@@ -575,6 +761,8 @@ void fsurround_decoder::steering_mode(bool mode) { impl->steering_mode(mode); }
 
 void fsurround_decoder::separation(float front, float rear) { impl->separation(front,rear); }
 
+void fsurround_decoder::parallel_mode(bool mode) { impl->parallel_mode(mode); }
+
 float ** fsurround_decoder::getInputBuffers()
 {
     return impl->getInputBuffers();
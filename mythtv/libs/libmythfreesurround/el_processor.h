@@ -66,6 +66,11 @@ public:
     // set samplerate for lfe filter
     void sample_rate(unsigned int samplerate);
 
+    // block-parallel mode: run the transforms of each block (two forward,
+    //  one inverse per output channel) on a pool of threads
+    //  false = one thread (default), true = up to six
+    void parallel_mode(bool mode);
+
 private:
 	class decoder_impl *impl; // private implementation (details hidden)
 };
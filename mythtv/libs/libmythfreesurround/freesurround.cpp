@@ -72,7 +72,8 @@ struct buffers
 int channel_select = -1;
 #endif
 
-FreeSurround::FreeSurround(uint srate, bool moviemode, SurroundMode smode) :
+FreeSurround::FreeSurround(uint srate, bool moviemode, SurroundMode smode,
+                           bool parallel) :
     srate(srate),
     bufs(NULL),
     decoder(0),
@@ -81,6 +82,7 @@ FreeSurround::FreeSurround(uint srate, bool moviemode, SurroundMode smode) :
     processed(true),
     processed_size(0),
     surround_mode(smode),
+    parallel(parallel),
     latency_frames(0),
     channels(0)
 {
@@ -447,6 +449,9 @@ void FreeSurround::open()
         if (bufs)
             bufs->clear();
         decoder->sample_rate(srate);
+        // off unless asked for, it costs more CPU than it saves wall time
+        // and competes with the video decoder for the cores
+        decoder->parallel_mode(parallel);
     }
     SetParams();
 }
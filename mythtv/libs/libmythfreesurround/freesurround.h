@@ -34,7 +34,8 @@ public:
         SurroundModePassiveHall
     } SurroundMode;
 public:
-    FreeSurround(uint srate, bool moviemode, SurroundMode mode);
+    FreeSurround(uint srate, bool moviemode, SurroundMode mode,
+                 bool parallel = false);
     ~FreeSurround();
 
     // put frames in buffer, returns number of frames used
@@ -82,6 +83,7 @@ private:
     bool processed;             // whether processing is enabled for latency calc
     int processed_size;                 // amount processed
     SurroundMode surround_mode;         // 1 of 3 surround modes supported
+    bool parallel;                      // block-parallel decoding
     int latency_frames;                 // number of frames of incurred latency
     int channels;
 };
@@ -1,5 +1,11 @@
 #include <map>
+#include <ctime>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <QDataStream>
+#include <QFile>
 #include <QDir>
 #include <QUrl>
 
@@ -11,6 +17,11 @@
 #include "mythlogging.h"
 #include "videoutils.h"
 #include "storagegroup.h"
+#include "mythdate.h"
+
+/// Identifies a DirectoryIndex file
+static const quint32 kIndexMagic   = 0x4d564958; // "MVIX"
+static const quint32 kIndexVersion = 1;
 
 DirectoryHandler::~DirectoryHandler()
 {
@@ -18,6 +29,23 @@ DirectoryHandler::~DirectoryHandler()
 
 namespace
 {
+    /// \brief Lists a directory, directory names end with a '/'.
+    bool read_dir(const QString &path, QStringList &entries)
+    {
+        QDir d(path);
+
+        if (!d.exists())
+            return false;
+
+        d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        QFileInfoList list = d.entryInfoList();
+
+        for (QFileInfoList::iterator p = list.begin(); p != list.end(); ++p)
+            entries << (p->isDir() ? p->fileName() + "/" : p->fileName());
+
+        return true;
+    }
+
     class ext_lookup
     {
       private:
@@ -47,40 +75,61 @@ namespace
     };
 
     bool scan_dir(const QString &start_path, DirectoryHandler *handler,
-                  const ext_lookup &ext_settings)
+                  const ext_lookup &ext_settings, DirectoryIndex *index)
     {
         QDir d(start_path);
+        QStringList list;
 
         // Return a fail if directory doesn't exist.
-        if (!d.exists())
+        if (!(index ? index->GetEntries(start_path, list) :
+                      read_dir(start_path, list)))
+        {
             return false;
-        
-        d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-        QFileInfoList list = d.entryInfoList();
+        }
+
         // An empty directory is fine
         if (list.isEmpty())
             return true;
 
         QDir dir_tester;
 
-        for (QFileInfoList::iterator p = list.begin(); p != list.end(); ++p)
+        for (QStringList::const_iterator p = list.begin(); p != list.end(); ++p)
         {
-            if (p->fileName() == "Thumbs.db")
+            bool    is_dir   = p->endsWith('/');
+            QString name     = is_dir ? p->left(p->length() - 1) : *p;
+            QString fq_name  = d.absoluteFilePath(name);
+            QString suffix   = QFileInfo(name).suffix();
+
+            if (name == "Thumbs.db")
                 continue;
 
-            if (!p->isDir() &&
-                ext_settings.extension_ignored(p->suffix())) continue;
+            if (!is_dir &&
+                ext_settings.extension_ignored(suffix)) continue;
 
             bool add_as_file = true;
 
-            if (p->isDir())
+            if (is_dir)
             {
                 add_as_file = false;
 
-                dir_tester.setPath(p->absoluteFilePath() + "/VIDEO_TS");
-                QDir bd_dir_tester;
-                bd_dir_tester.setPath(p->absoluteFilePath() + "/BDMV");
-                if (dir_tester.exists() || bd_dir_tester.exists())
+                bool disc_dir = false;
+                if (index)
+                {
+                    // The listing is needed for the recursion anyway
+                    QStringList sub;
+                    (void) index->GetEntries(fq_name, sub);
+                    disc_dir = sub.contains("VIDEO_TS/") ||
+                               sub.contains("BDMV/");
+                }
+                else
+                {
+                    dir_tester.setPath(fq_name + "/VIDEO_TS");
+                    QDir bd_dir_tester;
+                    bd_dir_tester.setPath(fq_name + "/BDMV");
+                    disc_dir = dir_tester.exists() || bd_dir_tester.exists();
+                }
+
+                if (disc_dir)
                 {
                     add_as_file = true;
                 }
@@ -88,15 +137,13 @@ namespace
                 {
 #if 0
                     LOG(VB_GENERAL, LOG_DEBUG, 
-                        QString(" -- Dir : %1").arg(p->absoluteFilePath()));
+                        QString(" -- Dir : %1").arg(fq_name));
 #endif
-                    DirectoryHandler *dh =
-                            handler->newDir(p->fileName(),
-                                            p->absoluteFilePath());
+                    DirectoryHandler *dh = handler->newDir(name, fq_name);
 
                     // Since we are dealing with a subdirectory failure is fine,
                     // so we'll just ignore the failue and continue
-                    (void) scan_dir(p->absoluteFilePath(), dh, ext_settings);
+                    (void) scan_dir(fq_name, dh, ext_settings, index);
                 }
             }
 
@@ -104,10 +151,9 @@ namespace
             {
 #if 0
                 LOG(VB_GENERAL, LOG_DEBUG,
-                    QString(" -- File : %1").arg(p->fileName()));
+                    QString(" -- File : %1").arg(name));
 #endif
-                handler->handleFile(p->fileName(), p->absoluteFilePath(),
-                                    p->suffix(), "");
+                handler->handleFile(name, fq_name, suffix, "");
             }
         }
 
@@ -227,9 +273,156 @@ namespace
     }
 }
 
+/** \brief Returns the entries of a directory, from the index if the
+ *         directory hasn't changed since it was last read.
+ *  \return false if the directory doesn't exist
+ */
+bool DirectoryIndex::GetEntries(const QString &path, QStringList &entries)
+{
+    QHash<QString, Entry>::const_iterator it = m_seen.find(path);
+    if (it != m_seen.end())
+    {
+        entries = it->entries;
+        return true;
+    }
+
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st) != 0 ||
+        !S_ISDIR(st.st_mode))
+    {
+        return false;
+    }
+
+    Entry entry;
+    entry.mtime = st.st_mtime;
+    entry.inode = st.st_ino;
+
+    // Entries read in the same second as the directory last changed may
+    // have missed a later change in that second, so they are read again.
+    it = m_old.find(path);
+    if (it != m_old.end() && it->mtime == entry.mtime &&
+        it->inode == entry.inode && it->listed > it->mtime + 1)
+    {
+        entry = *it;
+        m_reused++;
+    }
+    else
+    {
+        if (!read_dir(path, entry.entries))
+            return false;
+        entry.listed = time(NULL);
+        m_listed++;
+    }
+
+    m_seen.insert(path, entry);
+    entries = entry.entries;
+
+    return true;
+}
+
+DirectoryIndex::DirectoryIndex() :
+    m_created(MythDate::current()), m_listed(0), m_reused(0)
+{
+}
+
+/// \brief Forgets everything, the next scan reads every directory.
+void DirectoryIndex::Clear(void)
+{
+    m_old.clear();
+    m_seen.clear();
+    m_created = MythDate::current();
+    m_listed = m_reused = 0;
+}
+
+/** \brief Loads the directories seen by the last scan.
+ *  \return false if there is no usable index, it is left empty then
+ */
+bool DirectoryIndex::Load(const QString &filename)
+{
+    Clear();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0, version = 0, count = 0;
+    QDateTime created;
+    in >> magic >> version;
+    if (magic != kIndexMagic || version != kIndexVersion)
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("Ignoring unknown video scan index '%1'").arg(filename));
+        return false;
+    }
+
+    in >> created >> count;
+
+    QHash<QString, Entry> dirs;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        Entry   entry;
+        in >> path >> entry.mtime >> entry.inode >> entry.listed
+           >> entry.entries;
+        dirs.insert(path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok || !created.isValid())
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("Video scan index '%1' is damaged").arg(filename));
+        return false;
+    }
+
+    m_old     = dirs;
+    m_created = created;
+
+    return true;
+}
+
+/// \brief Saves the directories seen by this scan for the next one.
+bool DirectoryIndex::Save(const QString &filename) const
+{
+    QFile file(filename + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Unable to write video scan index '%1'")
+                .arg(file.fileName()));
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << kIndexMagic << kIndexVersion << m_created
+        << (quint32) m_seen.size();
+
+    QHash<QString, Entry>::const_iterator it = m_seen.begin();
+    for (; it != m_seen.end(); ++it)
+    {
+        out << it.key() << it->mtime << it->inode << it->listed
+            << it->entries;
+    }
+
+    file.close();
+
+    if (out.status() != QDataStream::Ok)
+    {
+        file.remove();
+        return false;
+    }
+
+    QFile::remove(filename);
+    return file.rename(filename);
+}
+
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, DirectoryIndex *index)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -241,7 +434,7 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        if (!scan_dir(start_path, handler, extlookup, index))
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
@@ -1,8 +1,62 @@
 #ifndef DIRSCAN_H_
 #define DIRSCAN_H_
 
+#include <QStringList>
+#include <QDateTime>
+#include <QString>
+#include <QHash>
+
 #include "mythmetaexp.h"
 
+/** \class DirectoryIndex
+ *  \brief Remembers what each local directory contained at the last scan.
+ *
+ *  A directory whose modification time and inode haven't changed since it
+ *  was last listed still has the same entries, so a rescan only needs to
+ *  stat it instead of reading it and stat'ing everything in it.  Only the
+ *  subtrees that changed are read again.  Only directories seen during the
+ *  last scan are kept when the index is saved.
+ *
+ *  This saves reading directories, not visiting them: every directory is
+ *  still stat'ed on each scan, and VideoScannerThread::verifyFiles() still
+ *  checks every video in the database against the files found.
+ */
+class META_PUBLIC DirectoryIndex
+{
+  public:
+    DirectoryIndex();
+
+    bool Load(const QString &filename);
+    bool Save(const QString &filename) const;
+    void Clear(void);
+
+    bool GetEntries(const QString &path, QStringList &entries);
+
+    /// \brief Time the index was last built from scratch
+    QDateTime GetCreated(void) const { return m_created; }
+    /// \brief Directories read during this scan
+    uint GetListed(void) const { return m_listed; }
+    /// \brief Directories whose entries were taken from the index
+    uint GetReused(void) const { return m_reused; }
+
+  private:
+    class Entry
+    {
+      public:
+        Entry() : mtime(0), inode(0), listed(0) {}
+        qint64      mtime;
+        quint64     inode;
+        qint64      listed;     ///< When the entries were read
+        QStringList entries;    ///< Names, directories end with a '/'
+    };
+
+    QHash<QString, Entry> m_old;
+    QHash<QString, Entry> m_seen;
+    QDateTime             m_created;
+    uint                  m_listed;
+    uint                  m_reused;
+};
+
 class META_PUBLIC DirectoryHandler
 {
   public:
@@ -17,6 +71,6 @@ class META_PUBLIC DirectoryHandler
 
 META_PUBLIC bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions);
+        bool list_unknown_extensions, DirectoryIndex *index = NULL);
 
 #endif // DIRSCAN_H_
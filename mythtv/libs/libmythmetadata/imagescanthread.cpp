@@ -1,11 +1,42 @@
 // Qt headers
+#include <QRunnable>
 
 // MythTV headers
 #include "mythcontext.h"
+#include "mythtimer.h"
+#include "mthreadpool.h"
 #include "storagegroup.h"
 #include "imagescanthread.h"
 #include "imageutils.h"
 
+// Number of loaded files that are inserted into the database together
+static const int kFilesPerFlush = 100;
+
+/** \class ImageScanFileTask
+ *  \brief Reads the information of one new file on the worker pool
+ *          and hands it back to the scan thread.
+ */
+class ImageScanFileTask : public QRunnable
+{
+  public:
+    ImageScanFileTask(ImageScanThread *parent, const QFileInfo &fileInfo,
+                      int parentId, const QString &baseDirectory) :
+        m_parent(parent), m_fileInfo(fileInfo),
+        m_parentId(parentId), m_baseDirectory(baseDirectory) {}
+
+    void run(void)
+    {
+        m_parent->FileLoaded(ImageScanThread::LoadFile(m_fileInfo, m_parentId,
+                                                       m_baseDirectory));
+    }
+
+  private:
+    ImageScanThread *m_parent;
+    QFileInfo        m_fileInfo;
+    int              m_parentId;
+    QString          m_baseDirectory;
+};
+
 
 /** \fn     ImageScanThread::ImageScanThread()
  *  \brief  Constructor
@@ -18,6 +49,9 @@ ImageScanThread::ImageScanThread() : MThread("ImageScanThread")
     m_dbFileList  = new QMap<QString, ImageMetadata *>;
     m_continue = false;
 
+    m_pool    = NULL;
+    m_pending = 0;
+
     m_progressCount       = 0;
     m_progressTotalCount  = 0;
 }
@@ -65,13 +99,18 @@ void ImageScanThread::run()
 
     m_progressCount       = 0;
     m_progressTotalCount  = 0;
-    
+
+    MythTimer timer(MythTimer::kStartRunning);
+    int inserted = 0;
+
     // Load all available directories and files from the database so that
     // they can be compared against the ones on the filesystem.
     ImageUtils *iu = ImageUtils::getInstance();
     iu->LoadDirectoriesFromDB(m_dbDirList);
     iu->LoadFilesFromDB(m_dbFileList);
 
+    m_pool = iu->GetThreadPool();
+
     QStringList paths = iu->GetStorageDirs();
 
     // Get the total list of files and directories that will be synced.
@@ -96,8 +135,13 @@ void ImageScanThread::run()
         if (!base.endsWith('/'))
             base.append('/');
         SyncFilesFromDir(path, 0, base);
+        inserted += FlushFiles(false);
     }
 
+    // Wait for the file tasks that are still running
+    // and save the files that are left over.
+    inserted += FlushFiles(true);
+
     // Adding or updating directories have been completed.
     // The directory list still contains the remaining directories
     // that are not in the filesystem anymore. Remove them from the database
@@ -113,6 +157,15 @@ void ImageScanThread::run()
         iu->RemoveFileFromDB(m_dbFileList->value(i.key()));
     }
 
+    int elapsed = timer.elapsed();
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Image syncronization checked %1 entries in %2 s, "
+                "added %3 files (%4 files/s) using %5 threads")
+        .arg(m_progressCount).arg(elapsed / 1000.0, 0, 'f', 1)
+        .arg(inserted)
+        .arg(elapsed ? inserted * 1000.0 / elapsed : 0.0, 0, 'f', 1)
+        .arg(m_pool->maxThreadCount()));
+
     m_continue = false;
     m_progressCount       = 0;
     m_progressTotalCount  = 0;
@@ -236,8 +289,8 @@ int ImageScanThread::SyncDirectory(QFileInfo &fileInfo, int parentId, const QStr
 
 
 /** \fn     ImageScanThread::SyncFile(QFileInfo &, int)
- *  \brief  Syncronizes a file with the database. Either inserts,
- *          updates or deletes the information in the database.
+ *  \brief  Syncronizes a file with the database. New files are read
+ *          by a task on the worker pool and inserted by FlushFiles().
  *  \param  fileInfo The information of the file
  *  \param  parentId The parent directory which will be saved with the file
  *  \return void
@@ -250,38 +303,21 @@ void ImageScanThread::SyncFile(QFileInfo &fileInfo, int parentId,
 
     if (!m_dbFileList->contains(fileInfo.absoluteFilePath()))
     {
-        ImageMetadata *im = new ImageMetadata();
-
-        // Load all required information of the file
-        ImageUtils *iu = ImageUtils::getInstance();
-        iu->LoadFileData(fileInfo, im, baseDirectory);
-
-        // Only load the file if contains a valid file extension
-        LOG(VB_FILE, LOG_DEBUG, QString("Type of file %1 is %2, extension %3").arg(im->m_fileName).arg(im->m_type).arg(im->m_extension));
-        if (im->m_type != kUnknown)
-        {
-            // Load any required exif information if the file is an image
-            if (im->m_type == kImageFile)
-            {
-                bool ok;
-
-                int exifOrientation = iu->GetExifOrientation(fileInfo.absoluteFilePath(), &ok);
-                if (ok)
-                    im->SetOrientation(exifOrientation, true);
-
-                int exifDate = iu->GetExifDate(fileInfo.absoluteFilePath(), &ok);
-                if (ok)
-                    im->m_date = exifDate;
-            }
-
-            // Load the parent id. This is the id of the file's path
-            im->m_parentId = parentId;
-
-            // The file is not in the database list
-            // add it to the database.
-            im->m_id = iu->InsertFileIntoDB(im);
-        }
-        delete im;
+        // Don't get too far ahead of the pool, the directory
+        // walk is a lot quicker than reading the exif data.
+        m_loadLock.lock();
+        while (m_pending >= 4 * m_pool->maxThreadCount())
+            m_loadWait.wait(&m_loadLock);
+        ++m_pending;
+        bool flush = m_loaded.size() >= kFilesPerFlush;
+        m_loadLock.unlock();
+
+        m_pool->start(new ImageScanFileTask(this, fileInfo, parentId,
+                                            baseDirectory),
+                      "ImageScanFile");
+
+        if (flush)
+            FlushFiles(false);
     }
     else
     {
@@ -290,3 +326,96 @@ void ImageScanThread::SyncFile(QFileInfo &fileInfo, int parentId,
         m_dbFileList->remove(fileInfo.absoluteFilePath());
     }
 }
+
+
+
+/**
+ *  \brief  Loads the information and exif data of a file.
+ *          This is called on the worker pool.
+ *  \param  fileInfo The information of the file
+ *  \param  parentId The parent directory which will be saved with the file
+ *  \param  baseDirectory The current root storage group path
+ *  \return The file information or NULL if the file is not an image or video
+ */
+ImageMetadata *ImageScanThread::LoadFile(QFileInfo &fileInfo, int parentId,
+                                         const QString &baseDirectory)
+{
+    ImageMetadata *im = new ImageMetadata();
+
+    // Load all required information of the file
+    ImageUtils *iu = ImageUtils::getInstance();
+    iu->LoadFileData(fileInfo, im, baseDirectory);
+
+    // Only load the file if contains a valid file extension
+    LOG(VB_FILE, LOG_DEBUG, QString("Type of file %1 is %2, extension %3").arg(im->m_fileName).arg(im->m_type).arg(im->m_extension));
+    if (im->m_type == kUnknown)
+    {
+        delete im;
+        return NULL;
+    }
+
+    // Load any required exif information if the file is an image
+    if (im->m_type == kImageFile)
+    {
+        bool ok;
+
+        int exifOrientation = iu->GetExifOrientation(fileInfo.absoluteFilePath(), &ok);
+        if (ok)
+            im->SetOrientation(exifOrientation, true);
+
+        int exifDate = iu->GetExifDate(fileInfo.absoluteFilePath(), &ok);
+        if (ok)
+            im->m_date = exifDate;
+    }
+
+    // Load the parent id. This is the id of the file's path
+    im->m_parentId = parentId;
+
+    return im;
+}
+
+
+
+/**
+ *  \brief  Called by a file task when it is done.
+ *  \param  im The file information or NULL if the file is skipped
+ *  \return void
+ */
+void ImageScanThread::FileLoaded(ImageMetadata *im)
+{
+    QMutexLocker locker(&m_loadLock);
+
+    if (im)
+        m_loaded.append(im);
+
+    --m_pending;
+    m_loadWait.wakeAll();
+}
+
+
+
+/**
+ *  \brief  Inserts the files loaded so far into the database.
+ *  \param  wait If true, waits for all file tasks to finish first
+ *  \return The number of files inserted
+ */
+int ImageScanThread::FlushFiles(bool wait)
+{
+    QList<ImageMetadata *> files;
+
+    m_loadLock.lock();
+    while (wait && m_pending > 0)
+        m_loadWait.wait(&m_loadLock);
+    files.swap(m_loaded);
+    m_loadLock.unlock();
+
+    if (files.isEmpty())
+        return 0;
+
+    int inserted = ImageUtils::getInstance()->InsertFilesIntoDB(files);
+
+    while (!files.isEmpty())
+        delete files.takeFirst();
+
+    return inserted;
+}
@@ -5,13 +5,27 @@
 #include <QApplication>
 #include <QFileInfo>
 #include <QMap>
+#include <QMutex>
+#include <QWaitCondition>
 
 // MythTV headers
 #include "mthread.h"
 #include "imagemetadata.h"
 
+class MThreadPool;
+
+/** \class ImageScanThread
+ *  \brief Synchronizes the gallery tables with the Photographs storage group.
+ *
+ *  The directory tree is walked by this thread, but reading the file
+ *  information and EXIF tags of new files is done by per-file tasks on
+ *  the pool returned by ImageUtils::GetThreadPool(). The results are
+ *  collected here and inserted into the database in batches.
+ */
 class ImageScanThread : public MThread
 {
+    friend class ImageScanFileTask;
+
 public:
     ImageScanThread();
     ~ImageScanThread();
@@ -29,9 +43,20 @@ private:
     void SyncFilesFromDir(QString &path, int parentId, const QString &baseDirectory);
     int  SyncDirectory(QFileInfo &fileInfo, int parentId, const QString &baseDirectory);
     void SyncFile(QFileInfo &fileInfo, int parentId, const QString &baseDirectory);
+    void FileLoaded(ImageMetadata *im);
+    int  FlushFiles(bool wait);
+
+    static ImageMetadata *LoadFile(QFileInfo &fileInfo, int parentId,
+                                   const QString &baseDirectory);
 
     QMap<QString, ImageMetadata *> *m_dbDirList;
     QMap<QString, ImageMetadata *> *m_dbFileList;
+
+    MThreadPool             *m_pool;
+    QMutex                   m_loadLock;
+    QWaitCondition           m_loadWait;
+    QList<ImageMetadata *>   m_loaded;    ///< New files waiting to be inserted
+    int                      m_pending;   ///< File tasks not finished yet
 };
 
 #endif // IMAGESCANTHREAD_H
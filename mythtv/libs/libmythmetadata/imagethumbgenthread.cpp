@@ -1,10 +1,14 @@
 // Qt headers
+#include <QImageReader>
+#include <QRunnable>
 #include <QPainter>
 #include <QFile>
 
 // MythTV headers
 #include "mythcontext.h"
 #include "mythdirs.h"
+#include "mythtimer.h"
+#include "mthreadpool.h"
 #include "mythuihelper.h"
 #include "mythsystemlegacy.h"
 #include "exitcodes.h"
@@ -13,12 +17,36 @@
 #include "imageutils.h"
 #include "imagethumbgenthread.h"
 
+/** \class ImageThumbGenTask
+ *  \brief Creates the thumbnails of one file on the worker pool.
+ */
+class ImageThumbGenTask : public QRunnable
+{
+  public:
+    ImageThumbGenTask(ImageThumbGenThread *parent, ImageMetadata *im) :
+        m_parent(parent), m_im(im) {}
+
+    void run(void)
+    {
+        m_parent->CreateThumbnail(m_im);
+        delete m_im;
+        m_parent->ThumbnailDone();
+    }
+
+  private:
+    ImageThumbGenThread *m_parent;
+    ImageMetadata       *m_im;
+};
+
+
+
 /** \fn     ImageThumbGenThread::ImageThumbGenThread()
  *  \brief  Constructor
  *  \return void
  */
 ImageThumbGenThread::ImageThumbGenThread()
         :   m_progressCount(0), m_progressTotalCount(0),
+            m_running(0), m_priorityDir(-1), m_priorityCount(0),
             m_width(0), m_height(0),
             m_pause(false), m_fileListSize(0)
 {
@@ -44,64 +72,100 @@ ImageThumbGenThread::~ImageThumbGenThread()
 
 
 /** \fn     ImageThumbGenThread::run()
- *  \brief  Called when the thread starts. Tries to generate
- *          thumbnails from the file list until its empty or aborted.
+ *  \brief  Called when the thread starts. Hands the files in the list to
+ *          the worker pool until the list is empty or aborted.
  *  \return void
  */
 void ImageThumbGenThread::run()
 {
-    volatile bool exit = false;
+    MThreadPool *pool = ImageUtils::getInstance()->GetThreadPool();
+    MythTimer timer(MythTimer::kStartRunning);
+    int started = 0;
 
     m_mutex.lock();
     m_fileListSize = m_fileList.size();
-    m_mutex.unlock();
 
-    while (!exit)
+    while (true)
     {
-        ImageMetadata *im = NULL;
+        // Allows the thread to be paused when Pause() was called
+        if (m_pause)
+            m_condition.wait(&m_mutex);
 
-        m_mutex.lock();
-        if (!m_fileList.isEmpty())
-            im = m_fileList.takeFirst();
+        // Wait for a free pool thread, or for the last
+        // tasks to finish when the list is empty.
+        while (m_running >= pool->maxThreadCount() ||
+               (m_running > 0 && m_fileList.isEmpty()))
+        {
+            m_taskDone.wait(&m_mutex);
+        }
+
+        if (m_fileList.isEmpty())
+            break;
+
+        ImageMetadata *im = m_fileList.takeFirst();
+        if (m_priorityCount > 0)
+            --m_priorityCount;
 
         // Update the progressbar even if the thumbnail will not be created
         emit UpdateThumbnailProgress(m_fileList.size(), m_fileListSize);
-        m_mutex.unlock();
 
-        if (im)
-        {
-            if (im->m_type == kSubDirectory ||
-                im->m_type == kUpDirectory)
-            {
-                for (int i = 0; i < im->m_thumbFileNameList->size(); ++i)
-                    CreateImageThumbnail(im, i);
-            }
-            else if (im->m_type == kImageFile)
-            {
-                CreateImageThumbnail(im, 0);
-            }
-            else if (im->m_type == kVideoFile)
-            {
-                CreateVideoThumbnail(im);
-            }
-        }
+        ++m_running;
+        ++started;
 
-        delete im;
+        // Run ahead of any image scanning tasks on the same pool
+        pool->start(new ImageThumbGenTask(this, im), "ImageThumbGen", 1);
+    }
 
-        m_mutex.lock();
-        exit = m_fileList.isEmpty();
-        m_mutex.unlock();
+    m_mutex.unlock();
 
-        // Allows the thread to be paused when Pause() was called
-        m_mutex.lock();
-        if (m_pause)
-            m_condition.wait(&m_mutex);
-        m_mutex.unlock();
+    int elapsed = timer.elapsed();
+    LOG(VB_FILE, LOG_INFO,
+        QString("Processed %1 thumbnails in %2 s (%3/s) using %4 threads")
+        .arg(started).arg(elapsed / 1000.0, 0, 'f', 1)
+        .arg(elapsed ? started * 1000.0 / elapsed : 0.0, 0, 'f', 1)
+        .arg(pool->maxThreadCount()));
+}
+
+
+
+/**
+ *  \brief  Creates the thumbnails of a file. This is called on the worker pool.
+ *  \param  im The file details
+ *  \return void
+ */
+void ImageThumbGenThread::CreateThumbnail(ImageMetadata *im)
+{
+    if (im->m_type == kSubDirectory ||
+        im->m_type == kUpDirectory)
+    {
+        for (int i = 0; i < im->m_thumbFileNameList->size(); ++i)
+            CreateImageThumbnail(im, i);
+    }
+    else if (im->m_type == kImageFile)
+    {
+        CreateImageThumbnail(im, 0);
+    }
+    else if (im->m_type == kVideoFile)
+    {
+        CreateVideoThumbnail(im);
     }
 }
 
 
 
+/**
+ *  \brief  Called by a thumbnail task when it is done.
+ *  \return void
+ */
+void ImageThumbGenThread::ThumbnailDone(void)
+{
+    QMutexLocker locker(&m_mutex);
+    --m_running;
+    m_taskDone.wakeAll();
+}
+
+
+
 /** \fn     ImageThumbGenThread::CreateImageThumbnail(ImageMetadata *, int)
  *  \brief  Creates a thumbnail with the correct size and rotation
  *  \param  im The thumbnail details
@@ -117,7 +181,9 @@ void ImageThumbGenThread::CreateImageThumbnail(ImageMetadata *im, int id)
     if (!dir.exists(im->m_thumbPath))
         dir.mkpath(im->m_thumbPath);
 
+    m_storageGroupLock.lock();
     QString imageFileName = m_storageGroup.FindFile(im->m_fileName);
+    m_storageGroupLock.unlock();
 
     // If a folder thumbnail shall be created we need to get
     // the real filename from the thumbnail filename by removing
@@ -129,8 +195,29 @@ void ImageThumbGenThread::CreateImageThumbnail(ImageMetadata *im, int id)
         imageFileName = imageFileName.mid(GetConfDir().append("/MythImage/").count());
     }
 
-    QImage image;
-    if (!image.load(imageFileName))
+    QImageReader reader(imageFileName);
+
+    // Let the decoder scale large images down while reading them, JPEG
+    // images are then only decoded at a fraction of their size. They
+    // are read at twice the thumbnail size so that Resize() still has
+    // enough detail for a smooth result.
+    QSize size = reader.size();
+    if (size.isValid() && m_width > 0 && m_height > 0)
+    {
+        // Orientations 5 to 8 swap the width and height below
+        QSize box = (im->GetOrientation() >= 5) ?
+                    QSize(m_height * 2, m_width * 2) :
+                    QSize(m_width * 2, m_height * 2);
+
+        if (size.width() > box.width() || size.height() > box.height())
+        {
+            size.scale(box, Qt::KeepAspectRatio);
+            reader.setScaledSize(size);
+        }
+    }
+
+    QImage image = reader.read();
+    if (image.isNull())
         return;
 
     QMatrix matrix;
@@ -204,7 +291,9 @@ void ImageThumbGenThread::CreateVideoThumbnail(ImageMetadata *im)
     if (!dir.exists(im->m_thumbPath))
         dir.mkpath(im->m_thumbPath);
 
+    m_storageGroupLock.lock();
     QString videoFileName = m_storageGroup.FindFile(im->m_fileName);
+    m_storageGroupLock.unlock();
 
     QString cmd = "mythpreviewgen";
     QStringList args;
@@ -254,7 +343,9 @@ void ImageThumbGenThread::Resize(QImage &image)
 
 
 /** \fn     ImageThumbGenThread::AddToThumbnailList(ImageMetadata *)
- *  \brief  Adds a file to the thumbnail list
+ *  \brief  Adds a file to the thumbnail list. Files are requested when
+ *          their directory is shown, so the files of the directory that
+ *          was added last go ahead of files added for other directories.
  *  \param  im The file information
  *  \return void
  */
@@ -264,8 +355,14 @@ void ImageThumbGenThread::AddToThumbnailList(ImageMetadata *im)
         return;
 
     m_mutex.lock();
-    m_fileList.append(im);
+    if (im->m_parentId != m_priorityDir)
+    {
+        m_priorityDir   = im->m_parentId;
+        m_priorityCount = 0;
+    }
+    m_fileList.insert(m_priorityCount++, im);
     m_fileListSize = m_fileList.size();
+    m_taskDone.wakeAll();
     m_mutex.unlock();
 }
 
@@ -301,7 +398,9 @@ void ImageThumbGenThread::cancel()
     m_mutex.lock();
     while (!m_fileList.isEmpty())
         delete m_fileList.takeFirst();
-    m_fileListSize = 0;
+    m_fileListSize  = 0;
+    m_priorityCount = 0;
+    m_taskDone.wakeAll();
     m_mutex.unlock();
 
     emit UpdateThumbnailProgress(0, 0);
@@ -4,6 +4,7 @@
 // Qt headers
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
 
 // MythTV headers
 #include "mythuibuttontree.h"
@@ -11,10 +12,20 @@
 #include "storagegroup.h"
 #include "mythmetaexp.h"
 
+/** \class ImageThumbGenThread
+ *  \brief Creates the gallery thumbnails.
+ *
+ *  This thread only hands the queued files to tasks on the pool returned
+ *  by ImageUtils::GetThreadPool(), at most one per pool thread. Files of
+ *  the directory that was requested last are queued ahead of the others,
+ *  so the thumbnails the user is looking at are created first.
+ */
 class META_PUBLIC ImageThumbGenThread : public QThread
 {
     Q_OBJECT
 
+    friend class ImageThumbGenTask;
+
   public:
     ImageThumbGenThread();
     ~ImageThumbGenThread();
@@ -37,6 +48,8 @@ class META_PUBLIC ImageThumbGenThread : public QThread
     void run();
 
   private:
+    void CreateThumbnail(ImageMetadata *);
+    void ThumbnailDone(void);
     void CreateImageThumbnail(ImageMetadata *, int);
     void CreateVideoThumbnail(ImageMetadata *);
 
@@ -47,6 +60,12 @@ class META_PUBLIC ImageThumbGenThread : public QThread
 
     QList<ImageMetadata *>    m_fileList;
     QMutex              m_mutex;
+    QMutex              m_storageGroupLock;
+    QWaitCondition      m_taskDone;
+
+    int m_running;          ///< Thumbnail tasks on the pool
+    int m_priorityDir;      ///< Directory of the last file that was added
+    int m_priorityCount;    ///< Files of m_priorityDir at the list's front
 
     int m_width;
     int m_height;
@@ -1,8 +1,14 @@
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // Qt headers
+#include <QThread>
 
 // MythTV headers
 #include "mythcontext.h"
 #include "mythdirs.h"
+#include "mthreadpool.h"
 #include "storagegroup.h"
 #include "imageutils.h"
 
@@ -10,9 +16,12 @@
 // The maximum possible value of the utc time
 #define MAX_UTCTIME 2147483646;
 
+// Rows written by a single INSERT statement
+static const int kMaxFilesPerInsert = 100;
+
 ImageUtils* ImageUtils::m_instance = NULL;
 
-ImageUtils::ImageUtils()
+ImageUtils::ImageUtils() : m_threadPool(NULL)
 {
     m_imageFileExt = QString("jpg,jpeg,png,tif,tiff,bmp,gif").split(",");
     m_videoFileExt = QString("avi,mpg,mp4,mpeg,mov,wmv,3gp").split(",");
@@ -37,6 +46,40 @@ ImageUtils* ImageUtils::getInstance()
 
 
 
+/**
+ *  \brief  Returns the thread pool shared by the image scanner and the
+ *          thumbnail generator. The number of threads is taken from the
+ *          "GalleryWorkerThreads" setting, 0 uses one thread per core.
+ *  \return The thread pool
+ */
+MThreadPool *ImageUtils::GetThreadPool()
+{
+    QMutexLocker locker(&m_threadPoolLock);
+
+    if (!m_threadPool)
+    {
+        int threads = gCoreContext->GetNumSetting("GalleryWorkerThreads", 0);
+        if (threads <= 0)
+            threads = QThread::idealThreadCount();
+
+        // Exiv2 sets up its XMP parser on first use, which is not safe
+        // when files are read on several pool threads at once. Do it
+        // here, before any task that reads a file is started.
+        Exiv2::XmpParser::initialize();
+
+        m_threadPool = new MThreadPool("ImageWorkers");
+        m_threadPool->setMaxThreadCount(max(threads, 1));
+
+        LOG(VB_FILE, LOG_INFO,
+            QString("Using %1 threads for image scanning and thumbnails")
+            .arg(m_threadPool->maxThreadCount()));
+    }
+
+    return m_threadPool;
+}
+
+
+
 /** \fn     ImageUtils::LoadDirectoryFromDB(QMap<QString, ImageMetadata *>*)
  *  \brief  Loads all directory information from the database
  *  \param  dbList The list where the results are stored
@@ -210,6 +253,85 @@ int ImageUtils::InsertFileIntoDB(ImageMetadata *im)
 
 
 
+/**
+ *  \brief  Saves information about the given files in the database,
+ *          using one INSERT for up to kMaxFilesPerInsert files.
+ *          The files of a batch that fails are inserted one by one.
+ *          The ids of the new rows are not loaded.
+ *  \param  files Information of the files
+ *  \return The number of files saved
+ */
+int ImageUtils::InsertFilesIntoDB(const QList<ImageMetadata *> &files)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    int written = 0;
+    int saved = 0;
+
+    while (written < files.size())
+    {
+        int count = min(files.size() - written, kMaxFilesPerInsert);
+
+        QStringList values;
+        for (int i = 0; i < count; ++i)
+        {
+            values << QString("(:FILENAME%1, :NAME%1, :PATH%1, :DIR_ID%1, "
+                              ":TYPE%1, :MODTIME%1, :SIZE%1, :EXTENSION%1, "
+                              ":ANGLE%1, :DATE%1, :ZOOM%1, "
+                              ":HIDDEN%1, :ORIENT%1)").arg(i);
+        }
+
+        query.prepare(
+                    QString("INSERT INTO gallery_files ("
+                            "filename, name, path, dir_id, "
+                            "type, modtime, size, extension, "
+                            "angle, date, zoom, "
+                            "hidden, orientation "
+                            ") VALUES ") + values.join(", "));
+
+        for (int i = 0; i < count; ++i)
+        {
+            ImageMetadata *im = files[written + i];
+            QString n = QString::number(i);
+
+            query.bindValue(":FILENAME"  + n, im->m_fileName);
+            query.bindValue(":NAME"      + n, im->m_name);
+            query.bindValue(":PATH"      + n, im->m_path);
+            query.bindValue(":DIR_ID"    + n, im->m_parentId);
+            query.bindValue(":TYPE"      + n, im->m_type);
+            query.bindValue(":MODTIME"   + n, im->m_modTime);
+            query.bindValue(":SIZE"      + n, im->m_size);
+            query.bindValue(":EXTENSION" + n, im->m_extension);
+            query.bindValue(":ANGLE"     + n, im->GetAngle());
+            query.bindValue(":DATE"      + n, im->m_date);
+            query.bindValue(":ZOOM"      + n, im->GetZoom());
+            query.bindValue(":HIDDEN"    + n, im->m_isHidden);
+            query.bindValue(":ORIENT"    + n, im->GetOrientation());
+        }
+
+        if (query.exec())
+        {
+            saved += count;
+        }
+        else
+        {
+            // One bad row fails the whole statement, so save the
+            // files of this batch one at a time and only lose that row
+            MythDB::DBError("Error inserting, query: ", query);
+            for (int i = 0; i < count; ++i)
+            {
+                if (InsertFileIntoDB(files[written + i]) > 0)
+                    ++saved;
+            }
+        }
+
+        written += count;
+    }
+
+    return saved;
+}
+
+
+
 /** \fn     ImageUtils::UpdateDirectoryInDB(ImageMetadata *)
  *  \brief  Updates the information about a given directory in the database
  *  \param  dm Information of the directory
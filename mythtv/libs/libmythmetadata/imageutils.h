@@ -3,6 +3,7 @@
 
 // Qt headers
 #include <QDirIterator>
+#include <QMutex>
 
 // Other headers
 // Note: Older versions of Exiv2 don't have the exiv2.hpp include
@@ -21,6 +22,8 @@
 
 #define IMAGE_STORAGE_GROUP "Photographs";
 
+class MThreadPool;
+
 class META_PUBLIC ImageUtils
 {
 public:
@@ -32,6 +35,7 @@ public:
 
     int  InsertDirectoryIntoDB(ImageMetadata *);
     int  InsertFileIntoDB(ImageMetadata *);
+    int  InsertFilesIntoDB(const QList<ImageMetadata *> &);
 
     bool UpdateDirectoryInDB(ImageMetadata *);
     bool UpdateFileInDB(ImageMetadata *);
@@ -47,6 +51,8 @@ public:
 
     QStringList  GetStorageDirs();
 
+    MThreadPool *GetThreadPool();
+
     long                GetExifDate(const QString &, bool *);
     int                 GetExifOrientation(const QString &, bool *);
     QString             GetExifValue(const QString &, const QString &, bool *);
@@ -64,6 +70,9 @@ private:
     QStringList          m_imageFileExt;
     QStringList          m_videoFileExt;
 
+    QMutex               m_threadPoolLock;
+    MThreadPool         *m_threadPool;
+
     void LoadDirectoryValues(MSqlQuery &, ImageMetadata *);
     void LoadFileValues(MSqlQuery &, ImageMetadata *);
 
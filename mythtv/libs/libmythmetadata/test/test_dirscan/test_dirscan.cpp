@@ -0,0 +1,3 @@
+#include "test_dirscan.h"
+
+QTEST_APPLESS_MAIN(TestDirScan)
@@ -0,0 +1,232 @@
+/*
+ *  Class TestDirScan
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <unistd.h> // for getpid()
+#include <utime.h>
+#include <ctime>
+
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QDir>
+
+#include "dbaccess.h"
+#include "dirscan.h"
+
+class TestDirScan: public QObject
+{
+    Q_OBJECT
+
+    QString m_path;
+    QString m_indexFile;
+
+    static void touch(const QString &filename)
+    {
+        QFile file(filename);
+        file.open(QIODevice::WriteOnly);
+    }
+
+    /// Sets the modification time of \p path to \p age seconds ago.  The
+    /// index doesn't trust entries read in the same second as a change.
+    static void setAge(const QString &path, int age)
+    {
+        struct utimbuf times;
+        times.actime = times.modtime = time(NULL) - age;
+        QCOMPARE(utime(QFile::encodeName(path).constData(), &times), 0);
+    }
+
+    static QStringList entries(DirectoryIndex &index, const QString &path)
+    {
+        QStringList list;
+        if (index.GetEntries(path, list))
+            list.sort();
+        return list;
+    }
+
+    void removeTree(const QString &path)
+    {
+        QDir dir(path);
+        QFileInfoList list =
+            dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        for (int i = 0; i < list.size(); i++)
+        {
+            if (list[i].isDir())
+                removeTree(list[i].filePath());
+            else
+                dir.remove(list[i].fileName());
+        }
+        QDir().rmdir(path);
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        m_path = QString("%1/test_dirscan-%2")
+            .arg(QDir::tempPath()).arg(getpid());
+        m_indexFile = m_path + ".idx";
+    }
+
+    // Videos in the root, one subdirectory, all last changed an hour ago
+    void init(void)
+    {
+        QDir().mkpath(m_path + "/Movies");
+        touch(m_path + "/a.mkv");
+        touch(m_path + "/Movies/b.avi");
+        setAge(m_path + "/Movies", 3600);
+        setAge(m_path, 3600);
+    }
+
+    void cleanup(void)
+    {
+        removeTree(m_path);
+        QFile::remove(m_indexFile);
+    }
+
+    void ListsDirectories(void)
+    {
+        DirectoryIndex index;
+
+        QCOMPARE(entries(index, m_path),
+                 QStringList() << "Movies/" << "a.mkv");
+        QCOMPARE(entries(index, m_path + "/Movies"),
+                 QStringList() << "b.avi");
+        QCOMPARE(index.GetListed(), 2U);
+        QCOMPARE(index.GetReused(), 0U);
+
+        // Asking again during the same scan doesn't read it again
+        QCOMPARE(entries(index, m_path),
+                 QStringList() << "Movies/" << "a.mkv");
+        QCOMPARE(index.GetListed(), 2U);
+
+        QStringList list;
+        QVERIFY(!index.GetEntries(m_path + "/missing", list));
+        QVERIFY(!index.GetEntries(m_path + "/a.mkv", list));
+    }
+
+    void SaveAndLoad(void)
+    {
+        QDateTime created;
+        {
+            DirectoryIndex index;
+            entries(index, m_path);
+            entries(index, m_path + "/Movies");
+            created = index.GetCreated();
+            QVERIFY(index.Save(m_indexFile));
+        }
+
+        DirectoryIndex index;
+        QVERIFY(index.Load(m_indexFile));
+        QCOMPARE(index.GetCreated(), created);
+
+        QCOMPARE(entries(index, m_path),
+                 QStringList() << "Movies/" << "a.mkv");
+        QCOMPARE(entries(index, m_path + "/Movies"),
+                 QStringList() << "b.avi");
+        QCOMPARE(index.GetListed(), 0U);
+        QCOMPARE(index.GetReused(), 2U);
+    }
+
+    void RereadsChangedDirectory(void)
+    {
+        {
+            DirectoryIndex index;
+            entries(index, m_path);
+            entries(index, m_path + "/Movies");
+            QVERIFY(index.Save(m_indexFile));
+        }
+
+        touch(m_path + "/Movies/c.avi");
+        setAge(m_path + "/Movies", 1800);
+
+        DirectoryIndex index;
+        QVERIFY(index.Load(m_indexFile));
+
+        QCOMPARE(entries(index, m_path),
+                 QStringList() << "Movies/" << "a.mkv");
+        QCOMPARE(entries(index, m_path + "/Movies"),
+                 QStringList() << "b.avi" << "c.avi");
+        QCOMPARE(index.GetListed(), 1U);
+        QCOMPARE(index.GetReused(), 1U);
+    }
+
+    void RereadsRecentChange(void)
+    {
+        // Changed in the second it was read, a later change in that same
+        // second wouldn't show in the modification time
+        setAge(m_path, 0);
+        {
+            DirectoryIndex index;
+            entries(index, m_path);
+            QVERIFY(index.Save(m_indexFile));
+        }
+
+        DirectoryIndex index;
+        QVERIFY(index.Load(m_indexFile));
+        entries(index, m_path);
+        QCOMPARE(index.GetListed(), 1U);
+        QCOMPARE(index.GetReused(), 0U);
+    }
+
+    void KeepsOnlySeenDirectories(void)
+    {
+        {
+            DirectoryIndex index;
+            entries(index, m_path);
+            entries(index, m_path + "/Movies");
+            QVERIFY(index.Save(m_indexFile));
+        }
+        {
+            DirectoryIndex index;
+            QVERIFY(index.Load(m_indexFile));
+            entries(index, m_path);
+            QVERIFY(index.Save(m_indexFile));
+        }
+
+        DirectoryIndex index;
+        QVERIFY(index.Load(m_indexFile));
+        entries(index, m_path);
+        entries(index, m_path + "/Movies");
+        QCOMPARE(index.GetListed(), 1U);
+        QCOMPARE(index.GetReused(), 1U);
+    }
+
+    void RejectsDamagedIndex(void)
+    {
+        DirectoryIndex index;
+        QVERIFY(!index.Load(m_indexFile));
+
+        {
+            DirectoryIndex saved;
+            entries(saved, m_path);
+            entries(saved, m_path + "/Movies");
+            QVERIFY(saved.Save(m_indexFile));
+        }
+
+        QFile file(m_indexFile);
+        QVERIFY(file.resize(file.size() - 8));
+        QVERIFY(!index.Load(m_indexFile));
+
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("not an index");
+        file.close();
+        QVERIFY(!index.Load(m_indexFile));
+
+        // Nothing is reused from a rejected index
+        entries(index, m_path);
+        QCOMPARE(index.GetReused(), 0U);
+    }
+};
@@ -16,6 +16,8 @@
 #include "remoteutil.h"
 #include "mythlogging.h"
 #include "mythdate.h"
+#include "mythdirs.h"
+#include "mythtimer.h"
 
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
@@ -149,6 +151,8 @@ void VideoScannerThread::run()
 {
     RunProlog();
 
+    MythTimer scanTimer(MythTimer::kStartRunning);
+
     VideoMetadataListManager::metadata_list ml;
     VideoMetadataListManager::loadAllFromDatabase(ml);
     m_dbmetadata->setList(ml);
@@ -163,6 +167,24 @@ void VideoScannerThread::run()
 
     LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
 
+    // Local directories that haven't changed since the last scan are not
+    // read again. The index is rebuilt from scratch every few days in case
+    // a change was missed, e.g. due to attribute caching on NFS mounts.
+    QString indexFile = GetConfDir() + "/videoscan.idx";
+    DirectoryIndex *index = NULL;
+    if (gCoreContext->GetNumSetting("VideoIncrementalScan", 1))
+    {
+        int fullScanDays = gCoreContext->GetNumSetting("VideoFullScanDays", 7);
+
+        index = new DirectoryIndex();
+        if (!index->Load(indexFile) ||
+            index->GetCreated().daysTo(MythDate::current()) >= fullScanDays)
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Reading all video directories.");
+            index->Clear();
+        }
+    }
+
     uint counter = 0;
     FileCheckList fs_files;
 
@@ -172,7 +194,7 @@ void VideoScannerThread::run()
     for (QStringList::const_iterator iter = m_directories.begin();
          iter != m_directories.end(); ++iter)
     {
-        if (!buildFileList(*iter, imageExtensions, fs_files))
+        if (!buildFileList(*iter, imageExtensions, fs_files, index))
         {
             if (iter->startsWith("myth://"))
             {
@@ -190,10 +212,25 @@ void VideoScannerThread::run()
             SendProgressEvent(++counter);
     }
 
+    if (index)
+        index->Save(indexFile);
+
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
     m_DBDataChanged = updateDB(fs_files, db_remove);
 
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Video scan finished in %1 ms, %2 files. "
+                "Directories read: %3, unchanged: %4. "
+                "Database: %5 added, %6 moved, %7 removed.")
+            .arg(scanTimer.elapsed()).arg(fs_files.size())
+            .arg(index ? index->GetListed() : 0)
+            .arg(index ? index->GetReused() : 0)
+            .arg(m_addList.size()).arg(m_movList.size())
+            .arg(m_delList.size()));
+
+    delete index;
+
     if (m_DBDataChanged)
     {
         QCoreApplication::postEvent(m_parent,
@@ -381,7 +418,8 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
 
 bool VideoScannerThread::buildFileList(const QString &directory,
                                        const QStringList &imageExtensions,
-                                       FileCheckList &filelist)
+                                       FileCheckList &filelist,
+                                       DirectoryIndex *index)
 {
     // TODO: FileCheckList is a std::map, keyed off the filename. In the event
     // multiple backends have access to shared storage, the potential exists
@@ -395,7 +433,7 @@ bool VideoScannerThread::buildFileList(const QString &directory,
     FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown);
+    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown, index);
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
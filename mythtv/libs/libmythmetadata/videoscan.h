@@ -18,6 +18,7 @@ class QStringList;
 class MythUIProgressDialog;
 
 class VideoMetadataListManager;
+class DirectoryIndex;
 
 class META_PUBLIC VideoScanner : public QObject
 {
@@ -91,7 +92,8 @@ class META_PUBLIC VideoScannerThread : public MThread
     bool updateDB(const FileCheckList &add, const PurgeList &remove);
     bool buildFileList(const QString &directory,
                                         const QStringList &imageExtensions,
-                                        FileCheckList &filelist);
+                                        FileCheckList &filelist,
+                                        DirectoryIndex *index);
 
     void SendProgressEvent(uint progress, uint total = 0,
             QString messsage = QString());
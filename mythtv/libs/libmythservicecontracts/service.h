@@ -36,6 +36,10 @@
 //    Defaults to "BOTH", available values:
 //          "GET", "POST" or "BOTH"
 //
+//  * Q_CLASSINFO( "<methodName>_Chunked", "true" ) streams the result to
+//    HTTP/1.1 clients with chunked transfer encoding as it is serialized.
+//    Use it for methods returning large lists; no ETag is sent for them.
+//
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
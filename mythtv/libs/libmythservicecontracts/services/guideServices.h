@@ -40,6 +40,7 @@ class SERVICE_PUBLIC GuideServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
     Q_CLASSINFO( "version"    , "2.1" );
+    Q_CLASSINFO( "GetProgramGuide_Chunked",            "true" )
 
     public:
 
@@ -42,7 +42,7 @@
 class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
-    Q_CLASSINFO( "version"    , "2.0" );
+    Q_CLASSINFO( "version"    , "2.1" );
     Q_CLASSINFO( "PutSetting_Method",            "POST" )
     Q_CLASSINFO( "AddStorageGroupDir_Method",    "POST" )
     Q_CLASSINFO( "RemoveStorageGroupDir_Method", "POST" )
@@ -105,7 +105,8 @@ class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
                                                 const QDateTime &FromTime,
                                                 const QDateTime &ToTime,
                                                 const QString   &Level,
-                                                const QString   &MsgContains ) = 0;
+                                                const QString   &MsgContains,
+                                                int             Count ) = 0;
 
         virtual DTC::SettingList*   GetSetting          ( const QString   &HostName,
                                                           const QString   &Key,
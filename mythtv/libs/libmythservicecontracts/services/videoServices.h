@@ -42,6 +42,7 @@ class SERVICE_PUBLIC VideoServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
     Q_CLASSINFO( "version"    , "1.2" );
+    Q_CLASSINFO( "GetVideoList_Chunked",               "true" )
     Q_CLASSINFO( "RemoveVideoFromDB_Method",           "POST" )
     Q_CLASSINFO( "AddVideo_Method",                    "POST" )
 
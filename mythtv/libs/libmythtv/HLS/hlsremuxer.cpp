@@ -0,0 +1,509 @@
+/*  -*- Mode: c++ -*-
+ *
+ *   Class HLSRemuxer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <algorithm>
+using namespace std;
+
+#include <QFile>
+#include <QFileInfo>
+
+#include "mythcorecontext.h"
+#include "mythdate.h"
+#include "mythlogging.h"
+#include "programinfo.h"
+#include "mpegtables.h"
+#include "httplivestream.h"
+#include "hlsremuxer.h"
+
+#define LOC QString("HLSRemux(%1): ").arg(streamid)
+#define SLOC QString("HLSRemux(): ")
+
+/// Transport stream packet size
+static const uint     kTSPacketSize = 188;
+/// How far into the recording to look for the PAT and PMT
+static const qint64   kMaxPSIScan   = 4 * 1024 * 1024;
+/// Refuse to serve segments larger than this, the seek table is broken
+static const uint64_t kMaxSegment   = 64 * 1024 * 1024;
+
+/// Bitrate HTTPLiveStream, and the sample web pages, use by default
+static const int      kDefaultBitrate = 800000;
+/// Recording files whose SourceInfo is kept
+static const int      kMaxSources   = 256;
+
+QMutex                          HLSRemuxer::s_lock;
+QHash<int, HLSRemuxer::SegmentTablePtr> HLSRemuxer::s_tables;
+QCache<QString, QByteArray>    *HLSRemuxer::s_cache = NULL;
+QCache<QString, HLSRemuxer::SourceInfo> HLSRemuxer::s_sources(kMaxSources);
+
+/** \brief Returns true if the recording can be streamed as is.
+ *
+ *  Only finished recordings in transport streams whose video is H.264
+ *  and whose audio is AAC are remuxed, which is what HLS clients can
+ *  play.  And only if the client didn't ask for a smaller picture or
+ *  lower bitrate than the recording has, everything else still needs
+ *  mythtranscode.
+ */
+bool HLSRemuxer::CanRemux(const ProgramInfo &pginfo, const QString &filename,
+                          int width, int bitrate)
+{
+    if (!filename.endsWith(".ts", Qt::CaseInsensitive))
+        return false;
+
+    if (!(pginfo.GetVideoProperties() & VID_AVC))
+        return false;
+
+    if (pginfo.GetRecordingEndTime() > MythDate::current())
+        return false;
+
+    return CanRemux(GetSourceInfo(pginfo, filename), width, bitrate);
+}
+
+/** \brief Decides between remuxing and transcoding once the source is
+ *         known to be a finished H.264 recording.
+ *
+ *  A \p width or \p bitrate of 0 means the client has no preference.
+ *  So does kDefaultBitrate, which clients send when the user didn't pick
+ *  one; it is far below any HD recording and would otherwise mean that
+ *  nothing is ever remuxed.
+ */
+bool HLSRemuxer::CanRemux(const SourceInfo &source, int width, int bitrate)
+{
+    if (!source.hlsStreams)
+        return false;
+
+    if (width > 0 && (uint)width < source.width)
+        return false;
+
+    if (bitrate > 0 && bitrate != kDefaultBitrate &&
+        (uint64_t)bitrate < source.bitrate)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/** \brief Looks at the streams, width and bitrate of a recording file.
+ *
+ *  This reads the start of the file and queries the database, so the
+ *  result is cached until the file's size or modification time changes.
+ */
+HLSRemuxer::SourceInfo HLSRemuxer::GetSourceInfo(const ProgramInfo &pginfo,
+                                                 const QString &filename)
+{
+    QFileInfo finfo(filename);
+    SourceInfo info;
+    info.modified = finfo.lastModified();
+    info.size     = finfo.size();
+
+    {
+        QMutexLocker locker(&s_lock);
+        SourceInfo *cached = s_sources.object(filename);
+        if (cached && cached->modified == info.modified &&
+            cached->size == info.size)
+        {
+            return *cached;
+        }
+    }
+
+    // The video and audio properties don't tell AAC from other audio
+    QFile file(filename);
+    info.hlsStreams = file.open(QIODevice::ReadOnly) &&
+                      HasHLSStreams(ReadPSI(file));
+
+    if (info.hlsStreams)
+    {
+        info.width = pginfo.QueryAverageWidth();
+
+        int64_t msecs = pginfo.QueryTotalDuration() / 1000;
+        if (msecs <= 0)
+            msecs = pginfo.GetRecordingStartTime()
+                .secsTo(pginfo.GetRecordingEndTime()) * 1000LL;
+
+        if (msecs > 0)
+            info.bitrate = (uint64_t)info.size * 8 * 1000 / msecs;
+    }
+
+    QMutexLocker locker(&s_lock);
+    s_sources.insert(filename, new SourceInfo(info));
+
+    return info;
+}
+
+QString HLSRemuxer::GetPlaylistURL(int streamid)
+{
+    return QString("/HLSRemux/GetPlaylist?StreamId=%1").arg(streamid);
+}
+
+/** \brief Builds the VOD playlist for a remuxed stream.
+ *  \return an empty array if the stream can not be remuxed
+ */
+QByteArray HLSRemuxer::GetPlaylist(int streamid)
+{
+    SegmentTablePtr table = GetSegmentTable(streamid);
+
+    if (!table)
+        return QByteArray();
+
+    QString playlist = QString(
+        "#EXTM3U\n"
+        "#EXT-X-VERSION:3\n"
+        "#EXT-X-TARGETDURATION:%1\n"
+        "#EXT-X-MEDIA-SEQUENCE:0\n"
+        "#EXT-X-PLAYLIST-TYPE:VOD\n")
+        .arg((table->maxDuration + 999) / 1000);
+
+    for (int i = 0; i < table->segments.size(); ++i)
+    {
+        playlist += QString("#EXTINF:%1,\n"
+                            "GetSegment?StreamId=%2&Segment=%3\n")
+            .arg(table->segments[i].duration / 1000.0, 0, 'f', 3)
+            .arg(streamid).arg(i);
+    }
+
+    playlist += "#EXT-X-ENDLIST\n";
+
+    return playlist.toUtf8();
+}
+
+/** \brief Returns the transport stream data for one segment, reading it
+ *         from the recording unless it is still in the cache.
+ *  \return an empty array if there is no such segment
+ */
+QByteArray HLSRemuxer::GetSegment(int streamid, uint segment)
+{
+    QString key = QString("%1:%2").arg(streamid).arg(segment);
+
+    {
+        QMutexLocker locker(&s_lock);
+
+        if (!s_cache)
+        {
+            int size = gCoreContext->GetNumSetting("HLSRemuxCacheSize", 64);
+            s_cache = new QCache<QString, QByteArray>(max(size, 1) * 1024);
+        }
+
+        QByteArray *cached = s_cache->object(key);
+        if (cached)
+            return *cached;
+    }
+
+    SegmentTablePtr table = GetSegmentTable(streamid);
+
+    if (!table || segment >= (uint)table->segments.size())
+        return QByteArray();
+
+    const Segment &seg = table->segments[segment];
+
+    if (seg.end <= seg.start || seg.end - seg.start > kMaxSegment)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Segment %1 has an invalid size %2")
+                .arg(segment).arg(seg.end - seg.start));
+        return QByteArray();
+    }
+
+    QFile file(table->filename);
+
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(seg.start))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to read %1").arg(table->filename));
+        return QByteArray();
+    }
+
+    QByteArray data = table->psi;
+    data += file.read(seg.end - seg.start);
+
+    if ((uint64_t)data.size() < seg.end - seg.start)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Short read of segment %1").arg(segment));
+    }
+
+    LOG(VB_FILE, LOG_DEBUG, LOC +
+        QString("Read segment %1, %2 bytes").arg(segment).arg(data.size()));
+
+    QMutexLocker locker(&s_lock);
+    s_cache->insert(key, new QByteArray(data), data.size() / 1024 + 1);
+
+    return data;
+}
+
+/// \brief Forgets the segment table and cached segments of a stream.
+void HLSRemuxer::RemoveStream(int streamid)
+{
+    QMutexLocker locker(&s_lock);
+
+    s_tables.remove(streamid);
+
+    if (!s_cache)
+        return;
+
+    QString prefix = QString("%1:").arg(streamid);
+    QList<QString> keys = s_cache->keys();
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        if (keys[i].startsWith(prefix))
+            s_cache->remove(keys[i]);
+    }
+}
+
+HLSRemuxer::SegmentTablePtr HLSRemuxer::GetSegmentTable(int streamid)
+{
+    {
+        QMutexLocker locker(&s_lock);
+        if (s_tables.contains(streamid))
+            return s_tables[streamid];
+    }
+
+    // Loading the table can take a while for long recordings, don't
+    // hold up requests for other streams while it is built.
+    SegmentTablePtr table = LoadSegmentTable(streamid);
+
+    if (!table)
+        return table;
+
+    QMutexLocker locker(&s_lock);
+    if (s_tables.contains(streamid))
+        return s_tables[streamid];
+    s_tables[streamid] = table;
+
+    return table;
+}
+
+/** \brief Splits the recording behind a live stream into segments at the
+ *         keyframes in its seek table.
+ */
+HLSRemuxer::SegmentTablePtr HLSRemuxer::LoadSegmentTable(int streamid)
+{
+    HTTPLiveStream hls(streamid);
+    QString filename = hls.GetSourceFile();
+
+    QFile file(filename);
+    if (filename.isEmpty() || !file.open(QIODevice::ReadOnly))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to open '%1'").arg(filename));
+        return SegmentTablePtr();
+    }
+
+    ProgramInfo pginfo(filename);
+    if (!pginfo.GetChanID())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("No recording found for '%1'").arg(filename));
+        return SegmentTablePtr();
+    }
+
+    frm_pos_map_t posMap;
+    frm_pos_map_t durMap;
+    pginfo.QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+    pginfo.QueryPositionMap(durMap, MARK_DURATION_MS);
+
+    if (posMap.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("'%1' has no seek table").arg(filename));
+        return SegmentTablePtr();
+    }
+
+    // Only used when the recording has no duration map
+    uint fps = pginfo.QueryAverageFrameRate();
+    if (!fps)
+        fps = 29970;
+
+    uint64_t target   = max((int)hls.GetSegmentSize(), 1) * 1000;
+    uint64_t filesize = file.size();
+    uint64_t total    = pginfo.QueryTotalDuration() / 1000;
+
+    SegmentTablePtr table(new SegmentTable);
+    table->filename    = filename;
+    table->psi         = ReadPSI(file);
+    table->maxDuration = 0;
+
+    uint64_t segStart  = 0;
+    uint64_t segTime   = 0;
+    frm_pos_map_t::const_iterator it = posMap.begin();
+    for (; it != posMap.end(); ++it)
+    {
+        uint64_t offset = *it - (*it % kTSPacketSize);
+        uint64_t time   = durMap.contains(it.key()) ? durMap.value(it.key()) :
+                          it.key() * 1000000 / fps;
+
+        if (offset >= filesize)
+            break;
+
+        if (time < segTime + target || offset <= segStart)
+            continue;
+
+        table->segments.push_back(
+            Segment(segStart, offset, time - segTime));
+        table->maxDuration = max(table->maxDuration, (uint)(time - segTime));
+
+        segStart = offset;
+        segTime  = time;
+    }
+
+    if (segStart < filesize)
+    {
+        uint duration = (total > segTime) ? total - segTime : target;
+        table->segments.push_back(Segment(segStart, filesize, duration));
+        table->maxDuration = max(table->maxDuration, duration);
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Remuxing '%1' as %2 segments")
+            .arg(filename).arg(table->segments.size()));
+
+    return table;
+}
+
+/** \brief Finds the first PAT and the PMT it points to in the recording.
+ *
+ *  These are put in front of every segment so that a client can start
+ *  decoding at any segment, without having to wait for the next PAT and
+ *  PMT the broadcaster sent.
+ */
+QByteArray HLSRemuxer::ReadPSI(QFile &file)
+{
+    QByteArray pat;
+    QByteArray pmt;
+    int        pmtPID = -1;
+
+    file.seek(0);
+
+    while (file.pos() < kMaxPSIScan && pmt.isEmpty())
+    {
+        QByteArray pkt = file.read(kTSPacketSize);
+        if ((uint)pkt.size() < kTSPacketSize)
+            break;
+
+        const unsigned char *data = (const unsigned char *)pkt.constData();
+        if (data[0] != 0x47 || !(data[1] & 0x40))
+            continue;
+
+        int pid = ((data[1] & 0x1f) << 8) | data[2];
+
+        if (pid == pmtPID)
+        {
+            pmt = pkt;
+            break;
+        }
+
+        if (pid != 0 || !pat.isEmpty())
+            continue;
+
+        // Skip the adaptation field and the pointer field
+        uint pos = 4;
+        if (data[3] & 0x20)
+            pos += 1 + data[4];
+        if (pos >= kTSPacketSize)
+            continue;
+        pos += 1 + data[pos];
+
+        if (pos + 8 > kTSPacketSize)
+            continue;
+
+        const unsigned char *section = data + pos;
+        uint len = ((section[1] & 0x0f) << 8) | section[2];
+        uint end = min(pos + 3 + len - 4, kTSPacketSize);
+
+        for (uint i = pos + 8; i + 4 <= end; i += 4)
+        {
+            uint program = (data[i] << 8) | data[i + 1];
+            if (program)
+            {
+                pmtPID = ((data[i + 2] & 0x1f) << 8) | data[i + 3];
+                pat = pkt;
+                break;
+            }
+        }
+    }
+
+    if (pat.isEmpty() || pmt.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, SLOC +
+            QString("No PAT/PMT found in '%1'").arg(file.fileName()));
+        return QByteArray();
+    }
+
+    return pat + pmt;
+}
+
+/** \brief Returns true if every video stream in the PMT is H.264 and
+ *         every audio stream is AAC (with ADTS framing).
+ *  \param psi The PAT and PMT packets found by ReadPSI(), one transport
+ *             stream packet each
+ */
+bool HLSRemuxer::HasHLSStreams(const QByteArray &psi)
+{
+    if ((uint)psi.size() < 2 * kTSPacketSize)
+        return false;
+
+    const unsigned char *data =
+        (const unsigned char *)psi.constData() + kTSPacketSize;
+
+    // Skip the adaptation field and the pointer field
+    uint pos = 4;
+    if (data[3] & 0x20)
+        pos += 1 + data[4];
+    if (pos >= kTSPacketSize)
+        return false;
+    pos += 1 + data[pos];
+
+    // A PMT continued in the next packet is not worth the trouble
+    if (pos + 3 > kTSPacketSize ||
+        pos + 3 + (((data[pos + 1] & 0x0f) << 8) | data[pos + 2]) >
+        kTSPacketSize)
+    {
+        return false;
+    }
+
+    if (data[pos] != TableID::PMT)
+        return false;
+
+    ProgramMapTable pmt(PSIPTable(data + pos, true));
+
+    bool video = false;
+    for (uint i = 0; i < pmt.StreamCount(); i++)
+    {
+        desc_list_t list = MPEGDescriptor::Parse(
+            pmt.StreamInfo(i), pmt.StreamInfoLength(i));
+        uint type = StreamID::Normalize(pmt.StreamType(i), list, "dvb");
+
+        if (StreamID::IsVideo(type))
+        {
+            if (type != StreamID::H264Video)
+                return false;
+            video = true;
+        }
+        else if (StreamID::IsAudio(type) && type != StreamID::MPEG2AACAudio)
+        {
+            LOG(VB_GENERAL, LOG_INFO, SLOC +
+                QString("Audio is %1, not AAC, transcoding")
+                    .arg(StreamID::GetDescription(type)));
+            return false;
+        }
+    }
+
+    return video;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
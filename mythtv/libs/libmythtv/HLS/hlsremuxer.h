@@ -0,0 +1,91 @@
+#ifndef HLSREMUXER_H
+#define HLSREMUXER_H
+
+#include <stdint.h>
+
+#include <QSharedPointer>
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <QCache>
+#include <QMutex>
+#include <QHash>
+
+#include "mythtvexp.h"
+
+class ProgramInfo;
+class QFile;
+
+/** \class HLSRemuxer
+ *  \brief Serves H.264 transport stream recordings as HTTP Live Streams
+ *         without transcoding them.
+ *
+ *  The recording's seek table is used to split the file into segments of
+ *  roughly the stream's segment size, each starting on a keyframe.  A
+ *  segment is only read from disk when a client asks for it, it is simply
+ *  the byte range of the recording between two keyframes with the
+ *  recording's PAT and PMT in front of it.  Recently requested segments
+ *  are kept in memory, up to "HLSRemuxCacheSize" MB for all streams.
+ */
+class MTV_PUBLIC HLSRemuxer
+{
+  public:
+    /// What CanRemux() needs to know about a recording file
+    class SourceInfo
+    {
+      public:
+        SourceInfo() : hlsStreams(false), width(0), bitrate(0), size(0) {}
+        bool      hlsStreams; ///< H.264 video and AAC audio only
+        uint      width;      ///< Average video width, 0 if unknown
+        uint64_t  bitrate;    ///< Average bitrate in bits/s, 0 if unknown
+        QDateTime modified;   ///< File modification time, for the cache
+        qint64    size;       ///< File size, for the cache
+    };
+
+    static bool CanRemux(const ProgramInfo &pginfo, const QString &filename,
+                         int width, int bitrate);
+    static bool CanRemux(const SourceInfo &source, int width, int bitrate);
+    static bool HasHLSStreams(const QByteArray &psi);
+    static QString GetPlaylistURL(int streamid);
+
+    static QByteArray GetPlaylist(int streamid);
+    static QByteArray GetSegment(int streamid, uint segment);
+    static void RemoveStream(int streamid);
+
+  private:
+    class Segment
+    {
+      public:
+        Segment(uint64_t s = 0, uint64_t e = 0, uint d = 0) :
+            start(s), end(e), duration(d) {}
+        uint64_t start;     ///< Offset of the first byte in the recording
+        uint64_t end;       ///< Offset one past the last byte
+        uint     duration;  ///< Duration in ms
+    };
+
+    class SegmentTable
+    {
+      public:
+        QString          filename;
+        QByteArray       psi;       ///< PAT and PMT packets
+        QVector<Segment> segments;
+        uint             maxDuration;
+    };
+    typedef QSharedPointer<SegmentTable> SegmentTablePtr;
+
+    static SegmentTablePtr GetSegmentTable(int streamid);
+    static SegmentTablePtr LoadSegmentTable(int streamid);
+    static QByteArray      ReadPSI(QFile &file);
+    static SourceInfo      GetSourceInfo(const ProgramInfo &pginfo,
+                                         const QString &filename);
+
+    static QMutex                        s_lock;
+    static QHash<int, SegmentTablePtr>   s_tables;
+    static QCache<QString, QByteArray>  *s_cache; ///< Cost is in KB
+    static QCache<QString, SourceInfo>   s_sources; ///< Keyed by filename
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -42,6 +42,7 @@
 #include "mythlogging.h"
 #include "storagegroup.h"
 #include "httplivestream.h"
+#include "hlsremuxer.h"
 
 #define LOC QString("HLS(%1): ").arg(m_sourceFile)
 #define LOC_ERR QString("HLS(%1) Error: ").arg(m_sourceFile)
@@ -807,6 +808,57 @@ DTC::LiveStreamInfo *HTTPLiveStream::StartStream(void)
     return GetLiveStreamInfo();
 }
 
+/** \brief Serves the source file as is instead of running mythtranscode.
+ *
+ *  The playlist and segments are produced by HLSRemuxer when a client asks
+ *  for them, so the stream is complete as soon as it has been added.
+ */
+DTC::LiveStreamInfo *HTTPLiveStream::StartRemux(void)
+{
+    if (m_streamid == -1)
+        return NULL;
+
+    m_relativeURL = HLSRemuxer::GetPlaylistURL(m_streamid);
+    m_fullURL     = QString("http://%1:%2%3")
+        .arg(gCoreContext->GetBackendServerIP())
+        .arg(gCoreContext->GetNumSetting("BackendStatusPort", 6544))
+        .arg(m_relativeURL);
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "UPDATE livestream "
+        "SET relativeurl = :RELATIVEURL, fullurl = :FULLURL, "
+        "    sourcewidth = :SOURCEWIDTH, sourceheight = :SOURCEHEIGHT "
+        "WHERE id = :STREAMID; ");
+    query.bindValue(":RELATIVEURL", m_relativeURL);
+    query.bindValue(":FULLURL", m_fullURL);
+    query.bindValue(":SOURCEWIDTH", m_width);
+    query.bindValue(":SOURCEHEIGHT", m_height);
+    query.bindValue(":STREAMID", m_streamid);
+
+    if (!query.exec())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to update URLs for streamid %1").arg(m_streamid));
+        UpdateStatus(kHLSStatusErrored);
+        return GetLiveStreamInfo();
+    }
+
+    m_sourceWidth  = m_width;
+    m_sourceHeight = m_height;
+
+    UpdateStatusMessage("Remuxing on demand");
+    UpdatePercentComplete(100);
+    UpdateStatus(kHLSStatusCompleted);
+
+    return GetLiveStreamInfo();
+}
+
+bool HTTPLiveStream::IsRemux(void) const
+{
+    return m_relativeURL.startsWith("/HLSRemux/");
+}
+
 bool HTTPLiveStream::RemoveStream(int id)
 {
     MSqlQuery query(MSqlQuery::InitCon());
@@ -828,6 +880,24 @@ bool HTTPLiveStream::RemoveStream(int id)
         HTTPLiveStream::StopStream(id);
     }
 
+    if (hls->IsRemux())
+    {
+        // Nothing was written to disk for this stream
+        HLSRemuxer::RemoveStream(id);
+
+        query.prepare(
+            "DELETE FROM livestream "
+            "WHERE id = :STREAMID; ");
+        query.bindValue(":STREAMID", id);
+
+        if (!query.exec())
+            LOG(VB_RECORD, LOG_ERR,
+                "Error deleting stream info in RemoveStream");
+
+        delete hls;
+        return true;
+    }
+
     QString thisFile;
     int startSegment = query.value(0).toInt();
     int segmentCount = query.value(1).toInt();
@@ -901,6 +971,10 @@ DTC::LiveStreamInfo *HTTPLiveStream::StopStream(int id)
     if (!hls)
         return NULL;
 
+    // There is no mythtranscode to notice the request
+    if (hls->IsRemux())
+        hls->UpdateStatus(kHLSStatusStopped);
+
     MythTimer statusTimer;
     int       delay = 250000;
     statusTimer.start();
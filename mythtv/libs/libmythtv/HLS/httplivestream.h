@@ -71,8 +71,10 @@ class MTV_PUBLIC HTTPLiveStream
     QString StatusToString(HTTPLiveStreamStatus status);
 
     bool CheckStop(void);
+    bool IsRemux(void) const;
 
            DTC::LiveStreamInfo     *StartStream(void);
+           DTC::LiveStreamInfo     *StartRemux(void);
     static DTC::LiveStreamInfo     *StopStream(int id);
     static bool                     RemoveStream(int id);
 
@@ -22,7 +22,10 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <QAtomicInt>
 #include <QObject>
+#include <QRunnable>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QtAlgorithms>
@@ -31,7 +34,9 @@
 #include <sys/time.h> // for gettimeofday
 
 #include "mthread.h"
+#include "mthreadpool.h"
 #include "httplivestreambuffer.h"
+#include "mythcorecontext.h"
 #include "mythdownloadmanager.h"
 #include "mythlogging.h"
 
@@ -46,6 +51,10 @@
 // Constants
 #define PLAYBACK_MINBUFFER 2    // number of segments to prefetch before playback starts
 #define PLAYBACK_READAHEAD 6    // number of segments download queue ahead of playback
+#define PLAYBACK_FETCHAHEAD 3   // number of segments downloaded concurrently ahead
+                                // of the one the stream worker is waiting for
+#define BANDWIDTH_EWMA   0.3    // weight of the newest sample in the bandwidth estimate
+#define BANDWIDTH_MARGIN 0.8    // fraction of the estimated bandwidth a stream may use
 #define PLAYLIST_FAILURE   6    // number of consecutive failures after which
                                 // playback will abort
 enum
@@ -621,8 +630,9 @@ public:
         segment->Lock();
         if (!segment->IsEmpty())
         {
-            /* Segment already downloaded */
+            /* Segment already downloaded, nothing was measured */
             segment->Unlock();
+            bandwidth = 0;
             return RET_OK;
         }
 
@@ -632,9 +642,10 @@ public:
             .arg(stream));
 
         /* sanity check - can we download this segment on time? */
-        if ((bandwidth > 0) && (m_bitrate > 0))
+        uint64_t bitrate = Bitrate();
+        if ((bandwidth > 0) && (bitrate > 0))
         {
-            uint64_t size = (segment->Duration() * m_bitrate); /* bits */
+            uint64_t size = (segment->Duration() * bitrate); /* bits */
             int estimated = (int)(size / bandwidth);
             if (estimated > segment->Duration())
             {
@@ -660,18 +671,25 @@ public:
         }
 
         uint64_t downloadduration = mdate() - start;
-        if (m_bitrate == 0 && segment->Duration() > 0)
+        if (segment->Duration() > 0)
         {
-            /* Try to estimate the bandwidth for this stream */
-            m_bitrate = (uint64_t)(((double)segment->Size() * 8) /
-                                     ((double)segment->Duration()));
+            /* Try to estimate the bandwidth for this stream, segments of
+             * it may be fetched in parallel */
+            QMutexLocker lock(&m_bitrateLock);
+            if (m_bitrate == 0)
+            {
+                m_bitrate = (uint64_t)(((double)segment->Size() * 8) /
+                                         ((double)segment->Duration()));
+            }
         }
 
 #ifdef USING_LIBCRYPTO
         /* If the segment is encrypted, decode it */
         if (segment->HasKeyPath())
         {
-            /* Do we have loaded the key ? */
+            /* Do we have loaded the key ? Other segments are fetched at
+             * the same time, only one of them loads the keys */
+            QMutexLocker keylock(&m_keyLock);
             if (!segment->KeyLoaded())
             {
                 if (ManageSegmentKeys() != RET_OK)
@@ -682,6 +700,7 @@ public:
                     return RET_OK;
                 }
             }
+            keylock.unlock();
             if (segment->DecodeData(m_ivloaded ? m_AESIV : NULL) != RET_OK)
             {
                 segment->Unlock();
@@ -733,6 +752,7 @@ public:
     }
     uint64_t Bitrate(void) const
     {
+        QMutexLocker lock(&m_bitrateLock);
         return m_bitrate;
     }
     bool Cache(void) const
@@ -787,6 +807,7 @@ public:
     /**
      * Will download all required segment AES-128 keys
      * Will try to re-use already downloaded keys if possible
+     * Must hold m_keyLock
      */
     int ManageSegmentKeys()
     {
@@ -851,6 +872,7 @@ public:
 
 private:
     QString     m_keypath;              // URL path of the encrypted key
+    QMutex      m_keyLock;              // serialises loading the segment keys
     bool        m_ivloaded;
     uint8_t     m_AESIV[AES_BLOCK_SIZE];// IV used when decypher the block
 #endif
@@ -861,6 +883,7 @@ private:
     int         m_startsequence;        // media starting sequence number
     int         m_targetduration;       // maximum duration per segment (s)
     uint64_t    m_bitrate;              // bitrate of stream content (bits per second)
+    mutable QMutex m_bitrateLock;       // protects m_bitrate
     uint64_t    m_size;                 // stream length is calculated by taking the sum
                                         // foreach segment of (segment->duration * hls->bitrate/8)
     int64_t     m_duration;             // duration of the stream in seconds
@@ -925,21 +948,43 @@ private:
     QMutex          m_lock;
 };
 
+class StreamWorker;
+
+// Downloads one segment ahead of the stream worker
+class SegmentFetcher : public QRunnable
+{
+public:
+    SegmentFetcher(StreamWorker *worker, int segnum, int stream) :
+        m_worker(worker), m_segnum(segnum), m_stream(stream)
+    {
+    }
+    void run(void);
+
+private:
+    StreamWorker   *m_worker;
+    int             m_segnum;
+    int             m_stream;
+};
+
 // Stream Download Thread
 class StreamWorker : public MThread
 {
 public:
     StreamWorker(HLSRingBuffer *parent, int startup, int buffer) : MThread("HLSStream"),
-        m_parent(parent), m_interrupted(false), m_bandwidth(0), m_stream(0),
-        m_segment(startup), m_buffer(buffer),
-        m_sumbandwidth(0.0), m_countbandwidth(0)
+        m_parent(parent), m_interrupted(0), m_bandwidth(0), m_stream(0),
+        m_segment(startup), m_buffer(buffer), m_downloads(0),
+        m_fetchers("HLSSegmentFetcher")
     {
+        m_cachesize = gCoreContext->GetNumSetting("HLSSegmentCacheSize", 64) *
+            1024LL * 1024LL;
+        m_fetchers.setMaxThreadCount(PLAYBACK_FETCHAHEAD);
     }
     void Cancel(void)
     {
-        m_interrupted = true;
-        Wakeup();
+        m_interrupted.fetchAndStoreOrdered(1);
         m_lock.lock();
+        Wakeup();
+        m_lock.unlock();
         // Interrupt on-going downloads of all segments
         int streams = m_parent->NumStreams();
         for (int i = 0; i < streams; i++)
@@ -950,7 +995,10 @@ public:
                 hls->Cancel();
             }
         }
-        m_lock.unlock();
+        // Segment fetchers still hold on to us and the streams.  Those still
+        // queued return as soon as they run, the pool is only ours so they
+        // don't wait behind anybody else's work.
+        m_fetchers.waitForDone();
         wait();
     }
     int CurrentStream(void)
@@ -1027,7 +1075,7 @@ public:
     }
     void AddSegmentToStream(int segnum, int stream)
     {
-        if (m_interrupted)
+        if (Interrupted())
             return;
         QMutexLocker lock(&m_lock);
         m_segmap.insert(segnum, stream);
@@ -1084,23 +1132,62 @@ public:
     }
     int64_t Bandwidth(void) const
     {
+        QMutexLocker lock(&m_lock);
         return m_bandwidth;
     }
-    double AverageNewBandwidth(int64_t bandwidth)
+    /**
+     * Add a bandwidth sample to the exponentially weighted moving average,
+     * so the estimate follows changes in network conditions rather than
+     * being dominated by the whole history of the session.
+     * A sample of 0 means nothing was measured and is ignored.
+     */
+    int64_t AverageNewBandwidth(int64_t bandwidth)
     {
-        m_sumbandwidth += bandwidth;
-        m_countbandwidth++;
-        m_bandwidth = m_sumbandwidth / m_countbandwidth;
+        QMutexLocker lock(&m_lock);
+        if (bandwidth <= 0)
+            return m_bandwidth;
+        if (m_bandwidth <= 0)
+            m_bandwidth = bandwidth;
+        else
+            m_bandwidth = (int64_t)(BANDWIDTH_EWMA * bandwidth +
+                                    (1.0 - BANDWIDTH_EWMA) * m_bandwidth);
         return m_bandwidth;
     }
 
+    /**
+     * Download a segment on behalf of a SegmentFetcher
+     */
+    void Fetch(int segnum, int stream)
+    {
+        int err         = RET_ERROR;
+        uint64_t bw     = Bandwidth();
+        HLSStream *hls  = Interrupted() ? NULL : m_parent->GetStream(stream);
+
+        if (hls)
+        {
+            int downloads = StartDownload();
+            err = hls->DownloadSegmentData(segnum, bw, stream);
+            FinishDownload();
+            if (err == RET_OK)
+                AverageNewBandwidth(bw * downloads);
+        }
+
+        QMutexLocker lock(&m_lock);
+        m_fetching.remove(segnum);
+        if (err == RET_OK && !Interrupted())
+        {
+            m_segmap.insert(segnum, stream);
+        }
+        m_waitcond.wakeAll();
+    }
+
 protected:
     void run(void)
     {
         RunProlog();
 
         int retries = 0;
-        while (!m_interrupted)
+        while (!Interrupted())
         {
             /*
              * we can go into waiting if:
@@ -1118,7 +1205,7 @@ protected:
                  * 1- got interrupted
                  * 2- we are less than 6 segments ahead of playback
                  * 3- got asked to seek to a particular segment */
-                while (!m_interrupted && (m_segment == dnldsegment) &&
+                while (!Interrupted() && (m_segment == dnldsegment) &&
                        (((m_segment - playsegment) > m_buffer) || IsAtEnd()))
                 {
                     WaitForSignal();
@@ -1131,7 +1218,7 @@ protected:
             }
             Unlock();
 
-            if (m_interrupted)
+            if (Interrupted())
             {
                 Wakeup();
                 break;
@@ -1139,15 +1226,22 @@ protected:
             // have we already downloaded the required segment?
             if (StreamForSegment(dnldsegment) < 0)
             {
-                uint64_t bw = m_bandwidth;
+                FetchAhead(dnldsegment, m_stream);
+
+                uint64_t bw = Bandwidth();
+                int downloads = StartDownload();
                 int err = hls->DownloadSegmentData(dnldsegment, bw, m_stream);
-                if (m_interrupted)
+                FinishDownload();
+                if (Interrupted())
                 {
                     // interrupt early
                     Wakeup();
                     break;
                 }
-                bw = AverageNewBandwidth(bw);
+                if (err == RET_OK)
+                    bw = AverageNewBandwidth(bw * downloads);
+                else
+                    bw = Bandwidth();
                 if (err != RET_OK)
                 {
                     retries++;
@@ -1175,6 +1269,7 @@ protected:
                         QString("download completed, %1 segments ahead")
                         .arg(CurrentLiveBuffer()));
                     AddSegmentToStream(dnldsegment, m_stream);
+                    EvictSegments();
                     if (m_parent->m_meta && hls->Bitrate() != bw)
                     {
                         int newstream = BandwidthAdaptation(hls->Id(), bw);
@@ -1207,7 +1302,8 @@ protected:
     int BandwidthAdaptation(int progid, uint64_t &bandwidth) const
     {
         int candidate = -1;
-        uint64_t bw = bandwidth;
+        /* leave some headroom, the estimate is only an average */
+        uint64_t bw = (uint64_t)(bandwidth * BANDWIDTH_MARGIN);
         uint64_t bw_candidate = 0;
 
         int count = m_parent->NumStreams();
@@ -1236,20 +1332,115 @@ protected:
         return candidate;
     }
 
+    /**
+     * Start downloading the segments following [segnum] in the background,
+     * so that the latency of each request isn't paid one segment at a time.
+     */
+    void FetchAhead(int segnum, int stream)
+    {
+        QMutexLocker lock(&m_lock);
+        int count       = m_parent->NumSegments();
+        int playsegment = m_parent->m_playback->Segment();
+
+        for (int n = segnum + 1;
+             n <= segnum + PLAYBACK_FETCHAHEAD && n < count; n++)
+        {
+            if (Interrupted() || (n - playsegment) > m_buffer)
+                break;
+            if (m_segmap.contains(n) || m_fetching.contains(n))
+                continue;
+            m_fetching.insert(n);
+            m_fetchers.start(new SegmentFetcher(this, n, stream),
+                             "HLSSegmentFetcher");
+        }
+    }
+
+    /**
+     * Drop the data of segments already played, oldest first, once the
+     * downloaded segments take more than HLSSegmentCacheSize MB.
+     * They will be downloaded again should playback seek back to them.
+     */
+    void EvictSegments(void)
+    {
+        Lock();
+        QMap<int,int> segmap = m_segmap;
+        Unlock();
+
+        int playsegment = m_parent->m_playback->Segment();
+        int64_t cached  = 0;
+
+        QMap<int,int>::const_iterator it = segmap.begin();
+        for (; it != segmap.end(); ++it)
+        {
+            HLSStream *hls = m_parent->GetStream(*it);
+            HLSSegment *segment = hls ? hls->GetSegment(it.key()) : NULL;
+            if (segment)
+            {
+                segment->Lock();
+                cached += segment->Size();
+                segment->Unlock();
+            }
+        }
+
+        for (it = segmap.begin();
+             it != segmap.end() && cached > m_cachesize &&
+             it.key() < playsegment; ++it)
+        {
+            HLSStream *hls = m_parent->GetStream(*it);
+            HLSSegment *segment = hls ? hls->GetSegment(it.key()) : NULL;
+            if (segment == NULL)
+                continue;
+            // same lock order as safe_read
+            segment->Lock();
+            cached -= segment->Size();
+            segment->Clear();
+            RemoveSegmentFromStream(it.key());
+            segment->Unlock();
+            LOG(VB_PLAYBACK, LOG_DEBUG, LOC +
+                QString("evicted segment %1 from cache").arg(it.key()));
+        }
+    }
+
+    /**
+     * Each sample is scaled by the number of downloads in progress,
+     * concurrent downloads share the available bandwidth.
+     */
+    int StartDownload(void)
+    {
+        QMutexLocker lock(&m_lock);
+        return ++m_downloads;
+    }
+    void FinishDownload(void)
+    {
+        QMutexLocker lock(&m_lock);
+        m_downloads--;
+    }
+    bool Interrupted(void)
+    {
+        return m_interrupted.fetchAndAddOrdered(0);
+    }
+
 private:
     HLSRingBuffer  *m_parent;
-    bool            m_interrupted;
-    int64_t         m_bandwidth;// measured average download bandwidth (bits per second)
+    QAtomicInt      m_interrupted;
+    int64_t         m_bandwidth;// estimated download bandwidth (bits per second)
     int             m_stream;   // current HLSStream
     int             m_segment;  // current segment for downloading
     int             m_buffer;   // buffer kept between download and playback
     QMap<int,int>   m_segmap;   // segment with streamid used for download
+    QSet<int>       m_fetching; // segments being downloaded by SegmentFetchers
+    int             m_downloads;// downloads in progress
+    int64_t         m_cachesize;// max bytes of downloaded segments kept
+    MThreadPool     m_fetchers; // runs the SegmentFetchers
     mutable QMutex  m_lock;
     QWaitCondition  m_waitcond;
-    double          m_sumbandwidth;
-    int             m_countbandwidth;
 };
 
+void SegmentFetcher::run(void)
+{
+    m_worker->Fetch(m_segnum, m_stream);
+}
+
 // Playlist Refresh Thread
 class PlaylistWorker : public MThread
 {
@@ -154,6 +154,9 @@ ChannelScanSM::ChannelScanSM(
       extend_scan_list(false),
       // Optional state
       scanDTVTunerType(DTVTunerType::kTunerTypeUnknown),
+      shardIndex(0),
+      shardCount(1),
+      sharedTransports(NULL),
       // State
       scanning(false),
       threadExit(false),
@@ -252,6 +255,19 @@ void ChannelScanSM::SetAnalog(bool is_analog)
         signalMonitor->AddListener(analogSignalHandler);
 }
 
+/** \brief Makes this scanner scan only part of the transports, while
+ *         the other tuners of a source scan the rest.
+ *
+ *  Call this before the transports are set, \p shared must be the same
+ *  for all of the scanners and outlive them.
+ */
+void ChannelScanSM::SetShard(uint index, uint count, ScannedTransports *shared)
+{
+    shardIndex       = index;
+    shardCount       = max(count, 1U);
+    sharedTransports = shared;
+}
+
 void ChannelScanSM::HandleAllGood(void)
 {
     QMutexLocker locker(&lock);
@@ -343,6 +359,7 @@ bool ChannelScanSM::ScanExistingTransports(uint sourceid, bool follow_nit)
     transportsScanned = 0;
     if (scanTransports.size())
     {
+        ShardTransports();
         nextIt   = scanTransports.begin();
         scanning = true;
     }
@@ -451,6 +468,8 @@ void ChannelScanSM::HandleSDT(uint tsid, const ServiceDescriptionTable *sdt)
 
     uint id = sdt->OriginalNetworkID() << 16 | sdt->TSID();
     ts_scanned.insert(id);
+    if (sharedTransports)
+        sharedTransports->Scanned(id);
 
     for (uint i = 0; !currentTestingDecryption && i < sdt->ServiceCount(); i++)
     {
@@ -992,8 +1011,8 @@ bool ChannelScanSM::UpdateChannelInfo(bool wait_until_complete)
         }
         else
         {
-            scan_monitor->ScanPercentComplete(100);
-            scan_monitor->ScanComplete();
+            scan_monitor->ScanPercentComplete(100, shardIndex);
+            scan_monitor->ScanComplete(shardIndex);
         }
 
         return true;
@@ -1617,6 +1636,13 @@ void ChannelScanSM::HandleActiveScan(void)
         QMap<uint32_t,DTVMultiplex>::iterator it = extend_transports.begin();
         while (it != extend_transports.end())
         {
+            // Another tuner may be scanning the transport already
+            if (!ts_scanned.contains(it.key()) && sharedTransports &&
+                !sharedTransports->Claim(it.key(), *it))
+            {
+                ts_scanned.insert(it.key());
+            }
+
             if (!ts_scanned.contains(it.key()))
             {
                 QString name = QString("TransportID %1").arg(it.key() & 0xffff);
@@ -1635,7 +1661,7 @@ tuning.toString());
     }
     else
     {
-        scan_monitor->ScanComplete();
+        scan_monitor->ScanComplete(shardIndex);
         scanning = false;
         current = nextIt = scanTransports.end();
     }
@@ -1686,10 +1712,7 @@ void ChannelScanSM::ScanTransport(const transport_scan_items_it_t transport)
     }
 
     if (channelsFound)
-    {
-        QString progress = QObject::tr(": Found %n", "", channelsFound);
-        scan_monitor->ScanUpdateStatusTitleText(progress);
-    }
+        scan_monitor->ScanChannelsFound(channelsFound, shardIndex);
 
     scan_monitor->ScanUpdateStatusText(cur_chan);
     LOG(VB_CHANSCAN, LOG_INFO, LOC + tune_msg_str);
@@ -1814,6 +1837,8 @@ bool ChannelScanSM::ScanTransports(
         tables.pop_back();
     }
 
+    ShardTransports();
+
     extend_scan_list = true;
     timer.start();
     waitingForTables = false;
@@ -1855,6 +1880,8 @@ bool ChannelScanSM::ScanForChannels(uint sourceid,
         return false;
     }
 
+    ShardTransports();
+
     timer.start();
     waitingForTables = false;
 
@@ -1995,6 +2022,32 @@ bool ChannelScanSM::AddToList(uint mplexid)
     return false;
 }
 
+/// \brief Drops the transports that the other tuners scan.
+void ChannelScanSM::ShardTransports(void)
+{
+    if (shardCount <= 1)
+        return;
+
+    // Every scanner reserves the whole list, so the other scanners don't
+    // pick these transports up from a NIT before they have been scanned
+    transport_scan_items_t shard;
+    transport_scan_items_t::const_iterator it = scanTransports.begin();
+    for (uint i = 0; it != scanTransports.end(); ++it, ++i)
+    {
+        if (sharedTransports)
+            sharedTransports->Reserve((*it).tuning);
+        if (i % shardCount == shardIndex)
+            shard.push_back(*it);
+    }
+
+    LOG(VB_CHANSCAN, LOG_INFO, LOC +
+        QString("Scanning %1 of %2 transports, part %3 of %4")
+            .arg(shard.size()).arg(scanTransports.size())
+            .arg(shardIndex + 1).arg(shardCount));
+
+    scanTransports = shard;
+}
+
 bool ChannelScanSM::ScanTransport(uint mplexid, bool follow_nit)
 {
     scanTransports.clear();
@@ -33,6 +33,7 @@
 // Qt includes
 #include <QRunnable>
 #include <QString>
+#include <QMutex>
 #include <QList>
 #include <QPair>
 #include <QMap>
@@ -64,6 +65,63 @@ class ScannedChannelInfo;
 typedef QPair<transport_scan_items_it_t, ScannedChannelInfo*> ChannelListItem;
 typedef QList<ChannelListItem> ChannelList;
 
+/** \brief Transports found in NITs while several tuners scan a source,
+ *         so that each of them is only scanned by one of the tuners.
+ *
+ *  The transports of the initial scan list are reserved up front by
+ *  frequency, as their IDs are only known once they have been tuned.
+ */
+class ScannedTransports
+{
+  public:
+    /// \brief Reserves a transport of the initial list, it is scanned
+    ///        by the tuner whose share it is in
+    void Reserve(const DTVMultiplex &tuning)
+    {
+        QMutexLocker locker(&lock);
+        if (!frequencies.values(tuning.frequency)
+            .contains((int)tuning.polarity))
+        {
+            frequencies.insertMulti(tuning.frequency, (int)tuning.polarity);
+        }
+    }
+
+    /// \brief Records a transport a tuner has scanned
+    void Scanned(uint32_t id)
+    {
+        QMutexLocker locker(&lock);
+        ids.insert(id);
+    }
+
+    /// \brief Returns true the first time it is called for a transport
+    ///        that has not been reserved or scanned
+    bool Claim(uint32_t id, const DTVMultiplex &tuning)
+    {
+        QMutexLocker locker(&lock);
+        if (ids.contains(id))
+            return false;
+        ids.insert(id);
+
+        // NIT frequencies may differ a little from the tables' (offsets)
+        uint64_t slack = tuning.frequency / 2000;
+        QMap<uint64_t, int>::const_iterator it =
+            frequencies.lowerBound(tuning.frequency - slack);
+        for (; it != frequencies.end() &&
+                 it.key() <= tuning.frequency + slack; ++it)
+        {
+            if (*it == (int)tuning.polarity)
+                return false;
+        }
+
+        return true;
+    }
+
+  private:
+    QMutex              lock;
+    QSet<uint32_t>      ids;
+    QMap<uint64_t, int> frequencies; ///< Reserved frequency -> polarity
+};
+
 class ChannelScanSM;
 class AnalogSignalHandler : public SignalMonitorListener
 {
@@ -118,9 +176,11 @@ class ChannelScanSM : public MPEGStreamListener,
     void SetSignalTimeout(uint val)    { signalTimeout = val; }
     void SetChannelTimeout(uint val)   { channelTimeout = val; }
     void SetScanDTVTunerType(DTVTunerType t) { scanDTVTunerType = t; }
+    void SetShard(uint index, uint count, ScannedTransports *shared);
 
     uint GetSignalTimeout(void)  const { return signalTimeout; }
     uint GetChannelTimeout(void) const { return channelTimeout; }
+    DTVTunerType GetScanDTVTunerType(void) const { return scanDTVTunerType; }
 
     SignalMonitor    *GetSignalMonitor(void) { return signalMonitor; }
     DTVSignalMonitor *GetDTVSignalMonitor(void);
@@ -192,6 +252,7 @@ class ChannelScanSM : public MPEGStreamListener,
     void HandleAllGood(void); // used for analog scanner
 
     bool AddToList(uint mplexid);
+    void ShardTransports(void);
 
     static QString loc(const ChannelScanSM*);
 
@@ -217,6 +278,12 @@ class ChannelScanSM : public MPEGStreamListener,
     // Optional info
     DTVTunerType      scanDTVTunerType;
 
+    // Scanning with several tuners, this one scans every shardCount'th
+    // transport starting with shardIndex
+    uint               shardIndex;
+    uint               shardCount;
+    ScannedTransports *sharedTransports;
+
     /// The big lock
     mutable QMutex    lock;
 
@@ -252,9 +319,9 @@ class ChannelScanSM : public MPEGStreamListener,
 
 inline void ChannelScanSM::UpdateScanPercentCompleted(void)
 {
-    int tmp = (transportsScanned * 100) /
-              (scanTransports.size() + extend_transports.size());
-    scan_monitor->ScanPercentComplete(tmp);
+    int total = scanTransports.size() + extend_transports.size();
+    int tmp = (total) ? (transportsScanned * 100) / total : 100;
+    scan_monitor->ScanPercentComplete(tmp, shardIndex);
 }
 
 void AnalogSignalHandler::AllGood(void)
@@ -120,6 +120,22 @@ class FreeToAirOnly : public CheckBoxSetting, public TransientStorage
     };
 };
 
+class UseAllTuners : public CheckBoxSetting, public TransientStorage
+{
+  public:
+    UseAllTuners() : CheckBoxSetting(this)
+    {
+        setValue(false);
+        setLabel(QObject::tr("Use All Tuners"));
+        setHelpText(
+            QObject::tr(
+                "If set, the scan is shared by all tuners of the same "
+                "type that are connected to this video source and not "
+                "in use, which makes full scans faster. Satellite "
+                "scans always use one tuner."));
+    };
+};
+
 class TrustEncSISetting : public CheckBoxSetting, public TransientStorage
 {
   public:
@@ -42,11 +42,91 @@ using namespace std;
 #include "dvbchannel.h"
 #include "v4lchannel.h"
 #include "cardutil.h"
+#include "inputinfo.h"
+#include "tvremoteutil.h"
+#include "mythcorecontext.h"
 
 #define LOC QString("ChScan: ")
 
+/** \brief Returns true for the scans that can use several tuners
+ *
+ *  Satellite scans (NITAddScan_DVBS/DVBS2) always use one tuner.  Tuners
+ *  on one dish often share an LNB or DiSEqC switch, so tuning one of them
+ *  to another polarity, band or position would change it for the others
+ *  too, and the card settings don't say which tuners do.  Those scans
+ *  also start from a single transport and find the rest in its NIT.
+ */
+static bool is_parallel_scan(int scantype)
+{
+    return ((ScanTypeSetting::FullScan_ATSC     == scantype) ||
+            (ScanTypeSetting::FullScan_DVBC     == scantype) ||
+            (ScanTypeSetting::FullScan_DVBT     == scantype) ||
+            (ScanTypeSetting::FullTransportScan == scantype) ||
+            (ScanTypeSetting::DVBUtilsImport    == scantype));
+}
+
+static ChannelBase *create_channel(const QString &card_type,
+                                   const QString &device)
+{
+    ChannelBase *channel = NULL;
+
+#ifdef USING_DVB
+    if ("DVB" == card_type)
+        channel = new DVBChannel(device);
+#endif
+
+#ifdef USING_V4L2
+    if (("V4L" == card_type) || ("MPEG" == card_type))
+        channel = new V4LChannel(NULL, device);
+#endif
+
+#ifdef USING_HDHOMERUN
+    if ("HDHOMERUN" == card_type)
+    {
+        channel = new HDHRChannel(NULL, device);
+    }
+#endif // USING_HDHOMERUN
+
+#ifdef USING_ASI
+    if ("ASI" == card_type)
+    {
+        channel = new ASIChannel(NULL, device);
+    }
+#endif // USING_ASI
+
+    (void) card_type;
+    (void) device;
+
+    return channel;
+}
+
+/** \brief Returns true if a backend is using the tuner of a card.
+ *
+ *  Every card on any host that shares the tuner is checked.  Opening
+ *  the device is no test, a network tuner such as an HDHomeRun opens
+ *  fine while it is recording.  Without a backend to ask, a network
+ *  tuner is assumed to be busy as another host may be using it.
+ */
+static bool is_tuner_busy(const QString &card_type, const QString &device,
+                          bool can_ask_backend)
+{
+    if (!can_ask_backend)
+        return ("HDHOMERUN" == card_type);
+
+    vector<uint> cards = CardUtil::GetCardIDs(device, card_type);
+    for (uint i = 0; i < cards.size(); ++i)
+    {
+        TunedInputInfo busy_input;
+        if (RemoteIsBusy(cards[i], busy_input))
+            return true;
+    }
+
+    return false;
+}
+
 ChannelScanner::ChannelScanner() :
     scanMonitor(NULL), channel(NULL), sigmonScanner(NULL), iptvScanner(NULL),
+    useAllTuners(false), scannedTransports(NULL),
     freeToAirOnly(false), serviceRequirements(kRequireAV)
 {
 }
@@ -70,6 +150,15 @@ void ChannelScanner::Teardown(void)
         sigmonScanner = NULL;
     }
 
+    while (!parallelScanners.empty())
+        delete parallelScanners.takeLast();
+
+    while (!parallelChannels.empty())
+        delete parallelChannels.takeLast();
+
+    delete scannedTransports;
+    scannedTransports = NULL;
+
     if (channel)
     {
         delete channel;
@@ -125,7 +214,11 @@ void ChannelScanner::Scan(
         return;
     }
 
-    sigmonScanner->StartScanner();
+    QList<ChannelScanSM*> scanners;
+    scanners << sigmonScanner << parallelScanners;
+
+    for (int i = 0; i < scanners.size(); ++i)
+        scanners[i]->StartScanner();
     scanMonitor->ScanUpdateStatusText("");
 
     bool ok = false;
@@ -138,19 +231,25 @@ void ChannelScanner::Scan(
         LOG(VB_CHANSCAN, LOG_INFO, LOC + QString("ScanTransports(%1, %2, %3)")
                 .arg(freq_std).arg(mod).arg(tbl));
 
-        // HACK HACK HACK -- begin
-        // if using QAM we may need additional time... (at least with HD-3000)
-        if ((mod.startsWith("qam", Qt::CaseInsensitive)) &&
-            (sigmonScanner->GetSignalTimeout() < 1000))
+        ok = true;
+        for (int i = 0; i < scanners.size(); ++i)
         {
-            sigmonScanner->SetSignalTimeout(1000);
+            // HACK HACK HACK -- begin
+            // if using QAM we may need additional time...
+            // (at least with HD-3000)
+            if ((mod.startsWith("qam", Qt::CaseInsensitive)) &&
+                (scanners[i]->GetSignalTimeout() < 1000))
+            {
+                scanners[i]->SetSignalTimeout(1000);
+            }
+            // HACK HACK HACK -- end
+
+            scanners[i]->SetAnalog(
+                ScanTypeSetting::FullScan_Analog == scantype);
+
+            ok &= scanners[i]->ScanTransports(
+                sourceid, freq_std, mod, tbl, tbl_start, tbl_end);
         }
-        // HACK HACK HACK -- end
-
-        sigmonScanner->SetAnalog(ScanTypeSetting::FullScan_Analog == scantype);
-
-        ok = sigmonScanner->ScanTransports(
-            sourceid, freq_std, mod, tbl, tbl_start, tbl_end);
     }
     else if ((ScanTypeSetting::NITAddScan_DVBT  == scantype) ||
              (ScanTypeSetting::NITAddScan_DVBS  == scantype) ||
@@ -166,7 +265,9 @@ void ChannelScanner::Scan(
         LOG(VB_CHANSCAN, LOG_INFO, LOC + QString("ScanExistingTransports(%1)")
                 .arg(sourceid));
 
-        ok = sigmonScanner->ScanExistingTransports(sourceid, do_follow_nit);
+        ok = true;
+        for (int i = 0; i < scanners.size(); ++i)
+            ok &= scanners[i]->ScanExistingTransports(sourceid, do_follow_nit);
         if (ok)
         {
             scanMonitor->ScanPercentComplete(0);
@@ -195,10 +296,10 @@ void ChannelScanner::Scan(
                 sub_type = CardUtil::ProbeDVBType(device).toUpper();
         }
 
-        if (ok)
+        for (int i = 0; ok && i < scanners.size(); ++i)
         {
-            ok = sigmonScanner->ScanForChannels(sourceid, freq_std,
-                                          sub_type, channels);
+            ok = scanners[i]->ScanForChannels(sourceid, freq_std,
+                                              sub_type, channels);
         }
         if (ok)
         {
@@ -342,29 +443,7 @@ void ChannelScanner::PreScanCommon(
         channel_timeout = max(channel_timeout, need_nit * 7 * 1000U);
     }
 
-#ifdef USING_DVB
-    if ("DVB" == card_type)
-        channel = new DVBChannel(device);
-#endif
-
-#ifdef USING_V4L2
-    if (("V4L" == card_type) || ("MPEG" == card_type))
-        channel = new V4LChannel(NULL, device);
-#endif
-
-#ifdef USING_HDHOMERUN
-    if ("HDHOMERUN" == card_type)
-    {
-        channel = new HDHRChannel(NULL, device);
-    }
-#endif // USING_HDHOMERUN
-
-#ifdef USING_ASI
-    if ("ASI" == card_type)
-    {
-        channel = new ASIChannel(NULL, device);
-    }
-#endif // USING_ASI
+    channel = create_channel(card_type, device);
 
     if (!channel)
     {
@@ -421,6 +500,19 @@ void ChannelScanner::PreScanCommon(
             break;
     }
 
+    scanMonitor->SetScannerCount(1);
+    if (useAllTuners && is_parallel_scan(scantype))
+    {
+        AddParallelScanners(cardid, sourceid, card_type,
+                            signal_timeout, channel_timeout,
+                            do_test_decryption);
+    }
+    else if (useAllTuners)
+    {
+        LOG(VB_CHANSCAN, LOG_INFO, LOC +
+            "This type of scan only uses one tuner");
+    }
+
     // Signal Meters are connected here
     SignalMonitor *mon = sigmonScanner->GetSignalMonitor();
     if (mon)
@@ -437,3 +529,125 @@ void ChannelScanner::PreScanCommon(
 
     MonitorProgress(mon, mon, dvbm, using_rotor);
 }
+
+/** \brief Adds a scanner for each other free tuner of the same type that
+ *         is connected to the video source, each of them scans a part of
+ *         the transports.
+ *
+ *  The signal meters only show the first tuner.
+ */
+void ChannelScanner::AddParallelScanners(
+    uint cardid, uint sourceid, const QString &card_type,
+    uint signal_timeout, uint channel_timeout, bool do_test_decryption)
+{
+    QString device   = CardUtil::GetVideoDevice(cardid);
+    QString sub_type = ("DVB" == card_type) ?
+        CardUtil::ProbeDVBType(device) : QString::null;
+    QStringList devices(device);
+
+    // Only ask when there is a backend, RemoteIsBusy() says busy otherwise
+    bool can_ask_backend = gCoreContext->IsConnectedToMaster() ||
+        gCoreContext->BackendIsRunning();
+
+    vector<uint> source_cards = CardUtil::GetCardIDs(sourceid);
+    vector<uint> local_cards  = CardUtil::GetCardIDs(
+        QString::null, card_type, gCoreContext->GetHostName());
+
+    for (uint i = 0; i < source_cards.size(); ++i)
+    {
+        uint other = source_cards[i];
+        if (find(local_cards.begin(), local_cards.end(), other) ==
+            local_cards.end())
+        {
+            continue;
+        }
+
+        // Several cards may share a tuner
+        QString other_device = CardUtil::GetVideoDevice(other);
+        if (devices.contains(other_device))
+            continue;
+        devices.push_back(other_device);
+
+        if (("DVB" == card_type) &&
+            (CardUtil::ProbeDVBType(other_device) != sub_type))
+        {
+            continue;
+        }
+
+        QStringList inputs = CardUtil::GetInputNames(other, sourceid);
+        if (inputs.empty())
+            continue;
+
+        if (is_tuner_busy(card_type, other_device, can_ask_backend))
+        {
+            LOG(VB_CHANSCAN, LOG_INFO, LOC +
+                QString("Not scanning with card %1 (%2), it is in use")
+                    .arg(other).arg(other_device));
+            continue;
+        }
+
+        ChannelBase *other_channel = create_channel(card_type, other_device);
+        if (!other_channel)
+            continue;
+
+        other_channel->SetCardID(other);
+
+        // Fails if some other program has the device open
+        if (!other_channel->Open())
+        {
+            LOG(VB_CHANSCAN, LOG_INFO, LOC +
+                QString("Not scanning with card %1 (%2), it is busy")
+                    .arg(other).arg(other_device));
+            delete other_channel;
+            continue;
+        }
+
+        ChannelScanSM *scanner = new ChannelScanSM(
+            scanMonitor, card_type, other_channel, sourceid,
+            signal_timeout, channel_timeout, inputs[0],
+            do_test_decryption);
+        scanner->SetScanDTVTunerType(sigmonScanner->GetScanDTVTunerType());
+
+        parallelChannels.push_back(other_channel);
+        parallelScanners.push_back(scanner);
+    }
+
+    if (parallelScanners.empty())
+        return;
+
+    uint count = parallelScanners.size() + 1;
+    LOG(VB_CHANSCAN, LOG_INFO, LOC + QString("Scanning with %1 tuners")
+        .arg(count));
+
+    scannedTransports = new ScannedTransports();
+    sigmonScanner->SetShard(0, count, scannedTransports);
+    for (int i = 0; i < parallelScanners.size(); ++i)
+        parallelScanners[i]->SetShard(i + 1, count, scannedTransports);
+
+    scanMonitor->SetScannerCount(count);
+}
+
+/** \brief Stops all scanners and returns the transports they found.
+ *
+ *  Transports found by more than one tuner are merged by ChannelImporter.
+ */
+ScanDTVTransportList ChannelScanner::StopScannersAndGetChannelList(void)
+{
+    ScanDTVTransportList transports;
+
+    if (!sigmonScanner)
+        return transports;
+
+    sigmonScanner->StopScanner();
+    for (int i = 0; i < parallelScanners.size(); ++i)
+        parallelScanners[i]->StopScanner();
+
+    transports = sigmonScanner->GetChannelList();
+    for (int i = 0; i < parallelScanners.size(); ++i)
+    {
+        ScanDTVTransportList list = parallelScanners[i]->GetChannelList();
+        transports.insert(transports.end(), list.begin(), list.end());
+    }
+
+    return transports;
+}
@@ -32,6 +32,7 @@
 
 // Qt headers
 #include <QCoreApplication>
+#include <QList>
 
 // MythTV headers
 #include "mythtvexp.h"
@@ -43,6 +44,7 @@ class ScanMonitor;
 class IPTVChannelFetcher;
 class ChannelScanSM;
 class ChannelBase;
+class ScannedTransports;
 
 // Not (yet?) implemented from old scanner
 // do_delete_channels, do_rename_channels, atsc_format
@@ -82,15 +84,24 @@ class MTV_PUBLIC ChannelScanner
     virtual bool ImportM3U(uint cardid, const QString &inputname,
                            uint sourceid);
 
+    /// \brief Scan with all free tuners of the same type on the source
+    void SetUseAllTuners(bool use_all) { useAllTuners = use_all; }
+
   protected:
     virtual void Teardown(void);
 
+    ScanDTVTransportList StopScannersAndGetChannelList(void);
+
     virtual void PreScanCommon(
         int scantype, uint cardid,
         const QString &inputname,
         uint sourceid, bool do_ignore_signal_timeout,
         bool do_test_decryption);
 
+    void AddParallelScanners(
+        uint cardid, uint sourceid, const QString &card_type,
+        uint signal_timeout, uint channel_timeout, bool do_test_decryption);
+
     virtual void MonitorProgress(
         bool /*lock*/, bool /*strength*/, bool /*snr*/, bool /*rotor*/) { }
 
@@ -105,6 +116,12 @@ class MTV_PUBLIC ChannelScanner
     ChannelScanSM      *sigmonScanner;
     IPTVChannelFetcher *iptvScanner;
 
+    // Other tuners scanning in parallel with sigmonScanner
+    bool                      useAllTuners;
+    QList<ChannelScanSM*>     parallelScanners;
+    QList<ChannelBase*>       parallelChannels;
+    ScannedTransports        *scannedTransports;
+
     /// imported channels
     DTVChannelList      channels;
 
@@ -35,6 +35,10 @@
 // Qt headers
 #include <QCoreApplication>
 
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 QEvent::Type ScannerEvent::ScanComplete =
     (QEvent::Type) QEvent::registerEventType();
 QEvent::Type ScannerEvent::ScanShutdown =
@@ -96,17 +100,65 @@ void ScanMonitor::deleteLater(void)
     QObject::deleteLater();
 }
 
-void ScanMonitor::ScanComplete(void)
+/** \brief Sets the number of tuners scanning in parallel.
+ *
+ *  Their progress is averaged, and the scan is only complete when all
+ *  of them have called ScanComplete().
+ */
+void ScanMonitor::SetScannerCount(uint count)
+{
+    QMutexLocker locker(&lock);
+    count = max(count, 1U);
+    percent.fill(0, count);
+    channelsFound.fill(0, count);
+    complete.fill(false, count);
+}
+
+void ScanMonitor::ScanComplete(uint scanner)
 {
+    {
+        QMutexLocker locker(&lock);
+        if (scanner < (uint)complete.size())
+            complete[scanner] = true;
+        if (complete.contains(false))
+            return;
+    }
+
     post_event(this, ScannerEvent::ScanComplete, 0);
 }
 
-void ScanMonitor::ScanPercentComplete(int pct)
+void ScanMonitor::ScanPercentComplete(int pct, uint scanner)
 {
+    {
+        QMutexLocker locker(&lock);
+        if (scanner < (uint)percent.size())
+            percent[scanner] = pct;
+
+        int sum = 0;
+        for (int i = 0; i < percent.size(); ++i)
+            sum += percent[i];
+        pct = sum / percent.size();
+    }
+
     int tmp = TRANSPORT_PCT + ((100 - TRANSPORT_PCT) * pct)/100;
     post_event(this, ScannerEvent::SetPercentComplete, tmp);
 }
 
+void ScanMonitor::ScanChannelsFound(uint count, uint scanner)
+{
+    {
+        QMutexLocker locker(&lock);
+        if (scanner < (uint)channelsFound.size())
+            channelsFound[scanner] = count;
+
+        count = 0;
+        for (int i = 0; i < channelsFound.size(); ++i)
+            count += channelsFound[i];
+    }
+
+    ScanUpdateStatusTitleText(QObject::tr(": Found %n", "", (int)count));
+}
+
 void ScanMonitor::ScanAppendTextToLog(const QString &str)
 {
     post_event(this, ScannerEvent::AppendTextToLog, str);
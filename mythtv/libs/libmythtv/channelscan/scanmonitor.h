@@ -32,6 +32,8 @@
 
 // Qt headers
 #include <QObject>
+#include <QVector>
+#include <QMutex>
 #include <QEvent>
 
 // MythTV headers
@@ -50,17 +52,22 @@ class ScanMonitor :
     friend class QObject; // quiet OSX gcc warning
 
   public:
-    ScanMonitor(ChannelScanner *cs) : channelScanner(cs) { }
+    ScanMonitor(ChannelScanner *cs) :
+        channelScanner(cs), percent(1, 0), channelsFound(1, 0),
+        complete(1, false) { }
     virtual void deleteLater(void);
 
     virtual void customEvent(QEvent*);
 
+    void SetScannerCount(uint count);
+
     // Values from 1-100 of scan completion
-    void ScanPercentComplete(int pct);
+    void ScanPercentComplete(int pct, uint scanner = 0);
+    void ScanChannelsFound(uint count, uint scanner = 0);
     void ScanUpdateStatusText(const QString &status);
     void ScanUpdateStatusTitleText(const QString &status);
     void ScanAppendTextToLog(const QString &status);
-    void ScanComplete(void);
+    void ScanComplete(uint scanner = 0);
     void ScanErrored(const QString &error);
 
     // SignalMonitorListener
@@ -79,6 +86,12 @@ class ScanMonitor :
     ~ScanMonitor() { }
 
     ChannelScanner *channelScanner;
+
+    // Progress of each tuner, when scanning with several of them
+    QMutex          lock;
+    QVector<int>    percent;
+    QVector<uint>   channelsFound;
+    QVector<bool>   complete;
 };
 
 class Configurable;
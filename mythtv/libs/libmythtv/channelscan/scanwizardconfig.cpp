@@ -31,7 +31,8 @@ ScanWizardConfig::ScanWizardConfig(
     scanConfig(new ScanOptionalConfig(scanType)),
     services(new DesiredServices()),
     ftaOnly(new FreeToAirOnly()),
-    trustEncSI(new TrustEncSISetting())
+    trustEncSI(new TrustEncSISetting()),
+    allTuners(new UseAllTuners())
 {
     setLabel(tr("Scan Configuration"));
 
@@ -40,6 +41,7 @@ ScanWizardConfig::ScanWizardConfig(
     cfg->addChild(services);
     cfg->addChild(ftaOnly);
     cfg->addChild(trustEncSI);
+    cfg->addChild(allTuners);
 
     addChild(videoSource);
     addChild(input);
@@ -80,6 +82,11 @@ bool ScanWizardConfig::DoTestDecryption(void) const
     return trustEncSI->getValue().toInt();
 }
 
+bool ScanWizardConfig::DoUseAllTuners(void) const
+{
+    return allTuners->getValue().toInt();
+}
+
 ////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////
 
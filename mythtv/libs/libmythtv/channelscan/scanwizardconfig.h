@@ -44,6 +44,7 @@ class IgnoreSignalTimeout;
 class DesiredServices;
 class FreeToAirOnly;
 class TrustEncSISetting;
+class UseAllTuners;
 
 class PaneAll;
 class PaneATSC;
@@ -170,6 +171,7 @@ class ScanWizardConfig: public VerticalConfigurationGroup
         { return scanConfig->DoFollowNIT(); }
     bool    DoFreeToAirOnly(void)  const;
     bool    DoTestDecryption(void) const;
+    bool    DoUseAllTuners(void)   const;
 
   protected:
     VideoSourceSelector *videoSource;
@@ -179,6 +181,7 @@ class ScanWizardConfig: public VerticalConfigurationGroup
     DesiredServices     *services;
     FreeToAirOnly       *ftaOnly;
     TrustEncSISetting   *trustEncSI;
+    UseAllTuners        *allTuners;
 };
 
 #endif // _SCAN_WIZARD_CONFIG_H_
@@ -143,7 +143,7 @@ HEADERS += mythsystemevent.h
 HEADERS += avfringbuffer.h
 HEADERS += ringbuffer.h             fileringbuffer.h
 HEADERS += streamingringbuffer.h    metadataimagehelper.h
-HEADERS += icringbuffer.h
+HEADERS += icringbuffer.h             zaptrace.h
 
 SOURCES += recordinginfo.cpp
 SOURCES += dbcheck.cpp
@@ -171,7 +171,7 @@ SOURCES += mythsystemevent.cpp
 SOURCES += avfringbuffer.cpp
 SOURCES += ringbuffer.cpp           fileringBuffer.cpp
 SOURCES += streamingringbuffer.cpp  metadataimagehelper.cpp
-SOURCES += icringbuffer.cpp
+SOURCES += icringbuffer.cpp           zaptrace.cpp
 
 # DiSEqC
 HEADERS += diseqc.h                 diseqcsettings.h
@@ -206,7 +206,7 @@ HEADERS += mpeg/atsc_huffman.h
 HEADERS += mpeg/freesat_huffman.h   mpeg/freesat_tables.h
 HEADERS += mpeg/iso6937tables.h
 HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
-HEADERS += mpeg/H264Parser.h
+HEADERS += mpeg/H264Parser.h        mpeg/mpegtablecache.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
 SOURCES += mpeg/mpegtables.cpp      mpeg/atsctables.cpp
@@ -219,7 +219,7 @@ SOURCES += mpeg/dvbdescriptors.cpp  mpeg/sctedescriptors.cpp
 SOURCES += mpeg/splicedescriptors.cpp
 SOURCES += mpeg/dishdescriptors.cpp mpeg/premieredescriptors.cpp
 SOURCES += mpeg/atsc_huffman.cpp
-SOURCES += mpeg/freesat_huffman.cpp
+SOURCES += mpeg/freesat_huffman.cpp mpeg/mpegtablecache.cpp
 SOURCES += mpeg/iso6937tables.cpp
 SOURCES += mpeg/H264Parser.cpp
 
@@ -294,6 +294,8 @@ HEADERS += HLS/httplivestream.h
 SOURCES += HLS/httplivestream.cpp
 HEADERS += HLS/httplivestreambuffer.h
 SOURCES += HLS/httplivestreambuffer.cpp
+HEADERS += HLS/hlsremuxer.h
+SOURCES += HLS/hlsremuxer.cpp
 using_libcrypto:DEFINES += USING_LIBCRYPTO
 using_libcrypto:LIBS    += -lcrypto
 
@@ -563,9 +565,11 @@ using_backend {
     HEADERS += recorders/recorderbase.h
     HEADERS += recorders/DeviceReadBuffer.h
     HEADERS += recorders/dtvrecorder.h
+    HEADERS += recorders/positionmapwriter.h
     SOURCES += recorders/recorderbase.cpp
     SOURCES += recorders/DeviceReadBuffer.cpp
     SOURCES += recorders/dtvrecorder.cpp
+    SOURCES += recorders/positionmapwriter.cpp
 
     # Import recorder
     HEADERS += recorders/importrecorder.h
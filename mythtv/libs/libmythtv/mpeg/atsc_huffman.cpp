@@ -1,4 +1,8 @@
 
+// Qt headers
+#include <QAtomicPointer>
+#include <QMutex>
+
 #include "atsc_huffman.h"
 
 /*------------------------------------------------------------------------
@@ -40,8 +44,8 @@ static inline bool huffman1_get_bit(const unsigned char *src, uint bit)
     return (src[(bit - (bit & 0x7)) >> 3] >> (7 - (bit & 0x7))) & 0x01;
 }
 
-QString atsc_huffman1_to_string(const unsigned char *compressed,
-                                uint size, uint table_index)
+QString atsc_huffman1_to_string_bitwise(const unsigned char *compressed,
+                                        uint size, uint table_index)
 {
     QString retval = "";
 
@@ -116,8 +120,8 @@ static inline void huffman2_set_pos(unsigned char &bitpos,
     bitpos  = 0x80 >> (pos & 0x7);
 }
 
-QString atsc_huffman2_to_string(const unsigned char *compressed,
-                                uint length, uint table)
+QString atsc_huffman2_to_string_bitwise(const unsigned char *compressed,
+                                        uint length, uint table)
 {
     QString decompressed = "";
 
@@ -652,6 +656,244 @@ unsigned char ATSC_C7[] =
     0x9B, 0x9B, 0x9B, 0x9B, 0x9B, 0x9B
 };
 
+/*------------------------------------------------------------------------
+ * Table driven decoders, giving the same results as the ones above from
+ * lookup tables generated from the Huffman tables the first time they are
+ * needed.
+ *------------------------------------------------------------------------*/
+
+#define HUFFMAN1_LOOKUP_BITS 8
+#define HUFFMAN1_LOOKUP_SIZE (1 << HUFFMAN1_LOOKUP_BITS)
+
+/* Where walking the tree of the previous character with the next 8 bits
+ * of input ends; a character if val & 0x80, else the node to carry on
+ * from a bit at a time. */
+struct huffman1_lookup {
+    unsigned char val;
+    unsigned char bits;
+};
+
+static huffman1_lookup *huffman1_build_lookup(const unsigned char *table)
+{
+    huffman1_lookup *lookup =
+        new huffman1_lookup[128 * HUFFMAN1_LOOKUP_SIZE];
+
+    for (uint ch = 0; ch < 128; ch++)
+    {
+        int root = huffman1_get_root(ch, table);
+        for (uint prefix = 0; prefix < HUFFMAN1_LOOKUP_SIZE; prefix++)
+        {
+            huffman1_lookup &entry = lookup[ch * HUFFMAN1_LOOKUP_SIZE + prefix];
+            int node = 0;
+            entry.bits = 0;
+            do
+            {
+                bool thebit =
+                    (prefix >> (HUFFMAN1_LOOKUP_BITS - 1 - entry.bits)) & 1;
+                entry.val = (thebit) ?
+                    table[root + (node*2) + 1] : table[root + (node*2)];
+                entry.bits++;
+                node = entry.val;
+            } while (!(entry.val & 0x80) &&
+                     entry.bits < HUFFMAN1_LOOKUP_BITS);
+        }
+    }
+
+    return lookup;
+}
+
+static const huffman1_lookup *huffman1_get_lookup(uint table_index)
+{
+    static QMutex                          lock;
+    static QAtomicPointer<huffman1_lookup> lookups[3];
+
+    huffman1_lookup *lookup = lookups[table_index].fetchAndAddAcquire(0);
+    if (lookup)
+        return lookup;
+
+    QMutexLocker locker(&lock);
+    lookup = lookups[table_index].fetchAndAddAcquire(0);
+    if (!lookup)
+    {
+        lookup = huffman1_build_lookup(atsc_tables[table_index]);
+        lookups[table_index].fetchAndStoreRelease(lookup);
+    }
+    return lookup;
+}
+
+/* Returns the 8 bits from bit number bit on from string src[] */
+static inline uint huffman1_get_byte(const unsigned char *src, uint bit)
+{
+    uint byte  = bit >> 3;
+    uint shift = bit & 0x7;
+    if (!shift)
+        return src[byte];
+    return ((src[byte] << shift) | (src[byte + 1] >> (8 - shift))) & 0xff;
+}
+
+QString atsc_huffman1_to_string(const unsigned char *compressed,
+                                uint size, uint table_index)
+{
+    QString retval = "";
+
+    const unsigned char   *table  = atsc_tables[table_index];
+    const huffman1_lookup *lookup = huffman1_get_lookup(table_index);
+    int totalbits = size * 8;
+    int bit = 0;
+    uint ch = 0;
+    int root = huffman1_get_root(ch, table);
+    int node = 0;
+    bool thebit;
+    unsigned char val;
+
+    while (bit < totalbits)
+    {
+        if (node == 0 && bit + HUFFMAN1_LOOKUP_BITS <= totalbits)
+        {
+            /* Usually a whole character at once */
+            const huffman1_lookup &entry = lookup[
+                ch * HUFFMAN1_LOOKUP_SIZE + huffman1_get_byte(compressed, bit)];
+            val  = entry.val;
+            bit += entry.bits - 1;
+        }
+        else
+        {
+            thebit = huffman1_get_bit(compressed, bit);
+            val = (thebit) ?
+                table[root + (node*2) + 1] : table[root + (node*2)];
+        }
+
+        if (val & 0x80)
+        {
+            /* Got a Null Character so return */
+            if ((val & 0x7F) == 0)
+            {
+                return retval;
+            }
+            /* Escape character so next character is uncompressed */
+            if ((val & 0x7F) == 27)
+            {
+                unsigned char val2 = 0;
+                for (int i = 0 ; i < 7 ; i++)
+                {
+                    val2 |=
+                        huffman1_get_bit(compressed, bit + i + 2) << (6 - i);
+                }
+                retval += QChar(val2);
+                bit += 8;
+                ch = val2;
+            }
+            /* Standard Character */
+            else
+            {
+                ch = val & 0x7F;
+                retval += QChar(ch);
+            }
+            root = huffman1_get_root(ch, table);
+            node = 0;
+        }
+        else
+            node = val;
+        bit++;
+    }
+    /* If you get here something went wrong so just return a blank string */
+    return QString("");
+}
+
+/* The character and code length of the bits which the bit at a time
+ * decoder finds a code for, or no bits when it would skip a bit. */
+struct huffman2_lookup {
+    unsigned char character;
+    unsigned char bits;
+};
+
+static huffman2_lookup *huffman2_build_lookup(
+    const struct huffman_table *ptrTable, const unsigned char *lookup,
+    uint min_size, uint max_size)
+{
+    uint width = max_size - 1;
+    huffman2_lookup *codes = new huffman2_lookup[1 << width];
+
+    for (uint prefix = 0; prefix < (1U << width); prefix++)
+    {
+        codes[prefix].character = 0;
+        codes[prefix].bits      = 0;
+        for (uint cur_size = min_size; cur_size < max_size; cur_size++)
+        {
+            uint key = lookup[prefix >> (width - cur_size)];
+            if (key && (ptrTable[key].number_of_bits == cur_size))
+            {
+                codes[prefix].character = ptrTable[key].character;
+                codes[prefix].bits      = cur_size;
+                break;
+            }
+        }
+    }
+
+    return codes;
+}
+
+static const huffman2_lookup *huffman2_get_lookup(uint table)
+{
+    static QMutex                          lock;
+    static QAtomicPointer<huffman2_lookup> lookups[2];
+
+    uint i = (table == 1) ? 0 : 1;
+    huffman2_lookup *codes = lookups[i].fetchAndAddAcquire(0);
+    if (codes)
+        return codes;
+
+    QMutexLocker locker(&lock);
+    codes = lookups[i].fetchAndAddAcquire(0);
+    if (!codes)
+    {
+        if (table == 1)
+            codes = huffman2_build_lookup(Table128, Huff2Lookup128, 3, 12);
+        else
+            codes = huffman2_build_lookup(Table255, Huff2Lookup256, 2, 14);
+        lookups[i].fetchAndStoreRelease(codes);
+    }
+    return codes;
+}
+
+/* Returns width bits from bit number pos on, zero past the end */
+static inline uint huffman2_get_bits(const unsigned char *buffer,
+                                     uint length, uint pos, uint width)
+{
+    uint byte  = pos >> 3;
+    uint value = 0;
+    for (uint i = 0; i < 3; i++)
+        value = (value << 8) | ((byte + i < length) ? buffer[byte + i] : 0);
+    return (value >> (24 - (pos & 0x7) - width)) & ((1 << width) - 1);
+}
+
+QString atsc_huffman2_to_string(const unsigned char *compressed,
+                                uint length, uint table)
+{
+    QString decompressed = "";
+
+    const huffman2_lookup *codes = huffman2_get_lookup(table);
+    uint width = (table == 1) ? 11 : 13;
+
+    uint total_bits  = length << 3;
+    uint current_bit = 0;
+
+    while (current_bit + 3 < total_bits)
+    {
+        const huffman2_lookup &code =
+            codes[huffman2_get_bits(compressed, length, current_bit, width)];
+        if (code.bits)
+        {
+            decompressed += code.character;
+            current_bit += code.bits;
+        }
+        else
+            current_bit++;
+    }
+
+    return decompressed;
+}
+
 struct huffman_table Table128[] =
 {
     { 0x0000, 0x20, 0x03, },  // ' ' duplicate entry makes 1st lookup non zero
@@ -13,5 +13,12 @@ QString atsc_huffman1_to_string(const unsigned char *compressed,
 QString atsc_huffman2_to_string(const unsigned char *compressed,
                                 uint length, uint table);
 
+// Decode one bit at a time, the reference the above are tested against
+QString atsc_huffman1_to_string_bitwise(const unsigned char *compressed,
+                                        uint size, uint table);
+
+QString atsc_huffman2_to_string_bitwise(const unsigned char *compressed,
+                                        uint length, uint table);
+
 
 #endif //_ATSC_HUFFMAN_H_
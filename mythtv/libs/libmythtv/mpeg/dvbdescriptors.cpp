@@ -2,8 +2,10 @@
 #include <unistd.h>
 
 // Qt headers
-#include <QTextCodec>
+#include <QVarLengthArray>
 #include <QCoreApplication>
+#include <QTextCodec>
+#include <QCache>
 
 // MythTV headers
 #include "dvbdescriptors.h"
@@ -13,11 +15,16 @@
 #include "programinfo.h"
 
 
+// How many decoded strings dvb_decode_text() keeps, by their raw bytes
+#define DVB_TEXT_CACHE_SIZE 4096
+
 static QString decode_iso6937(const unsigned char *buf, uint length)
 {
     // ISO/IEC 6937 to unicode (UCS2) convertor...
     // This is a composed encoding - accent first then plain character
-    QString result = "";
+    QString result(length, QChar(0));
+    QChar *out = result.data();
+    uint count = 0;
     ushort ch = 0x20;
     for (uint i = 0; (i < length) && buf[i]; i++)
     {
@@ -43,13 +50,88 @@ static QString decode_iso6937(const unsigned char *buf, uint length)
                 continue; // process second byte
 
         }
-        result += QChar(ch);
+        out[count++] = QChar(ch);
+    }
+    result.resize(count);
+    return result;
+}
+
+// Returns the unicode of each of the 256 characters of ISO 8859 part
+// 'part', or NULL if Qt has no codec for it. The tables are made with the
+// codecs the first time a part is used, so decoding is a plain lookup.
+static const ushort *iso8859_table(uint part)
+{
+    static const char *codec_names[16] =
+    {
+        "Latin1",
+        "ISO8859-1",  // Western
+        "ISO8859-2",  // Central European
+        "ISO8859-3",  // Central European
+        "ISO8859-4",  // Baltic
+        "ISO8859-5",  // Cyrillic
+        "ISO8859-6",  // Arabic
+        "ISO8859-7",  // Greek
+        "ISO8859-8",  // Hebrew, visually ordered
+        "ISO8859-9",  // Turkish
+        "ISO8859-10",
+        "ISO8859-11",
+        "ISO8859-12",
+        "ISO8859-13",
+        "ISO8859-14",
+        "ISO8859-15", // Western
+    };
+    static ushort            tables[16][256];
+    static QAtomicInt        made[16];
+    static QMutex            lock;
+
+    int state = made[part].fetchAndAddAcquire(0);
+    if (!state)
+    {
+        QMutexLocker locker(&lock);
+        state = made[part].fetchAndAddAcquire(0);
+        if (!state)
+        {
+            // Only some of the QTextCodec calls are reentrant.
+            // If you use this please verify that you are using a
+            // reentrant call.
+            const QTextCodec *codec =
+                QTextCodec::codecForName(codec_names[part]);
+            char all[256];
+            for (uint i = 0; i < 256; i++)
+                all[i] = (char) i;
+            QString chars;
+            if (codec)
+                chars = codec->toUnicode(all, 256);
+            // Every one of these is a one byte per character set
+            state = (chars.size() == 256) ? 1 : -1;
+            for (int i = 0; i < chars.size() && state > 0; i++)
+                tables[part][i] = chars[i].unicode();
+            made[part].fetchAndStoreRelease(state);
+        }
     }
+
+    return (state > 0) ? tables[part] : NULL;
+}
+
+static QString decode_iso8859(uint part, const unsigned char *buf,
+                              uint length)
+{
+    const ushort *table = iso8859_table(part);
+    if (!table)
+        return QString::fromLocal8Bit((char*)buf, length);
+
+    QString result(length, QChar(0));
+    QChar *out = result.data();
+    for (uint i = 0; i < length; i++)
+        out[i] = QChar(table[buf[i]]);
     return result;
 }
 
 static QString decode_text(const unsigned char *buf, uint length);
 
+static QMutex                      dvb_text_lock;
+static QCache<QByteArray, QString> dvb_text_cache(DVB_TEXT_CACHE_SIZE);
+
 // Decode a text string according to ETSI EN 300 468 Annex A
 QString dvb_decode_text(const unsigned char *src, uint raw_length,
                         const unsigned char *encoding_override,
@@ -58,11 +140,9 @@ QString dvb_decode_text(const unsigned char *src, uint raw_length,
     if (!raw_length)
         return "";
 
-    if (src[0] == 0x1f)
-        return freesat_huffman_to_string(src, raw_length);
-
+    // 0x1f is the Freesat Huffman coding
     if (((0x10 < src[0]) && (src[0] < 0x15)) ||
-        ((0x15 < src[0]) && (src[0] < 0x20)))
+        ((0x15 < src[0]) && (src[0] < 0x1f)))
     {
         // TODO: Handle multi-byte encodings
         LOG(VB_SIPARSER, LOG_ERR, 
@@ -72,58 +152,65 @@ QString dvb_decode_text(const unsigned char *src, uint raw_length,
 
     // if a override encoding is specified and the default ISO 6937 encoding
     // would be used copy the override encoding in front of the text
-    unsigned char *dst =
-        new unsigned char[raw_length + encoding_override_length];
-
-    uint length = 0;
-    if (encoding_override && src[0] >= 0x20) {
-        memcpy(dst, encoding_override, encoding_override_length);
-        length = encoding_override_length;
+    if (!encoding_override || src[0] < 0x20)
+        encoding_override_length = 0;
+
+    // The EIT carousel repeats the same titles and descriptions many
+    // times, look for the raw bytes and the override among those decoded
+    QVarLengthArray<unsigned char, 512> raw(1 + encoding_override_length +
+                                            raw_length);
+    raw[0] = encoding_override_length;
+    if (encoding_override_length)
+        memcpy(raw.data() + 1, encoding_override, encoding_override_length);
+    memcpy(raw.data() + 1 + encoding_override_length, src, raw_length);
+    QByteArray key = QByteArray::fromRawData((const char*)raw.constData(),
+                                             raw.size());
+    {
+        QMutexLocker locker(&dvb_text_lock);
+        const QString *cached = dvb_text_cache.object(key);
+        if (cached)
+            return *cached;
     }
 
-    // Strip formatting characters
-    for (uint i = 0; i < raw_length; i++)
+    QString sStr;
+    if (src[0] == 0x1f)
     {
-        if ((src[i] < 0x80) || (src[i] > 0x9F))
-            dst[length++] = src[i];
-        // replace CR/LF with a space
-        else if (src[i] == 0x8A)
-            dst[length++] = 0x20;
+        sStr = freesat_huffman_to_string(src, raw_length);
     }
+    else
+    {
+        QVarLengthArray<unsigned char, 512> dst(encoding_override_length +
+                                                raw_length);
+        uint length = 0;
+        if (encoding_override_length)
+        {
+            memcpy(dst.data(), encoding_override, encoding_override_length);
+            length = encoding_override_length;
+        }
 
-    // Exit on empty string, sans formatting.
+        // Strip formatting characters
+        for (uint i = 0; i < raw_length; i++)
+        {
+            if ((src[i] < 0x80) || (src[i] > 0x9F))
+                dst[length++] = src[i];
+            // replace CR/LF with a space
+            else if (src[i] == 0x8A)
+                dst[length++] = 0x20;
+        }
 
-    QString sStr = (!length) ? "" : decode_text(dst, length);
+        // Exit on empty string, sans formatting.
+        sStr = (!length) ? "" : decode_text(dst.constData(), length);
+    }
 
-    delete [] dst;
+    QMutexLocker locker(&dvb_text_lock);
+    dvb_text_cache.insert(QByteArray(key.constData(), key.size()),
+                          new QString(sStr));
 
     return sStr;
 }
 
 static QString decode_text(const unsigned char *buf, uint length)
 {
-    // Only some of the QTextCodec calls are reentrant.
-    // If you use this please verify that you are using a reentrant call.
-    static const QTextCodec *iso8859_codecs[16] =
-    {
-        QTextCodec::codecForName("Latin1"),
-        QTextCodec::codecForName("ISO8859-1"),  // Western
-        QTextCodec::codecForName("ISO8859-2"),  // Central European
-        QTextCodec::codecForName("ISO8859-3"),  // Central European
-        QTextCodec::codecForName("ISO8859-4"),  // Baltic
-        QTextCodec::codecForName("ISO8859-5"),  // Cyrillic
-        QTextCodec::codecForName("ISO8859-6"),  // Arabic
-        QTextCodec::codecForName("ISO8859-7"),  // Greek
-        QTextCodec::codecForName("ISO8859-8"),  // Hebrew, visually ordered
-        QTextCodec::codecForName("ISO8859-9"),  // Turkish
-        QTextCodec::codecForName("ISO8859-10"),
-        QTextCodec::codecForName("ISO8859-11"),
-        QTextCodec::codecForName("ISO8859-12"),
-        QTextCodec::codecForName("ISO8859-13"),
-        QTextCodec::codecForName("ISO8859-14"),
-        QTextCodec::codecForName("ISO8859-15"), // Western
-    };
-
     // Decode using the correct text codec
     if (buf[0] >= 0x20)
     {
@@ -131,7 +218,7 @@ static QString decode_text(const unsigned char *buf, uint length)
     }
     else if ((buf[0] >= 0x01) && (buf[0] <= 0x0B))
     {
-        return iso8859_codecs[4 + buf[0]]->toUnicode((char*)(buf + 1), length - 1);
+        return decode_iso8859(4 + buf[0], buf + 1, length - 1);
     }
     else if (buf[0] == 0x10)
     {
@@ -141,9 +228,12 @@ static QString decode_text(const unsigned char *buf, uint length)
         // coded using the character code table specified by
         // ISO Standard 8859, parts 1 to 9
 
+        if (length < 3)
+            return "";
+
         uint code = buf[1] << 8 | buf[2];
         if (code <= 15)
-            return iso8859_codecs[code]->toUnicode((char*)(buf + 3), length - 3);
+            return decode_iso8859(code, buf + 3, length - 3);
         else
             return QString::fromLocal8Bit((char*)(buf + 3), length - 3);
     }
@@ -35,9 +35,9 @@
 
 static QString coderate_inner(uint coderate);
 
-extern QString dvb_decode_text(const unsigned char *src, uint length,
-                               const unsigned char *encoding_override,
-                               uint encoding_override_length);
+MTV_PUBLIC QString dvb_decode_text(const unsigned char *src, uint length,
+                                   const unsigned char *encoding_override,
+                                   uint encoding_override_length);
 
 inline QString dvb_decode_text(const unsigned char *src, uint length)
 {
@@ -1,3 +1,11 @@
+// C++ headers
+#include <stdint.h>
+
+// Qt headers
+#include <QAtomicPointer>
+#include <QVector>
+#include <QMutex>
+
 #include "freesat_huffman.h"
 
 struct fsattab {
@@ -12,7 +20,210 @@ struct fsattab {
 
 #include "freesat_tables.h"
 
+/*------------------------------------------------------------------------
+ * The table driven decoder looks up the next FSAT_LOOKUP_BITS bits of the
+ * input for the current character and gets the next character and its
+ * code length in one step. The few codes longer than that are found by
+ * trying only the entries of fsat_table which share those leading bits.
+ *------------------------------------------------------------------------*/
+
+#define FSAT_LOOKUP_BITS 8
+#define FSAT_LOOKUP_SIZE (1 << FSAT_LOOKUP_BITS)
+#define FSAT_SEARCH      0xff   // fsatlookup::bits for codes we must search
+#define FSAT_SEARCH_END  0xffff // ends each list in fsatdecoder::search
+
+struct fsatlookup {
+    unsigned short search; // first entry of the search list, FSAT_SEARCH
+    unsigned char  next;
+    unsigned char  bits;
+};
+
+struct fsatdecoder {
+    const struct fsattab  *table;
+    fsatlookup             lookup[128 * FSAT_LOOKUP_SIZE];
+    QVector<unsigned short> search;
+};
+
+static inline unsigned fsat_mask(short bits)
+{
+    return bits ? 0xffffffff << (32 - bits) : 0;
+}
+
+static fsatdecoder *fsat_build_decoder(const struct fsattab *table,
+                                       const unsigned *index)
+{
+    fsatdecoder *decoder = new fsatdecoder;
+    decoder->table = table;
+    // The shared empty list, for bits that match no code at all
+    decoder->search.push_back(FSAT_SEARCH_END);
+
+    QVector<unsigned short> matches;
+    for (uint ch = 0; ch < 128; ch++)
+    {
+        for (uint prefix = 0; prefix < FSAT_LOOKUP_SIZE; prefix++)
+        {
+            // Collect the entries the bit at a time decoder would try, in
+            // its order, until one which matches whatever follows prefix
+            unsigned value = prefix << (32 - FSAT_LOOKUP_BITS);
+            bool short_code = false;
+            matches.clear();
+            for (unsigned j = index[ch]; j < index[ch+1]; j++)
+            {
+                unsigned mask = fsat_mask(table[j].bits);
+                if (table[j].bits <= FSAT_LOOKUP_BITS)
+                {
+                    if ((value & mask) == table[j].value)
+                    {
+                        short_code = matches.empty();
+                        matches.push_back(j);
+                        break;
+                    }
+                }
+                else if ((table[j].value & ~mask) == 0 &&
+                         (table[j].value >> (32 - FSAT_LOOKUP_BITS)) == prefix)
+                {
+                    matches.push_back(j);
+                }
+            }
+
+            fsatlookup &entry = decoder->lookup[ch * FSAT_LOOKUP_SIZE + prefix];
+            if (short_code)
+            {
+                entry.search = 0;
+                entry.next   = table[matches[0]].next;
+                entry.bits   = table[matches[0]].bits;
+                continue;
+            }
+
+            entry.search = 0;
+            entry.next   = STOP;
+            entry.bits   = FSAT_SEARCH;
+            if (matches.empty())
+                continue;
+            entry.search = decoder->search.size();
+            decoder->search += matches;
+            decoder->search.push_back(FSAT_SEARCH_END);
+        }
+    }
+    decoder->search.squeeze();
+
+    return decoder;
+}
+
+static const fsatdecoder *fsat_decoder(int table)
+{
+    static QMutex                      lock;
+    static QAtomicPointer<fsatdecoder> decoders[2];
+
+    fsatdecoder *decoder = decoders[table - 1].fetchAndAddAcquire(0);
+    if (decoder)
+        return decoder;
+
+    QMutexLocker locker(&lock);
+    decoder = decoders[table - 1].fetchAndAddAcquire(0);
+    if (!decoder)
+    {
+        if (table == 1)
+            decoder = fsat_build_decoder(fsat_table_1, fsat_index_1);
+        else
+            decoder = fsat_build_decoder(fsat_table_2, fsat_index_2);
+        decoders[table - 1].fetchAndStoreRelease(decoder);
+    }
+    return decoder;
+}
+
 QString freesat_huffman_to_string(const unsigned char *src, uint size)
+{
+    if (src[1] != 1 && src[1] != 2)
+        return QString("");
+
+    const fsatdecoder *decoder = fsat_decoder(src[1]);
+    QByteArray uncompressed(size * 3, '\0');
+    int p = 0;
+
+    // The next 64 bits from src[2] on, zero past the end of src
+    uint64_t bits  = 0;
+    int      avail = 0;
+    uint     byte  = 2;
+    // Stop where the bit at a time decoder stops, after the same number
+    // of bytes as it has preloaded
+    uint consumed = 0;
+    uint end = size + 4 - qMax(2u, qMin(6u, size));
+    char lastch = START;
+
+    do
+    {
+        while (avail <= 56)
+        {
+            if (byte < size)
+                bits |= (uint64_t)src[byte] << (56 - avail);
+            byte++;
+            avail += 8;
+        }
+        unsigned value = bits >> 32;
+
+        unsigned bitShift;
+        char nextCh;
+        if (lastch == ESCAPE)
+        {
+            // Encoded in the next 8 bits.
+            // Terminated by the first ASCII character.
+            nextCh = (value >> 24) & 0xff;
+            bitShift = 8;
+            if ((nextCh & 0x80) == 0)
+            {
+                if (nextCh < ' ')
+                    nextCh = STOP;
+                lastch = nextCh;
+            }
+        }
+        else
+        {
+            const fsatlookup &entry = decoder->lookup[
+                (unsigned)lastch * FSAT_LOOKUP_SIZE +
+                (value >> (32 - FSAT_LOOKUP_BITS))];
+            if (entry.bits != FSAT_SEARCH)
+            {
+                nextCh   = entry.next;
+                bitShift = entry.bits;
+            }
+            else
+            {
+                const unsigned short *j = &decoder->search[entry.search];
+                for (; *j != FSAT_SEARCH_END; j++)
+                {
+                    const struct fsattab &code = decoder->table[*j];
+                    if ((value & fsat_mask(code.bits)) == code.value)
+                        break;
+                }
+                if (*j == FSAT_SEARCH_END)
+                {
+                    // Entry missing in table.
+                    QString result = QString::fromUtf8(uncompressed, p);
+                    result.append("...");
+                    return result;
+                }
+                nextCh   = decoder->table[*j].next;
+                bitShift = decoder->table[*j].bits;
+            }
+            lastch = nextCh;
+        }
+
+        if (nextCh != STOP && nextCh != ESCAPE)
+        {
+            if (p >= uncompressed.count())
+                uncompressed.resize(p+10);
+            uncompressed[p++] = nextCh;
+        }
+        bits <<= bitShift;
+        avail -= bitShift;
+        consumed += bitShift;
+    } while (lastch != STOP && (consumed >> 3) < end);
+
+    return QString::fromUtf8(uncompressed, p);
+}
+
+QString freesat_huffman_to_string_bitwise(const unsigned char *src, uint size)
 {
     struct fsattab *fsat_table;
     unsigned int *fsat_index;
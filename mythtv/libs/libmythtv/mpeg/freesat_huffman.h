@@ -9,4 +9,8 @@
 
 QString freesat_huffman_to_string(const unsigned char *compressed, uint size);
 
+// Decodes one bit at a time, the reference the above is tested against
+QString freesat_huffman_to_string_bitwise(const unsigned char *compressed,
+                                          uint size);
+
 #endif // _FREESAT_HUFFMAN_H_
@@ -87,6 +87,8 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, int cardnum,
       _invalid_pat_seen(false), _invalid_pat_warning(false)
 {
     memset(_si_time_offsets, 0, sizeof(_si_time_offsets));
+    memset(_section_count, 0, sizeof(_section_count));
+    memset(_section_drops, 0, sizeof(_section_drops));
 
     AddListeningPID(MPEG_PAT_PID);
     AddListeningPID(MPEG_CAT_PID);
@@ -190,6 +192,9 @@ void MPEGStreamData::Reset(int desiredProgram)
         DeletePartialPSIP(it.key());
     _partial_psip_packet_cache.clear();
 
+    LogSectionStats();
+    _section_crcs.clear();
+
     _pids_listening.clear();
     _pids_notlistening.clear();
     _pids_writing.clear();
@@ -292,6 +297,23 @@ PSIPTable* MPEGStreamData::AssemblePSIP(const TSPacket* tspacket,
             return NULL;
         }
 
+        // Drop repeats of sections we've already seen without copying them
+        uint sectionEnd = partial->PSIOffset() + 1 + partial->SectionLength();
+        if (sectionEnd <= partial->TSSizeInBuffer() &&
+            IsRepeatedSection(tspacket, partial->pesdata()))
+        {
+            if (sectionEnd < partial->TSSizeInBuffer() &&
+                partial->pesdata()[partial->SectionLength()] != 0xff)
+            {
+                partial->SetPSIOffset(partial->PSIOffset() +
+                                      partial->SectionLength());
+                return AssemblePSIP(tspacket, moreTablePackets);
+            }
+            moreTablePackets = false;
+            DeletePartialPSIP(tspacket->PID());
+            return NULL;
+        }
+
         PSIPTable* psip = new PSIPTable(*partial);
 
         // Advance to the next packet
@@ -379,6 +401,22 @@ PSIPTable* MPEGStreamData::AssemblePSIP(const TSPacket* tspacket,
         return 0;
     }
 
+    // Drop repeats of sections we've already seen without copying them
+    const uint section_length = pes_length + 3;
+    if (IsRepeatedSection(tspacket, pesdata + 1))
+    {
+        if ((offset + section_length < TSPacket::kSize) &&
+            (pesdata[section_length + 1] != 0xff))
+        {
+            PSIPTable *pesp = new PSIPTable(*tspacket);
+            pesp->SetPSIOffset(offset + section_length);
+            SavePartialPSIP(tspacket->PID(), pesp);
+            return AssemblePSIP(tspacket, moreTablePackets);
+        }
+        moreTablePackets = false;
+        return NULL;
+    }
+
     PSIPTable *psip = new PSIPTable(*tspacket); // must be complete packet
 
     // There might be another section after this one in the
@@ -399,6 +437,142 @@ PSIPTable* MPEGStreamData::AssemblePSIP(const TSPacket* tspacket,
     return psip;
 }
 
+#define SECTION_KEY(pid, psip) \
+    (((uint64_t)(pid) << 32) | ((psip).TableID() << 24) | \
+     ((psip).TableIDExtension() << 8) | (psip).Section())
+#define SECTION_CRC(psip) (((uint64_t)(psip).Version() << 32) | (psip).CRC())
+#define MAX_SECTION_CRCS       65536
+#define SECTION_STATS_INTERVAL (5 * 60 * 1000)
+
+/** \fn MPEGStreamData::IsRepeatedSection(const TSPacket*,const unsigned char*)
+ *  \brief Returns true if a complete section is a repeat of one
+ *         HandleTSTables() has already validated and found redundant.
+ *
+ *   PAT, PMT, SDT and EIT sections are repeated many times for every
+ *   change, this lets AssemblePSIP() drop these repeats without copying
+ *   them into a PSIPTable. IsRedundant() is called on a view of the
+ *   section, so this makes the same version and section checks as
+ *   HandleTSTables(). The CRC must also match the one of the section
+ *   HandleTSTables() validated, anything else is left to it.
+ *
+ *  \param section The table_id byte of a section which is entirely
+ *                 within the buffer.
+ */
+bool MPEGStreamData::IsRepeatedSection(const TSPacket *tspacket,
+                                       const unsigned char *section)
+{
+    const uint table_id = section[0];
+    _section_count[table_id]++;
+
+    if (!_section_stats_timer.isRunning())
+        _section_stats_timer.start();
+    else if (_section_stats_timer.elapsed() > SECTION_STATS_INTERVAL)
+        LogSectionStats();
+
+    if (tspacket->Scrambled())
+        return false;
+
+    const PSIPTable psip(section, true);
+    if (!psip.HasCRC() || !psip.SectionSyntaxIndicator() ||
+        psip.SectionLength() < PSIPTable::PSIP_OFFSET + 4)
+        return false;
+
+    if (_have_CRC_bug &&
+        (TableID::PMT == table_id || TableID::PAT == table_id))
+        return false;
+
+    if (TableID::MGT <= table_id && table_id <= TableID::STT &&
+        !psip.IsCurrent())
+        return false;
+
+    if (!IsRedundant(tspacket->PID(), psip))
+        return false;
+
+    QHash<uint64_t, uint64_t>::const_iterator it =
+        _section_crcs.constFind(SECTION_KEY(tspacket->PID(), psip));
+    if (it == _section_crcs.constEnd() || *it != SECTION_CRC(psip))
+        return false;
+
+    // The CRC of a whole section, including its CRC_32, is zero
+    if (mpeg_crc32(section, psip.SectionLength()) != 0)
+        return false;
+
+    SendSingleProgramHeartbeat(tspacket->PID(), psip);
+    _section_drops[table_id]++;
+    return true;
+}
+
+/** \fn MPEGStreamData::RememberSection(uint, const PSIPTable&)
+ *  \brief Records the version and CRC of a section which passed all of
+ *         HandleTSTables()'s checks, for IsRepeatedSection().
+ */
+void MPEGStreamData::RememberSection(uint pid, const PSIPTable &psip)
+{
+    if (psip.SectionLength() < PSIPTable::PSIP_OFFSET + 4)
+        return;
+
+    if (_section_crcs.size() >= MAX_SECTION_CRCS)
+        _section_crcs.clear();
+
+    _section_crcs[SECTION_KEY(pid, psip)] = SECTION_CRC(psip);
+}
+
+/** \fn MPEGStreamData::SendSingleProgramHeartbeat(uint, const PSIPTable&)
+ *  \brief Tells the single program listeners a redundant PAT or desired
+ *         PMT was seen, without decoding it again.
+ */
+void MPEGStreamData::SendSingleProgramHeartbeat(uint pid,
+                                                const PSIPTable &psip)
+{
+    if (TableID::PAT == psip.TableID())
+    {
+        QMutexLocker locker(&_listener_lock);
+        ProgramAssociationTable *pat_sp = PATSingleProgram();
+        for (uint i = 0; i < _mpeg_sp_listeners.size(); i++)
+            _mpeg_sp_listeners[i]->HandleSingleProgramPAT(pat_sp, false);
+    }
+    if (TableID::PMT == psip.TableID() &&
+        pid == _pid_pmt_single_program)
+    {
+        QMutexLocker locker(&_listener_lock);
+        ProgramMapTable *pmt_sp = PMTSingleProgram();
+        for (uint i = 0; i < _mpeg_sp_listeners.size(); i++)
+            _mpeg_sp_listeners[i]->HandleSingleProgramPMT(pmt_sp, false);
+    }
+}
+
+/** \fn MPEGStreamData::LogSectionStats(void)
+ *  \brief Logs how many sections of each table IsRepeatedSection()
+ *         dropped since the last call, and starts counting again.
+ */
+void MPEGStreamData::LogSectionStats(void)
+{
+    QString msg;
+    for (uint i = 0; i < 256; i++)
+    {
+        if (!_section_count[i])
+            continue;
+        msg += QString(" 0x%1: %2/%3 (%4%)")
+            .arg(i,2,16,QChar('0'))
+            .arg(_section_drops[i]).arg(_section_count[i])
+            .arg(_section_drops[i] * 100 / _section_count[i]);
+    }
+    if (!msg.isEmpty())
+    {
+        LOG(VB_SIPARSER, LOG_INFO, LOC +
+            QString("Repeated sections dropped over %1 s, table_id: "
+                    "dropped/seen").arg(_section_stats_timer.elapsed() / 1000) +
+            msg);
+    }
+
+    memset(_section_count, 0, sizeof(_section_count));
+    memset(_section_drops, 0, sizeof(_section_drops));
+    _section_stats_timer.start();
+}
+
+#undef SECTION_KEY
+#undef SECTION_CRC
+
 bool MPEGStreamData::CreatePATSingleProgram(
     const ProgramAssociationTable& pat)
 {
@@ -968,25 +1142,14 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
         DONE_WITH_PSIP_PACKET();
     }
 
+    if (!buggy)
+        RememberSection(tspacket->PID(), *psip);
+
     // Don't decode redundant packets,
     // but if it is a desired PAT or PMT emit a "heartbeat" signal.
     if (IsRedundant(tspacket->PID(), *psip))
     {
-        if (TableID::PAT == psip->TableID())
-        {
-            QMutexLocker locker(&_listener_lock);
-            ProgramAssociationTable *pat_sp = PATSingleProgram();
-            for (uint i = 0; i < _mpeg_sp_listeners.size(); i++)
-                _mpeg_sp_listeners[i]->HandleSingleProgramPAT(pat_sp, false);
-        }
-        if (TableID::PMT == psip->TableID() &&
-            tspacket->PID() == _pid_pmt_single_program)
-        {
-            QMutexLocker locker(&_listener_lock);
-            ProgramMapTable *pmt_sp = PMTSingleProgram();
-            for (uint i = 0; i < _mpeg_sp_listeners.size(); i++)
-                _mpeg_sp_listeners[i]->HandleSingleProgramPMT(pmt_sp, false);
-        }
+        SendSingleProgramHeartbeat(tspacket->PID(), *psip);
         DONE_WITH_PSIP_PACKET(); // already parsed this table, toss it.
     }
 
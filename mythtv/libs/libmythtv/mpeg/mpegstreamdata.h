@@ -11,6 +11,7 @@
 using namespace std;
 
 // Qt
+#include <QHash>
 #include <QMap>
 
 #include "tspacket.h"
@@ -330,6 +331,11 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // Table processing -- for internal use
     PSIPTable* AssemblePSIP(const TSPacket* tspacket, bool& moreTablePackets);
     bool AssemblePSIP(PSIPTable& psip, TSPacket* tspacket);
+    bool IsRepeatedSection(const TSPacket *tspacket,
+                           const unsigned char *section);
+    void RememberSection(uint pid, const PSIPTable &psip);
+    void SendSingleProgramHeartbeat(uint pid, const PSIPTable &psip);
+    void LogSectionStats(void);
     void SavePartialPSIP(uint pid, PSIPTable* packet);
     PSIPTable* GetPartialPSIP(uint pid)
         { return _partial_psip_packet_cache[pid]; }
@@ -400,6 +406,12 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // PSIP construction
     pid_psip_map_t            _partial_psip_packet_cache;
 
+    // Sections validated by HandleTSTables(), for IsRepeatedSection()
+    QHash<uint64_t, uint64_t> _section_crcs;
+    uint                      _section_count[256];
+    uint                      _section_drops[256];
+    MythTimer                 _section_stats_timer;
+
     // Caching
     bool                             _cache_tables;
     mutable QMutex                   _cache_lock;
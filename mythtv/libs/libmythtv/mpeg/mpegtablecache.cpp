@@ -0,0 +1,123 @@
+// -*- Mode: c++ -*-
+
+// MythTV headers
+#include "mpegtablecache.h"
+#include "mpegstreamdata.h"
+#include "dvbstreamdata.h"
+#include "mpegtables.h"
+#include "dvbtables.h"
+#include "mythlogging.h"
+
+#define LOC QString("MPEGTableCache: ")
+
+QMutex                                             MPEGTableCache::s_lock;
+QHash<QString, QList<MPEGTableCache::CachedTable> > MPEGTableCache::s_tables;
+
+static QByteArray section_data(const PSIPTable &psip)
+{
+    return QByteArray((const char*)psip.pesdata(), psip.SectionLength());
+}
+
+/// \brief Returns the key of a channel's tables
+QString MPEGTableCache::Key(uint sourceid, const QString &channum, int program)
+{
+    return QString("%1:%2:%3").arg(sourceid).arg(channum).arg(program);
+}
+
+/** \brief Saves the PAT and PMT of the desired program, and the SDT of
+ *         its transport, from the tables cached by the stream data.
+ *
+ *  Nothing is saved until the live PAT and PMT have been processed,
+ *  so tables that came from Apply() aren't saved again.
+ */
+void MPEGTableCache::Save(const QString &key, const MPEGStreamData *sd)
+{
+    int program = sd ? sd->DesiredProgram() : -1;
+    if (program < 0 || sd->VersionPMT(program) < 0)
+        return;
+
+    QList<CachedTable> tables;
+    uint tsid = 0;
+
+    pat_vec_t pats = sd->GetCachedPATs();
+    for (uint i = 0; i < pats.size() && tables.isEmpty(); ++i)
+    {
+        uint pmt_pid = pats[i]->FindPID(program);
+        tsid = pats[i]->TransportStreamID();
+        if (!pmt_pid || sd->VersionPAT(tsid) < 0)
+            continue;
+
+        pmt_const_ptr_t pmt = sd->GetCachedPMT(program, 0);
+        if (pmt)
+        {
+            tables.push_back(
+                CachedTable(MPEG_PAT_PID, section_data(*pats[i])));
+            tables.push_back(CachedTable(pmt_pid, section_data(*pmt)));
+            sd->ReturnCachedTable(pmt);
+        }
+    }
+    sd->ReturnCachedPATTables(pats);
+
+    if (tables.isEmpty())
+        return;
+
+    const DVBStreamData *dsd = dynamic_cast<const DVBStreamData*>(sd);
+    if (dsd && dsd->VersionSDT(tsid) >= 0)
+    {
+        sdt_const_ptr_t sdt = dsd->GetCachedSDT(tsid, 0);
+        if (sdt)
+        {
+            tables.push_back(CachedTable(DVB_SDT_PID, section_data(*sdt)));
+            dsd->ReturnCachedTable(sdt);
+        }
+    }
+
+    QMutexLocker locker(&s_lock);
+    s_tables[key] = tables;
+}
+
+/** \brief Hands the cached tables of a channel to the stream data as if
+ *         they had just been received.
+ *
+ *  \return true if there were cached tables
+ */
+bool MPEGTableCache::Apply(const QString &key, MPEGStreamData *sd)
+{
+    QList<CachedTable> tables;
+    {
+        QMutexLocker locker(&s_lock);
+        tables = s_tables.value(key);
+    }
+
+    if (!sd || tables.isEmpty())
+        return false;
+
+    DVBStreamData *dsd = dynamic_cast<DVBStreamData*>(sd);
+
+    QList<CachedTable>::const_iterator it = tables.begin();
+    for (; it != tables.end(); ++it)
+    {
+        const PSIPTable psip((const unsigned char*)it->second.constData());
+        sd->HandleTables(it->first, psip);
+
+        // Process the live table again, even if it has the same version
+        if (psip.TableID() == TableID::PAT)
+            sd->SetVersionPAT(psip.TableIDExtension(), -1, 0);
+        else if (psip.TableID() == TableID::PMT)
+            sd->SetVersionPMT(psip.TableIDExtension(), -1, 0);
+        else if (dsd && psip.TableID() == TableID::SDT)
+            dsd->SetVersionSDT(psip.TableIDExtension(), -1, 0);
+    }
+
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Using %1 cached tables for %2").arg(tables.size()).arg(key));
+
+    return true;
+}
+
+/// \brief Forgets the tables of a channel, e.g. when they didn't work
+void MPEGTableCache::Remove(const QString &key)
+{
+    QMutexLocker locker(&s_lock);
+    s_tables.remove(key);
+}
@@ -0,0 +1,45 @@
+// -*- Mode: c++ -*-
+#ifndef MPEGTABLECACHE_H_
+#define MPEGTABLECACHE_H_
+
+// Qt
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
+#include <QList>
+
+#include "mythtvexp.h"
+
+class MPEGStreamData;
+
+/** \class MPEGTableCache
+ *  \brief Keeps the PAT, PMT and SDT last received for each channel, so
+ *         that after a channel change the recorder can start as soon as
+ *         the tuner has a lock, instead of waiting for the tables to be
+ *         sent again.
+ *
+ *  The tables are only kept in memory, shared by all tuners of the
+ *  backend.  Apply() replays them into the stream data and then forgets
+ *  their versions, so the live tables are always processed once more
+ *  when they arrive and replace the cached ones if anything changed.
+ */
+class MTV_PUBLIC MPEGTableCache
+{
+  public:
+    static QString Key(uint sourceid, const QString &channum, int program);
+
+    static void Save(const QString &key, const MPEGStreamData *sd);
+    static bool Apply(const QString &key, MPEGStreamData *sd);
+    static void Remove(const QString &key);
+
+  private:
+    /// PID and section of a table
+    typedef QPair<uint, QByteArray> CachedTable;
+
+    static QMutex                              s_lock;
+    static QHash<QString, QList<CachedTable> > s_tables;
+};
+
+#endif // MPEGTABLECACHE_H_
@@ -428,6 +428,19 @@ class MTV_PUBLIC PSIPTable : public PESPacket
         // fixup wrong assumption about length for sections without CRC
         _pesdataSize = SectionLength();
     }
+    /// Constructor for viewing a complete section without checking
+    /// its CRC, does not create it's own data
+    PSIPTable(const unsigned char *pesdata, bool)
+        : PESPacket()
+    {
+        _pesdata     = const_cast<unsigned char*>(pesdata);
+        _fullbuffer  = const_cast<unsigned char*>(pesdata);
+        _psiOffset   = 0;
+        _ccLast      = 255;
+        _allocSize   = 0;
+        _badPacket   = false;
+        _pesdataSize = SectionLength();
+    }
   public:
     PSIPTable(const PSIPTable& table) : PESPacket(table)
     {
@@ -8,13 +8,14 @@ extern "C" {
 #include "mythconfig.h"
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
-#include "libavutil/crc.h"
-#include "libavutil/bswap.h"
 }
 
 #include <vector>
 #include <map>
 
+#include <QAtomicPointer>
+#include <QMutex>
+
 using namespace std;
 
 // return true if complete or broken
@@ -146,8 +147,7 @@ uint PESPacket::CalcCRC(void) const
 {
     if (Length() < 1)
         return 0xffffffff;
-    return av_bswap32(av_crc(av_crc_get_table(AV_CRC_32_IEEE), (uint32_t) -1,
-                             _pesdata, Length() - 1));
+    return mpeg_crc32(_pesdata, Length() - 1);
 }
 
 bool PESPacket::VerifyCRC(void) const
@@ -208,6 +208,70 @@ float SequenceHeader::aspect(bool mpeg1) const
 
 
 
+/////////////////////////////////////////////////////////////////////////
+// CRC-32/MPEG-2, eight bytes at a time ("slicing-by-8").                //
+/////////////////////////////////////////////////////////////////////////
+
+typedef uint32_t crc32_tables_t[8][256];
+
+static const crc32_tables_t &mpeg_crc32_tables(void)
+{
+    static QMutex                         lock;
+    static QAtomicPointer<crc32_tables_t> tables;
+
+    crc32_tables_t *t = tables.fetchAndAddAcquire(0);
+    if (t)
+        return *t;
+
+    QMutexLocker locker(&lock);
+    t = tables.fetchAndAddAcquire(0);
+    if (!t)
+    {
+        t = new crc32_tables_t[1];
+        for (uint i = 0; i < 256; i++)
+        {
+            uint32_t crc = i << 24;
+            for (uint j = 0; j < 8; j++)
+                crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04C11DB7 : 0);
+            (*t)[0][i] = crc;
+        }
+        // (*t)[k][i] is the CRC of byte i followed by k zero bytes
+        for (uint k = 1; k < 8; k++)
+        {
+            for (uint i = 0; i < 256; i++)
+            {
+                uint32_t crc = (*t)[k-1][i];
+                (*t)[k][i] = (crc << 8) ^ (*t)[0][crc >> 24];
+            }
+        }
+        tables.fetchAndStoreRelease(t);
+    }
+    return *t;
+}
+
+/** \brief Returns the MPEG-2 CRC-32 of size bytes of data.
+ *
+ *  This is the CRC of ISO/IEC 13818-1 Annex A used by PSI sections, so the
+ *  CRC of a whole section including its CRC_32 field is zero.
+ */
+uint mpeg_crc32(const unsigned char *data, uint size)
+{
+    const crc32_tables_t &t = mpeg_crc32_tables();
+    uint32_t crc = 0xffffffff;
+
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        crc ^= (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+        crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xff] ^
+              t[5][(crc >>  8) & 0xff] ^ t[4][crc & 0xff] ^
+              t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+    }
+    for (; size; data++, size--)
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *data];
+
+    return crc;
+}
+
 /////////////////////////////////////////////////////////////////////////
 // Memory allocator to avoid malloc global lock and waste less memory. //
 /////////////////////////////////////////////////////////////////////////
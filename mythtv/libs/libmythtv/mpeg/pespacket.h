@@ -16,6 +16,7 @@ using namespace std;
 
 MTV_PUBLIC unsigned char *pes_alloc(uint size);
 MTV_PUBLIC void pes_free(unsigned char *ptr);
+MTV_PUBLIC uint mpeg_crc32(const unsigned char *data, uint size);
 
 /** \class PESPacket
  *  \brief Allows us to transform TS packets to PES packets, which
@@ -1150,6 +1150,9 @@ void MythPlayer::ReleaseNextVideoFrame(VideoFrame *buffer,
     if (videoOutput)
         videoOutput->ReleaseFrame(buffer);
 
+    if (player_ctx && player_ctx->zapTrace.IsActive())
+        player_ctx->zapTrace.Mark("first frame decoded", "file opened");
+
     detect_letter_box->Detect(buffer);
     if (allpaused)
         CheckAspectRatio(buffer);
@@ -1912,6 +1915,10 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
             return;
         }
 
+        if (player_ctx && player_ctx->zapTrace.IsActive())
+            player_ctx->zapTrace.Finish("first frame shown",
+                                        "first frame decoded");
+
         if (m_double_framerate)
         {
             //second stage of deinterlacer processing
@@ -1945,6 +1952,11 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
     {
         vsync_delay_clock = videosync->WaitForFrame(frameDelay);
         //currentaudiotime = AVSyncGetAudiotime();
+
+        // Without video output the frame counts as shown once it is due
+        if (player_ctx && player_ctx->zapTrace.IsActive())
+            player_ctx->zapTrace.Finish("first frame shown",
+                                        "first frame decoded");
     }
 
     if (output_jmeter && output_jmeter->RecordCycleTime())
@@ -2666,6 +2678,7 @@ void MythPlayer::JumpToProgram(void)
     if (!pginfo)
         return;
 
+    player_ctx->zapTrace.Mark("LiveTV chain switch");
     inJumpToProgramPause = true;
 
     bool newIsDummy = player_ctx->tvchain->GetCardType(newid) == "DUMMY";
@@ -2682,6 +2695,7 @@ void MythPlayer::JumpToProgram(void)
         OpenDummy();
         ResetPlaying();
         SetEof(kEofStateNone);
+        player_ctx->zapTrace.Cancel();
         delete pginfo;
         inJumpToProgramPause = false;
         return;
@@ -2716,11 +2730,14 @@ void MythPlayer::JumpToProgram(void)
         LOG(VB_GENERAL, LOG_ERR, player_ctx->tvchain->toString());
         SetEof(kEofStateImmediate);
         SetErrored(tr("Error opening jump program file buffer"));
+        player_ctx->zapTrace.Cancel();
         delete pginfo;
         inJumpToProgramPause = false;
         return;
     }
 
+    player_ctx->zapTrace.Mark("file opened", "LiveTV chain switch");
+
     bool wasDummy = isDummy;
     if (newtype || wasDummy)
     {
@@ -4297,6 +4314,9 @@ char *MythPlayer::GetScreenGrab(int secondsin, int &bufflen,
  *   This also tries to skip any commercial breaks for a more
  *   useful screen grab for previews.
  *
+ *   It may be called several times on the same player to grab more
+ *   than one frame, the file is only opened for the first grab.
+ *
  *   Warning: Don't use this on something you're playing!
  *
  *  \param frameNum  [in]  Frame number to capture
@@ -4319,34 +4339,39 @@ char *MythPlayer::GetScreenGrabAtFrame(uint64_t frameNum, bool absolute,
     memset(&orig,   0, sizeof(AVPicture));
     memset(&retbuf, 0, sizeof(AVPicture));
 
-    if (OpenFile(0) < 0)
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open file for preview.");
-        return NULL;
-    }
-
-    if ((video_dim.width() <= 0) || (video_dim.height() <= 0))
+    // When several previews are taken from the same file the decoder
+    // from the first grab is still running, so just seek it.
+    if (!decoderThread)
     {
-        LOG(VB_PLAYBACK, LOG_ERR, LOC +
-            QString("Video Resolution invalid %1x%2")
-                .arg(video_dim.width()).arg(video_dim.height()));
-
-        // This is probably an audio file, just return a grey frame.
-        vw = 640;
-        vh = 480;
-        ar = 4.0f / 3.0f;
+        if (OpenFile(0) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open file for preview.");
+            return NULL;
+        }
 
-        bufflen = vw * vh * 4;
-        outputbuf = new unsigned char[bufflen];
-        memset(outputbuf, 0x3f, bufflen * sizeof(unsigned char));
-        return (char*) outputbuf;
-    }
+        if ((video_dim.width() <= 0) || (video_dim.height() <= 0))
+        {
+            LOG(VB_PLAYBACK, LOG_ERR, LOC +
+                QString("Video Resolution invalid %1x%2")
+                    .arg(video_dim.width()).arg(video_dim.height()));
+
+            // This is probably an audio file, just return a grey frame.
+            vw = 640;
+            vh = 480;
+            ar = 4.0f / 3.0f;
+
+            bufflen = vw * vh * 4;
+            outputbuf = new unsigned char[bufflen];
+            memset(outputbuf, 0x3f, bufflen * sizeof(unsigned char));
+            return (char*) outputbuf;
+        }
 
-    if (!InitVideo())
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC +
-            "Unable to initialize video for screen grab.");
-        return NULL;
+        if (!InitVideo())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                "Unable to initialize video for screen grab.");
+            return NULL;
+        }
     }
 
     ClearAfterSeek();
@@ -4455,7 +4480,12 @@ void MythPlayer::SeekForScreenGrab(uint64_t &number, uint64_t frameNum,
     }
 
     DiscardVideoFrame(videoOutput->GetLastDecodedFrame());
-    DoJumpToFrame(number, kInaccuracyNone);
+
+    // A preview doesn't need to be frame exact, stopping on the nearest
+    // keyframe in the seek table saves decoding the rest of the GOP.
+    // Only an explicitly requested frame is worth the extra decoding.
+    DoJumpToFrame(number, (absolute || !hasFullPositionMap) ?
+                  kInaccuracyNone : kInaccuracyFull);
 }
 
 /** \fn MythPlayer::GetRawVideoFrame(long long)
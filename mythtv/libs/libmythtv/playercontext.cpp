@@ -43,7 +43,8 @@ PlayerContext::PlayerContext(const QString &inUseID) :
     stateLock(QMutex::Recursive),
     // pip
     pipState(kPIPOff), pipRect(0,0,0,0), parentWidget(NULL), pipLocation(0),
-    useNullVideo(false)
+    useNullVideo(false),
+    zapTrace("Frontend")
 {
     lastSignalMsgTime.start();
     lastSignalMsgTime.addMSecs(-2 * (int)kSMExitTimeout);
@@ -16,6 +16,7 @@ using namespace std;
 // MythTV headers
 #include "videoouttypes.h"
 #include "mythtimer.h"
+#include "zaptrace.h"
 #include "mythtvexp.h"
 #include "mythdeque.h"
 #include "mythdate.h"
@@ -209,6 +210,9 @@ class MTV_PUBLIC PlayerContext
     /// True iff software scaled PIP should be used
     bool                useNullVideo;
 
+    /// Times channel changes from TV to the first frame shown
+    ZapTrace            zapTrace;
+
     /// Timeout after last Signal Monitor message for ignoring OSD when exiting.
     static const uint kSMExitTimeout;
     static const uint kMaxChannelHistory;
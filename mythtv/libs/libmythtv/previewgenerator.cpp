@@ -12,6 +12,7 @@
 #include <QTemporaryFile>
 #include <QFileInfo>
 #include <QMetaType>
+#include <QVector>
 #include <QImage>
 #include <QDir>
 #include <QUrl>
@@ -111,6 +112,39 @@ void PreviewGenerator::AttachSignals(QObject *obj)
     m_listener = obj;
 }
 
+/** \brief Takes over the preview another generator was asked for, so that
+ *         both are taken while the recording is only opened once.
+ *
+ *   The other generator is not needed after this, the result of its
+ *   preview is reported by this generator using the other's token.
+ *
+ *  \return false if this generator can't take the other's preview.
+ */
+bool PreviewGenerator::AddCapture(const PreviewGenerator &other)
+{
+    if (other.m_pathname != m_pathname || other.m_mode != m_mode ||
+        m_token.isEmpty() || other.m_token.isEmpty() ||
+        !other.m_captures.isEmpty())
+    {
+        return false;
+    }
+
+    // Only mythpreviewgen can take more than one preview per run
+    if (!(m_mode & kLocal) || !IsLocal())
+        return false;
+
+    PreviewCapture capture;
+    capture.captureTime   = other.m_captureTime;
+    capture.timeInSeconds = other.m_timeInSeconds;
+    capture.outFileName   = other.m_outFileName;
+    capture.outFormat     = other.m_outFormat;
+    capture.outSize       = other.m_outSize;
+    capture.token         = other.m_token;
+    m_captures.push_back(capture);
+
+    return true;
+}
+
 /** \fn PreviewGenerator::RunReal(void)
  *  \brief This call creates a preview without starting a new thread.
  */
@@ -169,28 +203,9 @@ bool PreviewGenerator::RunReal(void)
     }
 
     QMutexLocker locker(&m_previewLock);
-    if (m_listener)
-    {
-        QString output_fn = m_outFileName.isEmpty() ?
-            (m_programInfo.GetPathname()+".png") : m_outFileName;
-
-        QDateTime dt;
-        if (ok)
-        {
-            QFileInfo fi(output_fn);
-            if (fi.exists())
-                dt = fi.lastModified();
-        }
-
-        QString message = (ok) ? "PREVIEW_SUCCESS" : "PREVIEW_FAILED";
-        QStringList list;
-        list.push_back(m_programInfo.MakeUniqueKey());
-        list.push_back(output_fn);
-        list.push_back(msg);
-        list.push_back(dt.isValid()?dt.toUTC().toString(Qt::ISODate):"");
-        list.push_back(m_token);
-        QCoreApplication::postEvent(m_listener, new MythEvent(message, list));
-    }
+    SendResult(ok, m_token, m_outFileName, msg);
+    for (int i = 0; i < m_captures.size(); ++i)
+        SendResult(ok, m_captures[i].token, m_captures[i].outFileName, msg);
 
     return ok;
 }
@@ -201,6 +216,7 @@ bool PreviewGenerator::Run(void)
     QDateTime dtm = MythDate::current();
     QTime tm = QTime::currentTime();
     bool ok = false;
+    QVector<bool> captureOk(m_captures.size(), false);
     QString command = GetAppBinDir() + "mythpreviewgen";
     bool local_ok = ((IsLocal() || !!(m_mode & kForceLocal)) &&
                      (!!(m_mode & kLocal)) &&
@@ -249,7 +265,10 @@ bool PreviewGenerator::Run(void)
         if (!m_outFileName.isEmpty())
             cmdargs << "--outfile" << m_outFileName;
 
-        // Timeout in 30s
+        for (int i = 0; i < m_captures.size(); ++i)
+            cmdargs << "--capture" << m_captures[i].ToString();
+
+        // Timeout in 30s, plus a little for each extra preview
         MythSystemLegacy *ms = new MythSystemLegacy(command, cmdargs,
                                         kMSDontBlockInputDevs |
                                         kMSDontDisableDrawing |
@@ -259,7 +278,7 @@ bool PreviewGenerator::Run(void)
         ms->SetNice(10);
         ms->SetIOPrio(7);
 
-        ms->Run(30);
+        ms->Run(30 + 5 * m_captures.size());
         uint ret = ms->Wait();
         delete ms;
 
@@ -272,16 +291,7 @@ bool PreviewGenerator::Run(void)
         else
         {
             LOG(VB_PLAYBACK, LOG_INFO, LOC + "Preview process returned 0.");
-            QString outname = (!m_outFileName.isEmpty()) ?
-                m_outFileName : (m_pathname + ".png");
-
-            QString lpath = QFileInfo(outname).fileName();
-            if (lpath == outname)
-            {
-                StorageGroup sgroup;
-                QString tmpFile = sgroup.FindFile(lpath);
-                outname = (tmpFile.isEmpty()) ? outname : tmpFile;
-            }
+            QString outname = GetOutputPath(m_outFileName);
 
             QFileInfo fi(outname);
             ok = (fi.exists() && fi.isReadable() && fi.size());
@@ -306,15 +316,44 @@ bool PreviewGenerator::Run(void)
                 msg = QString("Failed to read preview image despite "
                               "preview process returning success.");
             }
+
+            for (int i = 0; i < m_captures.size(); ++i)
+            {
+                QFileInfo cfi(GetOutputPath(m_captures[i].outFileName));
+                captureOk[i] = (cfi.exists() && cfi.isReadable() &&
+                                cfi.size());
+            }
         }
     }
 
+    // All the results are posted at once, the first one handled by the
+    // queue may already delete this generator which detaches the listener.
     QMutexLocker locker(&m_previewLock);
 
-    // Backdate file to start of preview time in case a bookmark was made
-    // while we were generating the preview.
-    QString output_fn = m_outFileName.isEmpty() ?
-        (m_programInfo.GetPathname()+".png") : m_outFileName;
+    SendResult(ok, m_token, m_outFileName, msg);
+    for (int i = 0; i < m_captures.size(); ++i)
+    {
+        SendResult(captureOk[i], m_captures[i].token,
+                   m_captures[i].outFileName,
+                   captureOk[i] ? msg : QString("Preview process not ok."));
+    }
+
+    return ok;
+}
+
+/** \brief Tells the listener how one of the previews went.
+ *
+ *   m_previewLock must be held by the caller.
+ */
+void PreviewGenerator::SendResult(bool ok, const QString &token,
+                                  const QString &outFileName,
+                                  const QString &msg)
+{
+    if (!m_listener)
+        return;
+
+    QString output_fn = outFileName.isEmpty() ?
+        (m_programInfo.GetPathname()+".png") : outFileName;
 
     QDateTime dt;
     if (ok)
@@ -325,18 +364,30 @@ bool PreviewGenerator::Run(void)
     }
 
     QString message = (ok) ? "PREVIEW_SUCCESS" : "PREVIEW_FAILED";
-    if (m_listener)
+    QStringList list;
+    list.push_back(m_programInfo.MakeUniqueKey());
+    list.push_back(output_fn);
+    list.push_back(msg);
+    list.push_back(dt.isValid()?dt.toUTC().toString(Qt::ISODate):"");
+    list.push_back(token);
+    QCoreApplication::postEvent(m_listener, new MythEvent(message, list));
+}
+
+/// \brief Returns where mythpreviewgen will have saved a preview.
+QString PreviewGenerator::GetOutputPath(const QString &outFileName) const
+{
+    QString outname = (!outFileName.isEmpty()) ?
+        outFileName : (m_pathname + ".png");
+
+    QString lpath = QFileInfo(outname).fileName();
+    if (lpath == outname)
     {
-        QStringList list;
-        list.push_back(m_programInfo.MakeUniqueKey());
-        list.push_back(output_fn);
-        list.push_back(msg);
-        list.push_back(dt.isValid()?dt.toUTC().toString(Qt::ISODate):"");
-        list.push_back(m_token);
-        QCoreApplication::postEvent(m_listener, new MythEvent(message, list));
+        StorageGroup sgroup;
+        QString tmpFile = sgroup.FindFile(lpath);
+        outname = (tmpFile.isEmpty()) ? outname : tmpFile;
     }
 
-    return ok;
+    return outname;
 }
 
 void PreviewGenerator::run(void)
@@ -614,9 +665,45 @@ bool PreviewGenerator::LocalPreviewRun(void)
 {
     m_programInfo.MarkAsInUse(true, kPreviewGeneratorInUseID);
 
+    PreviewCapture first;
+    first.captureTime   = m_captureTime;
+    first.timeInSeconds = m_timeInSeconds;
+    first.outFileName   = m_outFileName;
+    first.outFormat     = m_outFormat;
+    first.outSize       = m_outSize;
+    first.token         = m_token;
+
+    QList<PreviewCapture> captures = m_captures;
+    captures.push_front(first);
+
+    // The live end of a LiveTV recording may only be in the backend's
+    // RAM, the file on disk is then read through the backend.  Previews
+    // are still named after, and saved next to, the file.
+    QString readname = m_pathname;
+    if (m_programInfo.IsLiveTVRAMBuffered())
+        readname = m_programInfo.GetPlaybackURL(false, false);
+
+    // All the previews are taken with the same player, so the recording
+    // is only opened and probed once however many of them there are.
+    PlayerContext *ctx = OpenPlayer(m_programInfo, readname);
+
+    bool ok = (ctx != NULL);
+    for (int i = 0; ctx && i < captures.size(); ++i)
+        ok = LocalCapture(ctx, captures[i]) && ok;
+
+    delete ctx;
+
+    m_programInfo.MarkAsInUse(false, kPreviewGeneratorInUseID);
+
+    return ok;
+}
+
+/// \brief Takes and saves one preview using an already open player.
+bool PreviewGenerator::LocalCapture(PlayerContext *ctx, PreviewCapture capture)
+{
     float aspect = 0;
     int   width, height, sz;
-    long long captime = m_captureTime;
+    long long captime = capture.captureTime;
 
     QDateTime dt = MythDate::current();
 
@@ -628,7 +715,7 @@ bool PreviewGenerator::LocalPreviewRun(void)
         captime = m_programInfo.QueryBookmark();
         if (captime > 0)
         {
-            m_timeInSeconds = false;
+            capture.timeInSeconds = false;
             LOG(VB_GENERAL, LOG_INFO,
                 QString("Preview from bookmark (frame %1)").arg(captime));
         }
@@ -638,7 +725,7 @@ bool PreviewGenerator::LocalPreviewRun(void)
 
     if (captime <= 0)
     {
-        m_timeInSeconds = true;
+        capture.timeInSeconds = true;
         int startEarly = 0;
         int programDuration = 0;
         int preroll =  gCoreContext->GetNumSetting("RecordPreRoll", 0);
@@ -671,16 +758,17 @@ bool PreviewGenerator::LocalPreviewRun(void)
 
     width = height = sz = 0;
     unsigned char *data = (unsigned char*)
-        GetScreenGrab(m_programInfo, m_pathname,
-                      captime, m_timeInSeconds,
+        GetScreenGrab(ctx, m_pathname,
+                      captime, capture.timeInSeconds,
                       sz, width, height, aspect);
 
-    QString outname = CreateAccessibleFilename(m_pathname, m_outFileName);
+    QString outname = CreateAccessibleFilename(m_pathname,
+                                               capture.outFileName);
 
-    QString format = (m_outFormat.isEmpty()) ? "PNG" : m_outFormat;
+    QString format = (capture.outFormat.isEmpty()) ? "PNG" : capture.outFormat;
 
-    int dw = (m_outSize.width()  < 0) ? width  : m_outSize.width();
-    int dh = (m_outSize.height() < 0) ? height : m_outSize.height();
+    int dw = (capture.outSize.width()  < 0) ? width  : capture.outSize.width();
+    int dh = (capture.outSize.height() < 0) ? height : capture.outSize.height();
 
     bool ok = SavePreview(outname, data, width, height, aspect, dw, dh,
                           format);
@@ -696,8 +784,6 @@ bool PreviewGenerator::LocalPreviewRun(void)
 
     delete[] data;
 
-    m_programInfo.MarkAsInUse(false, kPreviewGeneratorInUseID);
-
     return ok;
 }
 
@@ -756,36 +842,16 @@ bool PreviewGenerator::IsLocal(void) const
 }
 
 /**
- *  \brief Returns a PIX_FMT_RGBA32 buffer containg a frame from the video.
+ *  \brief Opens a player for taking previews of a recording.
  *
  *  \param pginfo       Recording to grab from.
  *  \param filename     File containing recording.
- *  \param seektime     Seconds or frames into the video to seek before
- *                      capturing a frame.
- *  \param time_in_secs if true time is in seconds, otherwise it is in frames.
- *  \param bufferlen    Returns size of buffer returned (in bytes).
- *  \param video_width  Returns width of frame grabbed.
- *  \param video_height Returns height of frame grabbed.
- *  \param video_aspect Returns aspect ratio of frame grabbed.
- *  \return Buffer allocated with new containing frame in RGBA32 format if
- *          successful, NULL otherwise.
+ *  \return PlayerContext that must be deleted by the caller, or NULL if
+ *          the recording can not be opened.
  */
-char *PreviewGenerator::GetScreenGrab(
-    const ProgramInfo &pginfo, const QString &filename,
-    long long seektime, bool time_in_secs,
-    int &bufferlen,
-    int &video_width, int &video_height, float &video_aspect)
+PlayerContext *PreviewGenerator::OpenPlayer(
+    const ProgramInfo &pginfo, const QString &filename)
 {
-    (void) pginfo;
-    (void) filename;
-    (void) seektime;
-    (void) time_in_secs;
-    (void) bufferlen;
-    (void) video_width;
-    (void) video_height;
-    char *retbuf = NULL;
-    bufferlen = 0;
-
     if (!MSqlQuery::testDBConnection())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Previewer could not connect to DB.");
@@ -821,6 +887,33 @@ char *PreviewGenerator::GetScreenGrab(
     ctx->SetPlayer(new MythPlayer((PlayerFlags)(kAudioMuted | kVideoIsNull | kNoITV)));
     ctx->player->SetPlayerInfo(NULL, NULL, ctx);
 
+    return ctx;
+}
+
+/**
+ *  \brief Returns a PIX_FMT_RGBA32 buffer containg a frame from the video.
+ *
+ *  \param ctx          Player opened with OpenPlayer().
+ *  \param filename     File containing recording, for logging.
+ *  \param seektime     Seconds or frames into the video to seek before
+ *                      capturing a frame.
+ *  \param time_in_secs if true time is in seconds, otherwise it is in frames.
+ *  \param bufferlen    Returns size of buffer returned (in bytes).
+ *  \param video_width  Returns width of frame grabbed.
+ *  \param video_height Returns height of frame grabbed.
+ *  \param video_aspect Returns aspect ratio of frame grabbed.
+ *  \return Buffer allocated with new containing frame in RGBA32 format if
+ *          successful, NULL otherwise.
+ */
+char *PreviewGenerator::GetScreenGrab(
+    PlayerContext *ctx, const QString &filename,
+    long long seektime, bool time_in_secs,
+    int &bufferlen,
+    int &video_width, int &video_height, float &video_aspect)
+{
+    char *retbuf = NULL;
+    bufferlen = 0;
+
     if (time_in_secs)
         retbuf = ctx->player->GetScreenGrab(seektime, bufferlen,
                                     video_width, video_height, video_aspect);
@@ -829,8 +922,6 @@ char *PreviewGenerator::GetScreenGrab(
             seektime, true, bufferlen,
             video_width, video_height, video_aspect);
 
-    delete ctx;
-
     if (retbuf)
     {
         LOG(VB_GENERAL, LOG_INFO, LOC +
@@ -842,4 +933,31 @@ char *PreviewGenerator::GetScreenGrab(
     return retbuf;
 }
 
+/// \brief Returns the capture in the form mythpreviewgen's --capture takes.
+QString PreviewCapture::ToString(void) const
+{
+    return QString("%1%2:%3x%4:%5")
+        .arg(captureTime).arg(timeInSeconds ? "s" : "f")
+        .arg(outSize.width()).arg(outSize.height())
+        .arg(outFileName);
+}
+
+PreviewCapture PreviewCapture::FromString(const QString &str)
+{
+    PreviewCapture capture;
+
+    QString time = str.section(':', 0, 0);
+    QString size = str.section(':', 1, 1);
+
+    capture.timeInSeconds = !time.endsWith("f");
+    time.chop(1);
+    capture.captureTime   = time.toLongLong();
+    capture.outSize       = QSize(size.section('x', 0, 0).toInt(),
+                                  size.section('x', 1, 1).toInt());
+    capture.outFileName   = str.section(':', 2);
+    capture.outFormat     = QFileInfo(capture.outFileName).suffix().toUpper();
+
+    return capture;
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -7,6 +7,7 @@
 #include <QString>
 #include <QMutex>
 #include <QSize>
+#include <QList>
 #include <QMap>
 #include <QSet>
 
@@ -16,6 +17,7 @@
 #include "mythdate.h"
 
 class PreviewGenerator;
+class PlayerContext;
 class QByteArray;
 class MythSocket;
 class QObject;
@@ -23,6 +25,23 @@ class QEvent;
 
 typedef QMap<QString,QDateTime> FileTimeStampMap;
 
+/// \brief One more preview to take while the recording is open.
+class MTV_PUBLIC PreviewCapture
+{
+  public:
+    PreviewCapture() : captureTime(-1), timeInSeconds(true), outSize(0,0) {}
+
+    QString ToString(void) const;
+    static PreviewCapture FromString(const QString &str);
+
+    long long captureTime;    ///< Seconds or frames, -1 for the default
+    bool      timeInSeconds;
+    QString   outFileName;
+    QString   outFormat;      ///< Image format, PNG if empty
+    QSize     outSize;
+    QString   token;
+};
+
 class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
 {
     friend int preview_helper(uint           chanid,
@@ -31,7 +50,8 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                               long long      previewSeconds,
                               const QSize   &previewSize,
                               const QString &infile,
-                              const QString &outfile);
+                              const QString &outfile,
+                              const QStringList &captures);
 
     Q_OBJECT
 
@@ -62,6 +82,8 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
 
     QString GetToken(void) const { return m_token; }
 
+    bool AddCapture(const PreviewGenerator &other);
+
     void run(void); // MThread
     bool Run(void);
 
@@ -80,7 +102,14 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
 
     bool RunReal(void);
 
-    static char *GetScreenGrab(const ProgramInfo &pginfo,
+    bool LocalCapture(PlayerContext *ctx, PreviewCapture capture);
+    QString GetOutputPath(const QString &outFileName) const;
+    void SendResult(bool ok, const QString &token,
+                    const QString &outFileName, const QString &msg);
+
+    static PlayerContext *OpenPlayer(const ProgramInfo &pginfo,
+                                     const QString     &filename);
+    static char *GetScreenGrab(PlayerContext     *ctx,
                                const QString     &filename,
                                long long          seektime,
                                bool               time_in_secs,
@@ -120,6 +149,8 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
     QString            m_outFormat;
 
     QString            m_token;
+    /// previews of other requests taken while the recording is open
+    QList<PreviewCapture> m_captures;
     bool               m_gotReply;
     bool               m_pixmapOk;
 };
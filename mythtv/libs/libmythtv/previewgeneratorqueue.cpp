@@ -1,3 +1,5 @@
+#include <cstdlib> // for getloadavg
+
 #include <QCoreApplication>
 #include <QFileInfo>
 
@@ -9,9 +11,15 @@
 #include "remoteutil.h"
 #include "mythdirs.h"
 #include "mthread.h"
+#include "compat.h"
 
 #define LOC QString("PreviewQueue: ")
 
+/// Most previews of one recording taken by a single generator
+static const int    kMaxBatchSize     = 16;
+/// Weight of the newest preview in the average latency
+static const double kLatencyEWMAAlpha = 0.1;
+
 PreviewGeneratorQueue *PreviewGeneratorQueue::s_pgq = NULL;
 
 void PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
@@ -35,7 +43,8 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
     MThread("PreviewGeneratorQueue"),
     m_mode(mode),
     m_running(0), m_maxThreads(2),
-    m_maxAttempts(maxAttempts), m_minBlockSeconds(minBlockSeconds)
+    m_maxAttempts(maxAttempts), m_minBlockSeconds(minBlockSeconds),
+    m_done(0), m_avgLatency(0.0), m_maxLatency(0)
 {
     if (PreviewGenerator::kLocal & mode)
     {
@@ -108,6 +117,33 @@ void PreviewGeneratorQueue::RemoveListener(QObject *listener)
     s_pgq->m_listeners.remove(listener);
 }
 
+/** \brief Reports how busy the preview generators are.
+ *  \param queued          Generators waiting for a free thread
+ *  \param running         Generators currently running
+ *  \param done            Previews finished, successfully or not
+ *  \param avg_latency_ms  Recent average time from request to result
+ *  \param max_latency_ms  Longest time from request to result
+ *  \return false if there is no queue
+ */
+bool PreviewGeneratorQueue::GetStats(uint &queued, uint &running, uint &done,
+                                     uint &avg_latency_ms,
+                                     uint &max_latency_ms)
+{
+    queued = running = done = avg_latency_ms = max_latency_ms = 0;
+
+    if (!s_pgq)
+        return false;
+
+    QMutexLocker locker(&s_pgq->m_lock);
+    queued         = s_pgq->m_queue.size();
+    running        = s_pgq->m_running;
+    done           = s_pgq->m_done;
+    avg_latency_ms = (uint) s_pgq->m_avgLatency;
+    max_latency_ms = s_pgq->m_maxLatency;
+
+    return true;
+}
+
 bool PreviewGeneratorQueue::event(QEvent *e)
 {
     if (e->type() != (QEvent::Type) MythEvent::MythEventMessage)
@@ -169,10 +205,24 @@ bool PreviewGeneratorQueue::event(QEvent *e)
                 return true;
             }
 
-            if ((*it).gen)
-                (*it).gen->deleteLater();
+            if ((*it).requested.isRunning())
+                UpdateLatency((*it).requested.elapsed());
+            (*it).requested.stop();
+
+            // A generator may be taking the previews of several keys,
+            // it is only done once all of them have been reported.
+            PreviewGenerator *gen = (*it).gen;
             (*it).gen           = NULL;
             (*it).genStarted    = false;
+
+            bool last = true;
+            PreviewMap::const_iterator git = m_previewMap.begin();
+            for (; gen && git != m_previewMap.end() && last; ++git)
+                last = ((*git).gen != gen);
+
+            if (gen && last)
+                gen->deleteLater();
+
             if (me->Message() == "PREVIEW_SUCCESS")
             {
                 (*it).attempts      = 0;
@@ -212,7 +262,8 @@ bool PreviewGeneratorQueue::event(QEvent *e)
                 (*it).tokens.clear();
             }
 
-            m_running = (m_running > 0) ? m_running - 1 : 0;
+            if (last)
+                m_running = (m_running > 0) ? m_running - 1 : 0;
         }
 
         UpdatePreviewGeneratorThreads();
@@ -447,10 +498,28 @@ void PreviewGeneratorQueue::IncPreviewGeneratorPriority(
     }
 }
 
+/// \brief Returns true if there is already more to run than there are CPUs.
+static bool system_busy(void)
+{
+    double load;
+    if (getloadavg(&load, 1) != 1)
+        return false;
+
+    int cpus = QThread::idealThreadCount();
+    return load >= ((cpus >= 1) ? cpus : 1);
+}
+
 void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
 {
     QMutexLocker locker(&m_lock);
     QStringList &q = m_queue;
+
+    // Previews are not urgent, so only start more generators while the
+    // machine has idle CPU. The next one is started when a running one
+    // finishes, so the queue keeps moving even on a busy machine.
+    if (m_running && system_busy())
+        return;
+
     if (!q.empty() && (m_running < m_maxThreads))
     {
         QString fn = q.back();
@@ -458,6 +527,7 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
         PreviewMap::iterator it = m_previewMap.find(fn);
         if (it != m_previewMap.end() && (*it).gen && !(*it).genStarted)
         {
+            BatchPreviewGenerator((*it).gen);
             m_running++;
             (*it).gen->start();
             (*it).genStarted = true;
@@ -465,6 +535,50 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
     }
 }
 
+/** \brief Hands the other queued previews of the same recording to the
+ *         generator about to be started, so they are all taken while the
+ *         recording is open.
+ *
+ *   m_lock must be held by the caller.
+ */
+void PreviewGeneratorQueue::BatchPreviewGenerator(PreviewGenerator *gen)
+{
+    int batched = 0;
+    QStringList::iterator qit = m_queue.begin();
+    while (qit != m_queue.end() && batched < kMaxBatchSize)
+    {
+        PreviewMap::iterator it = m_previewMap.find(*qit);
+        if (it == m_previewMap.end() || !(*it).gen || (*it).genStarted ||
+            !gen->AddCapture(*(*it).gen))
+        {
+            ++qit;
+            continue;
+        }
+
+        (*it).gen->deleteLater();
+        (*it).gen        = gen;
+        (*it).genStarted = true;
+        qit = m_queue.erase(qit);
+        batched++;
+    }
+
+    if (batched)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Taking %1 more previews with the same generator")
+                .arg(batched));
+    }
+}
+
+/// \brief Adds the time one preview took, m_lock must be held.
+void PreviewGeneratorQueue::UpdateLatency(uint latency_ms)
+{
+    m_avgLatency = (m_done++) ?
+        m_avgLatency + kLatencyEWMAAlpha * (latency_ms - m_avgLatency) :
+        latency_ms;
+    m_maxLatency = max(m_maxLatency, latency_ms);
+}
+
 /** \brief Sets the PreviewGenerator for a specific file.
  *  \return true iff call succeeded.
  */
@@ -493,6 +607,7 @@ void PreviewGeneratorQueue::SetPreviewGenerator(
             g->AttachSignals(this);
             state.gen = g;
             state.genStarted = false;
+            state.requested.start();
             if (!g->GetToken().isEmpty())
                 state.tokens.insert(g->GetToken());
         }
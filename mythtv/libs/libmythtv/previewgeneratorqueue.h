@@ -9,6 +9,7 @@
 #include <QSet>
 
 #include "previewgenerator.h"
+#include "mythtimer.h"
 #include "mythtvexp.h"
 #include "mthread.h"
 
@@ -27,6 +28,7 @@ class PreviewGenState
     uint              lastBlockTime;
     QDateTime         blockRetryUntil;
     QSet<QString>     tokens;
+    MythTimer         requested;  ///< Time since the generator was queued
 };
 typedef QMap<QString,PreviewGenState> PreviewMap;
 
@@ -50,6 +52,8 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
                                 QString token);
     static void AddListener(QObject*);
     static void RemoveListener(QObject*);
+    static bool GetStats(uint &queued, uint &running, uint &done,
+                         uint &avg_latency_ms, uint &max_latency_ms);
 
   private:
     PreviewGeneratorQueue(PreviewGenerator::Mode mode,
@@ -65,6 +69,8 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     void SetPreviewGenerator(const QString &key, PreviewGenerator *g);
     void IncPreviewGeneratorPriority(const QString &key, QString token);
     void UpdatePreviewGeneratorThreads(void);
+    void BatchPreviewGenerator(PreviewGenerator *gen);
+    void UpdateLatency(uint latency_ms);
     bool IsGeneratingPreview(const QString &key) const;
     uint IncPreviewGeneratorAttempts(const QString &key);
     void ClearPreviewGeneratorAttempts(const QString &key);
@@ -91,6 +97,9 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     uint                   m_maxThreads;
     uint                   m_maxAttempts;
     uint                   m_minBlockSeconds;
+    uint                   m_done;          ///< Previews finished so far
+    double                 m_avgLatency;    ///< Request to result, in ms
+    uint                   m_maxLatency;
 };
 
 #endif // _PREVIEW_GENERATOR_QUEUE_H_
@@ -1,20 +1,29 @@
 // -*- Mode: c++ -*-
 
 #include <limits.h>
+#include <math.h>
 
 // C++ includes
 #include <algorithm>
 using namespace std;
 
+// Qt headers
+#include <QRunnable>
+#include <QMutex>
+
 // MythTV headers
 #include "programdata.h"
 #include "channelutil.h"
+#include "mthreadpool.h"
 #include "mythdb.h"
 #include "mythlogging.h"
 #include "dvbdescriptors.h"
 
 #define LOC      QString("ProgramData: ")
 
+/// Channels whose listings are stored at the same time
+static const int kChannelThreads = 4;
+
 static const char *roles[] =
 {
     "",
@@ -1082,17 +1091,68 @@ void ProgramData::FixProgramList(QList<ProgInfo*> &fixlist)
     }
 }
 
+/** \brief Fixes up and stores the listings of one XMLTV channel, which
+ *         may be used by several channels of the source.
+ */
+class ProgramChannelHandler : public QRunnable
+{
+  public:
+    ProgramChannelHandler(QList<ProgInfo> &list, const vector<uint> &chanids,
+                          QMutex &lock, uint &unchanged, uint &updated) :
+        m_list(list), m_chanids(chanids), m_lock(lock),
+        m_unchanged(unchanged), m_updated(updated) {}
+
+    void run(void)
+    {
+        QList<ProgInfo*> sortlist;
+        QList<ProgInfo>::iterator it = m_list.begin();
+        for (; it != m_list.end(); ++it)
+            sortlist.push_back(&(*it));
+
+        ProgramData::FixProgramList(sortlist);
+
+        MSqlQuery query(MSqlQuery::InitCon());
+        uint unchanged = 0, updated = 0;
+
+        for (uint i = 0; i < m_chanids.size(); ++i)
+        {
+            ProgramData::HandlePrograms(query, m_chanids[i], sortlist,
+                                        unchanged, updated);
+        }
+
+        QMutexLocker locker(&m_lock);
+        m_unchanged += unchanged;
+        m_updated   += updated;
+    }
+
+  private:
+    QList<ProgInfo> &m_list;
+    vector<uint>     m_chanids;
+    QMutex          &m_lock;
+    uint            &m_unchanged;
+    uint            &m_updated;
+};
+
+/** \brief Stores the listings of an XMLTV source.
+ *
+ *  The channels are independent of each other, so several of them are
+ *  handled at the same time, each with its own database connection.
+ */
 void ProgramData::HandlePrograms(
     uint sourceid, QMap<QString, QList<ProgInfo> > &proglist)
 {
     uint unchanged = 0, updated = 0;
+    QMutex lock;
+
+    MThreadPool pool("ProgramData");
+    pool.setMaxThreadCount(kChannelThreads);
 
     MSqlQuery query(MSqlQuery::InitCon());
 
-    QMap<QString, QList<ProgInfo> >::const_iterator mapiter;
+    QMap<QString, QList<ProgInfo> >::iterator mapiter;
     for (mapiter = proglist.begin(); mapiter != proglist.end(); ++mapiter)
     {
-        if (mapiter.key().isEmpty())
+        if (mapiter.key().isEmpty() || mapiter->isEmpty())
             continue;
 
         query.prepare(
@@ -1121,42 +1181,68 @@ void ProgramData::HandlePrograms(
             continue;
         }
 
-        QList<ProgInfo> &list = proglist[mapiter.key()];
-        QList<ProgInfo*> sortlist;
-        QList<ProgInfo>::iterator it = list.begin();
-        for (; it != list.end(); ++it)
-            sortlist.push_back(&(*it));
-
-        FixProgramList(sortlist);
-
-        for (uint i = 0; i < chanids.size(); ++i)
-        {
-            HandlePrograms(query, chanids[i], sortlist, unchanged, updated);
-        }
+        pool.start(new ProgramChannelHandler(*mapiter, chanids, lock,
+                                             unchanged, updated),
+                   "ProgramChannel");
     }
 
+    pool.waitForDone();
+
     LOG(VB_GENERAL, LOG_INFO,
         QString("Updated programs: %1 Unchanged programs: %2")
                 .arg(updated) .arg(unchanged));
 }
 
+/** \brief Stores the programs of sortlist, which must be sorted and free
+ *         of overlaps, on a channel.
+ *
+ *  The programs the channel already has in that time are read with one
+ *  query, so unchanged programs, usually most of them, are skipped without
+ *  touching the database, and overlapping programs are only deleted when
+ *  there are any.
+ */
 void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint                   chanid,
                                  const QList<ProgInfo*> &sortlist,
                                  uint &unchanged,
                                  uint &updated)
 {
+    if (sortlist.isEmpty())
+        return;
+
+    QDateTime to = sortlist.back()->endtime;
     QList<ProgInfo*>::const_iterator it = sortlist.begin();
     for (; it != sortlist.end(); ++it)
+        to = max(to, (*it)->endtime);
+
+    QMap<QDateTime, ProgInfo> existing;
+    bool loaded = LoadPrograms(query, chanid, sortlist.front()->starttime,
+                               to, existing);
+
+    for (it = sortlist.begin(); it != sortlist.end(); ++it)
     {
-        if (IsUnchanged(query, chanid, **it))
+        if (loaded)
         {
-            unchanged++;
-            continue;
-        }
+            QMap<QDateTime, ProgInfo>::const_iterator cur =
+                existing.find((*it)->starttime);
+            if (cur != existing.end() && IsUnchanged(*cur, **it))
+            {
+                unchanged++;
+                continue;
+            }
+
+            QMap<QDateTime, ProgInfo>::const_iterator overlap =
+                existing.lowerBound((*it)->starttime);
+            bool overlaps = overlap != existing.end() &&
+                            overlap.key() < (*it)->endtime;
 
-        if (!DeleteOverlaps(query, chanid, **it))
+            if (overlaps && !DeleteOverlaps(query, chanid, **it))
+                continue;
+        }
+        else if (!DeleteOverlaps(query, chanid, **it))
+        {
             continue;
+        }
 
         updated += (*it)->InsertDB(query, chanid);
     }
@@ -1224,67 +1310,96 @@ int ProgramData::fix_end_times(void)
     return count;
 }
 
-bool ProgramData::IsUnchanged(
-    MSqlQuery &query, uint chanid, const ProgInfo &pi)
+/** \brief Reads the programs of a channel that start in [from, to), with
+ *         the columns IsUnchanged() compares, keyed by start time.
+ */
+bool ProgramData::LoadPrograms(
+    MSqlQuery &query, uint chanid, const QDateTime &from, const QDateTime &to,
+    QMap<QDateTime, ProgInfo> &programs)
 {
     query.prepare(
-        "SELECT count(*) "
+        "SELECT starttime,       endtime,         title, "
+        "       subtitle,        description,     category, "
+        "       category_type,   airdate,         stars, "
+        "       previouslyshown, title_pronounce, audioprop+0, "
+        "       videoprop+0,     subtitletypes+0, partnumber, "
+        "       parttotal,       seriesid,        showtype, "
+        "       colorcode,       syndicatedepisodenumber, programid "
         "FROM program "
-        "WHERE chanid          = :CHANID     AND "
-        "      starttime       = :START      AND "
-        "      endtime         = :END        AND "
-        "      title           = :TITLE      AND "
-        "      subtitle        = :SUBTITLE   AND "
-        "      description     = :DESC       AND "
-        "      category        = :CATEGORY   AND "
-        "      category_type   = :CATEGORY_TYPE AND "
-        "      airdate         = :AIRDATE    AND "
-        "      stars >= (:STARS1 - 0.001)    AND "
-        "      stars <= (:STARS2 + 0.001)    AND "
-        "      previouslyshown = :PREVIOUSLYSHOWN AND "
-        "      title_pronounce = :TITLE_PRONOUNCE AND "
-        "      audioprop       = :AUDIOPROP  AND "
-        "      videoprop       = :VIDEOPROP  AND "
-        "      subtitletypes   = :SUBTYPES   AND "
-        "      partnumber      = :PARTNUMBER AND "
-        "      parttotal       = :PARTTOTAL  AND "
-        "      seriesid        = :SERIESID   AND "
-        "      showtype        = :SHOWTYPE   AND "
-        "      colorcode       = :COLORCODE  AND "
-        "      syndicatedepisodenumber = :SYNDICATEDEPISODENUMBER AND "
-        "      programid       = :PROGRAMID");
-
-    QString cattype = myth_category_type_to_string(pi.categoryType);
-
-    query.bindValue(":CHANID",     chanid);
-    query.bindValue(":START",      pi.starttime);
-    query.bindValue(":END",        pi.endtime);
-    query.bindValue(":TITLE",      denullify(pi.title));
-    query.bindValue(":SUBTITLE",   denullify(pi.subtitle));
-    query.bindValue(":DESC",       denullify(pi.description));
-    query.bindValue(":CATEGORY",   denullify(pi.category));
-    query.bindValue(":CATEGORY_TYPE", cattype);
-    query.bindValue(":AIRDATE",    pi.airdate);
-    query.bindValue(":STARS1",     pi.stars);
-    query.bindValue(":STARS2",     pi.stars);
-    query.bindValue(":PREVIOUSLYSHOWN", pi.previouslyshown);
-    query.bindValue(":TITLE_PRONOUNCE", pi.title_pronounce);
-    query.bindValue(":AUDIOPROP",  pi.audioProps);
-    query.bindValue(":VIDEOPROP",  pi.videoProps);
-    query.bindValue(":SUBTYPES",   pi.subtitleType);
-    query.bindValue(":PARTNUMBER", pi.partnumber);
-    query.bindValue(":PARTTOTAL",  pi.parttotal);
-    query.bindValue(":SERIESID",   denullify(pi.seriesId));
-    query.bindValue(":SHOWTYPE",   pi.showtype);
-    query.bindValue(":COLORCODE",  pi.colorcode);
-    query.bindValue(":SYNDICATEDEPISODENUMBER",
-                    denullify(pi.syndicatedepisodenumber));
-    query.bindValue(":PROGRAMID",  denullify(pi.programId));
-
-    if (query.exec() && query.next())
-        return query.value(0).toUInt() > 0;
-
-    return false;
+        "WHERE chanid     = :CHANID AND "
+        "      starttime >= :FROM   AND "
+        "      starttime <  :TO");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":FROM",   from);
+    query.bindValue(":TO",     to);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::LoadPrograms", query);
+        return false;
+    }
+
+    while (query.next())
+    {
+        ProgInfo pi;
+        pi.starttime       = MythDate::as_utc(query.value(0).toDateTime());
+        pi.endtime         = MythDate::as_utc(query.value(1).toDateTime());
+        pi.title           = query.value(2).toString();
+        pi.subtitle        = query.value(3).toString();
+        pi.description     = query.value(4).toString();
+        pi.category        = query.value(5).toString();
+        pi.categoryType    =
+            string_to_myth_category_type(query.value(6).toString());
+        pi.airdate         = query.value(7).toUInt();
+        pi.stars           = query.value(8).toString();
+        pi.previouslyshown = query.value(9).toBool();
+        pi.title_pronounce = query.value(10).toString();
+        pi.audioProps      = query.value(11).toUInt();
+        pi.videoProps      = query.value(12).toUInt();
+        pi.subtitleType    = query.value(13).toUInt();
+        pi.partnumber      = query.value(14).toUInt();
+        pi.parttotal       = query.value(15).toUInt();
+        pi.seriesId        = query.value(16).toString();
+        pi.showtype        = query.value(17).toString();
+        pi.colorcode       = query.value(18).toString();
+        pi.syndicatedepisodenumber = query.value(19).toString();
+        pi.programId       = query.value(20).toString();
+
+        programs.insert(pi.starttime, pi);
+    }
+
+    return true;
+}
+
+/** \brief Returns true if a program read by LoadPrograms() has the same
+ *         listing as the new one, so it doesn't need to be stored again.
+ *
+ *  Unlike in SQL, a null string is equal to an empty one here.
+ */
+bool ProgramData::IsUnchanged(const ProgInfo &existing, const ProgInfo &pi)
+{
+    return
+        existing.starttime       == pi.starttime       &&
+        existing.endtime         == pi.endtime         &&
+        existing.title           == pi.title           &&
+        existing.subtitle        == pi.subtitle        &&
+        existing.description     == pi.description     &&
+        existing.category        == pi.category        &&
+        existing.categoryType    == pi.categoryType    &&
+        existing.airdate         == pi.airdate         &&
+        existing.previouslyshown == pi.previouslyshown &&
+        existing.title_pronounce == pi.title_pronounce &&
+        existing.audioProps      == pi.audioProps      &&
+        existing.videoProps      == pi.videoProps      &&
+        existing.subtitleType    == pi.subtitleType    &&
+        existing.partnumber      == pi.partnumber      &&
+        existing.parttotal       == pi.parttotal       &&
+        existing.seriesId        == pi.seriesId        &&
+        existing.showtype        == pi.showtype        &&
+        existing.colorcode       == pi.colorcode       &&
+        existing.programId       == pi.programId       &&
+        existing.syndicatedepisodenumber == pi.syndicatedepisodenumber &&
+        fabs(existing.stars.toFloat() - pi.stars.toFloat()) <= 0.001f;
 }
 
 bool ProgramData::DeleteOverlaps(
@@ -287,13 +287,18 @@ class MTV_PUBLIC ProgramData
         bool use_channel_time_offset);
 
   private:
+    friend class ProgramChannelHandler;
+
     static void FixProgramList(QList<ProgInfo*> &fixlist);
     static void HandlePrograms(
         MSqlQuery &query, uint chanid,
         const QList<ProgInfo*> &sortlist,
         uint &unchanged, uint &updated);
-    static bool IsUnchanged(
-        MSqlQuery &query, uint chanid, const ProgInfo &pi);
+    static bool LoadPrograms(
+        MSqlQuery &query, uint chanid,
+        const QDateTime &from, const QDateTime &to,
+        QMap<QDateTime, ProgInfo> &programs);
+    static bool IsUnchanged(const ProgInfo &existing, const ProgInfo &pi);
     static bool DeleteOverlaps(
         MSqlQuery &query, uint chanid, const ProgInfo &pi);
 };
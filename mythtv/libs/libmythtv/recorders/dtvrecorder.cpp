@@ -775,6 +775,9 @@ void DTVRecorder::HandleKeyframe(int64_t extra)
     if (_first_keyframe < 0)
     {
         _first_keyframe = frameNum;
+        if (tvrec)
+            tvrec->GetZapTrace().Finish("first keyframe",
+                                        "recorder started", true);
         SendMythSystemRecEvent("REC_STARTED_WRITING", curRecording);
     }
 
@@ -1011,6 +1014,9 @@ void DTVRecorder::HandleH264Keyframe(void)
     {
         _first_keyframe = frameNum;
         startpos = 0;
+        if (tvrec)
+            tvrec->GetZapTrace().Finish("first keyframe",
+                                        "recorder started", true);
         SendMythSystemRecEvent("REC_STARTED_WRITING", curRecording);
     }
     else
@@ -0,0 +1,393 @@
+#include <algorithm>
+using namespace std;
+
+#include <QStringList>
+
+#include "positionmapwriter.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythdbcon.h"
+#include "mythdb.h"
+
+#define LOC QString("PosMapWriter: ")
+
+/// Rows written by a single INSERT statement
+static const int  kMaxRowsPerInsert = 500;
+/// Failed attempts before the rows of the failing INSERT are dropped
+static const uint kMaxFailures      = 3;
+
+QReadWriteLock     PositionMapWriter::s_lock;
+PositionMapWriter *PositionMapWriter::s_writer = NULL;
+
+void PositionMapWriter::CreatePositionMapWriter(void)
+{
+    QWriteLocker locker(&s_lock);
+
+    if (s_writer)
+        return;
+
+    uint latency = gCoreContext->GetNumSetting("PositionMapWriteLatency", 2000);
+    locker.unlock();
+
+    StartWriter(new PositionMapWriter(latency));
+}
+
+/// \brief Makes \p writer the backend wide writer and starts its thread.
+void PositionMapWriter::StartWriter(PositionMapWriter *writer)
+{
+    QWriteLocker locker(&s_lock);
+
+    if (s_writer)
+    {
+        delete writer;
+        return;
+    }
+
+    s_writer = writer;
+    s_writer->start();
+}
+
+/// \brief Writes out anything still queued and stops the writer thread.
+void PositionMapWriter::TeardownPositionMapWriter(void)
+{
+    QWriteLocker locker(&s_lock);
+
+    delete s_writer;
+    s_writer = NULL;
+}
+
+PositionMapWriter::PositionMapWriter(uint latency) :
+    MThread("PositionMapWriter"),
+    m_queued(0), m_done(0), m_flushers(0), m_failures(0),
+    m_latency(latency), m_stop(false)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Writing position maps every %1 ms").arg(m_latency));
+}
+
+PositionMapWriter::~PositionMapWriter()
+{
+    Stop();
+}
+
+/** \brief Writes out anything still queued and stops the writer thread.
+ *
+ *  Subclasses that override WriteRows() must call this from their own
+ *  destructor, the thread may still call WriteRows() until it returns.
+ */
+void PositionMapWriter::Stop(void)
+{
+    m_lock.lock();
+    m_stop = true;
+    m_wait.wakeAll();
+    m_lock.unlock();
+
+    wait();
+}
+
+/** \brief Queues a position map delta for writing to recordedseek.
+ *  \return false if there is no writer, in which case the caller must
+ *          save the map itself.
+ */
+bool PositionMapWriter::Enqueue(uint chanid, const QDateTime &recstartts,
+                                MarkTypes type, const frm_pos_map_t &posMap)
+{
+    QReadLocker rlocker(&s_lock);
+
+    if (!s_writer)
+        return false;
+
+    if (posMap.isEmpty())
+        return true;
+
+    QMutexLocker locker(&s_writer->m_lock);
+
+    if (s_writer->m_rows.isEmpty())
+        s_writer->m_oldest.start();
+
+    frm_pos_map_t::const_iterator it = posMap.begin();
+    for (; it != posMap.end(); ++it)
+        s_writer->m_rows.push_back(Row(chanid, recstartts, type,
+                                       it.key(), *it));
+
+    s_writer->m_queued++;
+
+    return true;
+}
+
+/** \brief Writes out everything queued so far and waits for it to complete.
+ *         This is used at the end of a recording so the complete seek table
+ *         is in the database before anything else looks at it.
+ *  \return true if everything queued before the call was written
+ */
+bool PositionMapWriter::Flush(uint timeout_ms)
+{
+    QReadLocker rlocker(&s_lock);
+
+    if (!s_writer)
+        return true;
+
+    QMutexLocker locker(&s_writer->m_lock);
+
+    uint64_t target = s_writer->m_queued;
+    s_writer->m_flushers++;
+    s_writer->m_wait.wakeAll();
+
+    MythTimer t(MythTimer::kStartRunning);
+    while (s_writer->m_done < target)
+    {
+        int left = (int)timeout_ms - t.elapsed();
+        if (left <= 0)
+            break;
+        s_writer->m_written.wait(locker.mutex(), left);
+    }
+
+    s_writer->m_flushers--;
+
+    if (s_writer->m_done < target)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Timed out flushing %1 position map rows")
+                .arg(s_writer->m_rows.size()));
+        return false;
+    }
+
+    return true;
+}
+
+/** \brief Reports how far the writer is behind the recorders.
+ *  \param pending_rows  Rows not yet written
+ *  \param lag_ms        Age of the oldest row not yet written
+ *  \return false if there is no writer
+ */
+bool PositionMapWriter::GetLag(uint &pending_rows, uint &lag_ms)
+{
+    QReadLocker rlocker(&s_lock);
+
+    pending_rows = lag_ms = 0;
+
+    if (!s_writer)
+        return false;
+
+    QMutexLocker locker(&s_writer->m_lock);
+
+    pending_rows = s_writer->m_rows.size();
+    if (pending_rows)
+        lag_ms = s_writer->m_oldest.elapsed();
+
+    return true;
+}
+
+void PositionMapWriter::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&m_lock);
+
+    while (true)
+    {
+        if (m_rows.isEmpty())
+        {
+            m_done = m_queued;
+            m_written.wakeAll();
+
+            if (m_stop)
+                break;
+
+            m_wait.wait(locker.mutex());
+            continue;
+        }
+
+        int age = m_oldest.elapsed();
+        if (!m_stop && !m_flushers && age < (int)m_latency)
+        {
+            m_wait.wait(locker.mutex(), m_latency - age);
+            continue;
+        }
+
+        QList<Row> rows;
+        rows.swap(m_rows);
+        GroupByRecording(rows);
+        MythTimer oldest = m_oldest;
+        uint64_t queued  = m_queued;
+
+        locker.unlock();
+        int handled = WriteRows(rows);
+        locker.relock();
+
+        if (handled == rows.size())
+        {
+            m_failures = 0;
+            m_done = queued;
+            m_written.wakeAll();
+            continue;
+        }
+
+        // Put back what wasn't written, ahead of anything queued since.
+        QList<Row> remaining = rows.mid(handled);
+        remaining += m_rows;
+        m_rows.swap(remaining);
+        m_oldest = oldest;
+
+        if (++m_failures >= kMaxFailures || m_stop)
+        {
+            // Most likely rows that can never be inserted, don't let them
+            // hold up every other recording.  Only the failing recording's
+            // rows are given up on, unless we are shutting down.
+            int drop = m_stop ? m_rows.size() : BatchSize(m_rows, 0);
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Giving up on %1 position map rows").arg(drop));
+            m_rows.erase(m_rows.begin(), m_rows.begin() + drop);
+            m_failures = 0;
+            if (!m_rows.isEmpty())
+                m_oldest.start();
+            continue;
+        }
+
+        m_written.wakeAll();
+        m_wait.wait(locker.mutex(), 1000);
+    }
+
+    RunEpilog();
+}
+
+/** \brief Reorders \p rows so the rows of each recording are adjacent.
+ *
+ *  Recorders enqueue small deltas in turn, so the queue interleaves the
+ *  recordings.  Recordings keep the order in which they first appear, and
+ *  rows keep their order within a recording.
+ */
+void PositionMapWriter::GroupByRecording(QList<Row> &rows)
+{
+    QList<Row> grouped;
+
+    while (!rows.isEmpty())
+    {
+        QList<Row> others;
+        const Row first = rows.front();
+
+        QList<Row>::const_iterator it = rows.begin();
+        for (; it != rows.end(); ++it)
+        {
+            if ((*it).SameRecording(first))
+                grouped.push_back(*it);
+            else
+                others.push_back(*it);
+        }
+
+        rows.swap(others);
+    }
+
+    rows.swap(grouped);
+}
+
+/** \brief Counts the rows from \p start on that go into one INSERT, they
+ *         must all belong to the same recording.
+ */
+int PositionMapWriter::BatchSize(const QList<Row> &rows, int start)
+{
+    int end = start;
+    int last = min(rows.size(), start + kMaxRowsPerInsert);
+
+    while (end < last && rows[end].SameRecording(rows[start]))
+        end++;
+
+    return end - start;
+}
+
+/** \brief Inserts rows into recordedseek, up to kMaxRowsPerInsert rows of
+ *         one recording at a time.
+ *
+ *  Each INSERT holds rows of a single recording, so a bad row (e.g. a
+ *  duplicate key) can only affect its own recording.  When an INSERT
+ *  fails with the database still reachable its rows are retried one at
+ *  a time, and only the rows that fail on their own are skipped.
+ *
+ *  \return the number of rows handled, rows from there on should be
+ *          retried later
+ */
+int PositionMapWriter::WriteRows(const QList<Row> &rows)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    int written = 0;
+    int handled = 0;
+
+    while (handled < rows.size())
+    {
+        int count = BatchSize(rows, handled);
+
+        QStringList values;
+        for (int i = 0; i < count; i++)
+        {
+            values << QString("(:CHANID%1, :STARTTIME%1, :MARK%1, "
+                              " :TYPE%1, :OFFSET%1)").arg(i);
+        }
+
+        query.prepare(
+            "INSERT INTO "
+            "recordedseek (chanid, starttime, mark, type, offset) "
+            "VALUES " + values.join(", "));
+
+        for (int i = 0; i < count; i++)
+            BindRow(query, QString::number(i), rows[handled + i]);
+
+        if (query.exec())
+        {
+            written += count;
+            handled += count;
+            continue;
+        }
+
+        MythDB::DBError("position map writer insert", query);
+
+        if (!MSqlQuery::testDBConnection())
+            break;
+
+        // The database is fine, so one of the rows is at fault
+        query.prepare(
+            "INSERT INTO "
+            "recordedseek (chanid, starttime, mark, type, offset) "
+            "VALUES (:CHANID, :STARTTIME, :MARK, :TYPE, :OFFSET)");
+
+        int inserted = 0;
+        for (int i = 0; i < count; i++)
+        {
+            BindRow(query, QString(), rows[handled + i]);
+            if (query.exec())
+                inserted++;
+        }
+
+        // Nothing went in, leave it to the caller to retry or give up
+        if (!inserted)
+            break;
+
+        if (inserted < count)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Skipped %1 position map rows for %2_%3")
+                    .arg(count - inserted).arg(rows[handled].chanid)
+                    .arg(rows[handled].recstartts.toString(Qt::ISODate)));
+        }
+
+        written += inserted;
+        handled += count;
+    }
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC +
+        QString("Wrote %1 of %2 position map rows")
+            .arg(written).arg(rows.size()));
+
+    return handled;
+}
+
+void PositionMapWriter::BindRow(MSqlQuery &query, const QString &suffix,
+                                const Row &row)
+{
+    query.bindValue(":CHANID"    + suffix, row.chanid);
+    query.bindValue(":STARTTIME" + suffix, row.recstartts);
+    query.bindValue(":MARK"      + suffix, (quint64)row.mark);
+    query.bindValue(":TYPE"      + suffix, row.type);
+    query.bindValue(":OFFSET"    + suffix, (quint64)row.offset);
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,92 @@
+// -*- Mode: c++ -*-
+#ifndef POSITION_MAP_WRITER_H_
+#define POSITION_MAP_WRITER_H_
+
+#include <stdint.h>
+
+#include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QMutex>
+#include <QList>
+
+#include "programtypes.h" // for MarkTypes, frm_pos_map_t
+#include "mythtimer.h"
+#include "mythtvexp.h"
+#include "mthread.h"
+
+class MSqlQuery;
+
+/** \class PositionMapWriter
+ *  \brief Backend wide writer for the recordedseek table.
+ *
+ *  Recorders hand their position map deltas to this thread rather than
+ *  each writing them with one INSERT per keyframe.  Rows from all
+ *  recorders are collected for up to "PositionMapWriteLatency" ms, then
+ *  grouped by recording and written using one multi-row INSERT per
+ *  recording.
+ *
+ *  When no writer has been created (i.e. outside of mythbackend) Enqueue()
+ *  returns false and the caller is expected to write the map itself.
+ */
+class MTV_PUBLIC PositionMapWriter : public MThread
+{
+  public:
+    static void CreatePositionMapWriter(void);
+    static void TeardownPositionMapWriter(void);
+
+    static bool Enqueue(uint chanid, const QDateTime &recstartts,
+                        MarkTypes type, const frm_pos_map_t &posMap);
+    static bool Flush(uint timeout_ms = 30000);
+    static bool GetLag(uint &pending_rows, uint &lag_ms);
+
+  protected:
+    class Row
+    {
+      public:
+        Row(uint c, const QDateTime &s, MarkTypes t, uint64_t m, uint64_t o) :
+            chanid(c), recstartts(s), type(t), mark(m), offset(o) {}
+        bool SameRecording(const Row &other) const
+        {
+            return chanid == other.chanid && recstartts == other.recstartts;
+        }
+        uint      chanid;
+        QDateTime recstartts;
+        MarkTypes type;
+        uint64_t  mark;
+        uint64_t  offset;
+    };
+
+    PositionMapWriter(uint latency);
+    virtual ~PositionMapWriter();
+
+    static void StartWriter(PositionMapWriter *writer);
+    void Stop(void);
+
+    virtual void run(void); // MThread
+    virtual int WriteRows(const QList<Row> &rows);
+
+  private:
+    static void GroupByRecording(QList<Row> &rows);
+    static int BatchSize(const QList<Row> &rows, int start);
+    static void BindRow(MSqlQuery &query, const QString &suffix,
+                        const Row &row);
+
+  private:
+    QMutex          m_lock;
+    QWaitCondition  m_wait;         ///< Wakes the writer thread
+    QWaitCondition  m_written;      ///< Signalled after each write attempt
+    QList<Row>      m_rows;         ///< Rows waiting to be written
+    MythTimer       m_oldest;       ///< Age of the first row in m_rows
+    uint64_t        m_queued;       ///< Enqueue() calls so far
+    uint64_t        m_done;         ///< Enqueue() calls written (or dropped)
+    uint            m_flushers;     ///< Threads waiting in Flush()
+    uint            m_failures;     ///< Consecutive failed INSERTs
+    uint            m_latency;      ///< Max time rows are held (ms)
+    bool            m_stop;
+
+    static QReadWriteLock     s_lock; ///< Protects s_writer
+    static PositionMapWriter *s_writer;
+};
+
+#endif // POSITION_MAP_WRITER_H_
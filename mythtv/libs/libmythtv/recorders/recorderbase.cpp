@@ -14,6 +14,7 @@ using namespace std;
 #include "iptvrecorder.h"
 #include "mpegrecorder.h"
 #include "recorderbase.h"
+#include "positionmapwriter.h"
 #include "cetonchannel.h"
 #include "asirecorder.h"
 #include "dvbrecorder.h"
@@ -498,15 +499,40 @@ void RecorderBase::SavePositionMap(bool force)
             durationMapDelta.clear();
             positionMapLock.unlock();
 
-            curRecording->SavePositionMapDelta(deltaCopy, positionMapType);
-            curRecording->SavePositionMapDelta(durationDeltaCopy,
-                                               MARK_DURATION_MS);
+            // The backend's PositionMapWriter batches the recordedseek
+            // rows of recordings with those of every other recorder.
+            // Anything else (a video, or a map redirected elsewhere by
+            // SetPositionMapDBReplacement()) is left to ProgramInfo.
+            bool queue = curRecording->IsRecording() &&
+                !curRecording->HasPositionMapDBReplacement();
+            uint chanid = curRecording->GetChanID();
+            QDateTime recstartts = curRecording->GetRecordingStartTime();
+
+            if (!queue || !PositionMapWriter::Enqueue(chanid, recstartts,
+                                                      positionMapType,
+                                                      deltaCopy))
+            {
+                curRecording->SavePositionMapDelta(deltaCopy,
+                                                   positionMapType);
+            }
+            if (!queue || !PositionMapWriter::Enqueue(chanid, recstartts,
+                                                      MARK_DURATION_MS,
+                                                      durationDeltaCopy))
+            {
+                curRecording->SavePositionMapDelta(durationDeltaCopy,
+                                                   MARK_DURATION_MS);
+            }
         }
         else
         {
             positionMapLock.unlock();
         }
 
+        // A forced save is done at the end of each file, so make sure
+        // the seek table is complete before anyone uses it.
+        if (force)
+            PositionMapWriter::Flush();
+
         if (ringBuffer)
         {
             curRecording->SaveFilesize(ringBuffer->GetWritePosition());
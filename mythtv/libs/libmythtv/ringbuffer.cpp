@@ -1567,6 +1567,16 @@ bool RingBuffer::WriterSetBlocking(bool block)
     return false;
 }
 
+/** \brief Calls ThreadedFileWriter::SetTimeshift(uint64_t,uint)
+ */
+void RingBuffer::WriterSetTimeshift(uint64_t max_bytes, uint max_secs)
+{
+    QReadLocker lock(&rwlock);
+
+    if (tfw)
+        tfw->SetTimeshift(max_bytes, max_secs);
+}
+
 /** \brief Tell RingBuffer if this is an old file or not.
  *
  *  Normally the RingBuffer determines that the file is old
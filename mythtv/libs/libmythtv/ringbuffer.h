@@ -152,6 +152,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void Sync(void);
     long long WriterSeek(long long pos, int whence, bool has_lock = false);
     bool WriterSetBlocking(bool lock = true);
+    void WriterSetTimeshift(uint64_t max_bytes, uint max_secs = 0);
 
     long long SetAdjustFilesize(void);
 
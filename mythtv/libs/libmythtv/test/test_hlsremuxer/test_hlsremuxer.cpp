@@ -0,0 +1,3 @@
+#include "test_hlsremuxer.h"
+
+QTEST_APPLESS_MAIN(TestHLSRemuxer)
@@ -0,0 +1,151 @@
+/*
+ *  Class TestHLSRemuxer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "hlsremuxer.h"
+#include "mpegtables.h"
+
+class TestHLSRemuxer: public QObject
+{
+    Q_OBJECT
+
+    /// A PAT packet (its content isn't looked at) followed by a PMT packet
+    /// with one elementary stream of each of the given types
+    static QByteArray psi(const QByteArray &types)
+    {
+        QByteArray pat(188, '\xff');
+        pat[0] = 0x47;
+
+        uint len = 9 + 5 * types.size() + 4;
+
+        QByteArray pmt;
+        pmt += (char)0x47;
+        pmt += (char)0x50;        // payload start, PID 0x1000
+        pmt += (char)0x00;
+        pmt += (char)0x10;        // payload only
+        pmt += (char)0x00;        // pointer field
+        pmt += (char)TableID::PMT;
+        pmt += (char)(0xb0 | (len >> 8));
+        pmt += (char)(len & 0xff);
+        pmt += (char)0x00;        // program number 1
+        pmt += (char)0x01;
+        pmt += (char)0xc1;        // version 0, current
+        pmt += (char)0x00;        // section number
+        pmt += (char)0x00;        // last section number
+        pmt += (char)0xe1;        // PCR PID 0x100
+        pmt += (char)0x00;
+        pmt += (char)0xf0;        // no program descriptors
+        pmt += (char)0x00;
+        for (int i = 0; i < types.size(); i++)
+        {
+            pmt += types[i];
+            pmt += (char)0xe1;    // PID 0x101 on
+            pmt += (char)(0x01 + i);
+            pmt += (char)0xf0;    // no stream descriptors
+            pmt += (char)0x00;
+        }
+        pmt += QByteArray(4, '\0'); // CRC, not checked
+        pmt += QByteArray(188 - pmt.size(), '\xff');
+
+        return pat + pmt;
+    }
+
+    static HLSRemuxer::SourceInfo source(uint width, uint64_t bitrate)
+    {
+        HLSRemuxer::SourceInfo info;
+        info.hlsStreams = true;
+        info.width      = width;
+        info.bitrate    = bitrate;
+        return info;
+    }
+
+  private slots:
+    void HasHLSStreams_data(void)
+    {
+        QTest::addColumn<QByteArray>("types");
+        QTest::addColumn<bool>("expected");
+
+        QTest::newRow("h264 aac")
+            << (QByteArray() + (char)StreamID::H264Video
+                + (char)StreamID::MPEG2AACAudio) << true;
+        QTest::newRow("h264 two aac")
+            << (QByteArray() + (char)StreamID::H264Video
+                + (char)StreamID::MPEG2AACAudio
+                + (char)StreamID::MPEG2AACAudio) << true;
+        QTest::newRow("h264 aac mp1")
+            << (QByteArray() + (char)StreamID::H264Video
+                + (char)StreamID::MPEG2AACAudio
+                + (char)StreamID::MPEG1Audio) << false;
+        QTest::newRow("mpeg2 aac")
+            << (QByteArray() + (char)StreamID::MPEG2Video
+                + (char)StreamID::MPEG2AACAudio) << false;
+        QTest::newRow("aac only")
+            << (QByteArray() + (char)StreamID::MPEG2AACAudio) << false;
+    }
+
+    void HasHLSStreams(void)
+    {
+        QFETCH(QByteArray, types);
+        QFETCH(bool, expected);
+
+        QCOMPARE(HLSRemuxer::HasHLSStreams(psi(types)), expected);
+    }
+
+    void MissingPSI(void)
+    {
+        QVERIFY(!HLSRemuxer::HasHLSStreams(QByteArray()));
+        QVERIFY(!HLSRemuxer::HasHLSStreams(QByteArray(188, '\xff')));
+    }
+
+    void CanRemux_data(void)
+    {
+        QTest::addColumn<int>("width");
+        QTest::addColumn<int>("bitrate");
+        QTest::addColumn<bool>("expected");
+
+        // Source is 1920 wide at 8 Mb/s
+        QTest::newRow("no preference")     << 0    << 0        << true;
+        QTest::newRow("default bitrate")   << 0    << 800000   << true;
+        QTest::newRow("full width")        << 1920 << 0        << true;
+        QTest::newRow("smaller picture")   << 1280 << 0        << false;
+        QTest::newRow("higher bitrate")    << 0    << 10000000 << true;
+        QTest::newRow("lower bitrate")     << 0    << 4000000  << false;
+        QTest::newRow("width, default br") << 1920 << 800000   << true;
+    }
+
+    void CanRemux(void)
+    {
+        QFETCH(int, width);
+        QFETCH(int, bitrate);
+        QFETCH(bool, expected);
+
+        QCOMPARE(HLSRemuxer::CanRemux(source(1920, 8000000), width, bitrate),
+                 expected);
+    }
+
+    void UnknownSource(void)
+    {
+        // Nothing known about the source, only the streams matter
+        QVERIFY(HLSRemuxer::CanRemux(source(0, 0), 640, 500000));
+
+        HLSRemuxer::SourceInfo info = source(1920, 8000000);
+        info.hlsStreams = false;
+        QVERIFY(!HLSRemuxer::CanRemux(info, 0, 0));
+    }
+};
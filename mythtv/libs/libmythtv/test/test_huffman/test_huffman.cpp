@@ -0,0 +1,3 @@
+#include "test_huffman.h"
+
+QTEST_APPLESS_MAIN(TestHuffman)
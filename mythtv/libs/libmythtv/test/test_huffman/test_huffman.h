@@ -0,0 +1,267 @@
+/*
+ *  Class TestHuffman
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "atsc_huffman.h"
+#include "freesat_huffman.h"
+
+// Typical event names and descriptions encoded with the Freesat and ATSC
+// tables. The first two bytes of the Freesat ones are the 0x1f encoding
+// byte and the number of the table.
+// "Homer and Bart go fishing, but Marge has other plans for the weekend. Also in HD. [S]"
+static const unsigned char freesat_text0[] = {
+    0x1f, 0x02, 0x05, 0x8e, 0xc9, 0xe7, 0x11, 0x5f, 0x74, 0xdf, 0xd2, 0xf5,
+    0xa1, 0x3a, 0xa7, 0xc3, 0xcd, 0x9b, 0x6b, 0xe4, 0x34, 0x9b, 0x3c, 0xa4,
+    0x1f, 0x26, 0x92, 0xe3, 0x61, 0x67, 0xfe, 0x30, 0x2e, 0x98, 0x7d, 0x96,
+    0xbd, 0x51, 0xbc, 0x2c, 0xe0,
+};
+// "Pointless"
+static const unsigned char freesat_text1[] = {
+    0x1f, 0x01, 0xef, 0xff, 0x7f, 0x34, 0x06,
+};
+// "Quiz show in which contestants try to find the answers nobody else could think of. [AD,S]"
+static const unsigned char freesat_text2[] = {
+    0x1f, 0x02, 0x0f, 0x4c, 0x5b, 0x17, 0xa5, 0xe7, 0x67, 0x9a, 0xee, 0xd9,
+    0x39, 0x6a, 0x92, 0x76, 0x99, 0xae, 0x27, 0xf5, 0x74, 0x92, 0x43, 0x54,
+    0xf2, 0x36, 0xce, 0xcd, 0xb7, 0xd9, 0xfc, 0xa7, 0x59, 0x0a, 0x8a, 0x56,
+    0xb9, 0x0e, 0xb5, 0xac, 0x72, 0xe0,
+};
+// "BBC News at Six"
+static const unsigned char freesat_text3[] = {
+    0x1f, 0x01, 0x48, 0xe7, 0xd5, 0x9c, 0xf8, 0x93, 0x30,
+};
+// "The latest national and international news stories from the BBC News team, followed by weather."
+static const unsigned char freesat_text4[] = {
+    0x1f, 0x02, 0xe5, 0xba, 0xad, 0x5f, 0xb5, 0x51, 0x9e, 0xbf, 0xa7, 0xbb,
+    0x17, 0xa9, 0x54, 0x67, 0xaf, 0xfb, 0x6b, 0x68, 0xaa, 0x93, 0xd3, 0xf8,
+    0xe7, 0x92, 0x73, 0x9c, 0x17, 0x6d, 0x46, 0x61, 0x43, 0xf0, 0x25, 0xdd,
+    0x82, 0xb3, 0xc6, 0x76, 0x6b, 0x90,
+};
+// "Doctor Who: The Doctor and Clara land on a spaceship in the far future. (Part 2 of 2)"
+static const unsigned char freesat_text5[] = {
+    0x1f, 0x02, 0x3a, 0xbf, 0xa9, 0xb1, 0x92, 0xc4, 0xe8, 0x2c, 0x55, 0x7f,
+    0x53, 0x27, 0x9d, 0xf4, 0x47, 0x6e, 0x9e, 0x1e, 0xae, 0x2d, 0xb3, 0x51,
+    0x7a, 0x94, 0xbb, 0x32, 0x5f, 0x73, 0xbf, 0xe6, 0x6f, 0xfa, 0xd8, 0x03,
+    0x2b, 0xec, 0x20, 0x76, 0xb0, 0xbf, 0x40,
+};
+
+// "Local News at Eleven"
+static const unsigned char atsc_title[] = {
+    0xe9, 0x83, 0x2a, 0xcb, 0xcb, 0x1d, 0x6b, 0x30, 0x1e, 0x00,
+};
+// "The latest headlines, weather and traffic from around the region, with sports at the half hour."
+static const unsigned char atsc_description[] = {
+    0xd7, 0xd7, 0x1f, 0x5d, 0xe3, 0xc1, 0xdf, 0x69, 0x7d, 0xf1, 0xd1, 0xe7,
+    0xbb, 0x77, 0xb9, 0xd2, 0x94, 0xfc, 0x3a, 0xc6, 0x77, 0x05, 0xed, 0xe9,
+    0xf3, 0xd1, 0xbb, 0xbf, 0xe7, 0x11, 0x27, 0x26, 0xbb, 0x35, 0x3f, 0xfa,
+    0x7c, 0x5e, 0xad, 0x0a, 0xb2, 0x30,
+};
+// "Sports highlights from around the country, with scores and interviews."
+static const unsigned char dish_description[] = {
+    0xd1, 0x82, 0x2b, 0x09, 0x19, 0x27, 0x8f, 0x25, 0x27, 0x8f, 0x24, 0x24,
+    0x66, 0x58, 0xe1, 0x1d, 0x63, 0x56, 0xb9, 0x0c, 0x88, 0x5a, 0x35, 0x68,
+    0x2f, 0x3f, 0x71, 0xe2, 0x9c, 0x32, 0x12, 0xb4, 0x55, 0x24, 0x3b, 0x5c,
+    0x9b, 0x41, 0x17, 0x14, 0xd3, 0xc5, 0x2c, 0xa0,
+};
+
+struct HuffmanSample
+{
+    const unsigned char *data;
+    uint                 size;
+    const char          *text;
+};
+
+#define SAMPLE(data, text) { data, sizeof(data), text }
+
+static const HuffmanSample freesat_samples[] =
+{
+    SAMPLE(freesat_text0,
+           "Homer and Bart go fishing, but Marge has other plans for the weekend. Also in HD. [S]"),
+    SAMPLE(freesat_text1,
+           "Pointless"),
+    SAMPLE(freesat_text2,
+           "Quiz show in which contestants try to find the answers nobody else could think of. [AD,S]"),
+    SAMPLE(freesat_text3,
+           "BBC News at Six"),
+    SAMPLE(freesat_text4,
+           "The latest national and international news stories from the BBC News team, followed by weather."),
+    SAMPLE(freesat_text5,
+           "Doctor Who: The Doctor and Clara land on a spaceship in the far future. (Part 2 of 2)"),
+};
+
+#define FUZZ_RUNS 20000
+
+typedef QString (*HuffmanDecoder)(const unsigned char *, uint, uint);
+
+Q_DECLARE_METATYPE(HuffmanDecoder)
+
+class TestHuffman: public QObject
+{
+    Q_OBJECT
+
+    // Deterministic noise, so failures can be reproduced
+    static uint noise(uint &seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    }
+
+    // Random input of up to 128 bytes, with zeros after it for the bit at
+    // a time ATSC decoders which can read a little past the end
+    static uint fillNoise(QByteArray &buf, uint &seed)
+    {
+        uint size = noise(seed) % 128;
+        buf.fill(0, size + 16);
+        for (uint i = 0; i < size; i++)
+            buf[i] = (char)noise(seed);
+        return size;
+    }
+
+    static QString freesat(const unsigned char *src, uint size, uint)
+    {
+        return freesat_huffman_to_string(src, size);
+    }
+
+    static QString freesat_bitwise(const unsigned char *src, uint size, uint)
+    {
+        return freesat_huffman_to_string_bitwise(src, size);
+    }
+
+  private slots:
+    void freesat_samples_test(void)
+    {
+        for (uint i = 0; i < sizeof(freesat_samples) / sizeof(HuffmanSample);
+             i++)
+        {
+            const HuffmanSample &sample = freesat_samples[i];
+            QCOMPARE(freesat_huffman_to_string(sample.data, sample.size),
+                     QString(sample.text));
+            QCOMPARE(freesat_huffman_to_string_bitwise(sample.data,
+                                                       sample.size),
+                     QString(sample.text));
+        }
+    }
+
+    void atsc_samples_test(void)
+    {
+        QCOMPARE(atsc_huffman1_to_string(atsc_title, sizeof(atsc_title), 1),
+                 QString("Local News at Eleven"));
+        QCOMPARE(atsc_huffman1_to_string(atsc_description,
+                                         sizeof(atsc_description), 2),
+                 QString("The latest headlines, weather and traffic from "
+                         "around the region, with sports at the half hour."));
+        // the padding bits of the last byte decode as a space
+        QCOMPARE(atsc_huffman2_to_string(dish_description,
+                                         sizeof(dish_description), 2),
+                 QString("Sports highlights from around the country, with "
+                         "scores and interviews. "));
+    }
+
+    // The table driven decoders must give exactly what the bit at a time
+    // ones give, whatever the input
+    void freesat_fuzz_test(void)
+    {
+        QByteArray buf;
+        uint seed = 1;
+        for (int run = 0; run < FUZZ_RUNS; run++)
+        {
+            uint size = fillNoise(buf, seed) + 2;
+            buf[0] = 0x1f;
+            buf[1] = (char)(1 + (run & 1));
+            const unsigned char *src = (const unsigned char *)buf.constData();
+            QCOMPARE(freesat_huffman_to_string(src, size),
+                     freesat_huffman_to_string_bitwise(src, size));
+        }
+    }
+
+    void atsc_huffman1_fuzz_test(void)
+    {
+        QByteArray buf;
+        uint seed = 2;
+        for (int run = 0; run < FUZZ_RUNS; run++)
+        {
+            uint size  = fillNoise(buf, seed);
+            uint table = 1 + (run & 1);
+            const unsigned char *src = (const unsigned char *)buf.constData();
+            QCOMPARE(atsc_huffman1_to_string(src, size, table),
+                     atsc_huffman1_to_string_bitwise(src, size, table));
+        }
+    }
+
+    void atsc_huffman2_fuzz_test(void)
+    {
+        QByteArray buf;
+        uint seed = 3;
+        for (int run = 0; run < FUZZ_RUNS; run++)
+        {
+            uint size  = fillNoise(buf, seed);
+            uint table = 1 + (run & 1);
+            const unsigned char *src = (const unsigned char *)buf.constData();
+            QCOMPARE(atsc_huffman2_to_string(src, size, table),
+                     atsc_huffman2_to_string_bitwise(src, size, table));
+        }
+    }
+
+    void freesat_benchmark_data(void)
+    {
+        QTest::addColumn<HuffmanDecoder>("decoder");
+        QTest::newRow("bitwise") << (HuffmanDecoder)freesat_bitwise;
+        QTest::newRow("table")   << (HuffmanDecoder)freesat;
+    }
+
+    // Decoding the EIT text of a few events
+    void freesat_benchmark(void)
+    {
+        QFETCH(HuffmanDecoder, decoder);
+
+        QBENCHMARK
+        {
+            for (uint i = 0;
+                 i < sizeof(freesat_samples) / sizeof(HuffmanSample); i++)
+            {
+                decoder(freesat_samples[i].data, freesat_samples[i].size, 0);
+            }
+        }
+    }
+
+    void atsc_benchmark_data(void)
+    {
+        QTest::addColumn<HuffmanDecoder>("huffman1");
+        QTest::addColumn<HuffmanDecoder>("huffman2");
+        QTest::newRow("bitwise")
+            << (HuffmanDecoder)atsc_huffman1_to_string_bitwise
+            << (HuffmanDecoder)atsc_huffman2_to_string_bitwise;
+        QTest::newRow("table")
+            << (HuffmanDecoder)atsc_huffman1_to_string
+            << (HuffmanDecoder)atsc_huffman2_to_string;
+    }
+
+    void atsc_benchmark(void)
+    {
+        QFETCH(HuffmanDecoder, huffman1);
+        QFETCH(HuffmanDecoder, huffman2);
+
+        QBENCHMARK
+        {
+            huffman1(atsc_title, sizeof(atsc_title), 1);
+            huffman1(atsc_description, sizeof(atsc_description), 2);
+            huffman2(dish_description, sizeof(dish_description), 2);
+        }
+    }
+};
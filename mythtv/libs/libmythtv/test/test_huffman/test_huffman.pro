@@ -0,0 +1,31 @@
+include ( ../../../../settings.pro )
+
+contains(QT_VERSION, ^4\\.[0-9]\\..*) {
+CONFIG += qtestlib
+}
+contains(QT_VERSION, ^5\\.[0-9]\\..*) {
+QT += testlib
+}
+
+TEMPLATE = app
+TARGET = test_huffman
+DEPENDPATH += . ../.. ../../mpeg
+INCLUDEPATH += . ../../mpeg
+
+contains(QMAKE_CXX, "g++") {
+  QMAKE_CXXFLAGS += -O0 -fprofile-arcs -ftest-coverage
+  QMAKE_LFLAGS += -fprofile-arcs
+}
+
+# Input
+HEADERS += test_huffman.h
+SOURCES += test_huffman.cpp
+
+# The decoders are not exported from libmythtv, build them in
+HEADERS += ../../mpeg/atsc_huffman.h ../../mpeg/freesat_huffman.h
+SOURCES += ../../mpeg/atsc_huffman.cpp ../../mpeg/freesat_huffman.cpp
+
+QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
+QMAKE_CLEAN += ; rm -f *.gcov *.gcda *.gcno
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -22,6 +22,8 @@
 
 #include "mpegtables.h"
 #include "dvbtables.h"
+#include "dvbdescriptors.h"
+#include "mpegstreamdata.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #define MSKIP(MSG) QSKIP(MSG, SkipSingle)
@@ -29,6 +31,78 @@
 #define MSKIP(MSG) QSKIP(MSG)
 #endif
 
+// A program_association_section with ten programs
+static const unsigned char pat_data[] = {
+    0x00, 0xb0, 0x31, 0x04, 0x37, 0xdf, 0x00, 0x00,  0x2b, 0x66, 0xf7, 0xd4, 0x6d, 0x66, 0xe0, 0x64,  /* ..1.7...+f..mf.d */
+    0x6d, 0x67, 0xe0, 0xc8, 0x6d, 0x68, 0xe1, 0x2c,  0x6d, 0x6b, 0xe2, 0x58, 0x6d, 0x6c, 0xe2, 0xbc,  /* mg..mh.,mk.Xml.. */
+    0x6d, 0x6d, 0xe3, 0x20, 0x6d, 0x6e, 0xe2, 0x8a,  0x6d, 0x70, 0xe4, 0x4c, 0x6d, 0x71, 0xe1, 0x9b,  /* mm. mn..mp.Lmq.. */
+    0xc0, 0x79, 0xa6, 0x2b                                                                            /* .y.+ */
+};
+
+// An event_information_section with a short event and a content identifier
+// descriptor in German and English
+static const unsigned char eit_data[] = {
+    0x4f, 0xf2, 0x17, 0x42, 0xd8, 0xdb, 0x00, 0x01,  0x00, 0xab, 0x27, 0x0f, 0x01, 0x4f, 0x30, 0x17,  /* O..B......'..O0. */
+    0xdc, 0xc9, 0x07, 0x15, 0x00, 0x00, 0x25, 0x00,  0x81, 0xfc, 0x4d, 0xb2, 0x65, 0x6e, 0x67, 0x0d,  /* ......%...M.eng. */
+    0x05, 0x4d, 0x6f, 0x6e, 0x65, 0x79, 0x62, 0x72,  0x6f, 0x74, 0x68, 0x65, 0x72, 0xa0, 0x05, 0x44,  /* .Moneybrother..D */
+    0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x61,  0x72, 0x79, 0x20, 0x73, 0x65, 0x72, 0x69, 0x65,  /* ocumentary serie */
+    0x73, 0x20, 0x6f, 0x6e, 0x20, 0x53, 0x77, 0x65,  0x64, 0x65, 0x6e, 0x27, 0x73, 0x20, 0x41, 0x6e,  /* s on Sweden's An */
+    0x64, 0x65, 0x72, 0x73, 0x20, 0x57, 0x65, 0x6e,  0x64, 0x69, 0x6e, 0x20, 0x61, 0x6e, 0x64, 0x20,  /* ders Wendin and  */
+    0x74, 0x68, 0x65, 0x20, 0x6d, 0x61, 0x6b, 0x69,  0x6e, 0x67, 0x20, 0x6f, 0x66, 0x20, 0x68, 0x69,  /* the making of hi */
+    0x73, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x61, 0x6c,  0x62, 0x75, 0x6d, 0x2e, 0x20, 0x54, 0x68, 0x69,  /* s new album. Thi */
+    0x73, 0x20, 0x65, 0x70, 0x69, 0x73, 0x6f, 0x64,  0x65, 0x20, 0x73, 0x68, 0x6f, 0x77, 0x73, 0x20,  /* s episode shows  */
+    0x74, 0x68, 0x65, 0x20, 0x70, 0x72, 0x65, 0x70,  0x61, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20,  /* the preparation  */
+    0x69, 0x6e, 0x20, 0x53, 0x74, 0x6f, 0x63, 0x6b,  0x68, 0x6f, 0x6c, 0x6d, 0x20, 0x61, 0x6e, 0x64,  /* in Stockholm and */
+    0x20, 0x72, 0x65, 0x63, 0x6f, 0x72, 0x64, 0x69,  0x6e, 0x67, 0x73, 0x20, 0x69, 0x6e, 0x20, 0x43,  /*  recordings in C */
+    0x68, 0x69, 0x63, 0x61, 0x67, 0x6f, 0x20, 0x61,  0x6e, 0x64, 0x20, 0x4c, 0x41, 0x2e, 0x4d, 0xc7,  /* hicago and LA.M. */
+    0x67, 0x65, 0x72, 0x0d, 0x05, 0x4d, 0x6f, 0x6e,  0x65, 0x79, 0x62, 0x72, 0x6f, 0x74, 0x68, 0x65,  /* ger..Moneybrothe */
+    0x72, 0xb5, 0x05, 0x44, 0x69, 0x65, 0x73, 0x65,  0x20, 0x46, 0x6f, 0x6c, 0x67, 0x65, 0x20, 0x64,  /* r..Diese Folge d */
+    0x65, 0x73, 0x20, 0x4d, 0x75, 0x73, 0x69, 0x6b,  0x6d, 0x61, 0x67, 0x61, 0x7a, 0x69, 0x6e, 0x73,  /* es Musikmagazins */
+    0x20, 0x6d, 0x69, 0x74, 0x20, 0x64, 0x65, 0x6d,  0x20, 0x73, 0x63, 0x68, 0x77, 0x65, 0x64, 0x69,  /*  mit dem schwedi */
+    0x73, 0x63, 0x68, 0x65, 0x6e, 0x20, 0x4d, 0x75,  0x73, 0x69, 0x6b, 0x65, 0x72, 0x20, 0x41, 0x6e,  /* schen Musiker An */
+    0x64, 0x65, 0x72, 0x73, 0x20, 0x57, 0x65, 0x6e,  0x64, 0x69, 0x6e, 0x20, 0x61, 0x2e, 0x6b, 0x2e,  /* ders Wendin a.k. */
+    0x61, 0x2e, 0x20, 0x4d, 0x6f, 0x6e, 0x65, 0x79,  0x62, 0x72, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x20,  /* a. Moneybrother  */
+    0x7a, 0x65, 0x69, 0x67, 0x74, 0x20, 0x64, 0x69,  0x65, 0x20, 0x56, 0x6f, 0x72, 0x62, 0x65, 0x72,  /* zeigt die Vorber */
+    0x65, 0x69, 0x74, 0x75, 0x6e, 0x67, 0x65, 0x6e,  0x20, 0x69, 0x6e, 0x20, 0x53, 0x74, 0x6f, 0x63,  /* eitungen in Stoc */
+    0x6b, 0x68, 0x6f, 0x6c, 0x6d, 0x20, 0x75, 0x6e,  0x64, 0x20, 0x64, 0x69, 0x65, 0x20, 0x65, 0x72,  /* kholm und die er */
+    0x73, 0x74, 0x65, 0x6e, 0x20, 0x41, 0x75, 0x66,  0x6e, 0x61, 0x68, 0x6d, 0x65, 0x6e, 0x20, 0x43,  /* sten Aufnahmen C */
+    0x68, 0x69, 0x63, 0x61, 0x67, 0x6f, 0x20, 0x75,  0x6e, 0x64, 0x20, 0x4c, 0x6f, 0x73, 0x20, 0x41,  /* hicago und Los A */
+    0x6e, 0x67, 0x65, 0x6c, 0x65, 0x73, 0x2e, 0x76,  0x73, 0x04, 0x40, 0x65, 0x76, 0x65, 0x6e, 0x74,  /* ngeles.vs.@event */
+    0x69, 0x73, 0x2e, 0x6e, 0x6c, 0x2f, 0x30, 0x30,  0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x2d, 0x30,  /* is.nl/00000000-0 */
+    0x30, 0x30, 0x30, 0x2d, 0x31, 0x30, 0x30, 0x30,  0x2d, 0x30, 0x36, 0x30, 0x34, 0x2d, 0x30, 0x30,  /* 000-1000-0604-00 */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x45, 0x30, 0x37,  0x31, 0x31, 0x23, 0x30, 0x30, 0x31, 0x30, 0x33,  /* 00000E0711#00103 */
+    0x38, 0x39, 0x39, 0x30, 0x30, 0x30, 0x30, 0x32,  0x30, 0x31, 0x37, 0x08, 0x2f, 0x65, 0x76, 0x65,  /* 89900002017./eve */
+    0x6e, 0x74, 0x69, 0x73, 0x2e, 0x6e, 0x6c, 0x2f,  0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,  /* ntis.nl/00000000 */
+    0x2d, 0x30, 0x30, 0x30, 0x30, 0x2d, 0x31, 0x30,  0x30, 0x30, 0x2d, 0x30, 0x36, 0x30, 0x38, 0x2d,  /* -0000-1000-0608- */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,  0x33, 0x46, 0x39, 0x43, 0x55, 0x04, 0x44, 0x45,  /* 000000003F9CU.DE */
+    0x55, 0x00, 0x54, 0x02, 0x23, 0x00, 0x3b, 0xf9,  0x94, 0xa5                                       /* U.T.#.;...       */
+};
+
+// Counts the PATs MPEGStreamData decodes and the repeats it only
+// signals, and exposes how many of them it dropped before decoding
+class PATCounter : public MPEGStreamData, public MPEGStreamListener,
+                   public MPEGSingleProgramStreamListener
+{
+  public:
+    PATCounter() : MPEGStreamData(-1, -1, false), pats(0), heartbeats(0)
+    {
+        AddMPEGListener(this);
+        AddMPEGSPListener(this);
+    }
+
+    void HandlePAT(const ProgramAssociationTable*) { pats++; }
+    void HandleCAT(const ConditionalAccessTable*) { }
+    void HandlePMT(uint, const ProgramMapTable*) { }
+    void HandleEncryptionStatus(uint, bool) { }
+    void HandleSingleProgramPAT(ProgramAssociationTable*, bool) { heartbeats++; }
+    void HandleSingleProgramPMT(ProgramMapTable*, bool) { }
+
+    uint Dropped(uint table_id) const { return _section_drops[table_id]; }
+
+    uint pats;
+    uint heartbeats;
+};
+
 class TestMPEGTables: public QObject
 {
     Q_OBJECT
@@ -36,14 +110,7 @@ class TestMPEGTables: public QObject
   private slots:
     void pat_test(void)
     {
-        const unsigned char si_data[] = {
-            0x00, 0xb0, 0x31, 0x04, 0x37, 0xdf, 0x00, 0x00,  0x2b, 0x66, 0xf7, 0xd4, 0x6d, 0x66, 0xe0, 0x64,  /* ..1.7...+f..mf.d */
-            0x6d, 0x67, 0xe0, 0xc8, 0x6d, 0x68, 0xe1, 0x2c,  0x6d, 0x6b, 0xe2, 0x58, 0x6d, 0x6c, 0xe2, 0xbc,  /* mg..mh.,mk.Xml.. */
-            0x6d, 0x6d, 0xe3, 0x20, 0x6d, 0x6e, 0xe2, 0x8a,  0x6d, 0x70, 0xe4, 0x4c, 0x6d, 0x71, 0xe1, 0x9b,  /* mm. mn..mp.Lmq.. */
-            0xc0, 0x79, 0xa6, 0x2b                                                                            /* .y.+ */
-        };
-
-        PSIPTable si_table(si_data);
+        PSIPTable si_table(pat_data);
 
         QVERIFY  (si_table.IsGood());
 
@@ -104,6 +171,75 @@ class TestMPEGTables: public QObject
         QCOMPARE (pat.FindAnyPID(),        (uint32_t)  6100);
     }
 
+    void crc_test(void)
+    {
+        const char check[] = "123456789";
+        QCOMPARE (mpeg_crc32((const unsigned char*)check, 9), 0x0376e6e7U);
+
+        PSIPTable pat(pat_data);
+        QCOMPARE (mpeg_crc32(pat_data, pat.SectionLength() - 4), pat.CRC());
+        QCOMPARE (mpeg_crc32(pat_data, pat.SectionLength()), 0U);
+
+        PSIPTable eit(eit_data);
+        QVERIFY  (eit.IsGood());
+        QCOMPARE (eit.SectionLength(), (uint) sizeof(eit_data));
+        QCOMPARE (mpeg_crc32(eit_data, sizeof(eit_data)), 0U);
+    }
+
+    // The CRC of the largest section we have, as checked for every
+    // section in the stream
+    void crc_benchmark(void)
+    {
+        volatile uint crc;
+        QBENCHMARK
+        {
+            crc = mpeg_crc32(eit_data, sizeof(eit_data));
+        }
+        Q_UNUSED(crc);
+    }
+
+    // A PAT repeated in the stream is only decoded once, the repeats are
+    // dropped before a PSIPTable is built but still signalled
+    void repeated_section_test(void)
+    {
+        TSPacket *packet = TSPacket::CreatePayloadOnlyPacket();
+        unsigned char *section = packet->data() + 5;
+        memcpy(section, pat_data, sizeof(pat_data));
+
+        PATCounter sd;
+        for (uint i = 0; i < 3; i++)
+        {
+            packet->SetContinuityCounter(i);
+            sd.HandleTSTables(packet);
+        }
+        QCOMPARE (sd.pats,                   1U);
+        QCOMPARE (sd.heartbeats,             2U);
+        QCOMPARE (sd.Dropped(TableID::PAT),  2U);
+
+        // a corrupted repeat must fail the CRC check, not be dropped
+        section[9] ^= 0x01;
+        sd.HandleTSTables(packet);
+        section[9] ^= 0x01;
+        QCOMPARE (sd.pats,                   1U);
+        QCOMPARE (sd.heartbeats,             2U);
+        QCOMPARE (sd.Dropped(TableID::PAT),  2U);
+
+        // a new version is decoded
+        section[5] = 0xc1;
+        uint crc = mpeg_crc32(section, sizeof(pat_data) - 4);
+        section[sizeof(pat_data) - 4] = crc >> 24;
+        section[sizeof(pat_data) - 3] = crc >> 16;
+        section[sizeof(pat_data) - 2] = crc >> 8;
+        section[sizeof(pat_data) - 1] = crc;
+        sd.HandleTSTables(packet);
+        sd.HandleTSTables(packet);
+        QCOMPARE (sd.pats,                   2U);
+        QCOMPARE (sd.heartbeats,             3U);
+        QCOMPARE (sd.Dropped(TableID::PAT),  3U);
+
+        delete packet;
+    }
+
     void dvbdate(void)
     {
         unsigned char dvbdate_data[] = {
@@ -150,43 +286,6 @@ class TestMPEGTables: public QObject
 
     void ContentIdentifierDescriptor_test(void)
     {
-        const unsigned char eit_data[] = {
-            0x4f, 0xf2, 0x17, 0x42, 0xd8, 0xdb, 0x00, 0x01,  0x00, 0xab, 0x27, 0x0f, 0x01, 0x4f, 0x30, 0x17,  /* O..B......'..O0. */
-            0xdc, 0xc9, 0x07, 0x15, 0x00, 0x00, 0x25, 0x00,  0x81, 0xfc, 0x4d, 0xb2, 0x65, 0x6e, 0x67, 0x0d,  /* ......%...M.eng. */
-            0x05, 0x4d, 0x6f, 0x6e, 0x65, 0x79, 0x62, 0x72,  0x6f, 0x74, 0x68, 0x65, 0x72, 0xa0, 0x05, 0x44,  /* .Moneybrother..D */
-            0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x61,  0x72, 0x79, 0x20, 0x73, 0x65, 0x72, 0x69, 0x65,  /* ocumentary serie */
-            0x73, 0x20, 0x6f, 0x6e, 0x20, 0x53, 0x77, 0x65,  0x64, 0x65, 0x6e, 0x27, 0x73, 0x20, 0x41, 0x6e,  /* s on Sweden's An */
-            0x64, 0x65, 0x72, 0x73, 0x20, 0x57, 0x65, 0x6e,  0x64, 0x69, 0x6e, 0x20, 0x61, 0x6e, 0x64, 0x20,  /* ders Wendin and  */
-            0x74, 0x68, 0x65, 0x20, 0x6d, 0x61, 0x6b, 0x69,  0x6e, 0x67, 0x20, 0x6f, 0x66, 0x20, 0x68, 0x69,  /* the making of hi */
-            0x73, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x61, 0x6c,  0x62, 0x75, 0x6d, 0x2e, 0x20, 0x54, 0x68, 0x69,  /* s new album. Thi */
-            0x73, 0x20, 0x65, 0x70, 0x69, 0x73, 0x6f, 0x64,  0x65, 0x20, 0x73, 0x68, 0x6f, 0x77, 0x73, 0x20,  /* s episode shows  */
-            0x74, 0x68, 0x65, 0x20, 0x70, 0x72, 0x65, 0x70,  0x61, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20,  /* the preparation  */
-            0x69, 0x6e, 0x20, 0x53, 0x74, 0x6f, 0x63, 0x6b,  0x68, 0x6f, 0x6c, 0x6d, 0x20, 0x61, 0x6e, 0x64,  /* in Stockholm and */
-            0x20, 0x72, 0x65, 0x63, 0x6f, 0x72, 0x64, 0x69,  0x6e, 0x67, 0x73, 0x20, 0x69, 0x6e, 0x20, 0x43,  /*  recordings in C */
-            0x68, 0x69, 0x63, 0x61, 0x67, 0x6f, 0x20, 0x61,  0x6e, 0x64, 0x20, 0x4c, 0x41, 0x2e, 0x4d, 0xc7,  /* hicago and LA.M. */
-            0x67, 0x65, 0x72, 0x0d, 0x05, 0x4d, 0x6f, 0x6e,  0x65, 0x79, 0x62, 0x72, 0x6f, 0x74, 0x68, 0x65,  /* ger..Moneybrothe */
-            0x72, 0xb5, 0x05, 0x44, 0x69, 0x65, 0x73, 0x65,  0x20, 0x46, 0x6f, 0x6c, 0x67, 0x65, 0x20, 0x64,  /* r..Diese Folge d */
-            0x65, 0x73, 0x20, 0x4d, 0x75, 0x73, 0x69, 0x6b,  0x6d, 0x61, 0x67, 0x61, 0x7a, 0x69, 0x6e, 0x73,  /* es Musikmagazins */
-            0x20, 0x6d, 0x69, 0x74, 0x20, 0x64, 0x65, 0x6d,  0x20, 0x73, 0x63, 0x68, 0x77, 0x65, 0x64, 0x69,  /*  mit dem schwedi */
-            0x73, 0x63, 0x68, 0x65, 0x6e, 0x20, 0x4d, 0x75,  0x73, 0x69, 0x6b, 0x65, 0x72, 0x20, 0x41, 0x6e,  /* schen Musiker An */
-            0x64, 0x65, 0x72, 0x73, 0x20, 0x57, 0x65, 0x6e,  0x64, 0x69, 0x6e, 0x20, 0x61, 0x2e, 0x6b, 0x2e,  /* ders Wendin a.k. */
-            0x61, 0x2e, 0x20, 0x4d, 0x6f, 0x6e, 0x65, 0x79,  0x62, 0x72, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x20,  /* a. Moneybrother  */
-            0x7a, 0x65, 0x69, 0x67, 0x74, 0x20, 0x64, 0x69,  0x65, 0x20, 0x56, 0x6f, 0x72, 0x62, 0x65, 0x72,  /* zeigt die Vorber */
-            0x65, 0x69, 0x74, 0x75, 0x6e, 0x67, 0x65, 0x6e,  0x20, 0x69, 0x6e, 0x20, 0x53, 0x74, 0x6f, 0x63,  /* eitungen in Stoc */
-            0x6b, 0x68, 0x6f, 0x6c, 0x6d, 0x20, 0x75, 0x6e,  0x64, 0x20, 0x64, 0x69, 0x65, 0x20, 0x65, 0x72,  /* kholm und die er */
-            0x73, 0x74, 0x65, 0x6e, 0x20, 0x41, 0x75, 0x66,  0x6e, 0x61, 0x68, 0x6d, 0x65, 0x6e, 0x20, 0x43,  /* sten Aufnahmen C */
-            0x68, 0x69, 0x63, 0x61, 0x67, 0x6f, 0x20, 0x75,  0x6e, 0x64, 0x20, 0x4c, 0x6f, 0x73, 0x20, 0x41,  /* hicago und Los A */
-            0x6e, 0x67, 0x65, 0x6c, 0x65, 0x73, 0x2e, 0x76,  0x73, 0x04, 0x40, 0x65, 0x76, 0x65, 0x6e, 0x74,  /* ngeles.vs.@event */
-            0x69, 0x73, 0x2e, 0x6e, 0x6c, 0x2f, 0x30, 0x30,  0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x2d, 0x30,  /* is.nl/00000000-0 */
-            0x30, 0x30, 0x30, 0x2d, 0x31, 0x30, 0x30, 0x30,  0x2d, 0x30, 0x36, 0x30, 0x34, 0x2d, 0x30, 0x30,  /* 000-1000-0604-00 */
-            0x30, 0x30, 0x30, 0x30, 0x30, 0x45, 0x30, 0x37,  0x31, 0x31, 0x23, 0x30, 0x30, 0x31, 0x30, 0x33,  /* 00000E0711#00103 */
-            0x38, 0x39, 0x39, 0x30, 0x30, 0x30, 0x30, 0x32,  0x30, 0x31, 0x37, 0x08, 0x2f, 0x65, 0x76, 0x65,  /* 89900002017./eve */
-            0x6e, 0x74, 0x69, 0x73, 0x2e, 0x6e, 0x6c, 0x2f,  0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,  /* ntis.nl/00000000 */
-            0x2d, 0x30, 0x30, 0x30, 0x30, 0x2d, 0x31, 0x30,  0x30, 0x30, 0x2d, 0x30, 0x36, 0x30, 0x38, 0x2d,  /* -0000-1000-0608- */
-            0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,  0x33, 0x46, 0x39, 0x43, 0x55, 0x04, 0x44, 0x45,  /* 000000003F9CU.DE */
-            0x55, 0x00, 0x54, 0x02, 0x23, 0x00, 0x3b, 0xf9,  0x94, 0xa5                                       /* U.T.#.;...       */
-        };
-
         /* pick just the ContentIdentifierDescriptor from the event_information_section */
         DVBContentIdentifierDescriptor descriptor(&eit_data[407]);
 
@@ -204,4 +303,70 @@ class TestMPEGTables: public QObject
         QCOMPARE (descriptor2.ContentId(), QString("eventis.nl/00000000-0000-1000-0608-000000003F9C"));
         QCOMPARE (descriptor.ContentId(1), QString("eventis.nl/00000000-0000-1000-0608-000000003F9C"));
     }
+    void dvb_text_test(void)
+    {
+        // ISO 8859-9 from the encoding byte
+        const unsigned char turkish[] = { 0x05, 0x4d, 0x61, 0x63, 0xfd };
+        QCOMPARE (dvb_decode_text(turkish, sizeof(turkish)),
+                  QString::fromUtf8("Mac\xc4\xb1"));
+        // ISO 8859-5
+        const unsigned char cyrillic[] = { 0x01, 0xc0, 0xde, 0xe1 };
+        QCOMPARE (dvb_decode_text(cyrillic, sizeof(cyrillic)),
+                  QString::fromUtf8("\xd0\xa0\xd0\xbe\xd1\x81"));
+        // ISO 8859-2 from the three byte form
+        const unsigned char polish[] = { 0x10, 0x00, 0x02, 0xb1, 0x6c };
+        QCOMPARE (dvb_decode_text(polish, sizeof(polish)),
+                  QString::fromUtf8("\xc4\x85l"));
+        // ISO 6937, accent then letter, and formatting characters
+        const unsigned char french[] = { 0x43, 0x61, 0x66, 0xc2, 0x65, 0x8a,
+                                         0x86, 0x42, 0x61, 0x72, 0x87 };
+        QCOMPARE (dvb_decode_text(french, sizeof(french)),
+                  QString::fromUtf8("Caf\xc3\xa9 Bar"));
+        // ISO 6937 text sent with an override to ISO 8859-9
+        const unsigned char override[] = { 0x05 };
+        QCOMPARE (dvb_decode_text(&turkish[1], sizeof(turkish) - 1,
+                                  override, sizeof(override)),
+                  QString::fromUtf8("Mac\xc4\xb1"));
+        QCOMPARE (dvb_decode_text(&turkish[1], sizeof(turkish) - 1),
+                  QString::fromUtf8("Mac\xc5\xa7"));
+
+        // the same text again comes from the cache
+        ShortEventDescriptor event(&eit_data[26]);
+        QCOMPARE (event.Name(), QString("Moneybrother"));
+        QCOMPARE (event.Name(), QString("Moneybrother"));
+        QVERIFY  (event.Text().startsWith("Documentary series on Sweden's"));
+    }
+
+    void dvb_text_benchmark_data(void)
+    {
+        QTest::addColumn<bool>("repeated");
+        QTest::newRow("new events")      << false;
+        QTest::newRow("repeated events") << true;
+    }
+
+    // Decoding the name and description of the short event descriptor of
+    // the EIT above, as the carousel sends it again and again, and for
+    // events the text of which has not been seen before
+    void dvb_text_benchmark(void)
+    {
+        QFETCH(bool, repeated);
+
+        QByteArray descriptor((const char*)&eit_data[26], eit_data[27] + 2);
+        unsigned char *data = (unsigned char*)descriptor.data();
+        uint last = descriptor.size() - 1;
+        uint serial = 0;
+
+        QBENCHMARK
+        {
+            if (!repeated)
+            {
+                serial++;
+                data[last - 1] = 0x20 + (serial % 90);
+                data[last]     = 0x20 + (serial / 90 % 90);
+            }
+            ShortEventDescriptor event(data);
+            event.Name();
+            event.Text();
+        }
+    }
 };
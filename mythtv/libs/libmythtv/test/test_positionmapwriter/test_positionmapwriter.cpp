@@ -0,0 +1,3 @@
+#include "test_positionmapwriter.h"
+
+QTEST_APPLESS_MAIN(TestPositionMapWriter)
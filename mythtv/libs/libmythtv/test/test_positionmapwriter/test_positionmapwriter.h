@@ -0,0 +1,185 @@
+/*
+ *  Class TestPositionMapWriter
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QPair>
+
+#include "positionmapwriter.h"
+
+typedef QPair<uint, quint64> WrittenRow; // chanid, mark
+
+/// Writer that records the rows it is given instead of using the database
+class FakeWriter : public PositionMapWriter
+{
+  public:
+    /// Fails the first \p failures writes, and never writes rows of
+    /// \p bad_chanid
+    static FakeWriter *Start(uint failures = 0, uint bad_chanid = 0)
+    {
+        FakeWriter *writer = new FakeWriter(failures, bad_chanid);
+        StartWriter(writer);
+        return writer;
+    }
+
+    ~FakeWriter()
+    {
+        Stop();
+    }
+
+    uint Calls(void)
+    {
+        QMutexLocker locker(&m_fakeLock);
+        return m_calls;
+    }
+
+    QList<WrittenRow> Written(void)
+    {
+        QMutexLocker locker(&m_fakeLock);
+        return m_written;
+    }
+
+  protected:
+    int WriteRows(const QList<Row> &rows)
+    {
+        QMutexLocker locker(&m_fakeLock);
+
+        if (++m_calls <= m_failures)
+            return 0;
+
+        int handled = 0;
+        for (; handled < rows.size(); handled++)
+        {
+            if (rows[handled].chanid == m_badChanid)
+                break;
+            m_written << WrittenRow(rows[handled].chanid,
+                                    rows[handled].mark);
+        }
+        return handled;
+    }
+
+  private:
+    // Long enough that nothing is written before Flush()
+    FakeWriter(uint failures, uint bad_chanid) :
+        PositionMapWriter(60 * 1000),
+        m_failures(failures), m_badChanid(bad_chanid), m_calls(0) {}
+
+    QMutex            m_fakeLock;
+    uint              m_failures;
+    uint              m_badChanid;
+    uint              m_calls;
+    QList<WrittenRow> m_written;
+};
+
+class TestPositionMapWriter : public QObject
+{
+    Q_OBJECT
+
+    QDateTime m_recstartts;
+
+    // Queues marks [first, first + count) of a recording on \p chanid
+    void enqueue(uint chanid, uint first, uint count)
+    {
+        frm_pos_map_t map;
+        for (uint i = first; i < first + count; i++)
+            map[i] = i * 1000;
+        QVERIFY(PositionMapWriter::Enqueue(chanid, m_recstartts,
+                                           MARK_GOP_BYFRAME, map));
+    }
+
+    static QList<WrittenRow> expected(uint chanid, uint first, uint count)
+    {
+        QList<WrittenRow> rows;
+        for (uint i = first; i < first + count; i++)
+            rows << WrittenRow(chanid, i);
+        return rows;
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        m_recstartts = QDateTime(QDate(2014, 1, 1), QTime(20, 0), Qt::UTC);
+    }
+
+    void cleanup(void)
+    {
+        PositionMapWriter::TeardownPositionMapWriter();
+    }
+
+    void NoWriter(void)
+    {
+        frm_pos_map_t map;
+        map[0] = 0;
+        QVERIFY(!PositionMapWriter::Enqueue(1001, m_recstartts,
+                                            MARK_GOP_BYFRAME, map));
+        QVERIFY(PositionMapWriter::Flush(100));
+    }
+
+    void GroupsRowsByRecording(void)
+    {
+        FakeWriter *writer = FakeWriter::Start();
+
+        // Two recorders taking turns, as they do in the backend
+        enqueue(1001, 0, 3);
+        enqueue(1002, 0, 3);
+        enqueue(1001, 3, 3);
+        enqueue(1002, 3, 3);
+
+        uint pending = 0, lag = 0;
+        QVERIFY(PositionMapWriter::GetLag(pending, lag));
+        QCOMPARE(pending, 12U);
+
+        QVERIFY(PositionMapWriter::Flush(5000));
+        QCOMPARE(writer->Calls(), 1U);
+        QCOMPARE(writer->Written(),
+                 expected(1001, 0, 6) + expected(1002, 0, 6));
+
+        QVERIFY(PositionMapWriter::GetLag(pending, lag));
+        QCOMPARE(pending, 0U);
+    }
+
+    void RetriesFailedWrites(void)
+    {
+        FakeWriter *writer = FakeWriter::Start(2);
+
+        enqueue(1001, 0, 10);
+
+        QVERIFY(PositionMapWriter::Flush(10000));
+        QCOMPARE(writer->Calls(), 3U);
+        QCOMPARE(writer->Written(), expected(1001, 0, 10));
+    }
+
+    void GivesUpOnFailingRecording(void)
+    {
+        FakeWriter *writer = FakeWriter::Start(0, 1001);
+
+        enqueue(1001, 0, 5);
+        enqueue(1002, 0, 5);
+        enqueue(1001, 5, 5);
+
+        // Three failed attempts on 1001's rows, then 1002's are written
+        QVERIFY(PositionMapWriter::Flush(10000));
+        QCOMPARE(writer->Calls(), 4U);
+        QCOMPARE(writer->Written(), expected(1002, 0, 5));
+
+        uint pending = 0, lag = 0;
+        QVERIFY(PositionMapWriter::GetLag(pending, lag));
+        QCOMPARE(pending, 0U);
+    }
+};
@@ -345,6 +345,14 @@ bool TV::StartTV(ProgramInfo *tvrec, uint flags,
         return false;
     }
 
+    // A player without video output doesn't open the audio device either
+    if (flags & kStartTVNullOutput)
+    {
+        PlayerContext *mctx = tv->GetPlayerWriteLock(0, __FILE__, __LINE__);
+        mctx->SetNullVideo(true);
+        tv->ReturnPlayerLock(mctx);
+    }
+
     if (!lastProgramStringList.empty())
     {
         ProgramInfo pginfo(lastProgramStringList);
@@ -5573,7 +5581,7 @@ bool TV::StartPlayer(PlayerContext *mctx, PlayerContext *ctx,
     {
         ok = ctx->CreatePlayer(this, NULL, desiredState, false);
         ScheduleStateChange(ctx);
-        if (ok)
+        if (ok && ctx != mctx)
             ok = PIPAddPlayer(mctx, ctx);
     }
     else
@@ -7521,6 +7529,9 @@ void TV::ChangeChannel(PlayerContext *ctx, ChannelChangeDirection direction)
     if (direction == CHANNEL_DIRECTION_FAVORITE)
         direction = CHANNEL_DIRECTION_UP;
 
+    ctx->zapTrace.Start(
+        (direction == CHANNEL_DIRECTION_DOWN) ? "channel down" : "channel up");
+
     QString oldinputname = ctx->recorder->GetInput();
 
     if (ContextIsPaused(ctx, __FILE__, __LINE__))
@@ -7545,6 +7556,7 @@ void TV::ChangeChannel(PlayerContext *ctx, ChannelChangeDirection direction)
     ctx->UnlockDeletePlayer(__FILE__, __LINE__);
 
     ctx->recorder->ChangeChannel(direction);
+    ctx->zapTrace.Mark("sent to backend");
     ClearInputQueues(ctx, false);
 
     if (ctx->player)
@@ -7707,6 +7719,8 @@ void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan)
     if (getit || !ctx->recorder || !ctx->recorder->CheckChannel(channum))
         return;
 
+    ctx->zapTrace.Start(channum);
+
     if (ContextIsPaused(ctx, __FILE__, __LINE__))
     {
         HideOSDWindow(ctx, "osd_status");
@@ -7729,6 +7743,7 @@ void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan)
     ctx->UnlockDeletePlayer(__FILE__, __LINE__);
 
     ctx->recorder->SetChannel(channum);
+    ctx->zapTrace.Mark("sent to backend");
 
     if (ctx->player)
         ctx->player->GetAudio()->Reset();
@@ -12842,6 +12857,7 @@ void TV::PauseLiveTV(PlayerContext *ctx)
         ctx->buffer->StopReads();
         ctx->player->PauseDecoder();
         ctx->buffer->StartReads();
+        ctx->zapTrace.Mark("decoder paused");
     }
     ctx->UnlockDeletePlayer(__FILE__, __LINE__);
 
@@ -117,6 +117,7 @@ enum {
     kStartTVInPlayList       = 0x02,
     kStartTVByNetworkCommand = 0x04,
     kStartTVIgnoreBookmark   = 0x08,
+    kStartTVNullOutput       = 0x10, ///< No video or audio output, for tests
 };
 
 class AskProgramInfo
@@ -15,6 +15,7 @@
 #include "mythsystemevent.h"
 #include "atscstreamdata.h"
 #include "dvbstreamdata.h"
+#include "mpegtablecache.h"
 #include "recordingrule.h"
 #include "channelgroup.h"
 #include "storagegroup.h"
@@ -84,6 +85,8 @@ TVRec::TVRec(int capturecardnum)
        // Various components TVRec coordinates
     : recorder(NULL), channel(NULL), signalMonitor(NULL),
       scanner(NULL),
+      zapTrace(QString("Recorder %1").arg(capturecardnum)),
+      tablesFromCache(false),
       // Various threads
       eventThread(new MThread("TVRecEvent", this)),
       recorderThread(NULL),
@@ -1819,6 +1822,13 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
         sd->SetCaching(true);
     }
 
+    tableCacheKey.clear();
+    tablesFromCache = false;
+
+    // Tables from the last time we were on the channel let LiveTV start
+    // as soon as we have a lock, the live ones replace them later.
+    bool use_cache = !EITscan && (internalState == kState_WatchingLiveTV);
+
     QString recording_type = "all";
     RecordingInfo *rec = lastTuningRequest.program;
     RecordingProfile profile;
@@ -1899,6 +1909,11 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
             sm->IgnoreEncrypted(true);
         }
 
+        tableCacheKey = MPEGTableCache::Key(
+            channel->GetCurrentSourceID(), channel->GetCurrentName(), progNum);
+        if (use_cache)
+            tablesFromCache = MPEGTableCache::Apply(tableCacheKey, sd);
+
         LOG(VB_RECORD, LOG_INFO, LOC +
             "Successfully set up DVB table monitoring.");
         return true;
@@ -1936,6 +1951,11 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
             sm->IgnoreEncrypted(true);
         }
 
+        tableCacheKey = MPEGTableCache::Key(
+            channel->GetCurrentSourceID(), channel->GetCurrentName(), progNum);
+        if (use_cache)
+            tablesFromCache = MPEGTableCache::Apply(tableCacheKey, sd);
+
         LOG(VB_RECORD, LOG_INFO, LOC +
             "Successfully set up MPEG table monitoring.");
         return true;
@@ -2821,6 +2841,10 @@ void TVRec::SetLiveRecording(int recording)
         recstat = curRecording->GetRecordingStatus();
         curRecording->SetRecordingGroup("Default");
         InitAutoRunJobs(curRecording, kAutoRunProfile, NULL, __LINE__);
+
+        // Write what is still held in RAM to disk
+        if (ringBuffer)
+            ringBuffer->WriterSetTimeshift(0);
     }
 
     MythEvent me(QString("UPDATE_RECORDING_STATUS %1 %2 %3 %4 %5")
@@ -3517,6 +3541,11 @@ void TVRec::HandleTuning(void)
         request.channel = TuningGetChanNum(request, input);
         request.input   = input;
 
+        if (request.flags & kFlagLiveTV)
+            zapTrace.Start(request.channel);
+        else
+            zapTrace.Cancel();
+
         if (TuningOnSameMultiplex(request))
             LOG(VB_PLAYBACK, LOG_INFO, LOC + "On same multiplex");
 
@@ -3567,6 +3596,8 @@ void TVRec::HandleTuning(void)
         else
             TuningNewRecorder(streamData);
 
+        zapTrace.Mark("recorder started");
+
         // If we got this far it is safe to set a new starting channel...
         if (channel)
             channel->StoreInputChannels();
@@ -3622,6 +3653,10 @@ void TVRec::TuningShutdowns(const TuningRequest &request)
     QString channum, inputname;
     uint newCardID = TuningCheckForHWChange(request, channum, inputname);
 
+    // By now the recorder has seen the live tables of the old channel
+    if (GetDTVRecorder() && !tableCacheKey.isEmpty())
+        MPEGTableCache::Save(tableCacheKey, GetDTVRecorder()->GetStreamData());
+
     if (scanner && !(request.flags & kFlagEITScan) &&
         HasFlags(kFlagEITScannerRunning))
     {
@@ -3779,6 +3814,8 @@ void TVRec::TuningFrequency(const TuningRequest &request)
     else
         ok = true;
 
+    zapTrace.Mark("tuned");
+
     if (!ok)
     {
         if (!(request.flags & kFlagLiveTV) || !(request.flags & kFlagEITScan))
@@ -3916,9 +3953,14 @@ void TVRec::TuningFrequency(const TuningRequest &request)
 MPEGStreamData *TVRec::TuningSignalCheck(void)
 {
     RecStatusType newRecStatus = rsRecording;
+
+    if (zapTrace.IsActive() && signalMonitor->HasSignalLock())
+        zapTrace.Mark("signal lock");
+
     if (signalMonitor->IsAllGood())
     {
         LOG(VB_RECORD, LOG_INFO, LOC + "TuningSignalCheck: Have a good signal");
+        zapTrace.Mark(tablesFromCache ? "tables (cached)" : "tables");
     }
     else if (signalMonitor->IsErrored() ||
              MythDate::current() > signalMonitorDeadline)
@@ -3926,6 +3968,10 @@ MPEGStreamData *TVRec::TuningSignalCheck(void)
         LOG(VB_RECORD, LOG_ERR, LOC + "TuningSignalCheck: SignalMonitor " +
             (signalMonitor->IsErrored() ? "failed" : "timed out"));
 
+        if (tablesFromCache)
+            MPEGTableCache::Remove(tableCacheKey);
+        zapTrace.Cancel();
+
         ClearFlags(kFlagNeedToStartRecorder);
         newRecStatus = rsFailed;
 
@@ -3972,6 +4018,9 @@ MPEGStreamData *TVRec::TuningSignalCheck(void)
     if (GetDTVSignalMonitor())
         streamData = GetDTVSignalMonitor()->GetStreamData();
 
+    if (newRecStatus == rsRecording && !tableCacheKey.isEmpty())
+        MPEGTableCache::Save(tableCacheKey, streamData);
+
     if (!HasFlags(kFlagEITScannerRunning))
     {
         // shut down signal monitoring
@@ -4521,6 +4570,15 @@ bool TVRec::GetProgramRingBufferForLiveTV(RecordingInfo **pginfo,
         return false;
     }
 
+    // Serve the live end from RAM, unless the recording is being kept
+    uint ram_mb = gCoreContext->GetNumSetting("LiveTVRAMBufferSize", 0);
+    if (ram_mb && !pseudoLiveTVRecording)
+    {
+        uint ram_secs =
+            gCoreContext->GetNumSetting("LiveTVRAMBufferTime", 0) * 60;
+        (*rb)->WriterSetTimeshift((uint64_t) ram_mb * 1024 * 1024, ram_secs);
+    }
+
     *pginfo = prog;
     return true;
 }
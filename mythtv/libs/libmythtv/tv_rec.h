@@ -11,6 +11,7 @@
 
 // MythTV headers
 #include "mythtimer.h"
+#include "zaptrace.h"
 #include "mthread.h"
 #include "inputinfo.h"
 #include "inputgroupmap.h"
@@ -236,6 +237,9 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
 
     uint GetFlags(void) const { return stateFlags; }
 
+    /// \brief Returns the timing of the current LiveTV channel change
+    ZapTrace &GetZapTrace(void) { return zapTrace; }
+
     static TVRec *GetTVRec(uint cardid);
 
     virtual void AllGood(void) { WakeEventLoop(); }
@@ -332,6 +336,11 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     QDateTime         signalMonitorDeadline;
     uint              signalMonitorCheckCnt;
 
+    // Channel change timing and cached tables
+    ZapTrace          zapTrace;
+    QString           tableCacheKey;
+    bool              tablesFromCache;
+
     // Various threads
     /// Event processing thread, runs TVRec::run().
     MThread          *eventThread;
@@ -0,0 +1,182 @@
+// -*- Mode: c++ -*-
+
+#include <QStringList>
+
+#include "zaptrace.h"
+#include "mythlogging.h"
+
+#define LOC QString("ZapTrace(%1): ").arg(m_name)
+
+/// Finished channel changes kept for GetZapTimes()
+static const int kMaxZapTimes = 10000;
+
+QMutex     ZapTrace::s_lock;
+QList<int> ZapTrace::s_zapTimes;
+
+ZapTrace::ZapTrace(const QString &name) : m_name(name), m_active(0)
+{
+}
+
+/** \brief Starts timing a channel change.
+ *
+ *  A channel change that hasn't finished yet is dropped.
+ */
+void ZapTrace::Start(const QString &channel)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_active.fetchAndStoreOrdered(1))
+    {
+        LOG(VB_CHANNEL, LOG_INFO, LOC +
+            QString("Channel change to %1 abandoned after %2 ms")
+                .arg(m_channel).arg(m_timer.elapsed()));
+    }
+
+    m_channel = channel;
+    m_phases.clear();
+    m_earlyAfter.clear();
+    m_timer.start();
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("Channel change to %1 started")
+        .arg(m_channel));
+}
+
+/** \brief Records that a phase of the channel change has been reached.
+ *
+ *  Only the first time a phase is reached is recorded, and only if the
+ *  phase \p after was recorded before it, so that this can be called for
+ *  every frame to find the first one after the new file was opened.
+ */
+void ZapTrace::Mark(const QString &phase, const QString &after)
+{
+    if (!IsActive())
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    if (!AddPhase(phase, after))
+        return;
+
+    if (!m_earlyAfter.isEmpty() && m_earlyAfter == phase)
+    {
+        m_phases.push_back(m_early);
+        Done();
+    }
+}
+
+/** \brief Records the last phase and logs how long each one took.
+ *
+ *  With \p mayComeFirst the last phase may be reached by another thread
+ *  before the phase it has to come \p after is marked, the recorder can
+ *  write its first keyframe before TVRec gets to mark that it started it.
+ *  The time of the last phase is then kept, and the channel change is
+ *  finished when the phase \p after is marked.  Otherwise the last phase
+ *  is ignored until \p after has been marked.
+ */
+void ZapTrace::Finish(const QString &phase, const QString &after,
+                      bool mayComeFirst)
+{
+    if (!IsActive())
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    if (AddPhase(phase, after))
+    {
+        Done();
+        return;
+    }
+
+    if (!mayComeFirst || !m_timer.isRunning() || after.isEmpty() ||
+        !m_earlyAfter.isEmpty())
+    {
+        return;
+    }
+
+    QList<Phase>::const_iterator it = m_phases.begin();
+    for (; it != m_phases.end(); ++it)
+    {
+        if ((*it).first == phase || (*it).first == after)
+            return;
+    }
+
+    m_early      = Phase(phase, m_timer.elapsed());
+    m_earlyAfter = after;
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("%1: %2 after %3 ms, before %4")
+        .arg(m_channel).arg(phase).arg(m_early.second).arg(after));
+}
+
+/// \brief Logs the phases and the total of a finished channel change,
+///        m_lock must be held.
+void ZapTrace::Done(void)
+{
+    m_active.fetchAndStoreOrdered(0);
+    int total = m_phases.back().second;
+    m_timer.stop();
+    m_earlyAfter.clear();
+
+    QStringList phases;
+    QList<Phase>::const_iterator it = m_phases.begin();
+    for (; it != m_phases.end(); ++it)
+        phases << QString("%1 %2").arg((*it).first).arg((*it).second);
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC +
+        QString("Channel change to %1 took %2 ms (%3)")
+            .arg(m_channel).arg(total).arg(phases.join(", ")));
+
+    QMutexLocker slocker(&s_lock);
+    s_zapTimes.push_back(total);
+    if (s_zapTimes.size() > kMaxZapTimes)
+        s_zapTimes.pop_front();
+}
+
+/// \brief Stops timing without recording the channel change.
+void ZapTrace::Cancel(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_active.fetchAndStoreOrdered(0);
+    m_timer.stop();
+    m_earlyAfter.clear();
+}
+
+/// \brief Returns the total times of the finished channel changes, in ms
+QList<int> ZapTrace::GetZapTimes(void)
+{
+    QMutexLocker locker(&s_lock);
+    return s_zapTimes;
+}
+
+void ZapTrace::ClearZapTimes(void)
+{
+    QMutexLocker locker(&s_lock);
+    s_zapTimes.clear();
+}
+
+/// \brief Adds a phase, m_lock must be held.
+bool ZapTrace::AddPhase(const QString &phase, const QString &after)
+{
+    if (!m_timer.isRunning())
+        return false;
+
+    bool found_after = after.isEmpty();
+    QList<Phase>::const_iterator it = m_phases.begin();
+    for (; it != m_phases.end(); ++it)
+    {
+        if ((*it).first == phase)
+            return false;
+        if ((*it).first == after)
+            found_after = true;
+    }
+
+    if (!found_after)
+        return false;
+
+    int elapsed = m_timer.elapsed();
+    m_phases.push_back(Phase(phase, elapsed));
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("%1: %2 after %3 ms")
+        .arg(m_channel).arg(phase).arg(elapsed));
+
+    return true;
+}
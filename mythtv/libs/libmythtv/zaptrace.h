@@ -0,0 +1,65 @@
+// -*- Mode: c++ -*-
+#ifndef _ZAPTRACE_H_
+#define _ZAPTRACE_H_
+
+#include <QAtomicInt>
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QPair>
+
+#include "mythtvexp.h"
+#include "mythtimer.h"
+
+/** \class ZapTrace
+ *  \brief Times the phases of a channel change.
+ *
+ *  TV and TVRec each keep one, the frontend's runs from the key press to
+ *  the first frame shown, the backend's from the tuning request to the
+ *  first keyframe written.  Each phase is logged with VB_CHANNEL as it
+ *  is reached, and a summary of all of them when the channel change is
+ *  finished.  The total time of the finished channel changes is kept for
+ *  the process, "mythavtest --zaptest" reports percentiles of it.
+ *
+ *  All methods are thread-safe, IsActive() is cheap enough to call for
+ *  every frame.
+ */
+class MTV_PUBLIC ZapTrace
+{
+  public:
+    explicit ZapTrace(const QString &name);
+
+    void Start(const QString &channel);
+    void Mark(const QString &phase, const QString &after = QString());
+    void Finish(const QString &phase, const QString &after = QString(),
+                bool mayComeFirst = false);
+    void Cancel(void);
+
+    /// \brief Returns true between Start() and Finish()
+    bool IsActive(void) const { return m_active.fetchAndAddRelaxed(0); }
+
+    static QList<int> GetZapTimes(void);
+    static void ClearZapTimes(void);
+
+  private:
+    bool AddPhase(const QString &phase, const QString &after);
+    void Done(void);
+
+    /// Phase name and ms since Start()
+    typedef QPair<QString, int> Phase;
+
+    QString            m_name;
+    mutable QAtomicInt m_active;
+    QMutex             m_lock;
+    QString            m_channel;
+    MythTimer          m_timer;
+    QList<Phase>       m_phases;
+    /// Last phase, reached before the phase it has to come after
+    Phase              m_early;
+    QString            m_earlyAfter;
+
+    static QMutex      s_lock;
+    static QList<int>  s_zapTimes;
+};
+
+#endif // _ZAPTRACE_H_
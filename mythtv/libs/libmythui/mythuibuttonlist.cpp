@@ -88,6 +88,9 @@ void MythUIButtonList::Const(void)
 
     m_nextItemLoaded = 0;
 
+    m_provider = NULL;
+    m_binding  = -1;
+
     SetCanTakeFocus(true);
 
     connect(this, SIGNAL(TakingFocus()), this, SLOT(Select()));
@@ -140,6 +143,7 @@ void MythUIButtonList::SetActive(bool active)
 void MythUIButtonList::Reset()
 {
     m_ButtonToItem.clear();
+    m_provider = NULL;
 
     if (m_itemList.isEmpty())
         return;
@@ -150,6 +154,7 @@ void MythUIButtonList::Reset()
         delete m_itemList.takeFirst();
 
     m_clearing = false;
+    m_boundItems.clear();
 
     m_selPosition = 0;
     m_topPosition = 0;
@@ -166,6 +171,114 @@ void MythUIButtonList::Update()
     SetRedraw();
 }
 
+/**
+ * \brief Shows the entries of a provider instead of individually added items
+ *
+ * Any existing items are deleted.  Items are only created for the entries
+ * around the visible ones, so apart from the current item, pointers returned
+ * by GetItemAt() and friends are only valid until the list is next drawn.
+ * Looking items up by data or name binds every entry, which is slow for
+ * long lists.  The provider isn't owned by the list, Reset() detaches it.
+ */
+void MythUIButtonList::SetProvider(MythUIButtonListProvider *provider,
+                                   int selected)
+{
+    m_ButtonToItem.clear();
+    StopLoad();
+
+    m_clearing = true;
+
+    while (!m_itemList.isEmpty())
+        delete m_itemList.takeFirst();
+
+    m_clearing = false;
+    m_boundItems.clear();
+
+    m_provider  = provider;
+    m_itemCount = provider ? qMax(provider->GetItemCount(), 0) : 0;
+
+    m_itemList.reserve(m_itemCount);
+    for (int i = 0; i < m_itemCount; ++i)
+        m_itemList.append(NULL);
+
+    m_selPosition = qBound(0, selected, qMax(m_itemCount - 1, 0));
+    m_topPosition = 0;
+
+    Update();
+
+    emit itemSelected(GetItemCurrent());
+}
+
+/**
+ * Returns the item at a position, having the provider bind one first if
+ * the list has a provider and there is no item for the position yet.
+ */
+MythUIButtonListItem *MythUIButtonList::MaterializeItem(int pos) const
+{
+    MythUIButtonListItem *item = m_itemList.at(pos);
+
+    if (item || !m_provider)
+        return item;
+
+    MythUIButtonList *self = const_cast<MythUIButtonList *>(this);
+
+    self->m_binding = pos;
+    item = new MythUIButtonListItem(self, "");
+    self->m_binding = -1;
+
+    m_provider->BindItem(item, pos);
+    self->m_boundItems.insert(pos);
+
+    return item;
+}
+
+/// Deletes the provider's item at a position, the entry itself stays.
+void MythUIButtonList::ReleaseItem(int pos)
+{
+    MythUIButtonListItem *item = m_itemList.at(pos);
+
+    m_itemList[pos] = NULL;
+    m_boundItems.remove(pos);
+
+    if (item)
+    {
+        item->m_parent = NULL;
+        delete item;
+    }
+}
+
+/**
+ * Deletes the provider's items that are more than a page away from the
+ * visible ones, so that only a few pages of items exist at any time.
+ */
+void MythUIButtonList::ReleaseHiddenItems(void)
+{
+    if (!m_provider)
+        return;
+
+    int margin = qMax((int)m_itemsVisible, 1);
+    int first  = m_topPosition - margin;
+    int last   = m_topPosition + (int)m_itemsVisible + margin;
+
+    QList<MythUIButtonListItem *> shown = m_ButtonToItem.values();
+    QList<int> hidden;
+
+    QSet<int>::const_iterator it = m_boundItems.constBegin();
+    for (; it != m_boundItems.constEnd(); ++it)
+    {
+        int pos = *it;
+
+        if ((pos >= first && pos <= last) || pos == m_selPosition ||
+            shown.contains(m_itemList.at(pos)))
+            continue;
+
+        hidden.append(pos);
+    }
+
+    for (int i = 0; i < hidden.size(); ++i)
+        ReleaseItem(hidden[i]);
+}
+
 /*
  * The "width" of a button determines it relative position when using
  * Dynamic-Layout.
@@ -232,7 +345,7 @@ MythUIGroup *MythUIButtonList::PrepareButton(int buttonIdx, int itemIdx,
 {
     MythUIStateType *realButton;
     MythUIGroup *buttonstate;
-    MythUIButtonListItem *buttonItem = m_itemList[itemIdx];
+    MythUIButtonListItem *buttonItem = MaterializeItem(itemIdx);
 
     buttonIdx += button_shift;
 
@@ -1308,7 +1421,7 @@ void MythUIButtonList::CalculateButtonPositions(void)
         }
     }
 
-    QList<MythUIButtonListItem *>::iterator it = m_itemList.begin() + m_topPosition;
+    int pos = m_topPosition;
 
     if (m_scrollStyle == ScrollCenter || m_scrollStyle == ScrollGroupCenter)
     {
@@ -1319,13 +1432,13 @@ void MythUIButtonList::CalculateButtonPositions(void)
             if (m_wrapStyle == WrapItems && button > 0 &&
                 m_itemCount >= (int)m_itemsVisible)
             {
-                it = m_itemList.end() - button;
+                pos = m_itemList.size() - button;
                 button = 0;
             }
         }
         else if ((m_itemCount - m_selPosition) < (int)(m_itemsVisible / 2))
         {
-            it = m_itemList.begin() + m_selPosition - (m_itemsVisible / 2);
+            pos = m_selPosition - (m_itemsVisible / 2);
         }
     }
     else if (m_drawFromBottom && m_itemCount < (int)m_itemsVisible)
@@ -1339,22 +1452,20 @@ void MythUIButtonList::CalculateButtonPositions(void)
     MythUIStateType *realButton = NULL;
     MythUIButtonListItem *buttonItem = NULL;
 
-    if (it < m_itemList.begin())
-        it = m_itemList.begin();
+    if (pos < 0)
+        pos = 0;
 
-    int curItem = it < m_itemList.end() ? GetItemPos(*it) : 0;
-
-    while (it < m_itemList.end() && button < (int)m_itemsVisible)
+    while (pos < m_itemList.size() && button < (int)m_itemsVisible)
     {
         realButton = m_ButtonList[button];
-        buttonItem = *it;
+        buttonItem = MaterializeItem(pos);
 
         if (!realButton || !buttonItem)
             break;
 
         bool selected = false;
 
-        if (!seenSelected && (curItem == m_selPosition))
+        if (!seenSelected && (pos == m_selPosition))
         {
             seenSelected = true;
             selected = true;
@@ -1364,17 +1475,11 @@ void MythUIButtonList::CalculateButtonPositions(void)
         buttonItem->SetToRealButton(realButton, selected);
         realButton->SetVisible(true);
 
-        if (m_wrapStyle == WrapItems && it == (m_itemList.end() - 1) &&
+        if (m_wrapStyle == WrapItems && pos == m_itemList.size() - 1 &&
             m_itemCount >= (int)m_itemsVisible)
-        {
-            it = m_itemList.begin();
-            curItem = 0;
-        }
+            pos = 0;
         else
-        {
-            ++it;
-            ++curItem;
-        }
+            ++pos;
 
         button++;
     }
@@ -1415,6 +1520,7 @@ void MythUIButtonList::CalculateArrowStates()
         DistributeButtons();
 
     updateLCD();
+    ReleaseHiddenItems();
 
     m_needsUpdate = false;
 
@@ -1451,6 +1557,13 @@ void MythUIButtonList::ItemVisible(MythUIButtonListItem *item)
 
 void MythUIButtonList::InsertItem(MythUIButtonListItem *item, int listPosition)
 {
+    // An item the provider is about to bind, the entry is already counted
+    if (m_binding >= 0)
+    {
+        m_itemList[m_binding] = item;
+        return;
+    }
+
     bool wasEmpty = m_itemList.isEmpty();
 
     if (listPosition >= 0 && listPosition <= m_itemList.count())
@@ -1487,6 +1600,16 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     if (curIndex == -1)
         return;
 
+    if (m_provider)
+    {
+        // The entry is still in the provider, only the item goes away
+        m_itemList[curIndex] = NULL;
+        m_boundItems.remove(curIndex);
+        m_ButtonToItem.clear();
+        Update();
+        return;
+    }
+
     if (curIndex == m_topPosition &&
         m_topPosition > 0 &&
         m_topPosition == m_itemCount - 1)
@@ -1507,7 +1630,7 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     Update();
 
     if (m_selPosition < m_itemCount)
-        emit itemSelected(m_itemList.at(m_selPosition));
+        emit itemSelected(GetItemAt(m_selPosition));
     else
         emit itemSelected(NULL);
 }
@@ -1519,11 +1642,11 @@ void MythUIButtonList::SetValueByData(QVariant data)
 
     for (int i = 0; i < m_itemList.size(); ++i)
     {
-        MythUIButtonListItem *item = m_itemList.at(i);
+        MythUIButtonListItem *item = GetItemAt(i);
 
         if (item->GetData() == data)
         {
-            SetItemCurrent(item);
+            SetItemCurrent(i);
             return;
         }
     }
@@ -1561,11 +1684,11 @@ void MythUIButtonList::SetItemCurrent(int current, int topPosition)
 
 MythUIButtonListItem *MythUIButtonList::GetItemCurrent() const
 {
-    if (m_itemList.isEmpty() || m_selPosition > m_itemList.size() ||
+    if (m_itemList.isEmpty() || m_selPosition >= m_itemList.size() ||
         m_selPosition < 0)
         return NULL;
 
-    return m_itemList.at(m_selPosition);
+    return MaterializeItem(m_selPosition);
 }
 
 int MythUIButtonList::GetIntValue() const
@@ -1608,7 +1731,7 @@ MythRect MythUIButtonList::GetButtonArea(void) const
 MythUIButtonListItem *MythUIButtonList::GetItemFirst() const
 {
     if (!m_itemList.empty())
-        return m_itemList[0];
+        return MaterializeItem(0);
 
     return NULL;
 }
@@ -1616,12 +1739,15 @@ MythUIButtonListItem *MythUIButtonList::GetItemFirst() const
 MythUIButtonListItem *MythUIButtonList::GetItemNext(MythUIButtonListItem *item)
 const
 {
-    QListIterator<MythUIButtonListItem *> it(m_itemList);
+    if (!item)
+        return NULL;
 
-    if (!it.findNext(item))
-        return 0;
+    int pos = m_itemList.indexOf(item);
 
-    return it.previous();
+    if (pos < 0 || pos + 1 >= m_itemList.size())
+        return NULL;
+
+    return MaterializeItem(pos + 1);
 }
 
 int MythUIButtonList::GetCount() const
@@ -1653,7 +1779,7 @@ MythUIButtonListItem *MythUIButtonList::GetItemAt(int pos) const
     if (pos < 0 || pos >= m_itemList.size())
         return NULL;
 
-    return m_itemList.at(pos);
+    return MaterializeItem(pos);
 }
 
 MythUIButtonListItem *MythUIButtonList::GetItemByData(QVariant data)
@@ -1663,7 +1789,7 @@ MythUIButtonListItem *MythUIButtonList::GetItemByData(QVariant data)
 
     for (int i = 0; i < m_itemList.size(); ++i)
     {
-        MythUIButtonListItem *item = m_itemList.at(i);
+        MythUIButtonListItem *item = GetItemAt(i);
 
         if (item->GetData() == data)
             return item;
@@ -1683,7 +1809,7 @@ int MythUIButtonList::GetItemPos(MythUIButtonListItem *item) const
 void MythUIButtonList::InitButton(int itemIdx, MythUIStateType* & realButton,
                                   MythUIButtonListItem* & buttonItem)
 {
-    buttonItem = m_itemList[itemIdx];
+    buttonItem = MaterializeItem(itemIdx);
 
     if (m_maxVisible == 0)
     {
@@ -2127,17 +2253,15 @@ bool MythUIButtonList::MoveToNamedPosition(const QString &position_name)
 
     bool found_it = false;
     int selectedPosition = 0;
-    QList<MythUIButtonListItem *>::iterator it = m_itemList.begin();
 
-    while (it != m_itemList.end())
+    while (selectedPosition < m_itemList.size())
     {
-        if ((*it)->GetText() == position_name)
+        if (GetItemAt(selectedPosition)->GetText() == position_name)
         {
             found_it = true;
             break;
         }
 
-        ++it;
         ++selectedPosition;
     }
 
@@ -2150,6 +2274,10 @@ bool MythUIButtonList::MoveToNamedPosition(const QString &position_name)
 
 bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
 {
+    // The provider decides the order of its entries
+    if (m_provider)
+        return false;
+
     if (GetItemCurrent() != item)
         return false;
 
@@ -2199,7 +2327,12 @@ void MythUIButtonList::SetAllChecked(MythUIButtonListItem::CheckState state)
     QMutableListIterator<MythUIButtonListItem *> it(m_itemList);
 
     while (it.hasNext())
-        it.next()->setChecked(state);
+    {
+        MythUIButtonListItem *item = it.next();
+
+        if (item)
+            item->setChecked(state);
+    }
 }
 
 void MythUIButtonList::Init()
@@ -2546,6 +2679,10 @@ void MythUIButtonList::customEvent(QEvent *event)
 
 void MythUIButtonList::LoadInBackground(int start, int pageSize)
 {
+    // A provider's items are bound when they are needed
+    if (m_provider)
+        return;
+
     m_nextItemLoaded = start;
     QCoreApplication::
         postEvent(this, new NextButtonListPageEvent(start, pageSize));
@@ -2967,6 +3104,8 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
 
     while (true)
     {
+        bool bound = m_itemList.at(currPos) != NULL;
+
         found = GetItemAt(currPos)->FindText(m_searchStr, m_searchFields, m_searchStartsWith);
 
         if (found)
@@ -2975,6 +3114,10 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
             return true;
         }
 
+        // Don't leave every entry of a provider bound after a search
+        if (!bound && m_provider)
+            ReleaseItem(currPos);
+
         if (searchForward)
         {
             currPos++;
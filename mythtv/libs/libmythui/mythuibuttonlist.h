@@ -3,6 +3,7 @@
 
 #include <QList>
 #include <QHash>
+#include <QSet>
 #include <QString>
 #include <QVariant>
 
@@ -120,6 +121,28 @@ class MUI_PUBLIC MythUIButtonListItem
     friend class MythGenericTree;
 };
 
+/**
+ * \class MythUIButtonListProvider
+ *
+ * \brief Supplies the entries of a MythUIButtonList on demand
+ *
+ * A list with a provider only creates MythUIButtonListItems for the entries
+ * that are drawn, plus a page either side, and deletes them again once they
+ * have scrolled out of view.  The provider keeps the real data in whatever
+ * compact form suits it, so that is where filtering and sorting happen.
+ * Call MythUIButtonList::SetProvider() again after changing the entries.
+ */
+class MUI_PUBLIC MythUIButtonListProvider
+{
+  public:
+    virtual ~MythUIButtonListProvider() {}
+
+    /// Returns the number of entries in the list
+    virtual int  GetItemCount(void) const = 0;
+    /// Sets the text, images, states and data of the item for an entry
+    virtual void BindItem(MythUIButtonListItem *item, int index) = 0;
+};
+
 /**
  * \class MythUIButtonList
  *
@@ -153,6 +176,9 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     void Reset();
     void Update();
 
+    void SetProvider(MythUIButtonListProvider *provider, int selected = 0);
+    MythUIButtonListProvider *GetProvider(void) const { return m_provider; }
+
     virtual void SetValue(int value) { MoveToNamedPosition(QString::number(value)); }
     virtual void SetValue(const QString &value) { MoveToNamedPosition(value); }
     void SetValueByData(QVariant data);
@@ -224,6 +250,9 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     virtual void Init();
 
     void InsertItem(MythUIButtonListItem *item, int listPosition = -1);
+    MythUIButtonListItem *MaterializeItem(int pos) const;
+    void ReleaseItem(int pos);
+    void ReleaseHiddenItems(void);
 
     int minButtonWidth(const MythRect & area);
     int minButtonHeight(const MythRect & area);
@@ -323,6 +352,10 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     QList<MythUIButtonListItem*> m_itemList;
     int m_nextItemLoaded;
 
+    MythUIButtonListProvider *m_provider;
+    int       m_binding;     ///< Position of the item being bound, or -1
+    QSet<int> m_boundItems;  ///< Positions that have an item, with a provider
+
     bool m_drawFromBottom;
 
     QString     m_lcdTitle;
@@ -7,7 +7,10 @@
 #include <QMutex>
 #include <QPalette>
 #include <QMap>
+#include <QHash>
+#include <QRunnable>
 #include <QDir>
+#include <QDateTime>
 #include <QFileInfo>
 #include <QApplication>
 #include <QPainter>
@@ -42,6 +45,65 @@ static MythUIHelper *mythui = NULL;
 static QMutex uiLock;
 QString MythUIHelper::x11_display;
 
+/**
+ *  \brief Removes stale theme cache directories and trims the current one
+ *         to "UIDiskCacheSize" MB, dropping the images that were read least
+ *         recently. This runs on the image thread pool so that starting the
+ *         UI doesn't wait for the directory walks.
+ */
+class ImageCachePruner : public QRunnable
+{
+  public:
+    ImageCachePruner(const QStringList &staleDirs, const QString &cacheDir,
+                     qint64 maxSize) :
+        m_staleDirs(staleDirs), m_cacheDir(cacheDir), m_maxSize(maxSize) {}
+
+    void run(void)
+    {
+        for (int i = 0; i < m_staleDirs.size(); ++i)
+            GetMythUI()->RemoveCacheDir(m_staleDirs[i]);
+
+        QDir dir(m_cacheDir);
+        QFileInfoList list = dir.entryInfoList(QDir::Files | QDir::NoSymLinks,
+                                               QDir::Unsorted);
+
+        qint64 total = 0;
+        QMultiMap<QDateTime, int> lastRead;
+
+        for (int i = 0; i < list.size(); ++i)
+        {
+            total += list[i].size();
+            lastRead.insert(list[i].lastRead(), i);
+        }
+
+        qint64 before  = total;
+        int    removed = 0;
+
+        QMultiMap<QDateTime, int>::const_iterator it = lastRead.begin();
+        for (; it != lastRead.end() && total > m_maxSize; ++it)
+        {
+            const QFileInfo &fi = list[*it];
+
+            if (QFile::remove(fi.absoluteFilePath()))
+            {
+                total -= fi.size();
+                removed++;
+            }
+        }
+
+        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
+            QString("Disk cache %1 holds %2 KB in %3 files, removed %4 files "
+                    "to stay below %5 KB")
+            .arg(m_cacheDir).arg(before / 1024).arg(list.size())
+            .arg(removed).arg(m_maxSize / 1024));
+    }
+
+  private:
+    QStringList m_staleDirs;
+    QString     m_cacheDir;
+    qint64      m_maxSize;
+};
+
 MythUIHelper *MythUIHelper::getMythUI(void)
 {
     if (mythui)
@@ -108,13 +170,27 @@ public:
     int m_baseWidth, m_baseHeight;
     bool m_isWide;
 
-    QMap<QString, MythImage *> imageCache;
-    QMap<QString, uint> CacheTrack;
+    void TouchCacheImage(const QString &url);
+    void RemoveCacheImage(const QString &url);
+    void ClearImageCache(void);
+    void CountCacheLookup(bool inMemory, MythImage *im, int cacheMode);
+
+    QHash<QString, MythImage *> imageCache;
+    QHash<QString, uint> CacheTrack;        ///< Last use, for the stat timeout
+    QMap<quint64, QString> m_cacheLRU;      ///< Least recently used first
+    QHash<QString, quint64> m_cacheLRUKey;  ///< Key of an image in m_cacheLRU
+    quint64 m_cacheUses;
     QMutex *m_cacheLock;
 
     QAtomicInt m_cacheSize;
     QAtomicInt m_maxCacheSize;
 
+    // Image cache statistics, protected by m_cacheLock
+    uint64_t m_cacheMemoryHits;
+    uint64_t m_cacheDiskHits;
+    uint64_t m_cacheMisses;
+    uint64_t m_cacheEvictions;
+
     // The part of the screen(s) allocated for the GUI. Unless
     // overridden by the user, defaults to drawable area above.
     int m_screenxbase, m_screenybase;
@@ -155,8 +231,10 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
       m_wmult(1.0), m_hmult(1.0), m_pixelAspectRatio(-1.0),
       m_xbase(0), m_ybase(0), m_height(0), m_width(0),
       m_baseWidth(800), m_baseHeight(600), m_isWide(false),
-      m_cacheLock(new QMutex(QMutex::Recursive)),
+      m_cacheUses(0), m_cacheLock(new QMutex(QMutex::Recursive)),
       m_cacheSize(0), m_maxCacheSize(30 * 1024 * 1024),
+      m_cacheMemoryHits(0), m_cacheDiskHits(0), m_cacheMisses(0),
+      m_cacheEvictions(0),
       m_screenxbase(0), m_screenybase(0), m_screenwidth(0), m_screenheight(0),
       screensaver(NULL), screensaverEnabled(false), display_res(NULL),
       screenSetup(false), m_imageThreadPool(new MThreadPool("MythUIHelper")),
@@ -171,17 +249,7 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
 
 MythUIHelperPrivate::~MythUIHelperPrivate()
 {
-    QMutableMapIterator<QString, MythImage *> i(imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
-
-    CacheTrack.clear();
+    ClearImageCache();
 
     delete m_cacheLock;
     delete m_imageThreadPool;
@@ -192,6 +260,72 @@ MythUIHelperPrivate::~MythUIHelperPrivate()
         DisplayRes::SwitchToDesktop();
 }
 
+/// \brief Marks an image as the most recently used one. Needs m_cacheLock.
+void MythUIHelperPrivate::TouchCacheImage(const QString &url)
+{
+    QHash<QString, quint64>::iterator it = m_cacheLRUKey.find(url);
+
+    if (it != m_cacheLRUKey.end())
+        m_cacheLRU.remove(*it);
+
+    m_cacheLRU[++m_cacheUses] = url;
+    m_cacheLRUKey[url] = m_cacheUses;
+}
+
+/// \brief Drops an image from the memory cache. Needs m_cacheLock.
+void MythUIHelperPrivate::RemoveCacheImage(const QString &url)
+{
+    QHash<QString, MythImage *>::iterator it = imageCache.find(url);
+
+    if (it == imageCache.end())
+        return;
+
+    MythImage *im = *it;
+    imageCache.erase(it);
+    CacheTrack.remove(url);
+    m_cacheLRU.remove(m_cacheLRUKey.take(url));
+
+    im->SetIsInCache(false);
+    im->DecrRef();
+}
+
+void MythUIHelperPrivate::ClearImageCache(void)
+{
+    QMutexLocker locker(m_cacheLock);
+
+    QHash<QString, MythImage *>::iterator it = imageCache.begin();
+
+    for (; it != imageCache.end(); ++it)
+    {
+        (*it)->SetIsInCache(false);
+        (*it)->DecrRef();
+    }
+
+    imageCache.clear();
+    CacheTrack.clear();
+    m_cacheLRU.clear();
+    m_cacheLRUKey.clear();
+}
+
+/**
+ *  \brief Updates the statistics after a lookup in LoadCacheImage().
+ *
+ *  Lookups that only check the memory cache are just counted when they
+ *  find the image, the caller goes on to look at the disk cache later.
+ */
+void MythUIHelperPrivate::CountCacheLookup(bool inMemory, MythImage *im,
+                                           int cacheMode)
+{
+    QMutexLocker locker(m_cacheLock);
+
+    if (im && inMemory)
+        m_cacheMemoryHits++;
+    else if (im)
+        m_cacheDiskHits++;
+    else if (!(cacheMode & (kCacheIgnoreDisk | kCacheCheckMemoryOnly)))
+        m_cacheMisses++;
+}
+
 void MythUIHelperPrivate::Init(void)
 {
     screensaver = ScreenSaverControl::get();
@@ -497,17 +631,7 @@ void MythUIHelper::UpdateImageCache(void)
 {
     QMutexLocker locker(d->m_cacheLock);
 
-    QMutableMapIterator<QString, MythImage *> i(d->imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
-
-    d->CacheTrack.clear();
+    d->ClearImageCache();
 
     d->m_cacheSize.fetchAndStoreOrdered(0);
 
@@ -521,6 +645,7 @@ MythImage *MythUIHelper::GetImageFromCache(const QString &url)
     if (d->imageCache.contains(url))
     {
         d->CacheTrack[url] = MythDate::current().toTime_t();
+        d->TouchCacheImage(url);
         d->imageCache[url]->IncrRef();
         return d->imageCache[url];
     }
@@ -573,55 +698,41 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
         im->save(dstfile, "PNG");
     }
 
-    // delete the oldest cached images until we fall below threshold.
+    // Delete the least recently used images until we fall below the
+    // threshold. Images that are still referenced elsewhere don't count
+    // towards m_cacheSize and removing them wouldn't free anything.
     QMutexLocker locker(d->m_cacheLock);
 
+    QMap<quint64, QString>::iterator lru = d->m_cacheLRU.begin();
+
     while (d->m_cacheSize.fetchAndAddOrdered(0) + im->byteCount() >=
            d->m_maxCacheSize.fetchAndAddOrdered(0) &&
-           d->imageCache.size())
+           lru != d->m_cacheLRU.end())
     {
-        QMap<QString, MythImage *>::iterator it = d->imageCache.begin();
-        uint oldestTime = MythDate::current().toTime_t();
-        QString oldestKey = it.key();
+        QString key = *lru;
+        ++lru;
 
-        int count = 0;
+        MythImage *old = d->imageCache.value(key);
 
-        for (; it != d->imageCache.end(); ++it)
-        {
-            if (d->CacheTrack[it.key()] < oldestTime)
-            {
-                if ((2 == it.value()->IncrRef()) && (it.value() != im))
-                {
-                    oldestTime = d->CacheTrack[it.key()];
-                    oldestKey = it.key();
-                    count++;
-                }
-                it.value()->DecrRef();
-            }
-        }
+        if (old == im)
+            continue;
+
+        bool unused = (2 == old->IncrRef());
+        old->DecrRef();
+
+        if (!unused)
+            continue;
 
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-            QString("%1 images are eligible for expiry").arg(count));
+            QString("Cache too big (%1), removing :%2:")
+            .arg(d->m_cacheSize.fetchAndAddOrdered(0) + im->byteCount())
+            .arg(key));
 
-        if (count > 0)
-        {
-            LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-                QString("Cache too big (%1), removing :%2:")
-                .arg(d->m_cacheSize.fetchAndAddOrdered(0) + im->byteCount())
-                .arg(oldestKey));
-
-            d->imageCache[oldestKey]->SetIsInCache(false);
-            d->imageCache[oldestKey]->DecrRef();
-            d->imageCache.remove(oldestKey);
-            d->CacheTrack.remove(oldestKey);
-        }
-        else
-        {
-            break;
-        }
+        d->RemoveCacheImage(key);
+        d->m_cacheEvictions++;
     }
 
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
+    QHash<QString, MythImage *>::iterator it = d->imageCache.find(url);
 
     if (it == d->imageCache.end())
     {
@@ -635,6 +746,8 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
             .arg(url).arg(im->byteCount()));
     }
 
+    d->TouchCacheImage(url);
+
     LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
         QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
         .arg(d->imageCache.count())
@@ -646,15 +759,7 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
 void MythUIHelper::RemoveFromCacheByURL(const QString &url)
 {
     QMutexLocker locker(d->m_cacheLock);
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
-
-    if (it != d->imageCache.end())
-    {
-        d->imageCache[url]->SetIsInCache(false);
-        d->imageCache[url]->DecrRef();
-        d->imageCache.remove(url);
-        d->CacheTrack.remove(url);
-    }
+    d->RemoveCacheImage(url);
 
     QString dstfile;
 
@@ -775,12 +880,14 @@ void MythUIHelper::ClearOldImageCache(void)
     // incurring a penalty. Especially for those writing new themes or testing
     // changes of an existing theme. The space used is neglible when compared
     // against the average video
+    QStringList staleDirs;
+
     while ((size_t)dirtimes.size() >= 2)
     {
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("Removing cache dir: %1")
             .arg(dirtimes.begin().value()));
 
-        RemoveCacheDir(dirtimes.begin().value());
+        staleDirs << dirtimes.begin().value();
         dirtimes.erase(dirtimes.begin());
     }
 
@@ -791,6 +898,13 @@ void MythUIHelper::ClearOldImageCache(void)
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
             QString("Keeping cache dir: %1").arg(*dit));
     }
+
+    qint64 maxSize =
+        GetMythDB()->GetNumSetting("UIDiskCacheSize", 512) * 1024LL * 1024LL;
+
+    d->m_imageThreadPool->start(
+        new ImageCachePruner(staleDirs, themecachedir, maxSize),
+        "ImageCachePruner");
 }
 
 void MythUIHelper::RemoveCacheDir(const QString &dirname)
@@ -1503,6 +1617,8 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
         if (d->imageCache.contains(label) &&
             d->CacheTrack[label] + kImageCacheTimeout > now)
         {
+            d->TouchCacheImage(label);
+            d->m_cacheMemoryHits++;
             d->imageCache[label]->IncrRef();
             return d->imageCache[label];
         }
@@ -1512,6 +1628,7 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
 
     // Check Memory Cache
     ret = GetImageFromCache(label);
+    bool inMemory = (ret != NULL);
 
     // If the image is in the memory or we are not ignoring the disk cache
     // then proceed to check whether the source file is newer than our cached
@@ -1525,7 +1642,12 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
         // If the file isn't in the disk cache, then we don't want to bother
         // checking the last modified times of the original
         if (!cacheFileInfo.exists())
+        {
+            if (ret)
+                ret->DecrRef();
+            d->CountCacheLookup(false, NULL, cacheMode);
             return NULL;
+        }
 
         // Now compare the time on the source versus our cached copy
         QDateTime srcLastModified;
@@ -1549,11 +1671,20 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
             }
         }
         else if (srcfile.startsWith("myth://"))
+        {
+            // Asking the backend is a round trip, but images in the memory
+            // cache only get here once per kImageCacheTimeout, see above.
             srcLastModified = RemoteFile::LastModified(srcfile);
+        }
         else
         {
             if (!FindThemeFile(srcfile))
+            {
+                if (ret)
+                    ret->DecrRef();
+                d->CountCacheLookup(false, NULL, cacheMode);
                 return NULL;
+            }
 
             QFileInfo original(srcfile);
 
@@ -1596,6 +1727,8 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
         }
         else
         {
+            if (ret)
+                ret->DecrRef();
             ret = NULL;
             // If file has changed on disk, then remove it from the memory
             // and disk cache
@@ -1603,9 +1736,42 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
         }
     }
 
+    d->CountCacheLookup(inMemory, ret, cacheMode);
+
     return ret;
 }
 
+/**
+ *  \brief Returns the state of the memory image cache and how well it did.
+ *  \param images      Images in the memory cache
+ *  \param bytes       Memory used by them
+ *  \param maxBytes    Memory that may be used by images not shown anywhere
+ *  \param memoryHits  Lookups answered from memory
+ *  \param diskHits    Lookups answered from the disk cache
+ *  \param misses      Lookups that had to load and scale the original
+ *  \param evictions   Images dropped from memory to stay within maxBytes
+ */
+void MythUIHelper::GetImageCacheStats(uint &images, uint64_t &bytes,
+                                      uint64_t &maxBytes, uint64_t &memoryHits,
+                                      uint64_t &diskHits, uint64_t &misses,
+                                      uint64_t &evictions)
+{
+    QMutexLocker locker(d->m_cacheLock);
+
+    images = d->imageCache.size();
+    bytes  = 0;
+
+    QHash<QString, MythImage *>::const_iterator it = d->imageCache.begin();
+    for (; it != d->imageCache.end(); ++it)
+        bytes += (*it)->byteCount();
+
+    maxBytes   = d->m_maxCacheSize.fetchAndAddRelaxed(0);
+    memoryHits = d->m_cacheMemoryHits;
+    diskHits   = d->m_cacheDiskHits;
+    misses     = d->m_cacheMisses;
+    evictions  = d->m_cacheEvictions;
+}
+
 QFont MythUIHelper::GetBigFont(void)
 {
     QFont font = QApplication::font();
@@ -1,6 +1,8 @@
 #ifndef MYTHUIHELPERS_H_
 #define MYTHUIHELPERS_H_
 
+#include <stdint.h>
+
 #include <QStringList>
 #include <QString>
 #include <QFont>
@@ -41,6 +43,8 @@ struct MUI_PUBLIC MythUIMenuCallbacks
 
 class MUI_PUBLIC MythUIHelper
 {
+    friend class ImageCachePruner;
+
   public:
     void Init(MythUIMenuCallbacks &cbs);
 
@@ -62,6 +66,10 @@ class MUI_PUBLIC MythUIHelper
     void IncludeInCacheSize(MythImage *im);
     void ExcludeFromCacheSize(MythImage *im);
 
+    void GetImageCacheStats(uint &images, uint64_t &bytes, uint64_t &maxBytes,
+                            uint64_t &memoryHits, uint64_t &diskHits,
+                            uint64_t &misses, uint64_t &evictions);
+
     Settings *qtconfig(void);
 
     bool IsScreenSetup(void);
@@ -1063,7 +1063,11 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
                 do_background_load = true;
         }
 
-        if (!isAnimation && !GetMythUI()->IsImageInCache(imagelabel))
+        // A background load leaves the current image up as a placeholder
+        // until customEvent() swaps in the new one, instead of showing an
+        // empty widget while the image is decoded and scaled.
+        if (!isAnimation && !do_background_load &&
+            !GetMythUI()->IsImageInCache(imagelabel))
             Clear();
 
         if (do_background_load)
@@ -7,7 +7,14 @@
 
 // QT headers
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QDataStream>
+#include <QCryptographicHash>
 #include <QDomDocument>
+#include <QMutex>
+#include <QHash>
 #include <QString>
 #include <QBrush>
 #include <QLinearGradient>
@@ -15,6 +22,7 @@
 
 // libmyth headers
 #include "mythlogging.h"
+#include "mythcorecontext.h"
 
 // Mythui headers
 #include "mythmainwindow.h"
@@ -323,6 +331,293 @@ QString XMLParseBase::parseText(QDomElement &element)
 static MythUIType *globalObjectStore = NULL;
 static QStringList loadedBaseFiles;
 
+/// A parsed theme file and the state of the file it was parsed from
+class ParsedThemeFile
+{
+  public:
+    QDomDocument doc;
+    QDateTime    modified;
+    qint64       size;
+};
+
+static QMutex themeFileLock;
+static QHash<QString, ParsedThemeFile> themeFiles;
+
+// Header of a theme file saved in parsed form, see SaveParsedThemeFile()
+static const quint32 kParsedThemeMagic   = 0x4d505446; // "MPTF"
+static const quint32 kParsedThemeVersion = 1;
+// Node types in a saved document
+static const quint8  kParsedElement      = 1;
+static const quint8  kParsedText         = 2;
+static const quint8  kParsedCDATA        = 3;
+// Deepest element nesting a saved document is trusted with
+static const int     kParsedMaxDepth     = 256;
+
+/// Where the parsed form of a theme file is kept between runs
+static QString ParsedThemeFileName(const QString &filename)
+{
+    QByteArray key = QCryptographicHash::hash(
+        filename.toUtf8(), QCryptographicHash::Md5).toHex();
+    return GetMythUI()->GetThemeCacheDir() + "/xml/" +
+        QString(key) + ".dom";
+}
+
+static void WriteDomNode(QDataStream &out, const QDomNode &node)
+{
+    if (node.isCDATASection())
+    {
+        out << kParsedCDATA << node.toCDATASection().data();
+        return;
+    }
+
+    if (node.isText())
+    {
+        out << kParsedText << node.toText().data();
+        return;
+    }
+
+    QDomElement element = node.toElement();
+    out << kParsedElement << element.tagName();
+
+    QDomNamedNodeMap attrs = element.attributes();
+    out << (quint32)attrs.count();
+    for (int i = 0; i < attrs.count(); ++i)
+    {
+        QDomAttr attr = attrs.item(i).toAttr();
+        out << attr.name() << attr.value();
+    }
+
+    // Comments and processing instructions are of no use to the parser
+    quint32 children = 0;
+    QDomNode child = element.firstChild();
+    for (; !child.isNull(); child = child.nextSibling())
+    {
+        if (child.isElement() || child.isText())
+            children++;
+    }
+
+    out << children;
+    for (child = element.firstChild(); !child.isNull();
+         child = child.nextSibling())
+    {
+        if (child.isElement() || child.isText())
+            WriteDomNode(out, child);
+    }
+}
+
+static bool ReadDomNode(QDataStream &in, QDomDocument &doc,
+                        QDomNode &parent, int depth)
+{
+    quint8  type;
+    QString data;
+    in >> type >> data;
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    if (type == kParsedText)
+    {
+        parent.appendChild(doc.createTextNode(data));
+        return true;
+    }
+
+    if (type == kParsedCDATA)
+    {
+        parent.appendChild(doc.createCDATASection(data));
+        return true;
+    }
+
+    if (type != kParsedElement || depth > kParsedMaxDepth)
+        return false;
+
+    QDomElement element = doc.createElement(data);
+
+    quint32 attrs;
+    in >> attrs;
+    for (quint32 i = 0; i < attrs && in.status() == QDataStream::Ok; ++i)
+    {
+        QString name, value;
+        in >> name >> value;
+        element.setAttribute(name, value);
+    }
+
+    quint32 children;
+    in >> children;
+    for (quint32 i = 0; i < children; ++i)
+    {
+        if (!ReadDomNode(in, doc, element, depth + 1))
+            return false;
+    }
+
+    parent.appendChild(element);
+
+    return in.status() == QDataStream::Ok;
+}
+
+/** \brief Saves a parsed theme file, so the next run of the program can
+ *         load it without parsing the XML again.
+ *
+ *  The document is written as a tree of elements, attributes and text,
+ *  with the path, modification time and size of the theme file it came
+ *  from.  It lives in the theme cache directory and goes with it when
+ *  the theme or resolution changes.
+ */
+static void SaveParsedThemeFile(const QString &filename, const QFileInfo &fi,
+                                const QDomDocument &doc)
+{
+    QString cachename = ParsedThemeFileName(filename);
+    QDir().mkpath(QFileInfo(cachename).path());
+
+    // Written under another name first so a reader never sees half of it
+    QString tmpname = cachename + ".tmp";
+    QFile f(tmpname);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << kParsedThemeMagic << kParsedThemeVersion << filename
+        << (qint64)fi.lastModified().toMSecsSinceEpoch() << (qint64)fi.size();
+    WriteDomNode(out, doc.documentElement());
+    f.close();
+
+    if (out.status() != QDataStream::Ok || f.error() != QFile::NoError)
+    {
+        QFile::remove(tmpname);
+        return;
+    }
+
+    QFile::remove(cachename);
+    if (!QFile::rename(tmpname, cachename))
+        QFile::remove(tmpname);
+}
+
+/** \brief Loads a theme file saved by SaveParsedThemeFile().
+ *
+ *  \return false if there is no saved form of the file, or the file has
+ *          changed since it was saved.
+ */
+static bool LoadParsedThemeFile(const QString &filename, const QFileInfo &fi,
+                                QDomDocument &doc)
+{
+    QFile f(ParsedThemeFileName(filename));
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic, version;
+    QString savedname;
+    qint64  modified, size;
+    in >> magic >> version >> savedname >> modified >> size;
+
+    if (in.status() != QDataStream::Ok || magic != kParsedThemeMagic ||
+        version != kParsedThemeVersion || savedname != filename ||
+        modified != fi.lastModified().toMSecsSinceEpoch() ||
+        size != fi.size())
+    {
+        return false;
+    }
+
+    QDomDocument loaded;
+    if (!ReadDomNode(in, loaded, loaded, 0))
+    {
+        LOG(VB_GUI, LOG_WARNING, LOC +
+            QString("Ignoring damaged parsed copy of '%1'").arg(filename));
+        return false;
+    }
+
+    doc = loaded;
+    return true;
+}
+
+/// Reads and parses the XML of a theme file
+static bool ParseThemeFile(const QString &filename, QDomDocument &doc)
+{
+    QFile f(filename);
+
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QString errorMsg;
+    int errorLine = 0;
+    int errorColumn = 0;
+
+    if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Location: '%1' @ %2 column: %3"
+                    "\n\t\t\tError: %4")
+                .arg(qPrintable(filename)).arg(errorLine).arg(errorColumn)
+                .arg(qPrintable(errorMsg)));
+        f.close();
+        return false;
+    }
+
+    f.close();
+
+    return true;
+}
+
+/** \brief Parses a theme file, unless it has already been parsed and
+ *         hasn't changed on disk since.
+ *
+ *  Every screen used to read and parse its whole theme file each time it
+ *  was created, and WindowExists() parsed it once more.  The documents are
+ *  now kept until the theme is changed or reloaded, see
+ *  XMLParseBase::ClearGlobalObjectStore().  They are also saved in parsed
+ *  form, so the first screens after a start don't parse XML either.
+ *  QDomDocument is implicitly shared but not thread-safe, so only the UI
+ *  thread, which creates nearly all screens, uses the caches.
+ *
+ *  \return false if the file doesn't exist or isn't valid XML
+ */
+static bool ReadThemeFile(const QString &filename, QDomDocument &doc)
+{
+    QFileInfo fi(filename);
+    if (!fi.isFile())
+        return false;
+
+    bool useCache = gCoreContext && gCoreContext->IsUIThread();
+
+    if (useCache)
+    {
+        QMutexLocker locker(&themeFileLock);
+        QHash<QString, ParsedThemeFile>::const_iterator it =
+            themeFiles.find(filename);
+        if (it != themeFiles.end() && it->modified == fi.lastModified() &&
+            it->size == fi.size())
+        {
+            doc = it->doc;
+            return true;
+        }
+    }
+
+    bool parsed = useCache && LoadParsedThemeFile(filename, fi, doc);
+
+    if (!parsed)
+    {
+        if (!ParseThemeFile(filename, doc))
+            return false;
+        if (useCache)
+            SaveParsedThemeFile(filename, fi, doc);
+    }
+
+    if (useCache)
+    {
+        ParsedThemeFile cached;
+        cached.doc      = doc;
+        cached.modified = fi.lastModified();
+        cached.size     = fi.size();
+
+        QMutexLocker locker(&themeFileLock);
+        themeFiles.insert(filename, cached);
+    }
+
+    return true;
+}
+
 MythUIType *XMLParseBase::GetGlobalObjectStore(void)
 {
     if (!globalObjectStore)
@@ -338,6 +633,9 @@ void XMLParseBase::ClearGlobalObjectStore(void)
 
     // clear any loaded base xml files which will force a reload the next time they are used
     loadedBaseFiles.clear();
+
+    QMutexLocker locker(&themeFileLock);
+    themeFiles.clear();
 }
 
 void XMLParseBase::ParseChildren(const QString &filename,
@@ -626,28 +924,10 @@ bool XMLParseBase::WindowExists(const QString &xmlfile,
     for (; it != searchpath.end(); ++it)
     {
         QString themefile = *it + xmlfile;
-        QFile f(themefile);
-
-        if (!f.open(QIODevice::ReadOnly))
-            continue;
-
         QDomDocument doc;
-        QString errorMsg;
-        int errorLine = 0;
-        int errorColumn = 0;
 
-        if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC +
-                QString("Location: '%1' @ %2 column: %3"
-                        "\n\t\t\tError: %4")
-                    .arg(qPrintable(themefile)).arg(errorLine).arg(errorColumn)
-                    .arg(qPrintable(errorMsg)));
-            f.close();
+        if (!ReadThemeFile(themefile, doc))
             continue;
-        }
-
-        f.close();
 
         QDomElement docElem = doc.documentElement();
         QDomNode n = docElem.firstChild();
@@ -708,28 +988,10 @@ bool XMLParseBase::doLoad(const QString &windowname,
                           bool showWarnings)
 {
     QDomDocument doc;
-    QFile f(filename);
 
-    if (!f.open(QIODevice::ReadOnly))
+    if (!ReadThemeFile(filename, doc))
         return false;
 
-    QString errorMsg;
-    int errorLine = 0;
-    int errorColumn = 0;
-
-    if (!doc.setContent(&f, false, &errorMsg, &errorLine, &errorColumn))
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC +
-            QString("Location: '%1' @ %2 column: %3"
-                    "\n\t\t\tError: %4")
-                .arg(qPrintable(filename)).arg(errorLine).arg(errorColumn)
-                .arg(qPrintable(errorMsg)));
-        f.close();
-        return false;
-    }
-
-    f.close();
-
     QDomElement docElem = doc.documentElement();
     QDomNode n = docElem.firstChild();
     while (!n.isNull())
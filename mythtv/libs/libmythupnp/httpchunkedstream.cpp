@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpchunkedstream.cpp
+// Created     : Oct. 19, 2026
+//
+// Purpose     : QIODevice that writes a response body straight to the
+//               client using HTTP/1.1 chunked transfer encoding
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "httpchunkedstream.h"
+#include "httprequest.h"
+#include "mythlogging.h"
+
+#define ZLIB_OUT_SIZE 16384
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HTTPChunkedStream::HTTPChunkedStream( HTTPRequest *pRequest,
+                                      bool         bGzip,
+                                      int          nChunkSize )
+                 : m_pRequest  ( pRequest   ),
+                   m_bGzip     ( bGzip      ),
+                   m_nChunkSize( nChunkSize ),
+                   m_bZInit    ( false      ),
+                   m_nBytesIn  ( 0          ),
+                   m_nBytesSent( 0          ),
+                   m_bError    ( false      )
+{
+    m_buffer.reserve( m_nChunkSize + ZLIB_OUT_SIZE );
+
+    if (m_bGzip)
+    {
+        m_zStream.zalloc = Z_NULL;
+        m_zStream.zfree  = Z_NULL;
+        m_zStream.opaque = Z_NULL;
+
+        int ret = deflateInit2( &m_zStream,
+                                Z_DEFAULT_COMPRESSION,
+                                Z_DEFLATED,
+                                15 + 16,
+                                8,
+                                Z_DEFAULT_STRATEGY ); // gzip encoding
+
+        m_bZInit = (ret == Z_OK);
+        m_bGzip  = m_bZInit;
+    }
+
+    if (m_bGzip)
+        m_pRequest->m_mapRespHeaders[ "Content-Encoding" ] = "gzip";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HTTPChunkedStream::~HTTPChunkedStream()
+{
+    if (isOpen())
+        close();
+
+    if (m_bZInit)
+        deflateEnd( &m_zStream );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::open( OpenMode mode )
+{
+    if (mode & QIODevice::ReadOnly)
+        return false;
+
+    return QIODevice::open( mode | QIODevice::Unbuffered );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void HTTPChunkedStream::close()
+{
+    if (!isOpen())
+        return;
+
+    if (m_bGzip && !m_bError)
+        Deflate( NULL, 0, Z_FINISH );
+
+    // Send whatever is left, followed by the terminating zero length chunk.
+
+    if (!m_bError)
+        SendChunk( true );
+
+    if (!m_bError && (m_pRequest->SendChunk( NULL, 0 ) < 0))
+        m_bError = true;
+
+    LOG(VB_UPNP, LOG_DEBUG,
+        QString("HTTPChunkedStream: %1 bytes serialized, %2 bytes sent%3")
+            .arg(m_nBytesIn).arg(m_nBytesSent)
+            .arg(m_bError ? " (aborted)" : ""));
+
+    QIODevice::close();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedStream::readData( char *data, qint64 maxSize )
+{
+    (void)data;
+    (void)maxSize;
+
+    return -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPChunkedStream::writeData( const char *data, qint64 maxSize )
+{
+    // Once the client has gone away there is no point in formatting the rest
+    // of the response; swallow it so the serializer can unwind normally.
+
+    if (m_bError)
+        return maxSize;
+
+    m_nBytesIn += maxSize;
+
+    if (m_bGzip)
+    {
+        if (!Deflate( data, maxSize, Z_NO_FLUSH ))
+            return maxSize;
+    }
+    else
+        m_buffer.append( data, maxSize );
+
+    if (m_buffer.size() >= m_nChunkSize)
+        SendChunk( false );
+
+    return maxSize;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::Deflate( const char *pData, qint64 nLen, int nFlush )
+{
+    char out[ ZLIB_OUT_SIZE ];
+
+    m_zStream.avail_in = nLen;
+    m_zStream.next_in  = (Bytef*)(pData);
+
+    int ret;
+
+    do
+    {
+        m_zStream.avail_out = ZLIB_OUT_SIZE;
+        m_zStream.next_out  = (Bytef*)(out);
+
+        ret = deflate( &m_zStream, nFlush );
+
+        if (ret == Z_STREAM_ERROR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, "HTTPChunkedStream: deflate failed");
+            m_bError = true;
+            return false;
+        }
+
+        m_buffer.append( out, ZLIB_OUT_SIZE - m_zStream.avail_out );
+
+        if (m_buffer.size() >= m_nChunkSize && !SendChunk( false ))
+            return false;
+    }
+    while (m_zStream.avail_out == 0);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool HTTPChunkedStream::SendChunk( bool bForce )
+{
+    if (m_buffer.isEmpty() || (!bForce && m_buffer.size() < m_nChunkSize))
+        return true;
+
+    qint64 nBytes = m_pRequest->SendChunk( m_buffer.constData(),
+                                           m_buffer.size() );
+
+    m_buffer.resize( 0 );
+
+    if (nBytes < 0)
+    {
+        LOG(VB_UPNP, LOG_ERR,
+            "HTTPChunkedStream: Error sending chunk, abandoning response");
+        m_bError = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    return true;
+}
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpchunkedstream.h
+// Created     : Oct. 19, 2026
+//
+// Purpose     : QIODevice that writes a response body straight to the
+//               client using HTTP/1.1 chunked transfer encoding
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPCHUNKEDSTREAM_H_
+#define HTTPCHUNKEDSTREAM_H_
+
+#include <QIODevice>
+#include <QByteArray>
+
+#include <zlib.h>
+
+#include "upnpexp.h"
+
+class HTTPRequest;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Serializers write into this device instead of HTTPRequest::m_response.
+// Data is collected until at least nChunkSize bytes are pending and is then
+// sent to the socket as a single chunk, so the full response never has to
+// be held in memory.  When bGzip is set the body is deflated on the fly.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+class UPNP_PUBLIC HTTPChunkedStream : public QIODevice
+{
+    public:
+
+                 HTTPChunkedStream( HTTPRequest *pRequest,
+                                    bool         bGzip      = false,
+                                    int          nChunkSize = 65536 );
+        virtual ~HTTPChunkedStream();
+
+        virtual bool    open      ( OpenMode mode );
+        virtual void    close     ();
+        virtual bool    isSequential() const { return true; }
+
+        qint64          BytesSent () const { return m_nBytesSent; }
+        qint64          BytesIn   () const { return m_nBytesIn;   }
+
+    protected:
+
+        virtual qint64  readData  ( char *data, qint64 maxSize );
+        virtual qint64  writeData ( const char *data, qint64 maxSize );
+
+    private:
+
+        bool            Deflate   ( const char *pData, qint64 nLen, int nFlush );
+        bool            SendChunk ( bool bForce );
+
+        HTTPRequest    *m_pRequest;
+        bool            m_bGzip;
+        int             m_nChunkSize;
+
+        z_stream        m_zStream;
+        bool            m_bZInit;
+
+        QByteArray      m_buffer;
+        qint64          m_nBytesIn;
+        qint64          m_nBytesSent;
+        bool            m_bError;
+};
+
+#endif
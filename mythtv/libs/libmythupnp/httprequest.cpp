@@ -142,7 +142,9 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
                              m_bSOAPRequest   ( false ),
                              m_eResponseType  ( ResponseTypeUnknown),
                              m_nResponseStatus( 200 ),
-                             m_pPostProcess   ( NULL )
+                             m_pPostProcess   ( NULL ),
+                             m_bChunked       ( false ),
+                             m_nChunkedBytes  ( 0 )
 {
     m_response.open( QIODevice::ReadWrite );
 }
@@ -191,11 +193,16 @@ QString HTTPRequest::BuildHeader( long long nSize )
     sHeader += GetAdditionalHeaders();
 
     sHeader += QString( "Connection: %1\r\n"
-                        "Content-Type: %2\r\n"
-                        "Content-Length: %3\r\n" )
+                        "Content-Type: %2\r\n" )
                         .arg( GetKeepAlive() ? "Keep-Alive" : "Close" )
-                        .arg( sContentType )
-                        .arg( nSize );
+                        .arg( sContentType );
+
+    // A negative size means the body follows as HTTP/1.1 chunks
+
+    if (nSize < 0)
+        sHeader += "Transfer-Encoding: chunked\r\n";
+    else
+        sHeader += QString( "Content-Length: %1\r\n" ).arg( nSize );
 
     // ----------------------------------------------------------------------
     // Temp Hack to process DLNA header
@@ -221,6 +228,20 @@ long HTTPRequest::SendResponse( void )
 {
     long      nBytes    = 0;
 
+    // ----------------------------------------------------------------------
+    // The body has already been written to the socket by SendChunk()
+    // ----------------------------------------------------------------------
+
+    if (m_bChunked)
+    {
+        LOG(VB_UPNP, LOG_INFO,
+            QString("HTTPRequest::SendResponse( Chunked ) :%1 -> %2: %3 bytes")
+                .arg(GetResponseStatus()) .arg(GetPeerAddress())
+                .arg(m_nChunkedBytes));
+
+        return( (m_nChunkedBytes < 0) ? -1 : m_nChunkedBytes );
+    }
+
     switch( m_eResponseType )
     {
         // The following are all eligable for gzip compression
@@ -322,7 +343,11 @@ long HTTPRequest::SendResponse( void )
 
     QBuffer compBuffer;
 
-    if (( nContentLen > 0 ) && m_mapHeaders[ "accept-encoding" ].contains( "gzip" ))
+    // Video is already compressed, don't waste time deflating it again.
+
+    if (( nContentLen > 0 ) && m_mapHeaders[ "accept-encoding" ].contains( "gzip" ) &&
+        !(m_eResponseType == ResponseTypeOther &&
+          m_sResponseTypeText.startsWith( "video/" )))
     {
         QByteArray compressed = gzipCompress( m_response.buffer() );
         compBuffer.setData( compressed );
@@ -549,6 +574,71 @@ long HTTPRequest::SendResponseFile( QString sFileName )
 //
 /////////////////////////////////////////////////////////////////////////////
 
+bool HTTPRequest::CanSendChunked()
+{
+    // Chunked transfer encoding is an HTTP/1.1 feature
+
+    if ((m_nMajor < 1) || ((m_nMajor == 1) && (m_nMinor < 1)))
+        return false;
+
+    if (m_eType == RequestTypeHead)
+        return false;
+
+    // An ETag can only be computed once the whole body is known, so let
+    // conditional requests take the buffered path.
+
+    if (!GetHeaderValue( "If-None-Match", "" ).isEmpty())
+        return false;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Sends the response header (on first use) followed by a single chunk.
+// A zero length chunk terminates the response.
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPRequest::SendChunk( const char *pData, qint64 nLen )
+{
+    if (m_nChunkedBytes < 0)
+        return -1;
+
+    qint64 nBytes = 0;
+
+    if (m_nChunkedBytes == 0)
+    {
+        m_mapRespHeaders[ "X-UA-Compatible" ] = "IE=Edge";
+
+        QByteArray sHeader = BuildHeader( -1 ).toUtf8();
+
+        if ((nBytes = WriteBlockDirect( sHeader.constData(),
+                                        sHeader.length() )) < 0)
+        {
+            m_nChunkedBytes = -1;
+            return -1;
+        }
+    }
+
+    QByteArray sSize = QByteArray::number( nLen, 16 ) + "\r\n";
+
+    if ((WriteBlockDirect( sSize.constData(), sSize.length() ) < 0) ||
+        ((nLen > 0) && (WriteBlockDirect( pData, nLen ) < 0)) ||
+        (WriteBlockDirect( "\r\n", 2 ) < 0))
+    {
+        m_nChunkedBytes = -1;
+        return -1;
+    }
+
+    nBytes          += sSize.length() + nLen + 2;
+    m_nChunkedBytes += nBytes;
+
+    return nBytes;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 #define SENDFILE_BUFFER_SIZE 65536
 
 qint64 HTTPRequest::SendData( QIODevice *pDevice, qint64 llStart, qint64 llBytes )
@@ -705,6 +795,22 @@ void HTTPRequest::FormatActionResponse( Serializer *pSer )
     //m_response << pFormatter->ToString();
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// The serializer is expected to write into an HTTPChunkedStream, with
+// SetHashContent( false ) so it adds no ETag, since the content hash isn't
+// known until the body is complete.
+/////////////////////////////////////////////////////////////////////////////
+
+void HTTPRequest::FormatChunkedResponse( Serializer *pSer )
+{
+    m_eResponseType     = ResponseTypeOther;
+    m_sResponseTypeText = pSer->GetContentType();
+    m_nResponseStatus   = 200;
+    m_bChunked          = true;
+
+    pSer->AddHeaders( m_mapRespHeaders );
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -1521,31 +1627,34 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 //
 /////////////////////////////////////////////////////////////////////////////
 
-Serializer *HTTPRequest::GetSerializer()
+Serializer *HTTPRequest::GetSerializer( QIODevice *pDevice )
 {
     Serializer *pSerializer = NULL;
 
+    if (pDevice == NULL)
+        pDevice = &m_response;
+
     if (m_bSOAPRequest) 
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     else
     {
         QString sAccept = GetHeaderValue( "Accept", "*/*" );
         
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ))    
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/javascript", Qt::CaseInsensitive ))    
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/x-apple-plist+xml", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new XmlPListSerializer(&m_response);
+            pSerializer = (Serializer *)new XmlPListSerializer(pDevice);
     }
 
     // Default to XML
 
     if (pSerializer == NULL)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
 
     return pSerializer;
 }
@@ -141,6 +141,12 @@ class UPNP_PUBLIC HTTPRequest
 
         IPostProcess       *m_pPostProcess;
 
+        // Set when the body has been streamed with SendChunk() instead of
+        // being buffered in m_response.
+
+        bool                m_bChunked;
+        qint64              m_nChunkedBytes;
+
     protected:
 
         RequestType     SetRequestType      ( const QString &sType  );
@@ -182,18 +188,22 @@ class UPNP_PUBLIC HTTPRequest
                                               const QString &sDetails );
 
         void            FormatActionResponse( Serializer *ser );
+        void            FormatChunkedResponse( Serializer *ser );
         void            FormatActionResponse( const NameValues &pArgs );
         void            FormatFileResponse  ( const QString &sFileName );
         void            FormatRawResponse   ( const QString &sXML );
 
         long            SendResponse    ( void );
         long            SendResponseFile( QString sFileName );
+        qint64          SendChunk       ( const char *pData, qint64 nLen );
+
+        bool            CanSendChunked  ();
 
         QString         GetHeaderValue  ( const QString &sKey, QString sDefault );
 
         bool            GetKeepAlive    ();
 
-        Serializer *    GetSerializer   ();
+        Serializer *    GetSerializer   ( QIODevice *pDevice = NULL );
 
         static QString  GetMimeType     ( const QString &sFileExtension );
         static QString  TestMimeType    ( const QString &sFileName );
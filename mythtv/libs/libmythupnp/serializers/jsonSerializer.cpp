@@ -247,21 +247,45 @@ QString JSONSerializer::Encode(const QString &sIn)
     if (sIn.isEmpty())
         return sIn;
 
-    QString sStr = sIn;
+    // Walk the string once, only building a new string when a character
+    // actually needs escaping.  Most values (numbers, dates, plain titles)
+    // are returned without any copy.
 
-    // -=>TODO: Would it be better to just loop through string once and build 
-    // new string with encoded chars instead of calling replace multiple times?
-    // It might perform better.
+    QString      sStr;
+    const QChar *pIn    = sIn.constData();
+    int          nLen   = sIn.length();
+    int          nStart = 0;
 
-    sStr.replace( '\\', "\\\\" ); // This must be first
-    sStr.replace( '"' , "\\\"" ); 
+    for (int nIdx = 0; nIdx < nLen; ++nIdx)
+    {
+        const char *pszEscape = NULL;
+
+        switch (pIn[ nIdx ].unicode())
+        {
+            case '\\': pszEscape = "\\\\"; break;
+            case '"' : pszEscape = "\\\""; break;
+            case '\b': pszEscape = "\\b";  break;
+            case '\f': pszEscape = "\\f";  break;
+            case '\n': pszEscape = "\\n";  break;
+            case '\r': pszEscape = "\\r";  break;
+            case '\t': pszEscape = "\\t";  break;
+            case '/' : pszEscape = "\\/";  break;
+            default  : continue;
+        }
+
+        if (sStr.isNull())
+            sStr.reserve( nLen + 16 );
+
+        sStr.append( sIn.midRef( nStart, nIdx - nStart ) );
+        sStr.append( QLatin1String( pszEscape ) );
+
+        nStart = nIdx + 1;
+    }
+
+    if (nStart == 0)
+        return sIn;
 
-    sStr.replace( '\b', "\\b"  );
-    sStr.replace( '\f', "\\f"  );
-    sStr.replace( '\n', "\\n"  );
-    sStr.replace( "\r", "\\r"  );
-    sStr.replace( "\t", "\\t"  );
-    sStr.replace(  "/", "\\/"  );
+    sStr.append( sIn.midRef( nStart ) );
 
     // we don't handle hex values yet...
     /*
@@ -24,7 +24,9 @@ void Serializer::AddHeaders( QStringMap &headers )
     headers[ "Cache-Control" ] = "no-cache=\"Ext\", "
                                  "max-age = 5000";
     
-    headers[ "ETag" ] = "\"" + m_hash.result().toHex() + "\"";
+    // Without the content hash there is nothing to base an ETag on
+    if (m_bHashContent)
+        headers[ "ETag" ] = "\"" + m_hash.result().toHex() + "\"";
 
 }
 
@@ -87,7 +89,8 @@ void Serializer::Serialize( const QVariant &vValue, const QString &_sName )
 
 void Serializer::SerializeObject( const QObject *pObject, const QString &sName )
 {
-    m_hash.addData( sName.toUtf8() );
+    if (m_bHashContent)
+        m_hash.addData( sName.toUtf8() );
 
     BeginObject( sName, pObject );
 
@@ -122,7 +125,8 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
                 
                 bool bHash = false;
 
-                if (ReadPropertyMetadata( pObject, 
+                if (m_bHashContent &&
+                    ReadPropertyMetadata( pObject,
                                           sPropName, 
                                           "transient").toLower() != "true" )
                 {
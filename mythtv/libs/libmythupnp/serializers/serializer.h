@@ -33,6 +33,7 @@ class UPNP_PUBLIC Serializer
     protected:
 
         QCryptographicHash  m_hash;
+        bool                m_bHashContent;
 
         virtual void BeginSerialize( QString &sName ) {}
         virtual void EndSerialize  () {}
@@ -66,6 +67,10 @@ class UPNP_PUBLIC Serializer
         virtual QString GetContentType () = 0;
         virtual void    AddHeaders     ( QStringMap &headers );
 
+        // The content hash is only needed for the ETag header, streamed
+        // responses can skip it.
+        void            SetHashContent ( bool bHash ) { m_bHashContent = bHash; }
+
 
         inline Serializer();
 };
@@ -73,7 +78,7 @@ class UPNP_PUBLIC Serializer
 Q_DECLARE_METATYPE( QList<QObject*> )
 
 inline Serializer::Serializer() :
-    m_hash(QCryptographicHash::Sha1)
+    m_hash(QCryptographicHash::Sha1), m_bHashContent(true)
 {
     qRegisterMetaType< QList<QObject*> >("QList<QObject*>");
 }
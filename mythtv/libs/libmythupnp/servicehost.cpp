@@ -14,6 +14,7 @@
 
 #include "mythlogging.h"
 #include "servicehost.h"
+#include "httpchunkedstream.h"
 #include "wsdl.h"
 #include "xsd.h"
 
@@ -28,6 +29,7 @@ MethodInfo::MethodInfo()
     m_nMethodIndex = 0;
     m_eRequestType = (RequestType)(RequestTypeGet | RequestTypePost |
                                    RequestTypeHead);
+    m_bChunked     = false;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -251,6 +253,24 @@ ServiceHost::ServiceHost(const QMetaObject &metaObject,
                                                          RequestTypeHead);
             }
 
+            // ------------------------------------------------------
+            // Methods returning large lists can ask for their
+            // response to be streamed to the client as it is
+            // serialized rather than buffered in memory.
+            // ------------------------------------------------------
+
+            QString sChunkedClassInfo = oInfo.m_sName + "_Chunked";
+
+            nClassIdx =
+                m_oMetaObject.indexOfClassInfo(sChunkedClassInfo.toLatin1());
+
+            if (nClassIdx >=0)
+            {
+                QString sChunked = m_oMetaObject.classInfo(nClassIdx).value();
+
+                oInfo.m_bChunked = (sChunked.toLower() == "true");
+            }
+
             m_Methods.insert( oInfo.m_sName, oInfo );
         }
     }
@@ -400,7 +420,14 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
                     QVariant vResult = oInfo.Invoke(pService,
                                                     pRequest->m_mapParams);
 
-                    bHandled = FormatResponse( pRequest, vResult );
+                    if (oInfo.m_bChunked && pRequest->CanSendChunked() &&
+                        vResult.canConvert< QObject* >())
+                    {
+                        bHandled = FormatChunkedResponse(
+                            pRequest, vResult.value< QObject* >() );
+                    }
+                    else
+                        bHandled = FormatResponse( pRequest, vResult );
                 }
             }
 
@@ -468,6 +495,44 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QObject *pResults )
     return false;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Serializes directly to the socket using chunked transfer encoding so the
+// response (and its gzip'd copy) is never held in memory as a whole.
+/////////////////////////////////////////////////////////////////////////////
+
+bool ServiceHost::FormatChunkedResponse( HTTPRequest *pRequest,
+                                         QObject     *pResults )
+{
+    if (pResults == NULL)
+    {
+        UPnp::FormatErrorResponse( pRequest, UPnPResult_ActionFailed, "Call to method failed" );
+        return false;
+    }
+
+    bool bGzip = pRequest->GetHeaderValue( "Accept-Encoding", "" )
+                                                        .contains( "gzip" );
+
+    HTTPChunkedStream stream( pRequest, bGzip );
+
+    stream.open( QIODevice::WriteOnly );
+
+    Serializer *pSer = pRequest->GetSerializer( &stream );
+
+    pSer->SetHashContent( false );
+
+    pRequest->FormatChunkedResponse( pSer );
+
+    pSer->Serialize( pResults );
+
+    delete pSer;
+
+    stream.close();
+
+    delete pResults;
+
+    return true;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -38,6 +38,7 @@ class UPNP_PUBLIC MethodInfo
         QString         m_sName;
         QMetaMethod     m_oMethod;
         RequestType     m_eRequestType;
+        bool            m_bChunked;
 
     public:
         MethodInfo();
@@ -72,6 +73,9 @@ class UPNP_PUBLIC ServiceHost : public HttpServerExtension
         virtual bool FormatResponse( HTTPRequest *pRequest, QFileInfo  oInfo    );
         virtual bool FormatResponse( HTTPRequest *pRequest, QVariant   vValue   );
 
+        virtual bool FormatChunkedResponse( HTTPRequest *pRequest,
+                                            QObject     *pResults );
+
     public:
 
                  ServiceHost( const QMetaObject &metaObject,
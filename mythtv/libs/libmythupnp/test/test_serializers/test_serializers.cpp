@@ -0,0 +1,3 @@
+#include "test_serializers.h"
+
+QTEST_APPLESS_MAIN(TestSerializers)
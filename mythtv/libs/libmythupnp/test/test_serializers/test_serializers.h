@@ -0,0 +1,249 @@
+/*
+ *  Class TestSerializers
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QBuffer>
+
+#include "httprequest.h"
+#include "httpchunkedstream.h"
+#include "upnputil.h"
+#include "jsonSerializer.h"
+#include "xmlSerializer.h"
+#include "datacontracts/programList.h"
+#include "datacontracts/programGuide.h"
+
+/*
+ * A request without a socket, it counts what would have been sent
+ */
+class NullRequest : public HTTPRequest
+{
+  public:
+    NullRequest() : m_nWritten(0)
+    {
+        m_nMajor = 1;
+        m_nMinor = 1;
+    }
+
+    virtual qlonglong  BytesAvailable  () { return 0; }
+    virtual qulonglong WaitForMore     ( int, bool *timeout = NULL )
+        { if (timeout) *timeout = true; return 0; }
+    virtual bool       CanReadLine     () { return false; }
+    virtual QString    ReadLine        ( int = 0 ) { return QString(); }
+    virtual qlonglong  ReadBlock       ( char *, qulonglong, int = 0 )
+        { return -1; }
+    virtual qlonglong  WriteBlock      ( const char *, qulonglong nLen )
+        { m_nWritten += nLen; return nLen; }
+    virtual qlonglong  WriteBlockDirect( const char *, qulonglong nLen )
+        { m_nWritten += nLen; return nLen; }
+    virtual QString    GetHostAddress  () { return "127.0.0.1"; }
+    virtual QString    GetPeerAddress  () { return "127.0.0.1"; }
+    virtual void       Flush           () { }
+    virtual bool       IsValid         () { return true; }
+    virtual int        getSocketHandle () { return -1; }
+    virtual void       SetBlocking     ( bool ) { }
+    virtual bool       IsBlocking      () { return true; }
+
+    qlonglong m_nWritten;
+};
+
+class TestSerializers: public QObject
+{
+    Q_OBJECT
+
+    static void fillProgram(DTC::Program *pProgram, const QDateTime &start,
+                            int nIdx)
+    {
+        pProgram->setStartTime  ( start );
+        pProgram->setEndTime    ( start.addSecs( 3600 ) );
+        pProgram->setTitle      ( QString( "Title \"%1\"" ).arg( nIdx % 500 ) );
+        pProgram->setSubTitle   ( QString( "Episode %1" ).arg( nIdx ) );
+        pProgram->setCategory   ( "Documentary" );
+        pProgram->setCatType    ( "series" );
+        pProgram->setSeriesId   ( QString( "EP%1" ).arg( nIdx % 500, 8, 10, QChar('0') ) );
+        pProgram->setProgramId  ( QString( "EP%1" ).arg( nIdx, 12, 10, QChar('0') ) );
+        pProgram->setDescription(
+            "A look behind the scenes of the making of a new album, "
+            "from the first demos in Stockholm to the recordings in "
+            "Chicago and Los Angeles.\nPart of a series." );
+    }
+
+    // Dvr/GetRecordedList of a well used backend
+    static QObject *recordedList(int nRecordings)
+    {
+        DTC::ProgramList *pList = new DTC::ProgramList();
+        QDateTime start(QDate(2014, 1, 1), QTime(20, 0), Qt::UTC);
+
+        for (int n = 0; n < nRecordings; n++)
+        {
+            DTC::Program *pProgram = pList->AddNewProgram();
+            fillProgram( pProgram, start.addSecs( -86400 * (n / 4) ), n );
+
+            pProgram->setFileName( QString( "1001_%1.ts" ).arg( n ) );
+            pProgram->setHostName( "backend" );
+            pProgram->setFileSize( 3000000000LL );
+
+            DTC::ChannelInfo *pChannel = pProgram->Channel();
+            pChannel->setChanId  ( 1001 + n % 50 );
+            pChannel->setChanNum ( QString::number( 1 + n % 50 ) );
+            pChannel->setCallSign( QString( "CHAN%1" ).arg( n % 50 ) );
+            pChannel->setSerializeDetails( false );
+
+            DTC::RecordingInfo *pRecording = pProgram->Recording();
+            pRecording->setStartTs( pProgram->StartTime() );
+            pRecording->setEndTs  ( pProgram->EndTime() );
+            pRecording->setRecGroup( "Default" );
+        }
+
+        pList->setCount( nRecordings );
+        pList->setTotalAvailable( nRecordings );
+        return pList;
+    }
+
+    // Guide/GetProgramGuide with an hour long program per channel and hour
+    static QObject *programGuide(int nChannels, int nDays)
+    {
+        DTC::ProgramGuide *pGuide = new DTC::ProgramGuide();
+        QDateTime start(QDate(2014, 1, 1), QTime(0, 0), Qt::UTC);
+
+        for (int c = 0; c < nChannels; c++)
+        {
+            DTC::ChannelInfo *pChannel = pGuide->AddNewChannel();
+            pChannel->setChanId     ( 1001 + c );
+            pChannel->setChanNum    ( QString::number( c + 1 ) );
+            pChannel->setCallSign   ( QString( "CHAN%1" ).arg( c ) );
+            pChannel->setChannelName( QString( "Channel %1" ).arg( c ) );
+            pChannel->setSerializeDetails( false );
+
+            for (int h = 0; h < nDays * 24; h++)
+            {
+                DTC::Program *pProgram = pChannel->AddNewProgram();
+                fillProgram( pProgram, start.addSecs( 3600 * h ),
+                             c * nDays * 24 + h );
+                pProgram->setSerializeDetails( false );
+                pProgram->setSerializeChannel( false );
+            }
+        }
+
+        pGuide->setStartTime( start );
+        pGuide->setEndTime( start.addDays( nDays ) );
+        pGuide->setNumOfChannels( nChannels );
+        pGuide->setCount( nChannels );
+        return pGuide;
+    }
+
+  private slots:
+    void Serialize_data(void)
+    {
+        QTest::addColumn<QString>("method");
+        QTest::addColumn<int>("size");
+        QTest::addColumn<bool>("json");
+        QTest::addColumn<bool>("chunked");
+        QTest::addColumn<bool>("gzip");
+
+        const char *modes[4] = { "buffered", "chunked",
+                                 "buffered, gzip", "chunked, gzip" };
+        for (int m = 0; m < 8; m++)
+        {
+            bool json = m >= 4, chunked = m & 1, gzip = m & 2;
+            QString mode = QString("%1 %2").arg(json ? "json" : "xml")
+                                           .arg(modes[m & 3]);
+            QTest::newRow(qPrintable(QString("GetRecordedList 5000, %1")
+                                     .arg(mode)))
+                << "GetRecordedList" << 5000 << json << chunked << gzip;
+            QTest::newRow(qPrintable(QString("GetProgramGuide 500x1d, %1")
+                                     .arg(mode)))
+                << "GetProgramGuide" << 1 << json << chunked << gzip;
+            QTest::newRow(qPrintable(QString("GetProgramGuide 500x14d, %1")
+                                     .arg(mode)))
+                << "GetProgramGuide" << 14 << json << chunked << gzip;
+        }
+    }
+
+    // What the buffered path (including HTTPRequest::SendResponse()'s
+    // gzipCompress() of the whole body) and ServiceHost's chunked path pay
+    // to serialize a large result, and how much each of them sends.  The
+    // result objects are built before the benchmark in both cases.
+    void Serialize(void)
+    {
+        QFETCH(QString, method);
+        QFETCH(int,     size);
+        QFETCH(bool,    json);
+        QFETCH(bool,    chunked);
+        QFETCH(bool,    gzip);
+
+        QObject *pResults = (method == "GetRecordedList") ?
+            recordedList( size ) : programGuide( 500, size );
+
+        qlonglong nSent = 0;
+
+        QBENCHMARK_ONCE
+        {
+            NullRequest request;
+            request.m_sMethod = method;
+
+            QBuffer buffer;
+            HTTPChunkedStream *pStream = NULL;
+            QIODevice *pDevice = &buffer;
+            if (chunked)
+                pDevice = pStream = new HTTPChunkedStream( &request, gzip );
+            pDevice->open( QIODevice::WriteOnly );
+
+            Serializer *pSer = json ?
+                (Serializer *)new JSONSerializer( pDevice, method ) :
+                (Serializer *)new XmlSerializer ( pDevice, method );
+
+            // The same order as ServiceHost, streamed responses need their
+            // headers before the first chunk goes out
+            if (chunked)
+            {
+                pSer->SetHashContent( false );
+                request.FormatChunkedResponse( pSer );
+            }
+
+            pSer->Serialize( pResults );
+
+            if (!chunked)
+                request.FormatActionResponse( pSer );
+            delete pSer;
+
+            pDevice->close();
+            if (chunked)
+                nSent = request.m_nWritten;
+            else if (gzip)
+                nSent = gzipCompress( buffer.buffer() ).size();
+            else
+                nSent = buffer.size();
+            delete pStream;
+
+            if (chunked)
+                QVERIFY( !request.m_mapRespHeaders.contains( "ETag" ) );
+            else
+                QVERIFY( request.m_mapRespHeaders.contains( "ETag" ) );
+            QCOMPARE( request.m_mapRespHeaders.contains( "Content-Encoding" ),
+                      chunked && gzip );
+            QVERIFY( request.m_mapRespHeaders.contains( "Cache-Control" ) );
+        }
+
+        qDebug() << method << size << (json ? "json" : "xml")
+                 << (chunked ? "chunked" : "buffered")
+                 << (gzip ? "gzip'd" : "plain") << nSent << "bytes";
+        QVERIFY( nSent > 0 );
+
+        delete pResults;
+    }
+};
@@ -17,6 +17,7 @@
 #include <QMap>
 
 #include "compat.h"     // for suseconds_t
+#include "upnpexp.h"
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -142,6 +143,6 @@ bool operator==           ( TaskTime t1, TaskTime t2 );
 void AddMicroSecToTaskTime( TaskTime &t, suseconds_t uSecs );
 void AddSecondsToTaskTime ( TaskTime &t, long nSecs );
 
-QByteArray gzipCompress( const QByteArray &data );
+UPNP_PUBLIC QByteArray gzipCompress( const QByteArray &data );
 
 #endif
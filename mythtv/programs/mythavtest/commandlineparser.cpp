@@ -47,5 +47,25 @@ void MythAVTestCommandLineParser::LoadArguments(void)
                     "The number of seconds to run the test (default 5).", "")
                     ->SetGroup("Video Performance Testing")
                     ->SetChildOf("test");
+    add(QStringList(QStringList() << "--zaptest"), "zaptest", false,
+                    "Test channel change time.",
+                    "Start LiveTV and change the channel up repeatedly, "
+                    "then report the percentiles of the time from the "
+                    "channel change to the first frame due to be shown. "
+                    "Nothing is sent to the video or audio output. "
+                    "Use -v channel "
+                    "to log the time of each phase of the channel changes, "
+                    "and a DEMO or IMPORT capture card to test without "
+                    "tuner hardware.")
+                    ->SetGroup("Channel Change Testing")
+                    ->SetBlocks("test");
+    add(QStringList(QStringList() << "--zaps"), "zaps", "",
+                    "The number of channel changes (default 20).", "")
+                    ->SetGroup("Channel Change Testing")
+                    ->SetChildOf("zaptest");
+    add(QStringList(QStringList() << "--zapinterval"), "zapinterval", "",
+                    "Seconds between channel changes (default 10).", "")
+                    ->SetGroup("Channel Change Testing")
+                    ->SetChildOf("zaptest");
 }
 
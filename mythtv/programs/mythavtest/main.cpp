@@ -1,5 +1,6 @@
 #include <unistd.h>
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -7,6 +8,7 @@ using namespace std;
 #include <QRegExp>
 #include <QDir>
 #include <QApplication>
+#include <QTimerEvent>
 #include <QTime>
 
 #include "tv_play.h"
@@ -14,6 +16,7 @@ using namespace std;
 #include "commandlineparser.h"
 #include "mythplayer.h"
 #include "jitterometer.h"
+#include "zaptrace.h"
 
 #include "exitcodes.h"
 #include "mythcontext.h"
@@ -24,6 +27,7 @@ using namespace std;
 #include "mythlogging.h"
 #include "signalhandling.h"
 #include "mythmiscutil.h"
+#include "mythevent.h"
 
 // libmythui
 #include "mythuihelper.h"
@@ -144,6 +148,83 @@ class VideoPerformanceTest
     PlayerContext *ctx;
 };
 
+/** \brief Changes the channel of LiveTV over and over, and reports how
+ *         long it took from the key press to the first frame shown.
+ *
+ *  The channel changes are sent the same way as the network control
+ *  "play channel up" command.  The player has no video or audio output,
+ *  like the decode only test, a frame counts as shown when it is due.
+ *  Use a DEMO or IMPORT capture card to test the frontend and the
+ *  recorder without tuner hardware.
+ */
+class ZapTest : public QObject
+{
+  public:
+    ZapTest(int zaps, int interval)
+      : zapsToSend(zaps), zapsSent(0), timerId(0)
+    {
+        if (interval < 1)
+            interval = 1;
+        timerId = startTimer(interval * 1000);
+        ZapTrace::ClearZapTimes();
+    }
+
+    void Report(void)
+    {
+        QList<int> times = ZapTrace::GetZapTimes();
+        std::sort(times.begin(), times.end());
+
+        LOG(VB_GENERAL, LOG_INFO, "-----------------------------------");
+        LOG(VB_GENERAL, LOG_INFO, QString("%1 of %2 channel changes finished")
+            .arg(times.size()).arg(zapsSent));
+
+        if (!times.empty())
+        {
+            LOG(VB_GENERAL, LOG_INFO,
+                QString("Channel change time: min %1 ms, 50% %2 ms, "
+                        "90% %3 ms, 99% %4 ms, max %5 ms")
+                    .arg(times.front()).arg(Percentile(times, 50))
+                    .arg(Percentile(times, 90)).arg(Percentile(times, 99))
+                    .arg(times.back()));
+        }
+        LOG(VB_GENERAL, LOG_INFO, "-----------------------------------");
+    }
+
+  protected:
+    void timerEvent(QTimerEvent *e)
+    {
+        if (e->timerId() != timerId)
+            return;
+
+        QString message = "NETWORK_CONTROL CHANNEL UP";
+        if (zapsSent < zapsToSend)
+        {
+            zapsSent++;
+        }
+        else
+        {
+            message = "NETWORK_CONTROL STOP";
+            killTimer(timerId);
+            timerId = 0;
+        }
+
+        MythEvent me(message);
+        gCoreContext->dispatch(me);
+    }
+
+  private:
+    /// Nearest-rank percentile of a sorted list
+    static int Percentile(const QList<int> &sorted, int percent)
+    {
+        int rank = (sorted.size() * percent + 99) / 100;
+        return sorted[std::max(rank, 1) - 1];
+    }
+
+    int zapsToSend;
+    int zapsSent;
+    int timerId;
+};
+
 int main(int argc, char *argv[])
 {
     MythAVTestCommandLineParser cmdline;
@@ -219,7 +300,7 @@ int main(int argc, char *argv[])
     // Mac OS X doesn't define the AudioOutputDevice setting
 #else
     QString auddevice = gCoreContext->GetSetting("AudioOutputDevice");
-    if (auddevice.isEmpty())
+    if (auddevice.isEmpty() && !cmdline.toBool("zaptest"))
     {
         LOG(VB_GENERAL, LOG_ERR, "Fatal Error: Audio not configured, you need "
                                  "to run 'mythfrontend', not 'mythtv'.");
@@ -268,7 +349,19 @@ int main(int argc, char *argv[])
             return GENERIC_EXIT_DB_OUTOFDATE;
         }
 
-        if (filename.isEmpty())
+        if (cmdline.toBool("zaptest"))
+        {
+            int zaps = 20, interval = 10;
+            if (!cmdline.toString("zaps").isEmpty())
+                zaps = cmdline.toInt("zaps");
+            if (!cmdline.toString("zapinterval").isEmpty())
+                interval = cmdline.toInt("zapinterval");
+
+            ZapTest test(zaps, interval);
+            TV::StartTV(NULL, kStartTVNullOutput);
+            test.Report();
+        }
+        else if (filename.isEmpty())
         {
             TV::StartTV(NULL, kStartTVNoFlags);
         }
@@ -4,6 +4,8 @@
 
 #include "filetransfer.h"
 #include "ringbuffer.h"
+#include "threadedfilewriter.h"
+#include "compat.h"
 #include "mythdate.h"
 #include "mythsocket.h"
 #include "programinfo.h"
@@ -13,18 +15,31 @@ FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, int timeout_ms) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
     readthreadlive(true), readsLocked(false),
-    rbuffer(RingBuffer::Create(filename, false, usereadahead, timeout_ms, true)),
+    timeshift(ThreadedFileWriter::IsTimeshifted(filename)),
+    tsfile(filename), tspos(0),
+    // The start of a timeshifted recording may not be on disk yet, so
+    // the RingBuffer isn't opened for it.
+    rbuffer(RingBuffer::Create(filename, false, usereadahead && !timeshift,
+                               timeshift ? -1 : timeout_ms, true)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
     writemode(false)
 {
     pginfo = new ProgramInfo(filename);
     pginfo->MarkAsInUse(true, kFileTransferInUseID);
     rbuffer->Start();
+
+    if (timeshift)
+    {
+        LOG(VB_FILE, LOG_INFO, QString("FileTransfer: Serving '%1' from the "
+                                       "timeshift buffer").arg(filename));
+        tsfile.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
 }
 
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote, bool write) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
     readthreadlive(true), readsLocked(false),
+    timeshift(false), tspos(0),
     rbuffer(RingBuffer::Create(filename, write)),
     sock(remote), ateof(false), lock(QMutex::NonRecursive),
     writemode(write)
@@ -59,6 +74,8 @@ FileTransfer::~FileTransfer()
 
 bool FileTransfer::isOpen(void)
 {
+    if (timeshift)
+        return tsfile.isOpen();
     if (rbuffer && rbuffer->IsOpen())
         return true;
     return false;
@@ -132,6 +149,15 @@ int FileTransfer::RequestBlock(int size)
 
     requestBuffer.resize(max((size_t)max(size,0) + 128, requestBuffer.size()));
     char *buf = &requestBuffer[0];
+
+    if (timeshift)
+    {
+        tot = RequestTimeshiftBlock(buf, size);
+        if (pginfo)
+            pginfo->UpdateInUseMark();
+        return tot;
+    }
+
     while (tot < size && !rbuffer->GetStopReads() && readthreadlive)
     {
         int request = size - tot;
@@ -158,6 +184,48 @@ int FileTransfer::RequestBlock(int size)
     return (ret < 0) ? -1 : tot;
 }
 
+/** \brief Sends the recording from the writer's RAM where it is not on
+ *         disk yet, and from the file otherwise.  lock must be held.
+ */
+int FileTransfer::RequestTimeshiftBlock(char *buf, int size)
+{
+    int tot = 0;
+    uint zerocnt = 0;
+
+    while (tot < size && readthreadlive)
+    {
+        int request = size - tot;
+
+        int ret = ThreadedFileWriter::ReadTimeshift(
+            tsfile.fileName(), tspos, buf, request);
+        if (ret <= 0 && tsfile.seek(tspos))
+            ret = tsfile.read(buf, request);
+
+        if (ret < 0)
+            return -1;
+
+        if (ret == 0)
+        {
+            // Wait for the recorder like FileRingBuffer::safe_read() does
+            if (tot > 0 || ++zerocnt >= 40 ||
+                !ThreadedFileWriter::IsTimeshifted(tsfile.fileName()))
+            {
+                break;
+            }
+            usleep(60000);
+            continue;
+        }
+
+        if (sock->Write(buf, (uint)ret) != ret)
+            return -1;
+
+        tot   += ret;
+        tspos += ret;
+    }
+
+    return tot;
+}
+
 int FileTransfer::WriteBlock(int size)
 {
     if (!writemode || !rbuffer)
@@ -232,6 +300,19 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
 
     ateof = false;
 
+    if (timeshift)
+    {
+        QMutexLocker locker(&lock);
+        if (whence == SEEK_SET)
+            tspos = pos;
+        else if (whence == SEEK_CUR)
+            tspos = curpos + pos;
+        else if (whence == SEEK_END)
+            tspos = (long long) GetFileSize() + pos;
+        tspos = max(tspos, 0LL);
+        return tspos;
+    }
+
     Pause();
 
     if (whence == SEEK_CUR)
@@ -257,6 +338,14 @@ uint64_t FileTransfer::GetFileSize(void)
     if (pginfo)
         pginfo->UpdateInUseMark();
 
+    if (timeshift)
+    {
+        long long size = ThreadedFileWriter::GetTimeshiftSize(
+            tsfile.fileName());
+        if (size >= 0)
+            return size;
+    }
+
     return QFileInfo(rbuffer->GetFilename()).size();
 }
 
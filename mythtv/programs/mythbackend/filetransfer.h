@@ -11,6 +11,7 @@ using namespace std;
 // Qt headers
 #include <QMutex>
 #include <QWaitCondition>
+#include <QFile>
 
 // MythTV headers
 #include "referencecounter.h"
@@ -50,10 +51,18 @@ class FileTransfer : public ReferenceCounter
   private:
    ~FileTransfer();
 
+    int RequestTimeshiftBlock(char *buf, int size);
+
     volatile bool  readthreadlive;
     bool           readsLocked;
     QWaitCondition readsUnlockedCond;
 
+    // LiveTV recording being written with a timeshift, see
+    // ThreadedFileWriter::SetTimeshift()
+    bool           timeshift;
+    QFile          tsfile;       ///< spilled part of the recording
+    long long      tspos;
+
     ProgramInfo *pginfo;
     RingBuffer *rbuffer;
     MythSocket *sock;
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httphlsremux.cpp
+//
+// Purpose - Serves remuxed HTTP Live Stream playlists and segments
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "httphlsremux.h"
+#include "httprequest.h"
+#include "mythlogging.h"
+#include "HLS/hlsremuxer.h"
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpHLSRemux::HttpHLSRemux( const QString &sSharePath )
+        : HttpServerExtension( "HttpHLSRemux", sSharePath )
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpHLSRemux::~HttpHLSRemux()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+QStringList HttpHLSRemux::GetBasePaths()
+{
+    return QStringList( "/HLSRemux" );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HttpHLSRemux::ProcessRequest( HTTPRequest *pRequest )
+{
+    if (!pRequest || pRequest->m_sBaseUrl != "/HLSRemux")
+        return false;
+
+    LOG(VB_UPNP, LOG_INFO,
+        QString("HttpHLSRemux::ProcessRequest: %1 : %2")
+            .arg(pRequest->m_sMethod)
+            .arg(pRequest->m_sRawRequest));
+
+    bool bOk       = false;
+    int  nStreamId = pRequest->m_mapParams[ "streamid" ].toInt( &bOk );
+
+    if (!bOk)
+        return false;
+
+    if (pRequest->m_sMethod == "GetPlaylist")
+    {
+        GetPlaylist( pRequest, nStreamId );
+        return true;
+    }
+
+    if (pRequest->m_sMethod == "GetSegment")
+    {
+        GetSegment( pRequest, nStreamId );
+        return true;
+    }
+
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpHLSRemux::GetPlaylist( HTTPRequest *pRequest, int nStreamId )
+{
+    QByteArray playlist = HLSRemuxer::GetPlaylist( nStreamId );
+
+    if (playlist.isEmpty())
+    {
+        pRequest->m_eResponseType   = ResponseTypeHTML;
+        pRequest->m_nResponseStatus = 404;
+        return;
+    }
+
+    pRequest->m_eResponseType     = ResponseTypeOther;
+    pRequest->m_sResponseTypeText = "application/vnd.apple.mpegurl";
+    pRequest->m_response.write( playlist );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpHLSRemux::GetSegment( HTTPRequest *pRequest, int nStreamId )
+{
+    bool bOk      = false;
+    uint nSegment = pRequest->m_mapParams[ "segment" ].toUInt( &bOk );
+
+    QByteArray segment;
+
+    if (bOk)
+        segment = HLSRemuxer::GetSegment( nStreamId, nSegment );
+
+    if (segment.isEmpty())
+    {
+        pRequest->m_eResponseType   = ResponseTypeHTML;
+        pRequest->m_nResponseStatus = 404;
+        return;
+    }
+
+    // Segments never change, let clients that seek back reuse theirs.
+
+    pRequest->m_mapRespHeaders[ "ETag" ] =
+        QString( "\"%1-%2\"" ).arg( nStreamId ).arg( nSegment );
+
+    pRequest->m_eResponseType     = ResponseTypeOther;
+    pRequest->m_sResponseTypeText = "video/MP2T";
+    pRequest->m_response.write( segment );
+}
@@ -0,0 +1,42 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httphlsremux.h
+//
+// Purpose - Serves remuxed HTTP Live Stream playlists and segments
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPHLSREMUX_H_
+#define HTTPHLSREMUX_H_
+
+#include "httpserver.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// Playlists and segments of live streams started with
+// HTTPLiveStream::StartRemux() are produced by HLSRemuxer as clients ask
+// for them:
+//
+//    /HLSRemux/GetPlaylist?StreamId=<id>
+//    /HLSRemux/GetSegment?StreamId=<id>&Segment=<n>
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+class HttpHLSRemux : public HttpServerExtension
+{
+    private:
+
+        void    GetPlaylist( HTTPRequest *pRequest, int nStreamId );
+        void    GetSegment ( HTTPRequest *pRequest, int nStreamId );
+
+    public:
+                 HttpHLSRemux( const QString &sSharePath );
+        virtual ~HttpHLSRemux();
+
+        virtual QStringList GetBasePaths();
+
+        bool     ProcessRequest( HTTPRequest *pRequest );
+};
+
+#endif
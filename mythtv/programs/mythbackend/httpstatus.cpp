@@ -27,11 +27,14 @@
 #include "mythcorecontext.h"
 #include "mythversion.h"
 #include "mythdbcon.h"
+#include "mythdb.h"
 #include "compat.h"
 #include "mythconfig.h"
 #include "autoexpire.h"
 #include "tv.h"
 #include "encoderlink.h"
+#include "recorders/positionmapwriter.h"
+#include "previewgeneratorqueue.h"
 #include "scheduler.h"
 #include "mainserver.h"
 #include "cardutil.h"
@@ -40,6 +43,7 @@
 #include "jobqueue.h"
 #include "upnp.h"
 #include "mythdate.h"
+#include "threadedfilewriter.h"
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -178,6 +182,12 @@ static QString setting_to_localtime(const char *setting)
     return MythDate::toString(origDate, MythDate::kDateTimeFull);
 }
 
+static bool query_stats_more_time(const MSqlQueryStats &a,
+                                  const MSqlQueryStats &b)
+{
+    return a.totalUSecs > b.totalUSecs;
+}
+
 void HttpStatus::FillStatusXML( QDomDocument *pDoc )
 {
     QDateTime qdtNow          = MythDate::current();
@@ -564,6 +574,105 @@ void HttpStatus::FillStatusXML( QDomDocument *pDoc )
         pDoc->createTextNode(gCoreContext->GetSetting("DataDirectMessage"));
     guide.appendChild(dataDirectMessage);
 
+    // Database connections and the most expensive queries ---------
+
+    MDBManager *dbmanager = GetMythDB()->GetDBManager();
+
+    if (dbmanager)
+    {
+        QDomElement database = pDoc->createElement("Database");
+        mInfo.appendChild(database);
+
+        uint hits = 0, misses = 0;
+        dbmanager->GetStatementCacheStats(hits, misses);
+
+        QStringList limits;
+        for (int i = 0; i < MSqlQueryStats::kHistogramBuckets - 1; i++)
+            limits << QString::number(MSqlQueryStats::HistogramLimit(i));
+
+        database.setAttribute("connections",
+                              dbmanager->GetConnectionCount());
+        database.setAttribute("idleConnections",
+                              dbmanager->GetIdleConnectionCount());
+        database.setAttribute("stmtCacheHits"  , hits  );
+        database.setAttribute("stmtCacheMisses", misses);
+        database.setAttribute("histogramLimits", limits.join(","));
+
+        QList<MSqlQueryStats> stats = dbmanager->GetQueryStats();
+        qSort(stats.begin(), stats.end(), query_stats_more_time);
+
+        for (int i = 0; i < stats.size() && i < 25; i++)
+        {
+            const MSqlQueryStats &qs = stats[i];
+            QDomElement stmt = pDoc->createElement("Query");
+            database.appendChild(stmt);
+
+            QStringList histogram;
+            for (int j = 0; j < MSqlQueryStats::kHistogramBuckets; j++)
+                histogram << QString::number(qs.histogram[j]);
+
+            stmt.setAttribute("caller"   , qs.caller);
+            stmt.setAttribute("count"    , qs.count);
+            stmt.setAttribute("failed"   , qs.failed);
+            stmt.setAttribute("totalMS"  , (qlonglong)(qs.totalUSecs / 1000));
+            stmt.setAttribute("maxMS"    , (qlonglong)(qs.maxUSecs / 1000));
+            stmt.setAttribute("histogram", histogram.join(","));
+            stmt.appendChild(pDoc->createTextNode(qs.sql.simplified()));
+        }
+    }
+
+    // Seek table writes still waiting to go to the database -------
+
+    uint pendingRows = 0, lagMS = 0;
+
+    if (PositionMapWriter::GetLag(pendingRows, lagMS))
+    {
+        QDomElement posmap = pDoc->createElement("PositionMapWriter");
+        mInfo.appendChild(posmap);
+
+        posmap.setAttribute("pendingRows", pendingRows);
+        posmap.setAttribute("lagMS"      , lagMS      );
+    }
+
+    // Preview generation ------------------
+
+    uint previewsQueued = 0, previewsRunning = 0, previewsDone = 0;
+    uint avgLatencyMS = 0, maxLatencyMS = 0;
+
+    if (PreviewGeneratorQueue::GetStats(previewsQueued, previewsRunning,
+                                        previewsDone, avgLatencyMS,
+                                        maxLatencyMS))
+    {
+        QDomElement previews = pDoc->createElement("PreviewQueue");
+        mInfo.appendChild(previews);
+
+        previews.setAttribute("queued"      , previewsQueued );
+        previews.setAttribute("running"     , previewsRunning);
+        previews.setAttribute("done"        , previewsDone   );
+        previews.setAttribute("avgLatencyMS", avgLatencyMS   );
+        previews.setAttribute("maxLatencyMS", maxLatencyMS   );
+    }
+
+    // LiveTV held in RAM ------------------
+
+    if (gCoreContext->GetNumSetting("LiveTVRAMBufferSize", 0))
+    {
+        TimeshiftStats ts = ThreadedFileWriter::GetTimeshiftStats();
+
+        QDomElement timeshift = pDoc->createElement("LiveTVRAMBuffer");
+        mInfo.appendChild(timeshift);
+
+        timeshift.setAttribute("buffers"     , ts.buffers);
+        timeshift.setAttribute("ramKB"       , (qulonglong)(ts.ramBytes / 1024));
+        timeshift.setAttribute("peakRAMKB"   ,
+                               (qulonglong)(ts.peakRAMBytes / 1024));
+        timeshift.setAttribute("spills"      , ts.spills);
+        timeshift.setAttribute("spilledKB"   ,
+                               (qulonglong)(ts.spilledBytes / 1024));
+        timeshift.setAttribute("servedFromRAMKB",
+                               (qulonglong)(ts.ramReadBytes / 1024));
+    }
+
     // Add Miscellaneous information
 
     QString info_script = gCoreContext->GetSetting("MiscStatusScript");
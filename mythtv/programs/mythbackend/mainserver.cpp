@@ -39,6 +39,7 @@ using namespace std;
 #include <QNetworkProxy>
 
 #include "previewgeneratorqueue.h"
+#include "recorders/positionmapwriter.h"
 #include "mythmiscutil.h"
 #include "mythsystemlegacy.h"
 #include "exitcodes.h"
@@ -239,6 +240,7 @@ MainServer::MainServer(bool master, int port,
     PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
         PreviewGenerator::kLocalAndRemote, ~0, 0);
     PreviewGeneratorQueue::AddListener(this);
+    PositionMapWriter::CreatePositionMapWriter();
 
     threadPool.setMaxThreadCount(PRT_STARTUP_THREAD_COUNT);
 
@@ -361,6 +363,7 @@ void MainServer::Stop()
 
     PreviewGeneratorQueue::RemoveListener(this);
     PreviewGeneratorQueue::TeardownPreviewGeneratorQueue();
+    PositionMapWriter::TeardownPositionMapWriter();
 
     if (mythserver)
     {
@@ -11,6 +11,7 @@
 #include "mediaserver.h"
 #include "httpconfig.h"
 #include "internetContent.h"
+#include "httphlsremux.h"
 #include "mythdirs.h"
 
 #include "upnpcdstv.h"
@@ -115,6 +116,7 @@ void MediaServer::Init(bool bIsMaster, bool bDisableUPnp /* = false */)
     LOG(VB_UPNP, LOG_INFO, "MediaServer::Registering Http Server Extensions.");
 
     m_pHttpServer->RegisterExtension( new InternetContent   ( m_sSharePath ));
+    m_pHttpServer->RegisterExtension( new HttpHLSRemux      ( m_sSharePath ));
 
     m_pHttpServer->RegisterExtension( new MythServiceHost   ( m_sSharePath ));
     m_pHttpServer->RegisterExtension( new GuideServiceHost  ( m_sSharePath ));
@@ -45,6 +45,7 @@
 #include "musicmetadata.h"
 #include "videometadatalistmanager.h"
 #include "HLS/httplivestream.h"
+#include "HLS/hlsremuxer.h"
 #include "mythmiscutil.h"
 #include "remotefile.h"
 
@@ -1120,6 +1121,31 @@ DTC::LiveStreamInfo *Content::AddRecordingLiveStream(
 
     QFileInfo fInfo( sFileName );
 
+    // ----------------------------------------------------------------------
+    // H.264 recordings can be segmented as they are, only transcode when
+    // the client asked for something smaller than the recording.
+    // ----------------------------------------------------------------------
+
+    if (gCoreContext->GetNumSetting( "HLSRemuxRecordings", 1 ) &&
+        HLSRemuxer::CanRemux( pginfo, sFileName, nWidth, nBitrate ))
+    {
+        uint nSrcWidth  = pginfo.QueryAverageWidth();
+        uint nSrcHeight = pginfo.QueryAverageHeight();
+
+        HTTPLiveStream *hls = new
+            HTTPLiveStream(sFileName,
+                           nSrcWidth  ? nSrcWidth  : 1280,
+                           nSrcHeight ? nSrcHeight : 720,
+                           nBitrate, nAudioBitrate, nMaxSegments, 10,
+                           32000, nSampleRate);
+
+        DTC::LiveStreamInfo *lsInfo = hls->StartRemux();
+
+        delete hls;
+
+        return lsInfo;
+    }
+
     return AddLiveStream( pginfo.GetStorageGroup(), fInfo.fileName(),
                           pginfo.GetHostname(), nMaxSegments, nWidth,
                           nHeight, nBitrate, nAudioBitrate, nSampleRate );
@@ -35,6 +35,7 @@
 #include "mythcorecontext.h"
 #include "mythdbcon.h"
 #include "mythlogging.h"
+#include "logstore.h"
 #include "storagegroup.h"
 #include "dbutil.h"
 #include "hardwareprofile.h"
@@ -432,13 +433,20 @@ DTC::LogMessageList *Myth::GetLogs(  const QString   &HostName,
                                      const QDateTime &FromTime,
                                      const QDateTime &ToTime,
                                      const QString   &Level,
-                                     const QString   &MsgContains )
+                                     const QString   &MsgContains,
+                                     int             Count )
 {
     DTC::LogMessageList *pList = new DTC::LogMessageList();
 
     MSqlQuery query(MSqlQuery::InitCon());
 
+    // This host's messages come from the log store mythlogserver keeps,
+    // when there is one, so searching them doesn't load the database
+    QString localHostName = gCoreContext->GetHostName();
+    bool bLogStore = QDir( LogStore::DefaultPath() ).exists();
+
     // Get host name list
+    QStringList hostNames;
     QString sql = "SELECT DISTINCT host FROM logging ORDER BY host ASC";
     if (!query.exec(sql))
     {
@@ -446,14 +454,24 @@ DTC::LogMessageList *Myth::GetLogs(  const QString   &HostName,
         throw( QString( "Database Error executing query." ));
     }
     while (query.next())
+        hostNames << query.value(0).toString();
+    if (bLogStore && !hostNames.contains(localHostName))
+    {
+        hostNames << localHostName;
+        hostNames.sort();
+    }
+
+    for (int i = 0; i < hostNames.size(); i++)
     {
         DTC::LabelValue *pLabelValue = pList->AddNewHostName();
-        QString availableHostName = query.value(0).toString();
+        QString availableHostName = hostNames[i];
         pLabelValue->setValue   ( availableHostName );
         pLabelValue->setActive  ( availableHostName == HostName );
         pLabelValue->setSelected( availableHostName == HostName );
     }
+
     // Get application list
+    QStringList applications;
     sql = "SELECT DISTINCT application FROM logging ORDER BY application ASC";
     if (!query.exec(sql))
     {
@@ -461,15 +479,62 @@ DTC::LogMessageList *Myth::GetLogs(  const QString   &HostName,
         throw( QString( "Database Error executing query." ));
     }
     while (query.next())
+        applications << query.value(0).toString();
+
+    if (bLogStore)
+    {
+        QStringList storeApplications =
+            LogStore::Applications( LogStore::DefaultPath() );
+        for (int i = 0; i < storeApplications.size(); i++)
+        {
+            if (!applications.contains(storeApplications[i]))
+                applications << storeApplications[i];
+        }
+        applications.sort();
+    }
+
+    for (int i = 0; i < applications.size(); i++)
     {
         DTC::LabelValue *pLabelValue = pList->AddNewApplication();
-        QString availableApplication = query.value(0).toString();
+        QString availableApplication = applications[i];
         pLabelValue->setValue   ( availableApplication );
         pLabelValue->setActive  ( availableApplication == Application );
         pLabelValue->setSelected( availableApplication == Application );
     }
 
-    if (!HostName.isEmpty() && !Application.isEmpty())
+    if (HostName.isEmpty() || Application.isEmpty())
+        return pList;
+
+    // With a store the newest messages come from it.  The database only
+    // has to provide those logged before the store's oldest one.
+    QList<LogStoreRow> storeRows;
+    QDateTime storeStart;
+    if (bLogStore && HostName == localHostName)
+    {
+        LogStoreFilter filter;
+        filter.application = Application;
+        filter.pid         = PID;
+        filter.tid         = TID;
+        filter.thread      = Thread;
+        filter.file        = Filename;
+        filter.line        = Line;
+        filter.function    = Function;
+        filter.from        = FromTime;
+        filter.to          = ToTime;
+        filter.level       = Level.isEmpty() ? -1 : (int)logLevelGet(Level);
+        filter.contains    = MsgContains;
+        filter.limit       = Count;
+
+        LogStore::Query( LogStore::DefaultPath(), filter, storeRows );
+
+        qlonglong oldest = LogStore::Oldest( LogStore::DefaultPath() );
+        if (oldest >= 0)
+            storeStart = MythDate::fromTime_t( oldest );
+    }
+
+    int nDBCount = (Count > 0) ? Count - storeRows.size() : 0;
+
+    if (Count <= 0 || nDBCount > 0)
     {
         // Get log messages
         sql = "SELECT host, application, pid, tid, thread, filename, "
@@ -491,6 +556,16 @@ DTC::LogMessageList *Myth::GetLogs(  const QString   &HostName,
         {
             sql.append("   AND message LIKE :MSGCONTAINS ");
         }
+        if (storeStart.isValid())
+        {
+            sql.append("   AND msgtime < :STORESTART ");
+        }
+        if (nDBCount > 0)
+        {
+            // The newest of them, still returned oldest first
+            sql = "SELECT * FROM (" + sql +
+                  " ORDER BY msgtime DESC LIMIT :COUNT) AS newest ";
+        }
         sql.append(" ORDER BY msgtime ASC;");
 
         query.prepare(sql);
@@ -517,6 +592,14 @@ DTC::LogMessageList *Myth::GetLogs(  const QString   &HostName,
         {
             query.bindValue(":MSGCONTAINS", "%" + MsgContains + "%" );
         }
+        if (storeStart.isValid())
+        {
+            query.bindValue(":STORESTART", storeStart);
+        }
+        if (nDBCount > 0)
+        {
+            query.bindValue(":COUNT", nDBCount);
+        }
 
         if (!query.exec())
         {
@@ -543,6 +626,24 @@ DTC::LogMessageList *Myth::GetLogs(  const QString   &HostName,
         }
     }
 
+    for (int i = 0; i < storeRows.size(); i++)
+    {
+        const LogStoreRow &row = storeRows[i];
+        DTC::LogMessage *pLogMessage = pList->AddNewLogMessage();
+
+        pLogMessage->setHostName( localHostName );
+        pLogMessage->setApplication( row.application );
+        pLogMessage->setPID( row.pid );
+        pLogMessage->setTID( row.tid );
+        pLogMessage->setThread( row.thread );
+        pLogMessage->setFilename( row.file );
+        pLogMessage->setLine( row.line );
+        pLogMessage->setFunction( row.function );
+        pLogMessage->setTime( MythDate::fromTime_t( row.epoch ) );
+        pLogMessage->setLevel( logLevelGetName( (LogLevel_t)row.level ) );
+        pLogMessage->setMessage( row.message );
+    }
+
     return pList;
 }
 
@@ -75,7 +75,8 @@ class Myth : public MythServices
                                                   const QDateTime &FromTime,
                                                   const QDateTime &ToTime,
                                                   const QString   &Level,
-                                                  const QString   &MsgContains
+                                                  const QString   &MsgContains,
+                                                  int             Count
                                                 );
 
         DTC::SettingList*   GetSetting          ( const QString   &HostName,
@@ -219,11 +220,12 @@ class ScriptableMyth : public QObject
                           const QDateTime &FromTime,
                           const QDateTime &ToTime,
                           const QString   &Level,
-                          const QString   &MsgContains )
+                          const QString   &MsgContains,
+                          int             Count )
         {
             return m_obj.GetLogs( HostName, Application, PID, TID, Thread,
                                   Filename, Line, Function, FromTime, ToTime,
-                                  Level, MsgContains );
+                                  Level, MsgContains, Count );
         }
 
         QObject* GetSetting ( const QString   &HostName,
@@ -5,6 +5,7 @@
 #include <QStringList>
 #include <QDateTime>
 #include <QDomDocument>
+#include <QXmlStreamReader>
 #include <QUrl>
 
 // C++ headers
@@ -571,11 +572,57 @@ ProgInfo *XMLTVParser::parseProgram(QDomElement &element)
     return pginfo;
 }
 
+/** \brief Reads the element the reader is at, with everything in it, into
+ *         an element of doc.
+ *
+ *  Like QDomDocument::setContent(), whitespace-only text is dropped.
+ */
+static QDomElement readElement(QXmlStreamReader &xml, QDomDocument &doc)
+{
+    QDomElement element = doc.createElement(xml.qualifiedName().toString());
+
+    QXmlStreamAttributes attributes = xml.attributes();
+    for (int i = 0; i < attributes.size(); ++i)
+    {
+        element.setAttribute(attributes[i].qualifiedName().toString(),
+                             attributes[i].value().toString());
+    }
+
+    while (!xml.atEnd())
+    {
+        xml.readNext();
+
+        if (xml.isStartElement())
+        {
+            element.appendChild(readElement(xml, doc));
+        }
+        else if (xml.isCharacters() && !xml.isWhitespace())
+        {
+            // The reader may split text, e.g. around a CDATA section
+            QDomText text = element.lastChild().toText();
+            if (!text.isNull())
+                text.appendData(xml.text().toString());
+            else
+                element.appendChild(doc.createTextNode(xml.text().toString()));
+        }
+        else if (xml.isEndElement())
+        {
+            break;
+        }
+    }
+
+    return element;
+}
+
+/** \brief Reads the channels and programs of an XMLTV file.
+ *
+ *  The file is read one channel or programme element at a time, so large
+ *  files don't have to fit into memory as a whole document.
+ */
 bool XMLTVParser::parseFile(
     QString filename, ChannelInfoList *chanlist,
     QMap<QString, QList<ProgInfo> > *proglist)
 {
-    QDomDocument doc;
     QFile f;
 
     if (!dash_open(f, filename, QIODevice::ReadOnly))
@@ -585,92 +632,105 @@ bool XMLTVParser::parseFile(
         return false;
     }
 
-    QString errorMsg = "unknown";
-    int errorLine = 0;
-    int errorColumn = 0;
-
-    if (!doc.setContent(&f, &errorMsg, &errorLine, &errorColumn))
-    {
-        LOG(VB_GENERAL, LOG_ERR, QString("Error in %1:%2: %3")
-            .arg(errorLine).arg(errorColumn).arg(errorMsg));
-
-        f.close();
-        return true;
-    }
+    QXmlStreamReader xml(&f);
 
-    f.close();
+    while (!xml.atEnd() && !xml.isStartElement())
+        xml.readNext();
 
-    QDomElement docElem = doc.documentElement();
-
-    QUrl baseUrl(docElem.attribute("source-data-url", ""));
-    //QUrl sourceUrl(docElem.attribute("source-info-url", ""));
+    QUrl baseUrl(xml.attributes().value("source-data-url").toString());
+    //QUrl sourceUrl(xml.attributes().value("source-info-url").toString());
 
     QString aggregatedTitle;
     QString aggregatedDesc;
 
-    QDomNode n = docElem.firstChild();
-    while (!n.isNull())
+    while (!xml.atEnd())
     {
-        QDomElement e = n.toElement();
-        if (!e.isNull())
+        xml.readNext();
+
+        if (!xml.isStartElement())
+            continue;
+
+        if (xml.name() != QLatin1String("channel") &&
+            xml.name() != QLatin1String("programme"))
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+
+        QDomDocument doc;
+        QDomElement e = readElement(xml, doc);
+
+        if (xml.hasError())
+            break;
+
+        if (e.tagName() == "channel")
+        {
+            ChannelInfo *chinfo = parseChannel(e, baseUrl);
+            if (!chinfo->xmltvid.isEmpty())
+                chanlist->push_back(*chinfo);
+            delete chinfo;
+        }
+        else if (e.tagName() == "programme")
         {
-            if (e.tagName() == "channel")
+            ProgInfo *pginfo = parseProgram(e);
+
+            if (pginfo->startts == pginfo->endts)
             {
-                ChannelInfo *chinfo = parseChannel(e, baseUrl);
-                if (!chinfo->xmltvid.isEmpty())
-                    chanlist->push_back(*chinfo);
-                delete chinfo;
+                LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
+                                                    "identical start and end "
+                                                    "times, skipping")
+                                                    .arg(pginfo->title));
             }
-            else if (e.tagName() == "programme")
+            else
             {
-                ProgInfo *pginfo = parseProgram(e);
-
-                if (pginfo->startts == pginfo->endts)
-                {
-                    LOG(VB_GENERAL, LOG_WARNING, QString("Invalid programme (%1), "
-                                                        "identical start and end "
-                                                        "times, skipping")
-                                                        .arg(pginfo->title));
-                }
+                if (pginfo->clumpidx.isEmpty())
+                    (*proglist)[pginfo->channel].push_back(*pginfo);
                 else
                 {
-                    if (pginfo->clumpidx.isEmpty())
-                        (*proglist)[pginfo->channel].push_back(*pginfo);
-                    else
+                    /* append all titles/descriptions from one clump */
+                    if (pginfo->clumpidx.toInt() == 0)
                     {
-                        /* append all titles/descriptions from one clump */
-                        if (pginfo->clumpidx.toInt() == 0)
-                        {
-                            aggregatedTitle.clear();
-                            aggregatedDesc.clear();
-                        }
+                        aggregatedTitle.clear();
+                        aggregatedDesc.clear();
+                    }
 
-                        if (!pginfo->title.isEmpty())
-                        {
-                            if (!aggregatedTitle.isEmpty())
-                                aggregatedTitle.append(" | ");
-                            aggregatedTitle.append(pginfo->title);
-                        }
+                    if (!pginfo->title.isEmpty())
+                    {
+                        if (!aggregatedTitle.isEmpty())
+                            aggregatedTitle.append(" | ");
+                        aggregatedTitle.append(pginfo->title);
+                    }
 
-                        if (!pginfo->description.isEmpty())
-                        {
-                            if (!aggregatedDesc.isEmpty())
-                                aggregatedDesc.append(" | ");
-                            aggregatedDesc.append(pginfo->description);
-                        }
-                        if (pginfo->clumpidx.toInt() ==
-                            pginfo->clumpmax.toInt() - 1)
-                        {
-                            pginfo->title = aggregatedTitle;
-                            pginfo->description = aggregatedDesc;
-                            (*proglist)[pginfo->channel].push_back(*pginfo);
-                        }
+                    if (!pginfo->description.isEmpty())
+                    {
+                        if (!aggregatedDesc.isEmpty())
+                            aggregatedDesc.append(" | ");
+                        aggregatedDesc.append(pginfo->description);
+                    }
+                    if (pginfo->clumpidx.toInt() ==
+                        pginfo->clumpmax.toInt() - 1)
+                    {
+                        pginfo->title = aggregatedTitle;
+                        pginfo->description = aggregatedDesc;
+                        (*proglist)[pginfo->channel].push_back(*pginfo);
                     }
                 }
-                delete pginfo;
             }
+            delete pginfo;
         }
-        n = n.nextSibling();
+    }
+
+    f.close();
+
+    if (xml.hasError())
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Error in %1:%2: %3")
+            .arg(xml.lineNumber()).arg(xml.columnNumber())
+            .arg(xml.errorString()));
+
+        // Like a file that can't be parsed at all, don't use any of it
+        chanlist->clear();
+        proglist->clear();
     }
 
     return true;
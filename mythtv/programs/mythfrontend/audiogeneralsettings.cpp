@@ -1272,6 +1272,21 @@ HostCheckBox *AudioAdvancedSettings::HBRPassthrough()
     return gc;
 }
 
+HostCheckBox *AudioAdvancedSettings::UpmixParallel()
+{
+    HostCheckBox *gc = new HostCheckBox("AudioUpmixParallel");
+
+    gc->setLabel(tr("Multi-threaded upmixing"));
+
+    gc->setValue(false);
+
+    gc->setHelpText(tr("If enabled, the stereo to 5.1 upconversion uses "
+                       "up to six threads. This only helps on machines "
+                       "with cores to spare while playing video; it takes "
+                       "more CPU time overall. (default is unchecked)"));
+    return gc;
+}
+
 AudioAdvancedSettings::AudioAdvancedSettings(bool mpcm)
 {
     ConfigurationGroup *settings3 =
@@ -1301,6 +1316,7 @@ AudioAdvancedSettings::AudioAdvancedSettings(bool mpcm)
     ConfigurationGroup *settings6 =
         new HorizontalConfigurationGroup(false, false);
     settings6->addChild(HBRPassthrough());
+    settings6->addChild(UpmixParallel());
 
     addChild(settings4);
     addChild(settings5);
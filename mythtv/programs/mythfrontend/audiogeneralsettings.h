@@ -119,6 +119,7 @@ class AudioAdvancedSettings : public VerticalConfigurationGroup
     HostComboBox       *PassThroughOutputDevice();
     HostCheckBox       *SPDIFRateOverride();
     HostCheckBox       *HBRPassthrough();
+    HostCheckBox       *UpmixParallel();
 
     HostCheckBox       *m_PassThroughOverride;
 };
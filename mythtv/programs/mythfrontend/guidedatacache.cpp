@@ -0,0 +1,314 @@
+// -*- Mode: c++ -*-
+
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QStringList>
+#include <QMap>
+
+// MythTV headers
+#include "guidedatacache.h"
+#include "mythlogging.h"
+#include "mythdbcon.h"
+#include "mythdate.h"
+#include "mythtimer.h"
+#include "mythdb.h"
+
+#define LOC QString("GuideData: ")
+
+/// Length of a tile
+static const uint kTileSecs         = 3 * 60 * 60;
+/// Channels loaded by a single query, keeps it well below its row limit
+static const int  kChannelsPerQuery = 50;
+/// Tiles kept before the least recently used ones are dropped
+static const int  kMaxTiles         = 4096;
+/// Tiles older than this are loaded again, in case the listings were edited
+static const int  kMaxTileAge       = 15 * 60;
+
+static uint TileNumber(const QDateTime &time)
+{
+    return time.toTime_t() / kTileSecs;
+}
+
+static QDateTime TileStart(uint tile)
+{
+    return MythDate::fromTime_t(tile * kTileSecs);
+}
+
+GuideDataCache::GuideDataCache() :
+    m_useCount(0), m_generation(0), m_checkListings(true)
+{
+}
+
+GuideDataCache::~GuideDataCache()
+{
+    Clear();
+}
+
+/** \brief Loads the tiles covering [start, end] of the given channels,
+ *         unless they are already cached.
+ */
+void GuideDataCache::Load(const QVector<uint> &chanids,
+                          const QDateTime &start, const QDateTime &end)
+{
+    if (chanids.isEmpty() || !start.isValid() || end < start)
+        return;
+
+    UpdateListingsTime();
+
+    uint first = TileNumber(start);
+    uint last  = TileNumber(end);
+
+    QVector<uint> missing;
+    uint generation;
+    {
+        QMutexLocker locker(&m_lock);
+        QDateTime now = MythDate::current();
+
+        for (int i = 0; i < chanids.size(); ++i)
+        {
+            for (uint n = first; n <= last; ++n)
+            {
+                if (!IsLoaded(m_tiles.value(TileKey(chanids[i], n)), now))
+                {
+                    missing.push_back(chanids[i]);
+                    break;
+                }
+            }
+        }
+
+        generation = m_generation;
+    }
+
+    if (missing.isEmpty())
+        return;
+
+    MythTimer t(MythTimer::kStartRunning);
+
+    for (int i = 0; i < missing.size(); i += kChannelsPerQuery)
+        LoadChannels(missing.mid(i, kChannelsPerQuery), first, last,
+                     generation);
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Loaded %1 channels x %2 hours in %3 ms")
+            .arg(missing.size()).arg((last - first + 1) * kTileSecs / 3600)
+            .arg(t.elapsed()));
+
+    QMutexLocker locker(&m_lock);
+    Trim();
+}
+
+/** \brief Returns copies of the programs of a channel that overlap
+ *         [start, end], with the recording status from schedList.
+ *
+ *  Tiles that aren't cached yet are loaded first.
+ *  \return a list which the caller takes ownership of
+ */
+ProgramList *GuideDataCache::GetPrograms(uint chanid,
+                                         const QDateTime &start,
+                                         const QDateTime &end,
+                                         const ProgramList &schedList)
+{
+    ProgramList *proglist = new ProgramList();
+
+    if (!start.isValid() || end < start)
+        return proglist;
+
+    Load(QVector<uint>(1, chanid), start, end);
+
+    uint first = TileNumber(start);
+    uint last  = TileNumber(end);
+
+    QMutexLocker locker(&m_lock);
+
+    // A program that spans tiles is in each of them
+    QMap<QDateTime, const ProgramInfo*> programs;
+
+    for (uint n = first; n <= last; ++n)
+    {
+        Tile *tile = m_tiles.value(TileKey(chanid, n));
+        if (!tile)
+            continue;
+
+        tile->lastUsed = ++m_useCount;
+
+        ProgramList::const_iterator it = tile->programs.begin();
+        for (; it != tile->programs.end(); ++it)
+        {
+            if ((*it)->GetScheduledEndTime() >= start &&
+                (*it)->GetScheduledStartTime() <= end)
+                programs.insert((*it)->GetScheduledStartTime(), *it);
+        }
+    }
+
+    QMap<QDateTime, const ProgramInfo*>::const_iterator it = programs.begin();
+    for (; it != programs.end(); ++it)
+    {
+        ProgramInfo *pginfo = new ProgramInfo(**it);
+        pginfo->ApplySchedule(schedList);
+        proglist->push_back(pginfo);
+    }
+
+    return proglist;
+}
+
+/** \brief Has the next Load() check whether mythfilldatabase has run,
+ *         and drop all tiles if it did.
+ *
+ *  This is cheap, call it whenever the schedule changes.
+ */
+void GuideDataCache::CheckListings(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_checkListings = true;
+}
+
+void GuideDataCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    qDeleteAll(m_tiles);
+    m_tiles.clear();
+    m_generation++;
+}
+
+bool GuideDataCache::IsLoaded(const Tile *tile, const QDateTime &now) const
+{
+    return tile && tile->loaded.secsTo(now) < kMaxTileAge;
+}
+
+/** \brief Loads tiles first to last of the channels with a single query.
+ *
+ *  The tiles are dropped if the cache was cleared in the meantime,
+ *  as they may already be out of date.
+ */
+void GuideDataCache::LoadChannels(const QVector<uint> &chanids,
+                                  uint first, uint last, uint generation)
+{
+    QStringList  params;
+    MSqlBindings bindings;
+
+    for (int i = 0; i < chanids.size(); ++i)
+    {
+        QString param = QString(":CHANID%1").arg(i);
+        params << param;
+        bindings[param] = chanids[i];
+    }
+
+    bindings[":STARTTS"] = TileStart(first);
+    bindings[":ENDTS"]   = TileStart(last + 1);
+
+    QString querystr = QString(
+        "WHERE program.chanid IN (%1) "
+        "  AND program.endtime >= :STARTTS "
+        "  AND program.starttime < :ENDTS "
+        "  AND program.manualid = 0 "
+        "GROUP BY program.chanid, program.starttime ")
+        .arg(params.join(", "));
+
+    ProgramList programs;
+    ProgramList noSchedule;
+
+    if (!LoadFromProgram(programs, querystr, bindings, noSchedule))
+        return;
+
+    QDateTime now = MythDate::current();
+    QHash<TileKey, Tile*> loaded;
+
+    for (int i = 0; i < chanids.size(); ++i)
+    {
+        for (uint n = first; n <= last; ++n)
+        {
+            Tile *tile = new Tile;
+            tile->loaded   = now;
+            tile->lastUsed = 0;
+            loaded.insert(TileKey(chanids[i], n), tile);
+        }
+    }
+
+    ProgramList::const_iterator it = programs.begin();
+    for (; it != programs.end(); ++it)
+    {
+        uint from = max(TileNumber((*it)->GetScheduledStartTime()), first);
+        uint to   = min(TileNumber((*it)->GetScheduledEndTime()), last);
+
+        for (uint n = from; n <= to; ++n)
+        {
+            Tile *tile = loaded.value(TileKey((*it)->GetChanID(), n));
+            if (tile)
+                tile->programs.push_back(new ProgramInfo(**it));
+        }
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    if (generation != m_generation)
+    {
+        qDeleteAll(loaded);
+        return;
+    }
+
+    QHash<TileKey, Tile*>::const_iterator lit = loaded.begin();
+    for (; lit != loaded.end(); ++lit)
+    {
+        (*lit)->lastUsed = ++m_useCount;
+        delete m_tiles.value(lit.key());
+        m_tiles.insert(lit.key(), *lit);
+    }
+}
+
+/// \brief Drops all tiles if mythfilldatabase has run since the last check.
+void GuideDataCache::UpdateListingsTime(void)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_checkListings)
+            return;
+        m_checkListings = false;
+    }
+
+    // Not gCoreContext->GetSetting(), that may return a cached value
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT data FROM settings "
+                  "WHERE value = 'mythfilldatabaseLastRunEnd'");
+
+    if (!query.exec())
+    {
+        MythDB::DBError("GuideDataCache::UpdateListingsTime", query);
+        return;
+    }
+
+    QString listingsTime = query.next() ? query.value(0).toString() : "";
+
+    bool changed;
+    {
+        QMutexLocker locker(&m_lock);
+        changed = !m_listingsTime.isNull() && listingsTime != m_listingsTime;
+        m_listingsTime = listingsTime;
+    }
+
+    if (changed)
+    {
+        LOG(VB_GUI, LOG_INFO, LOC + "Listings have been updated");
+        Clear();
+    }
+}
+
+/// \brief Drops the least recently used tiles, m_lock must be held.
+void GuideDataCache::Trim(void)
+{
+    if (m_tiles.size() <= kMaxTiles)
+        return;
+
+    QMap<uint64_t, TileKey> byUse;
+
+    QHash<TileKey, Tile*>::const_iterator it = m_tiles.begin();
+    for (; it != m_tiles.end(); ++it)
+        byUse.insertMulti((*it)->lastUsed, it.key());
+
+    QMap<uint64_t, TileKey>::const_iterator uit = byUse.begin();
+    for (; uit != byUse.end() && m_tiles.size() > kMaxTiles * 3 / 4; ++uit)
+        delete m_tiles.take(*uit);
+}
@@ -0,0 +1,74 @@
+// -*- Mode: c++ -*-
+#ifndef GUIDEDATACACHE_H_
+#define GUIDEDATACACHE_H_
+
+// C headers
+#include <stdint.h>
+
+// Qt headers
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QPair>
+#include <QHash>
+
+// MythTV headers
+#include "programinfo.h"
+
+/** \class GuideDataCache
+ *  \brief Listings for the program guide, loaded in tiles of a few hours
+ *         of a channel with one query for a whole block of channels.
+ *
+ *  Tiles stay cached while the guide is open, so scrolling back to a page
+ *  doesn't query the database again, and GuideGrid prefetches the tiles
+ *  next to the visible ones in the background.  Programs are kept without
+ *  schedule information, it is applied when they are handed out, so after
+ *  a reschedule only the scheduler's list needs to be reloaded.  The tiles
+ *  are only reloaded when mythfilldatabase has run since they were loaded,
+ *  or when they are older than a few minutes.
+ *
+ *  All methods are thread-safe, Load() and GetPrograms() may query the
+ *  database and should not be called from the UI thread.
+ */
+class GuideDataCache
+{
+  public:
+    GuideDataCache();
+    ~GuideDataCache();
+
+    void Load(const QVector<uint> &chanids,
+              const QDateTime &start, const QDateTime &end);
+    ProgramList *GetPrograms(uint chanid,
+                             const QDateTime &start, const QDateTime &end,
+                             const ProgramList &schedList);
+
+    void CheckListings(void);
+    void Clear(void);
+
+  private:
+    class Tile
+    {
+      public:
+        ProgramList programs;
+        QDateTime   loaded;
+        uint64_t    lastUsed;
+    };
+    /// chanid and tile number
+    typedef QPair<uint, uint> TileKey;
+
+    bool IsLoaded(const Tile *tile, const QDateTime &now) const;
+    void LoadChannels(const QVector<uint> &chanids, uint first, uint last,
+                      uint generation);
+    void UpdateListingsTime(void);
+    void Trim(void);
+
+    QMutex                m_lock;
+    QHash<TileKey, Tile*> m_tiles;
+    uint64_t              m_useCount;
+    uint                  m_generation;    ///< Incremented by Clear()
+    bool                  m_checkListings;
+    QString               m_listingsTime;  ///< Last mythfilldatabase run
+};
+
+#endif // GUIDEDATACACHE_H_
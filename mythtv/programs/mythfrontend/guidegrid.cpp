@@ -2,6 +2,7 @@
 #include "guidegrid.h"
 
 // c/c++
+#include <limits.h>
 #include <math.h>
 #include <unistd.h>
 #include <iostream>
@@ -226,7 +227,8 @@ class GuideUpdateProgramRow : public GuideUpdaterBase
 {
 public:
     GuideUpdateProgramRow(GuideGrid *guide, const GuideStatus &gs,
-                          const QVector<ProgramList*> &proglists)
+                          const QVector<ProgramList*> &proglists,
+                          const QVector<uint> &chanids)
         : GuideUpdaterBase(guide),
           m_firstRow(gs.m_firstRow),
           m_numRows(gs.m_numRows),
@@ -244,6 +246,7 @@ public:
           m_verticalLayout(gs.m_verticalLayout),
           m_firstTime(gs.m_firstTime),
           m_lastTime(gs.m_lastTime),
+          m_chanids(chanids),
           m_proglists(proglists)
     {
         for (unsigned int i = m_firstRow;
@@ -263,6 +266,11 @@ public:
             return false;
         }
 
+        // Load all rows with one query, unless they are cached already
+        if (m_proglists.contains(NULL))
+            m_guide->loadProgramData(m_chanids, m_currentStartTime,
+                                     m_currentEndTime);
+
         for (unsigned int i = 0; i < m_numRows; ++i)
         {
             unsigned int row = i + m_firstRow;
@@ -302,6 +310,7 @@ private:
     const bool m_verticalLayout;
     const QDateTime m_firstTime;
     const QDateTime m_lastTime;
+    const QVector<uint> m_chanids;
 
     QVector<ProgramList*> m_proglists;
     ProgInfoGuideArray m_programInfos;
@@ -310,6 +319,52 @@ private:
     QLinkedList<GuideUIElement> m_result;
 };
 
+// Loads the listings around the visible ones into the GuideDataCache,
+// so that they are already there when the guide is scrolled.
+class GuideUpdatePrefetch : public GuideUpdaterBase
+{
+public:
+    GuideUpdatePrefetch(GuideGrid *guide, uint startChan,
+                        const QDateTime &startTime, const QDateTime &endTime,
+                        const QVector<uint> &visible,
+                        const QVector<uint> &neighbours)
+        : GuideUpdaterBase(guide), m_currentStartChannel(startChan),
+          m_currentStartTime(startTime), m_currentEndTime(endTime),
+          m_visible(visible), m_neighbours(neighbours) {}
+    virtual bool ExecuteNonUI(void)
+    {
+        int page = m_currentStartTime.secsTo(m_currentEndTime);
+
+        // Most likely the user pages forward, then up or down, then back
+        if (!Moved())
+            m_guide->loadProgramData(m_visible, m_currentEndTime,
+                                     m_currentEndTime.addSecs(page));
+        if (!Moved())
+            m_guide->loadProgramData(m_neighbours, m_currentStartTime,
+                                     m_currentEndTime);
+        if (!Moved())
+            m_guide->loadProgramData(m_visible,
+                                     m_currentStartTime.addSecs(-page),
+                                     m_currentStartTime);
+
+        return false;
+    }
+    virtual void ExecuteUI(void) {}
+
+private:
+    bool Moved(void) const
+    {
+        return m_currentStartChannel != m_guide->GetCurrentStartChannel() ||
+               m_currentStartTime != m_guide->GetCurrentStartTime();
+    }
+
+    const uint m_currentStartChannel;
+    const QDateTime m_currentStartTime;
+    const QDateTime m_currentEndTime;
+    const QVector<uint> m_visible;
+    const QVector<uint> m_neighbours;
+};
+
 class GuideUpdateChannels : public GuideUpdaterBase
 {
 public:
@@ -586,19 +641,33 @@ void GuideGrid::Load(void)
     setStartChannel((int)(m_currentStartChannel) - (int)(m_channelCount / 2));
     m_channelCount = min(m_channelCount, maxchannel + 1);
 
+    QVector<int>  chanNums;
+    QVector<uint> chanids;
     for (int y = 0; y < m_channelCount; ++y)
     {
         int chanNum = y + m_currentStartChannel;
         if (chanNum >= (int) m_channelInfos.size())
             chanNum -= (int) m_channelInfos.size();
         if (chanNum >= (int) m_channelInfos.size())
-            continue;
-
-        if (chanNum < 0)
+            chanNum = -1;
+        else if (chanNum < 0)
             chanNum = 0;
 
+        chanNums.push_back(chanNum);
+        if (chanNum >= 0)
+            chanids.push_back(GetChannelInfo(chanNum)->chanid);
+    }
+
+    // One query for the whole page instead of one per row
+    m_guideData.Load(chanids, m_currentStartTime, m_currentEndTime);
+
+    for (int y = 0; y < chanNums.size(); ++y)
+    {
+        if (chanNums[y] < 0)
+            continue;
+
         delete m_programs[y];
-        m_programs[y] = getProgramListFromProgram(chanNum);
+        m_programs[y] = getProgramListFromProgram(chanNums[y]);
     }
 }
 
@@ -629,6 +698,9 @@ void GuideGrid::Init(void)
 
 GuideGrid::~GuideGrid()
 {
+    // Makes queued updates and prefetches look out of date, so they are
+    // skipped instead of querying the database for a guide that is gone.
+    m_currentStartChannel = UINT_MAX;
     GuideHelper::Wait(this);
 
     gCoreContext->removeListener(this);
@@ -1328,25 +1400,51 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
 
 ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 {
-    ProgramList *proglist = new ProgramList();
+    return m_guideData.GetPrograms(
+        GetChannelInfo(chanNum)->chanid,
+        m_currentStartTime.addSecs(0 - m_currentStartTime.time().second()),
+        m_currentEndTime.addSecs(0 - m_currentEndTime.time().second()),
+        m_recList);
+}
 
-    if (proglist)
+/**
+ * Queues loading the listings of the pages around the visible one, behind
+ * any work for the visible page.
+ */
+void GuideGrid::prefetchProgramData(void)
+{
+    int count = GetChannelCount();
+    if (!count || m_channelCount <= 0)
+        return;
+
+    QVector<uint> visible;
+    QVector<uint> neighbours;
+
+    for (int row = 0; row < m_channelCount; ++row)
+    {
+        const ChannelInfo *chinfo =
+            GetChannelInfo((m_currentStartChannel + row) % count);
+        if (chinfo)
+            visible.push_back(chinfo->chanid);
+    }
+
+    for (int row = -m_channelCount; row < 2 * m_channelCount; ++row)
     {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.manualid = 0 ";
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] =
-            m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":ENDTS"] =
-            m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+        int chanNum = ((int)m_currentStartChannel + row) % count;
+        if (chanNum < 0)
+            chanNum += count;
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
+        const ChannelInfo *chinfo = GetChannelInfo(chanNum);
+        if (chinfo && !visible.contains(chinfo->chanid) &&
+            !neighbours.contains(chinfo->chanid))
+            neighbours.push_back(chinfo->chanid);
     }
 
-    return proglist;
+    GuideUpdatePrefetch *prefetch =
+        new GuideUpdatePrefetch(this, m_currentStartChannel,
+                                m_currentStartTime, m_currentEndTime,
+                                visible, neighbours);
+    m_threadPool.start(new GuideHelper(this, prefetch), "GuidePrefetch", 1);
 }
 
 void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
@@ -1361,6 +1459,7 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
                       (unsigned int)m_guideGrid->getChannelCount());
     }
     QVector<int> chanNums;
+    QVector<uint> chanids;
     QVector<ProgramList*> proglists;
 
     for (unsigned int i = 0; i < numRows; ++i)
@@ -1391,6 +1490,7 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
         if (useExistingData)
             proglist = CopyProglist(m_programs[row]);
         chanNums.push_back(chanNum);
+        chanids.push_back(GetChannelInfo(chanNum)->chanid);
         proglists.push_back(proglist);
     }
     if (allRows)
@@ -1409,8 +1509,11 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
                    m_currentRow, m_currentCol, m_channelCount, m_timeCount,
                    m_verticalLayout, m_firstTime, m_lastTime);
     GuideUpdateProgramRow *updater =
-        new GuideUpdateProgramRow(this, gs, proglists);
+        new GuideUpdateProgramRow(this, gs, proglists, chanids);
     m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (allRows)
+        prefetchProgramData();
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row, int chanNum,
@@ -1656,6 +1759,9 @@ void GuideGrid::customEvent(QEvent *event)
 
         if (message == "SCHEDULE_CHANGE")
         {
+            // The cached listings get the new schedule when they are used,
+            // they only need reloading if mythfilldatabase has run.
+            m_guideData.CheckListings();
             LoadFromScheduler(m_recList);
             fillProgramInfos();
         }
@@ -22,6 +22,7 @@ using namespace std;
 
 // mythfrontend
 #include "schedulecommon.h"
+#include "guidedatacache.h"
 
 using namespace std;
 
@@ -215,6 +216,9 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
 public:
     // These need to be public so that the helper classes can operate.
     ProgramList *getProgramListFromProgram(int chanNum);
+    void loadProgramData(const QVector<uint> &chanids,
+                         const QDateTime &start, const QDateTime &end)
+        { m_guideData.Load(chanids, start, end); }
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -234,6 +238,7 @@ private:
     int                  GetStartChannelOffset(int row = -1) const;
 
     ProgramList GetProgramList(uint chanid) const;
+    void prefetchProgramData(void);
     uint GetAlternateChannelIndex(uint chan_idx, bool with_same_channum) const;
     void updateDateText(void);
 
@@ -247,6 +252,7 @@ private:
     vector<ProgramList*> m_programs;
     ProgInfoGuideArray m_programInfos;
     ProgramList  m_recList;
+    GuideDataCache m_guideData;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -1593,12 +1593,19 @@ void ProgLister::HandleVisible(MythUIButtonListItem *item)
     }
 }
 
+/// Binds a program of m_itemList, only the visible ones get buttons.
+void ProgLister::BindItem(MythUIButtonListItem *item, int index)
+{
+    if (index < 0 || index >= (int)m_itemList.size())
+        return;
+
+    item->SetData(qVariantFromValue(m_itemList[index]));
+    HandleVisible(item);
+}
+
 void ProgLister::UpdateButtonList(void)
 {
-    ProgramList::const_iterator it = m_itemList.begin();
-    for (; it != m_itemList.end(); ++it)
-        new MythUIButtonListItem(m_progList, "", qVariantFromValue(*it));
-    m_progList->LoadInBackground();
+    m_progList->SetProvider(this);
 
     if (m_positionText)
     {
@@ -6,6 +6,7 @@
 #include <QString>
 
 // MythTV headers
+#include "mythuibuttonlist.h"
 #include "programinfo.h" // for ProgramList
 #include "schedulecommon.h"
 #include "proglist_helpers.h"
@@ -28,7 +29,7 @@ enum ProgListType {
     plPreviouslyRecorded
 };
 
-class ProgLister : public ScheduleCommon
+class ProgLister : public ScheduleCommon, public MythUIButtonListProvider
 {
     friend class PhrasePopup;
     friend class TimePopup;
@@ -48,6 +49,10 @@ class ProgLister : public ScheduleCommon
     bool keyPressEvent(QKeyEvent *);
     void customEvent(QEvent *);
 
+    // MythUIButtonListProvider
+    int  GetItemCount(void) const { return (int)m_itemList.size(); }
+    void BindItem(MythUIButtonListItem *item, int index);
+
   protected slots:
     void HandleSelected(MythUIButtonListItem *item);
     void HandleVisible(MythUIButtonListItem *item);
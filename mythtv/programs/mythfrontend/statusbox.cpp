@@ -1270,6 +1270,30 @@ void StatusBox::doMachineStatus()
         }
     }
 
+    // image cache of this frontend
+    uint images;
+    uint64_t bytes, maxBytes, memoryHits, diskHits, misses, evictions;
+    GetMythUI()->GetImageCacheStats(images, bytes, maxBytes,
+                                    memoryHits, diskHits, misses, evictions);
+
+    line = "   " + tr("Image cache") + ": " +
+           tr("%n image(s) using %1, limit %2", "", images)
+           .arg(sm_str(bytes / 1024)).arg(sm_str(maxBytes / 1024));
+    AddLogLine(line, machineStr);
+
+    uint64_t lookups = memoryHits + diskHits + misses;
+    if (lookups > 0)
+    {
+        line = "   " + tr("Image cache hits") + ": " +
+               tr("%1% from memory, %2% from disk, %3% loaded")
+               .arg(memoryHits * 100.0 / lookups, 0, 'f', 1)
+               .arg(diskHits * 100.0 / lookups, 0, 'f', 1)
+               .arg(misses * 100.0 / lookups, 0, 'f', 1);
+        if (evictions > 0)
+            line += ", " + tr("%1 evicted").arg(evictions);
+        AddLogLine(line, machineStr);
+    }
+
     if (!m_isBackendActive)
     {
         line = tr("MythTV server") + ':';
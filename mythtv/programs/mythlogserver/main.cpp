@@ -21,6 +21,7 @@ using namespace std;
 #include "ringbuffer.h"
 #include "exitcodes.h"
 #include "loggingserver.h"
+#include "logstore.h"
 #include "signalhandling.h"
 
 namespace {
@@ -120,6 +121,8 @@ int main(int argc, char *argv[])
         return GENERIC_EXIT_NO_MYTHCONTEXT;
     }
 
+    LogStore::PublishPath();
+
     qApp->exec();
 
     SignalHandler::Done();
@@ -19,6 +19,10 @@ void MythPreviewGeneratorCommandLineParser::LoadArguments(void)
     add("--size", "size", QSize(0,0), "Dimensions of preview image.", "");
     add("--infile", "inputfile", "", "Input video for preview generation.", "");
     add("--outfile", "outputfile", "", "Optional output file for preview generation.", "");
+    add("--capture", "captures", QVariant::StringList,
+            "Additional preview to take from the same video, as "
+            "<time><s|f>:<width>x<height>:<outfile>. "
+            "Can be given multiple times.", "");
 }
 
 
@@ -90,7 +90,8 @@ namespace
 int preview_helper(uint chanid, QDateTime starttime,
                    long long previewFrameNumber, long long previewSeconds,
                    const QSize &previewSize,
-                   const QString &infile, const QString &outfile)
+                   const QString &infile, const QString &outfile,
+                   const QStringList &captures)
 {
     // Lower scheduling priority, to avoid problems with recordings.
     if (setpriority(PRIO_PROCESS, 0, 9))
@@ -143,6 +144,8 @@ int preview_helper(uint chanid, QDateTime starttime,
 
     previewgen->SetOutputSize(previewSize);
     previewgen->SetOutputFilename(outfile);
+    for (int i = 0; i < captures.size(); ++i)
+        previewgen->m_captures.push_back(PreviewCapture::FromString(captures[i]));
     bool ok = previewgen->RunReal();
     previewgen->deleteLater();
 
@@ -230,7 +233,8 @@ int main(int argc, char **argv)
         cmdline.toUInt("chanid"), cmdline.toDateTime("starttime"),
         cmdline.toLongLong("frame"), cmdline.toLongLong("seconds"),
         cmdline.toSize("size"),
-        cmdline.toString("inputfile"), cmdline.toString("outputfile"));
+        cmdline.toString("inputfile"), cmdline.toString("outputfile"),
+        cmdline.toStringList("captures"));
     return ret;
 }
 
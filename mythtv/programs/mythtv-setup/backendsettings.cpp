@@ -227,6 +227,33 @@ static GlobalSpinBox *HDRingbufferSize()
     return bs;
 }
 
+static HostSpinBox *LiveTVRAMBufferSize()
+{
+    HostSpinBox *bs = new HostSpinBox("LiveTVRAMBufferSize", 0, 1024, 16);
+    bs->setLabel(QObject::tr("LiveTV RAM buffer size (MB)"));
+    bs->setHelpText(QObject::tr("If not zero, LiveTV recordings on this "
+                    "backend are written to disk later and in larger "
+                    "batches. The most recent part of each recording is "
+                    "held in memory and sent to frontends from there, and "
+                    "is written to disk once it no longer fits, or when "
+                    "the recording is kept or finished. Nothing is left "
+                    "out of the recording. Each tuner in LiveTV uses up "
+                    "to this much memory."));
+    bs->setValue(0);
+    return bs;
+}
+
+static HostSpinBox *LiveTVRAMBufferTime()
+{
+    HostSpinBox *bs = new HostSpinBox("LiveTVRAMBufferTime", 0, 120, 1);
+    bs->setLabel(QObject::tr("LiveTV RAM buffer time (minutes)"));
+    bs->setHelpText(QObject::tr("If not zero, LiveTV data is also written "
+                    "to disk after it has been in memory for this many "
+                    "minutes, even if the RAM buffer isn't full."));
+    bs->setValue(0);
+    return bs;
+}
+
 static GlobalComboBox *StorageScheduler()
 {
     GlobalComboBox *gc = new GlobalComboBox("StorageScheduler");
@@ -856,6 +883,11 @@ BackendSettings::BackendSettings() {
     fmh1->addChild(TruncateDeletes());
     fm->addChild(fmh1);
     fm->addChild(HDRingbufferSize());
+    HorizontalConfigurationGroup *fmh2 =
+        new HorizontalConfigurationGroup(false, false, true, true);
+    fmh2->addChild(LiveTVRAMBufferSize());
+    fmh2->addChild(LiveTVRAMBufferTime());
+    fm->addChild(fmh2);
     fm->addChild(StorageScheduler());
     group2->addChild(fm);
     VerticalConfigurationGroup* upnp = new VerticalConfigurationGroup();
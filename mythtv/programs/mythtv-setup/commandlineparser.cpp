@@ -38,6 +38,10 @@ void MythTVSetupCommandLineParser::LoadArguments(void)
             "Specify which input to scan for, if specified card "
             "supports multiple.");
     add("--FTAonly", "ftaonly", false, "", "Only import 'Free To Air' channels.");
+    add("--scan-all-tuners", "alltuners", false, "",
+            "Scan with all free tuners of the same type that are "
+            "connected to the video source. Satellite scans always "
+            "use one tuner.");
     add("--service-type", "servicetype", "all", "",
             "To be used with channel scanning or importing, specify "
             "the type of services to import. Select from the following, "
@@ -50,6 +54,7 @@ void MythTVSetupCommandLineParser::LoadArguments(void)
         ->SetParentOf("inputname")
         ->SetParentOf("ftaonly")
         ->SetParentOf("servicetype")
+        ->SetParentOf("alltuners")
         ->SetBlocks("importscan");
 
     add("--scan-import", "importscan", 0U, "",